@@ -11,7 +11,7 @@
 
 #include <stdarg.h>
 #include <stdio.h>
-#include <string.h>                 // strlen
+#include <string.h>                 // memcpy, strlen
 
 #include "Debug.h"                  // ASSERT
 
@@ -27,8 +27,10 @@ const size_t RESERVE_COLS = 80;
 
 CSelectedOutput::CSelectedOutput()
 : m_nRowCount(0)
+, m_nNextCol(0)
+, m_nStringsFree(0)
 {
-	this->m_arrayVar.reserve(RESERVE_COLS);
+	this->m_columns.reserve(RESERVE_COLS);
 }
 
 CSelectedOutput::~CSelectedOutput()
@@ -38,9 +40,12 @@ CSelectedOutput::~CSelectedOutput()
 void CSelectedOutput::Clear(void)
 {
 	this->m_nRowCount = 0;
+	this->m_nNextCol = 0;
 	this->m_vecVarHeadings.clear();
-	this->m_arrayVar.clear();
+	this->m_columns.clear();
 	this->m_mapHeadingToCol.clear();
+	this->m_strings.clear();
+	this->m_nStringsFree = 0;
 }
 
 size_t CSelectedOutput::GetRowCount(void)const
@@ -87,8 +92,34 @@ VRESULT CSelectedOutput::Get(int nRow, int nCol, VAR* pVAR)const
 	}
 	if (nRow)
 	{
-		ASSERT((size_t)nRow <= this->m_arrayVar[nCol].size());
-		return ::VarCopy(pVAR, &(this->m_arrayVar[nCol])[nRow - 1]);
+		const Column& c = this->m_columns[nCol];
+		size_t i = (size_t)nRow - 1;
+		ASSERT(i < c.types.size());
+		pVAR->type = (VAR_TYPE)c.types[i];
+		switch (pVAR->type)
+		{
+		case TT_LONG:
+			pVAR->lVal = c.longs[i];
+			break;
+		case TT_DOUBLE:
+			pVAR->dVal = c.doubles[i];
+			break;
+		case TT_STRING:
+			pVAR->sVal = (c.longs[i] < 0) ? NULL : ::VarAllocString(&this->m_strings[c.longs[i]]);
+			if (pVAR->sVal == NULL && c.longs[i] >= 0)
+			{
+				pVAR->type = TT_ERROR;
+				pVAR->vresult = VR_OUTOFMEMORY;
+				return pVAR->vresult;
+			}
+			break;
+		case TT_ERROR:
+			pVAR->vresult = (VRESULT)c.longs[i];
+			break;
+		default:
+			break;
+		}
+		return VR_OK;
 	}
 	else
 	{
@@ -96,21 +127,61 @@ VRESULT CSelectedOutput::Get(int nRow, int nCol, VAR* pVAR)const
 	}
 }
 
+const double* CSelectedOutput::GetDoubles(int nCol)const
+{
+	if ((size_t)nCol >= this->GetColCount() || nCol < 0 || this->m_nRowCount == 0)
+	{
+		return NULL;
+	}
+	ASSERT(this->m_columns[nCol].doubles.size() >= this->m_nRowCount);
+	return &this->m_columns[nCol].doubles[0];
+}
+
+VRESULT CSelectedOutput::GetDoubles(double* values, size_t nValuesRows, size_t nValuesCols, bool bRowMajor)const
+{
+	size_t nrows = this->m_nRowCount;
+	size_t ncols = this->GetColCount();
+	if (values == NULL || nValuesRows < nrows || nValuesCols < ncols)
+	{
+		return VR_INVALIDARG;
+	}
+	for (size_t j = 0; j < ncols; ++j)
+	{
+		const double* column = nrows ? &this->m_columns[j].doubles[0] : NULL;
+		if (bRowMajor)
+		{
+			for (size_t i = 0; i < nrows; ++i)
+			{
+				values[i * nValuesCols + j] = column[i];
+			}
+		}
+		else if (nrows)
+		{
+			::memcpy(values + j * nValuesRows, column, nrows * sizeof(double));
+		}
+	}
+	return VR_OK;
+}
+
 
 int CSelectedOutput::EndRow(void)
 {
 	if (size_t ncols = this->GetColCount())
 	{
 		++this->m_nRowCount;
+		this->m_nNextCol = 0;
 
 		// make sure array is full
 		for (size_t col = 0; col < ncols; ++col)
 		{
-			size_t nrows = this->m_arrayVar[col].size();
+			Column& c = this->m_columns[col];
+			size_t nrows = c.types.size();
 			if (nrows < this->m_nRowCount)
 			{
 				// fill w/ empty
-				this->m_arrayVar[col].resize(this->m_nRowCount);
+				c.types.resize(this->m_nRowCount, (char)TT_EMPTY);
+				c.doubles.resize(this->m_nRowCount, (double)INACTIVE_CELL_VALUE);
+				c.longs.resize(this->m_nRowCount, 0L);
 			}
 #if defined(_DEBUG)
 			else if (nrows > this->m_nRowCount)
@@ -119,83 +190,210 @@ int CSelectedOutput::EndRow(void)
 			}
 #endif
 		}
+		if (this->m_nStringsFree > this->m_strings.size() / 2)
+		{
+			this->CompactStrings();
+		}
 	}
 	return 0;
 }
 
-int CSelectedOutput::PushBack(const char* key, const CVar& var)
+void CSelectedOutput::CompactStrings(void)
 {
-	try
+	// copies the strings still referenced, each cell has its own
+	std::vector<char> strings;
+	strings.reserve(this->m_strings.size() - this->m_nStringsFree);
+	for (size_t col = 0; col < this->m_columns.size(); ++col)
 	{
-		// check if key is new
-		std::map< std::string, size_t >::iterator find;
-		find = this->m_mapHeadingToCol.find(std::string(key));
-		if (find == this->m_mapHeadingToCol.end())
+		Column& c = this->m_columns[col];
+		for (size_t row = 0; row < c.types.size(); ++row)
 		{
-			// new key(column)
-			//
-			this->m_mapHeadingToCol.insert(std::map< std::string, size_t >::value_type(std::string(key),
-				this->m_mapHeadingToCol.size()) );
+			if (c.types[row] == TT_STRING && c.longs[row] >= 0)
+			{
+				const char* str = &this->m_strings[c.longs[row]];
+				c.longs[row] = (long)strings.size();
+				strings.insert(strings.end(), str, str + ::strlen(str) + 1);
+			}
+		}
+	}
+	this->m_strings.swap(strings);
+	this->m_nStringsFree = 0;
+}
 
-			// add heading
-			//
-			this->m_vecVarHeadings.push_back(CVar(key));
+size_t CSelectedOutput::FindCol(const char* key)
+{
+	// USER_PUNCH and SELECTED_OUTPUT punch the columns of each row in
+	// the same order, so the heading map is only searched when the
+	// expected column does not match
+	size_t ncols = this->m_vecVarHeadings.size();
+	if (this->m_nNextCol < ncols && ::strcmp(this->m_vecVarHeadings[this->m_nNextCol].sVal, key) == 0)
+	{
+		return this->m_nNextCol++;
+	}
 
+	// check if key is new
+	std::map< std::string, size_t >::iterator find;
+	find = this->m_mapHeadingToCol.find(std::string(key));
+	if (find != this->m_mapHeadingToCol.end())
+	{
+		this->m_nNextCol = find->second + 1;
+		return find->second;
+	}
 
-			// add new vector(col)
-			//
-			this->m_arrayVar.resize(this->m_arrayVar.size() + 1);
-			this->m_arrayVar.back().reserve(RESERVE_ROWS);
+	// new key(column)
+	//
+	this->m_mapHeadingToCol.insert(std::map< std::string, size_t >::value_type(std::string(key), ncols));
+
+	// add heading
+	//
+	this->m_vecVarHeadings.push_back(CVar(key));
+
+	// add new column with empty rows if nec
+	//
+	this->m_columns.resize(ncols + 1);
+	Column& c = this->m_columns.back();
+	c.types.reserve(RESERVE_ROWS);
+	c.doubles.reserve(RESERVE_ROWS);
+	c.longs.reserve(RESERVE_ROWS);
+	c.types.resize(this->m_nRowCount, (char)TT_EMPTY);
+	c.doubles.resize(this->m_nRowCount, (double)INACTIVE_CELL_VALUE);
+	c.longs.resize(this->m_nRowCount, 0L);
+
+	this->m_nNextCol = ncols + 1;
+	return ncols;
+}
 
-			// add empty rows if nec
-			if (this->m_nRowCount)
-				this->m_arrayVar.back().resize(this->m_nRowCount);
+void CSelectedOutput::PushBackTyped(const char* key, VAR_TYPE type, double dVal, long lVal)
+{
+	this->SetCell(this->m_columns[this->FindCol(key)], type, dVal, lVal);
+}
 
-			this->m_arrayVar.back().push_back(var);
+void CSelectedOutput::SetCell(Column& c, VAR_TYPE type, double dVal, long lVal)
+{
+	if (c.types.size() == this->m_nRowCount)
+	{
+		c.types.push_back((char)type);
+		c.doubles.push_back(dVal);
+		c.longs.push_back(lVal);
+	}
+	else
+	{
+		// the column was already punched in this row
+		ASSERT(c.types.size() == this->m_nRowCount + 1);
+		long old = c.longs[this->m_nRowCount];
+		if (c.types[this->m_nRowCount] == TT_STRING && old >= 0 && !(type == TT_STRING && lVal == old))
+		{
+			this->m_nStringsFree += ::strlen(&this->m_strings[old]) + 1;
 		}
-		else
+		c.types[this->m_nRowCount] = (char)type;
+		c.doubles[this->m_nRowCount] = dVal;
+		c.longs[this->m_nRowCount] = lVal;
+	}
+}
+
+int CSelectedOutput::PushBack(const char* key, const CVar& var)
+{
+	switch (var.type)
+	{
+	case TT_LONG:
+		return this->PushBackLong(key, var.lVal);
+	case TT_DOUBLE:
+		return this->PushBackDouble(key, var.dVal);
+	case TT_STRING:
+		return this->PushBackString(key, var.sVal);
+	case TT_ERROR:
+		try
 		{
-			if (this->m_arrayVar[find->second].size() == this->m_nRowCount) {
-				this->m_arrayVar[find->second].push_back(var);
-			}
-			else {
-				ASSERT(this->m_arrayVar[find->second].size() == this->m_nRowCount + 1);
-				this->m_arrayVar[find->second].at(this->m_nRowCount) = var;
-			}
+			this->PushBackTyped(key, TT_ERROR, (double)INACTIVE_CELL_VALUE, (long)var.vresult);
+		}
+		catch(...)
+		{
+			ASSERT(false);
+			throw;
 		}
 		return 0;
+	default:
+		return this->PushBackEmpty(key);
+	}
+}
+
+int CSelectedOutput::PushBackDouble(const char* key, double value)
+{
+	try
+	{
+		this->PushBackTyped(key, TT_DOUBLE, value, 0L);
 	}
 	catch(...)
 	{
 		ASSERT(false);
 		throw;
 	}
-	return 1; // error
-}
-
-
-int CSelectedOutput::PushBackDouble(const char* key, double value)
-{
-	CVar v(value);
-	return this->PushBack(key, v);
+	return 0;
 }
 
 int CSelectedOutput::PushBackLong(const char* key, long value)
 {
-	CVar v(value);
-	return this->PushBack(key, v);
+	try
+	{
+		this->PushBackTyped(key, TT_LONG, (double)value, value);
+	}
+	catch(...)
+	{
+		ASSERT(false);
+		throw;
+	}
+	return 0;
 }
 
 int CSelectedOutput::PushBackString(const char* key, const char* value)
 {
-	CVar v(value);
-	return this->PushBack(key, v);
+	try
+	{
+		Column& c = this->m_columns[this->FindCol(key)];
+		long offset = -1;
+		if (value)
+		{
+			size_t len = ::strlen(value) + 1;
+			if (c.types.size() > this->m_nRowCount && c.types[this->m_nRowCount] == TT_STRING &&
+				c.longs[this->m_nRowCount] >= 0)
+			{
+				// overwrites the string of this row in place if it fits
+				size_t old_len = ::strlen(&this->m_strings[c.longs[this->m_nRowCount]]) + 1;
+				if (len <= old_len)
+				{
+					offset = c.longs[this->m_nRowCount];
+					::memcpy(&this->m_strings[offset], value, len);
+					this->m_nStringsFree += old_len - len;
+				}
+			}
+			if (offset < 0)
+			{
+				offset = (long)this->m_strings.size();
+				this->m_strings.insert(this->m_strings.end(), value, value + len);
+			}
+		}
+		this->SetCell(c, TT_STRING, (double)INACTIVE_CELL_VALUE, offset);
+	}
+	catch(...)
+	{
+		ASSERT(false);
+		throw;
+	}
+	return 0;
 }
 
 int CSelectedOutput::PushBackEmpty(const char* key)
 {
-	CVar v;
-	return this->PushBack(key, v);
+	try
+	{
+		this->PushBackTyped(key, TT_EMPTY, (double)INACTIVE_CELL_VALUE, 0L);
+	}
+	catch(...)
+	{
+		ASSERT(false);
+		throw;
+	}
+	return 0;
 }
 
 #if defined(_DEBUG)
@@ -217,10 +415,12 @@ void CSelectedOutput::AssertValid(void)const
 {
 	if (size_t cols = this->GetColCount())
 	{
-		size_t rows = this->m_arrayVar[0].size();
+		size_t rows = this->m_columns[0].types.size();
 		for (size_t col = 0; col < cols; ++col)
 		{
-			ASSERT(rows == this->m_arrayVar[col].size());
+			ASSERT(rows == this->m_columns[col].types.size());
+			ASSERT(rows == this->m_columns[col].doubles.size());
+			ASSERT(rows == this->m_columns[col].longs.size());
 		}
 	}
 }
@@ -273,25 +473,27 @@ void CSelectedOutput::Serialize(
 	// go through rows by column
 	for (size_t j = 0; j < ncols; j++)
 	{
+		const Column& c = this->m_columns[j];
 		for (size_t i = row_number; i < (size_t)(row_number + 1); i++)
 		{
-			types.push_back(m_arrayVar[j][i].type);
-			switch(m_arrayVar[j][i].type)
+			types.push_back(c.types[i]);
+			switch(c.types[i])
 			{
 			case TT_EMPTY:
 				break;
 			case TT_ERROR:
-				longs.push_back(m_arrayVar[j][i].vresult);
-				break;
 			case TT_LONG:
-				longs.push_back(m_arrayVar[j][i].lVal);
+				longs.push_back(c.longs[i]);
 				break;
 			case TT_DOUBLE:
-				doubles.push_back(m_arrayVar[j][i].dVal);
+				doubles.push_back(c.doubles[i]);
 				break;
 			case TT_STRING:
-				longs.push_back((long) strlen(m_arrayVar[j][i].sVal));
-				strings.append(m_arrayVar[j][i].sVal);
+				{
+					const char* str = (c.longs[i] < 0) ? "" : &this->m_strings[c.longs[i]];
+					longs.push_back((long) strlen(str));
+					strings.append(str);
+				}
 				break;
 
 			}
@@ -368,34 +570,10 @@ void CSelectedOutput::Doublize(
 	nrow = (int) this->m_nRowCount;
 	ncol = (int) this->m_vecVarHeadings.size();
 
-	doubles.clear();
 	// go through column dominant order (Fortran)
-	for (size_t j = 0; j < (size_t)ncol; j++)
+	doubles.resize((size_t)nrow * (size_t)ncol);
+	if (doubles.size())
 	{
-		for (size_t i = 0; i < (size_t)nrow; i++)
-		{
-			switch(m_arrayVar[j][i].type)
-			{
-			case TT_EMPTY:
-				doubles.push_back((double) INACTIVE_CELL_VALUE);
-				break;
-			case TT_ERROR:
-				doubles.push_back((double) INACTIVE_CELL_VALUE);
-				break;
-			case TT_LONG:
-				doubles.push_back((double) m_arrayVar[j][i].lVal);
-				break;
-			case TT_DOUBLE:
-				doubles.push_back(m_arrayVar[j][i].dVal);
-				break;
-			case TT_STRING:
-				doubles.push_back((double) INACTIVE_CELL_VALUE);
-				break;
-			default:
-				doubles.push_back((double) INACTIVE_CELL_VALUE);
-				break;
-
-			}
-		}
+		this->GetDoubles(&doubles[0], (size_t)nrow, (size_t)ncol, false);
 	}
 }
@@ -37,6 +37,11 @@ public:
 	int PushBackString(const char* key, const char* sVal);
 	int PushBackEmpty(const char* key);
 
+	// Bulk export of the values as doubles; TT_LONG values are converted
+	// and empty, error and string values are INACTIVE_CELL_VALUE
+	const double* GetDoubles(int nCol)const;
+	VRESULT GetDoubles(double* values, size_t nValuesRows, size_t nValuesCols, bool bRowMajor)const;
+
 	// Serialize
 	void Serialize(
 		int row,
@@ -62,11 +67,27 @@ public:
 protected:
 	friend std::ostream& operator<< (std::ostream &os, const CSelectedOutput &a);
 
+	size_t FindCol(const char* key);
+	void PushBackTyped(const char* key, VAR_TYPE type, double dVal, long lVal);
+
+	// values of one column, one element per row
+	struct Column
+	{
+		std::vector<char>   types;      // VAR_TYPE
+		std::vector<double> doubles;    // TT_DOUBLE and TT_LONG values, INACTIVE_CELL_VALUE otherwise
+		std::vector<long>   longs;      // TT_LONG value, offset in m_strings of TT_STRING, VRESULT of TT_ERROR
+	};
+	void SetCell(Column& c, VAR_TYPE type, double dVal, long lVal);
+	void CompactStrings(void);
+
 	size_t m_nRowCount;
+	size_t m_nNextCol;                  // column expected for the next value of the row
 
-	std::vector< std::vector<CVar> > m_arrayVar;
+	std::vector<Column> m_columns;
 	std::vector<CVar> m_vecVarHeadings;
 	std::map< std::string, size_t > m_mapHeadingToCol;
+	std::vector<char> m_strings;        // TT_STRING values, each terminated by '\0'
+	size_t m_nStringsFree;              // bytes of m_strings no longer referenced by a cell
 
 private:
 	static CSelectedOutput* s_instance;
@@ -1,8 +1,19 @@
 #include <memory>                       // auto_ptr
 #include <map>
 #include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#if !defined(WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
 #include "IPhreeqc.hpp"                 // IPhreeqc
 #include "Phreeqc.h"                    // Phreeqc
+#include "Solution.h"                   // cxxSolution
 #include "thread.h"
 #include "Version.h"
 
@@ -20,11 +31,134 @@ std::string IPhreeqc::Version(VERSION_STRING);
 
 static const char empty[] = "";
 
+// read-only database shared by IPhreeqc instances (see CreateDatabaseSnapshot)
+class IPhreeqcDatabase
+{
+public:
+	IPhreeqcDatabase(void)
+	: PhreeqcPtr(new Phreeqc)
+	, RefCount(1)
+	, Checksum(0)
+	{
+	}
+	~IPhreeqcDatabase(void)
+	{
+		delete this->PhreeqcPtr;
+	}
+	Phreeqc* PhreeqcPtr;
+	size_t   RefCount;                  // guarded by map_lock
+	unsigned long long Checksum;        // of the database text
+};
+
+static bool
+read_text_file(const char* filename, std::string& text)
+{
+	std::ifstream ifs;
+	ifs.open(filename);
+	if (!ifs.is_open())
+	{
+		return false;
+	}
+	text.assign((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+	return true;
+}
+
+static bool
+file_stamp(const char* filename, long long* size, long long* time)
+{
+	struct stat st;
+	if (::stat(filename, &st) != 0)
+	{
+		return false;
+	}
+	*size = (long long) st.st_size;
+	*time = (long long) st.st_mtime;
+	return true;
+}
+
+// read-only view of a whole file, mapped into memory
+class MappedFile
+{
+public:
+	MappedFile(void)
+	: Begin(0)
+	, Size(0)
+#if defined(WIN32)
+	, File(INVALID_HANDLE_VALUE)
+	, Mapping(NULL)
+#endif
+	{
+	}
+	~MappedFile(void)
+	{
+		this->close();
+	}
+	bool open(const char* filename)
+	{
+		this->close();
+#if defined(WIN32)
+		this->File = ::CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		LARGE_INTEGER size;
+		if (this->File == INVALID_HANDLE_VALUE || !::GetFileSizeEx(this->File, &size) || size.QuadPart <= 0)
+		{
+			this->close();
+			return false;
+		}
+		this->Mapping = ::CreateFileMappingA(this->File, NULL, PAGE_READONLY, 0, 0, NULL);
+		this->Begin = (this->Mapping != NULL) ? (const char*) ::MapViewOfFile(this->Mapping, FILE_MAP_READ, 0, 0, 0) : 0;
+		this->Size = (size_t) size.QuadPart;
+#else
+		int fd = ::open(filename, O_RDONLY);
+		struct stat st;
+		if (fd < 0 || ::fstat(fd, &st) != 0 || st.st_size <= 0)
+		{
+			if (fd >= 0) ::close(fd);
+			return false;
+		}
+		void* p = ::mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		this->Begin = (p != MAP_FAILED) ? (const char*) p : 0;
+		this->Size = (size_t) st.st_size;
+#endif
+		if (this->Begin == 0)
+		{
+			this->close();
+			return false;
+		}
+		return true;
+	}
+	void close(void)
+	{
+#if defined(WIN32)
+		if (this->Begin) ::UnmapViewOfFile(this->Begin);
+		if (this->Mapping != NULL) ::CloseHandle(this->Mapping);
+		if (this->File != INVALID_HANDLE_VALUE) ::CloseHandle(this->File);
+		this->Mapping = NULL;
+		this->File = INVALID_HANDLE_VALUE;
+#else
+		if (this->Begin) ::munmap((void*) this->Begin, this->Size);
+#endif
+		this->Begin = 0;
+		this->Size = 0;
+	}
+	bool is_open(void)const       { return this->Begin != 0; }
+	const char* begin(void)const  { return this->Begin; }
+	const char* end(void)const    { return this->Begin + this->Size; }
+protected:
+	const char* Begin;
+	size_t Size;
+#if defined(WIN32)
+	HANDLE File;
+	HANDLE Mapping;
+#endif
+};
+
 
 IPhreeqc::IPhreeqc(void)
 : DatabaseLoaded(false)
 , ClearAccumulated(false)
 , UpdateComponents(true)
+, SelectedOutputBinaryOnly(false)
 , OutputFileOn(false)
 , LogFileOn(false)
 , ErrorFileOn(false)
@@ -38,6 +172,11 @@ IPhreeqc::IPhreeqc(void)
 , WarningReporter(0)
 , CurrentSelectedOutputUserNumber(1)
 , PhreeqcPtr(0)
+, DatabaseSnapshot(0)
+, DatabaseChecksum(0)
+, DatabaseFileSize(-1)
+, DatabaseFileTime(-1)
+, DatabaseBinaryUsed(false)
 , input_file(0)
 , database_file(0)
 {
@@ -73,6 +212,7 @@ IPhreeqc::~IPhreeqc(void)
 	this->OutputFileOn = false;
 #endif
 	delete this->PhreeqcPtr;
+	IPhreeqc::ReleaseDatabaseSnapshot(this->DatabaseSnapshot);
 	delete this->WarningReporter;
 	delete this->ErrorReporter;
 
@@ -163,6 +303,19 @@ int IPhreeqc::GetCurrentSelectedOutputUserNumber(void)const
 	return this->CurrentSelectedOutputUserNumber;
 }
 
+void IPhreeqc::GetCvodeStatistics(int *integrations, int *steps, int *rhs_evaluations, int *jacobian_evaluations)const
+{
+	if (integrations)         *integrations         = this->PhreeqcPtr->cvode_integrations;
+	if (steps)                *steps                = this->PhreeqcPtr->cvode_steps_taken;
+	if (rhs_evaluations)      *rhs_evaluations      = this->PhreeqcPtr->cvode_rhs_evaluations;
+	if (jacobian_evaluations) *jacobian_evaluations = this->PhreeqcPtr->cvode_jacobian_evaluations;
+}
+
+bool IPhreeqc::GetDatabaseBinaryUsed(void)const
+{
+	return this->DatabaseBinaryUsed;
+}
+
 const char* IPhreeqc::GetDumpFileName(void)const
 {
 	return this->DumpFileName.c_str();
@@ -344,6 +497,24 @@ bool IPhreeqc::GetOutputStringOn(void)const
 	return this->OutputStringOn;
 }
 
+bool IPhreeqc::GetProfilingOn(void)const
+{
+	return this->PhreeqcPtr->profiler.Get_on();
+}
+
+const char* IPhreeqc::GetProfilingString(void)
+{
+	std::ostringstream oss;
+	this->PhreeqcPtr->profiler.Dump_json(oss);
+	this->ProfilingString = oss.str();
+	return this->ProfilingString.c_str();
+}
+
+bool IPhreeqc::GetSelectedOutputBinaryOnly(void)const
+{
+	return this->SelectedOutputBinaryOnly;
+}
+
 int IPhreeqc::GetSelectedOutputColumnCount(void)const
 {
 	std::map< int, CSelectedOutput* >::const_iterator ci = this->SelectedOutputMap.find(this->CurrentSelectedOutputUserNumber);
@@ -373,7 +544,33 @@ const char* IPhreeqc::GetSelectedOutputFileName(void)const
 
 bool IPhreeqc::GetSelectedOutputFileOn(void)const
 {
-	return this->get_sel_out_file_on(this->CurrentSelectedOutputUserNumber);
+	// reports the setting even while SelectedOutputBinaryOnly overrides it
+	std::map< int, bool >::const_iterator ci = this->SelectedOutputFileOnMap.find(this->CurrentSelectedOutputUserNumber);
+	return (ci != this->SelectedOutputFileOnMap.end()) && (*ci).second;
+}
+
+const double* IPhreeqc::GetSelectedOutputColumnDoubles(int col)const
+{
+	std::map< int, CSelectedOutput* >::const_iterator ci = this->SelectedOutputMap.find(this->CurrentSelectedOutputUserNumber);
+	if (ci != this->SelectedOutputMap.end())
+	{
+		return (*ci).second->GetDoubles(col);
+	}
+	return NULL;
+}
+
+VRESULT IPhreeqc::GetSelectedOutputDoubles(double* values, int rows, int cols, bool row_major)const
+{
+	if (values == NULL || rows < 0 || cols < 0)
+	{
+		return VR_INVALIDARG;
+	}
+	std::map< int, CSelectedOutput* >::const_iterator ci = this->SelectedOutputMap.find(this->CurrentSelectedOutputUserNumber);
+	if (ci != this->SelectedOutputMap.end())
+	{
+		return (*ci).second->GetDoubles(values, (size_t)rows, (size_t)cols, row_major);
+	}
+	return VR_OK;
 }
 
 int IPhreeqc::GetSelectedOutputRowCount(void)const
@@ -426,7 +623,9 @@ int IPhreeqc::GetSelectedOutputStringLineCount(void)const
 
 bool IPhreeqc::GetSelectedOutputStringOn(void)const
 {
-	return this->get_sel_out_string_on(this->CurrentSelectedOutputUserNumber);
+	// reports the setting even while SelectedOutputBinaryOnly overrides it
+	std::map< int, bool >::const_iterator ci = this->SelectedOutputStringOn.find(this->CurrentSelectedOutputUserNumber);
+	return (ci != this->SelectedOutputStringOn.end()) && (*ci).second;
 }
 
 VRESULT IPhreeqc::GetSelectedOutputValue(int row, int col, VAR* pVAR)
@@ -522,11 +721,57 @@ VRESULT IPhreeqc::GetSelectedOutputValue2(int row, int col, int *vtype, double*
 	return result;
 }
 
+VRESULT IPhreeqc::GetSolverStats(int n, SolverStats *stats)const
+{
+	if (stats == NULL || n < 0 || n >= this->GetSolverStatsCount())
+	{
+		return VR_INVALIDARG;
+	}
+	const struct solver_stats &s = this->PhreeqcPtr->solver_stats_list[n];
+	stats->cell               = s.cell;
+	stats->simulation         = s.simulation;
+	stats->calculations       = s.calculations;
+	stats->kinetics           = s.kinetics;
+	stats->converged          = s.converged;
+	stats->tries              = s.tries;
+	stats->last_try           = s.last_try;
+	stats->path               = s.path;
+	stats->iterations         = s.iterations;
+	stats->step_cuts          = s.step_cuts;
+	stats->overflows          = s.overflows;
+	stats->basis_changes      = s.basis_changes;
+	stats->infeasible         = s.infeasible;
+	stats->sparse_solves      = s.sparse_solves;
+	stats->numerical_switches = s.numerical_switches;
+	stats->time               = (double) s.time;
+	stats->time_ineq          = (double) s.time_ineq;
+	stats->time_gammas        = (double) s.time_gammas;
+	stats->time_jacobian      = (double) s.time_jacobian;
+	return VR_OK;
+}
+
+int IPhreeqc::GetSharedReactionCount(void)const
+{
+	return this->PhreeqcPtr->shared_reaction_count();
+}
+
+int IPhreeqc::GetSolverStatsCount(void)const
+{
+	return (int) this->PhreeqcPtr->solver_stats_list.size();
+}
+
 const char* IPhreeqc::GetVersionString(void)
 {
 	return IPhreeqc::Version.c_str();
 }
 
+void IPhreeqc::GetWarmStartStatistics(int *calculations, int *warm_starts, int *iterations)const
+{
+	if (calculations) *calculations = this->PhreeqcPtr->cell_calculations;
+	if (warm_starts)  *warm_starts  = this->PhreeqcPtr->cell_warm_starts;
+	if (iterations)   *iterations   = this->PhreeqcPtr->cell_iterations;
+}
+
 const char* IPhreeqc::GetWarningString(void)
 {
 	this->WarningString = ((CErrorReporter<std::ostringstream>*)this->WarningReporter)->GetOS()->str();
@@ -575,20 +820,24 @@ int IPhreeqc::load_db(const char* filename)
 
 		// open file
 		//
-		std::ifstream ifs;
-		ifs.open(filename);
-
-		if (!ifs.is_open())
+		std::string text;
+		if (!read_text_file(filename, text))
 		{
 			std::ostringstream oss;
 			oss << "LoadDatabase: Unable to open:" << "\"" << filename << "\".";
 			this->PhreeqcPtr->error_msg(oss.str().c_str(), STOP); // throws
 		}
+		this->DatabaseChecksum = Phreeqc::database_checksum(text.c_str(), text.size());
+		if (!file_stamp(filename, &this->DatabaseFileSize, &this->DatabaseFileTime))
+		{
+			this->DatabaseFileSize = this->DatabaseFileTime = -1;
+		}
+		std::istringstream iss(text);
 
 		// read input
 		//
 		ASSERT(this->PhreeqcPtr->phrq_io->get_istream() == NULL);
-		this->PhreeqcPtr->phrq_io->push_istream(&ifs, false);
+		this->PhreeqcPtr->phrq_io->push_istream(&iss, false);
 		this->PhreeqcPtr->read_database();
 	}
 	catch (const IPhreeqcStop&)
@@ -623,6 +872,7 @@ int IPhreeqc::LoadDatabase(const char* filename)
 	this->OutputFileOn     = false;
 	this->LogFileOn        = false;
 
+	ProfilerScope profiler_scope(this->PhreeqcPtr->profiler, "LoadDatabase");
 	int n = this->load_db(filename);
 	if (n == 0)
 	{
@@ -637,6 +887,233 @@ int IPhreeqc::LoadDatabase(const char* filename)
 	return n;
 }
 
+int IPhreeqc::LoadDatabaseBinary(const char* binary_filename, const char* filename)
+{
+	long long text_size = -1, text_time = -1;
+	MappedFile image;
+	if (binary_filename && filename && file_stamp(filename, &text_size, &text_time))
+	{
+		image.open(binary_filename);
+	}
+	if (!image.is_open())
+	{
+		int n = this->LoadDatabase(filename);
+		if (n == 0)
+		{
+			this->write_db_binary(binary_filename);
+			this->update_errors();
+		}
+		return n;
+	}
+
+	this->UnLoadDatabase();
+
+	// save I/O state
+	bool bSaveErrorFileOn  = this->ErrorFileOn;
+	bool bSaveOutputOn     = this->OutputFileOn;
+	bool bSaveLogFileOn    = this->LogFileOn;
+	this->ErrorFileOn      = false;
+	this->OutputFileOn     = false;
+	this->LogFileOn        = false;
+
+	long long image_size, image_time;
+	unsigned long long checksum = 0;
+	bool restamp = false;
+	int status = ERROR;
+	try
+	{
+		// the text is read and summed only if the file is not the one the image was made from
+		if (this->PhreeqcPtr->database_binary_stamp(image.begin(), image.end(), &image_size, &image_time, &checksum))
+		{
+			std::string text;
+			if (image_size != text_size || image_time != text_time)
+			{
+				restamp = true;
+				checksum = read_text_file(filename, text) ? Phreeqc::database_checksum(text.c_str(), text.size()) : ~checksum;
+			}
+			status = this->PhreeqcPtr->read_database_binary(image.begin(), image.end(), checksum);
+		}
+	}
+	catch (const IPhreeqcStop&)
+	{
+		// do nothing
+	}
+	image.close();
+
+	// restore I/O state
+	this->ErrorFileOn  = bSaveErrorFileOn;
+	this->OutputFileOn = bSaveOutputOn;
+	this->LogFileOn    = bSaveLogFileOn;
+
+	if (status != OK)
+	{
+		// stale or foreign image; read the text and replace the image
+		int n = this->LoadDatabase(filename);
+		if (n == 0)
+		{
+			this->write_db_binary(binary_filename);
+			this->update_errors();
+		}
+		return n;
+	}
+
+	this->DatabaseChecksum = checksum;
+	this->DatabaseFileSize = text_size;
+	this->DatabaseFileTime = text_time;
+	this->update_errors();
+	this->DatabaseLoaded = (this->PhreeqcPtr->get_input_errors() == 0);
+	this->DatabaseBinaryUsed = this->DatabaseLoaded;
+	if (restamp && this->DatabaseLoaded)
+	{
+		// same text in a touched file; record its new size and time
+		this->write_db_binary(binary_filename);
+	}
+	return this->PhreeqcPtr->get_input_errors();
+}
+
+int IPhreeqc::LoadDatabaseSnapshot(IPhreeqcDatabase* snapshot)
+{
+	this->UnLoadDatabase();
+	if (snapshot == 0)
+	{
+		this->AddError("LoadDatabaseSnapshot: Invalid snapshot.\n");
+		this->update_errors();
+		return 1;
+	}
+
+	mutex_lock(&map_lock);
+	++snapshot->RefCount;
+	mutex_unlock(&map_lock);
+	this->DatabaseSnapshot = snapshot;
+	this->DatabaseChecksum = snapshot->Checksum;
+
+	// save I/O state
+	bool bSaveErrorFileOn  = this->ErrorFileOn;
+	bool bSaveOutputOn     = this->OutputFileOn;
+	bool bSaveLogFileOn    = this->LogFileOn;
+	this->ErrorFileOn      = false;
+	this->OutputFileOn     = false;
+	this->LogFileOn        = false;
+
+	try
+	{
+		// strings must be looked up in the snapshot before any are saved
+		this->PhreeqcPtr->clean_up();
+		this->PhreeqcPtr->init();
+		this->PhreeqcPtr->database_snapshot = snapshot->PhreeqcPtr;
+		this->PhreeqcPtr->do_initialize();
+		this->PhreeqcPtr->InternalCopy(snapshot->PhreeqcPtr);
+	}
+	catch (const IPhreeqcStop&)
+	{
+		// do nothing
+	}
+
+	// restore I/O state
+	this->ErrorFileOn  = bSaveErrorFileOn;
+	this->OutputFileOn = bSaveOutputOn;
+	this->LogFileOn    = bSaveLogFileOn;
+
+	this->update_errors();
+	this->DatabaseLoaded = (this->PhreeqcPtr->get_input_errors() == 0);
+	return this->PhreeqcPtr->get_input_errors();
+}
+
+IPhreeqcDatabase* IPhreeqc::CreateDatabaseSnapshot(void)
+{
+	if (!this->DatabaseLoaded)
+	{
+		return 0;
+	}
+	IPhreeqcDatabase* snapshot = new IPhreeqcDatabase;
+	snapshot->PhreeqcPtr->initialize();
+	snapshot->PhreeqcPtr->InternalCopy(this->PhreeqcPtr);
+	snapshot->Checksum = this->DatabaseChecksum;
+	return snapshot;
+}
+
+void IPhreeqc::ReleaseDatabaseSnapshot(IPhreeqcDatabase* snapshot)
+{
+	if (snapshot)
+	{
+		mutex_lock(&map_lock);
+		size_t n = --snapshot->RefCount;
+		mutex_unlock(&map_lock);
+		if (n == 0)
+		{
+			delete snapshot;
+		}
+	}
+}
+
+int IPhreeqc::WriteDatabaseBinary(const char* binary_filename)
+{
+	this->ErrorReporter->Clear();
+	this->WarningReporter->Clear();
+	int n = 0;
+	if (!this->DatabaseLoaded)
+	{
+		this->AddError("WriteDatabaseBinary: No database is loaded.\n");
+		n = 1;
+	}
+	else if (this->write_db_binary(binary_filename) != 0)
+	{
+		std::ostringstream oss;
+		oss << "WriteDatabaseBinary: Unable to write:" << "\"" << (binary_filename ? binary_filename : "") << "\".\n";
+		this->AddError(oss.str().c_str());
+		n = 1;
+	}
+	this->update_errors();
+	return n;
+}
+
+int IPhreeqc::write_db_binary(const char* binary_filename)
+{
+	if (binary_filename == 0)
+	{
+		return 1;
+	}
+
+	// write to a temporary file so that readers never see a partial image
+	std::string tmp_name(binary_filename);
+	tmp_name += ".tmp";
+	std::ofstream ofs(tmp_name.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+	if (!ofs.is_open())
+	{
+		return 1;
+	}
+	// a file modified in the last second may change again without a new
+	// time; its stamp is left out so that the next load sums the text
+	long long text_time = this->DatabaseFileTime;
+	if (text_time >= (long long) ::time(NULL) - 1)
+	{
+		text_time = -1;
+	}
+	int status = ERROR;
+	try
+	{
+		status = this->PhreeqcPtr->write_database_binary(ofs, this->DatabaseChecksum,
+			this->DatabaseFileSize, text_time);
+	}
+	catch (const IPhreeqcStop&)
+	{
+		// do nothing
+	}
+	ofs.close();
+	if (status != OK || ofs.fail())
+	{
+		::remove(tmp_name.c_str());
+		return 1;
+	}
+	::remove(binary_filename);
+	if (::rename(tmp_name.c_str(), binary_filename) != 0)
+	{
+		::remove(tmp_name.c_str());
+		return 1;
+	}
+	return 0;
+}
+
 int IPhreeqc::load_db_str(const char* input)
 {
 	try
@@ -647,6 +1124,7 @@ int IPhreeqc::load_db_str(const char* input)
 
 		std::string s(input);
 		std::istringstream iss(s);
+		this->DatabaseChecksum = Phreeqc::database_checksum(s.c_str(), s.size());
 
 		// read input
 		//
@@ -687,6 +1165,7 @@ int IPhreeqc::LoadDatabaseString(const char* input)
 	this->OutputFileOn     = false;
 	this->LogFileOn        = false;
 
+	ProfilerScope profiler_scope(this->PhreeqcPtr->profiler, "LoadDatabaseString");
 	int n = this->load_db_str(input);
 	if (n == 0)
 	{
@@ -783,6 +1262,64 @@ int IPhreeqc::RunAccumulated(void)
 	return this->PhreeqcPtr->get_input_errors();
 }
 
+int IPhreeqc::RunCells(int first_cell, int ncells, const double *c, const double *tc, const double *patm, double *c_out, double *so_out)
+{
+	static const char *sz_routine = "RunCells";
+	try
+	{
+		// clear accumulated
+		//
+		this->ClearAccumulatedLines();
+		this->ClearAccumulated = false;
+
+		// these may throw
+		this->open_output_files(sz_routine);
+		this->check_database(sz_routine);
+
+		this->PhreeqcPtr->input_error = 0;
+		this->io_error_count = 0;
+
+		// this may throw
+		this->do_run_cells(sz_routine, first_cell, ncells, c, tc, patm, c_out, so_out);
+	}
+	catch (const IPhreeqcStop&)
+	{
+		// do nothing
+	}
+	catch(std::exception &e)
+	{
+		std::string errmsg("RunCells: ");
+		errmsg += e.what();
+		try
+		{
+			this->PhreeqcPtr->error_msg(errmsg.c_str(), STOP); // throws PhreeqcStop
+		}
+		catch (const IPhreeqcStop&)
+		{
+			// do nothing
+		}
+		throw;
+	}
+	catch(...)
+	{
+		const char *errmsg = "RunCells: An unhandled exception occured.\n";
+		try
+		{
+			this->PhreeqcPtr->error_msg(errmsg, STOP); // throws PhreeqcStop
+		}
+		catch (const IPhreeqcStop&)
+		{
+			// do nothing
+		}
+		throw;
+	}
+
+	this->close_output_files();
+	this->update_errors();
+
+	return this->PhreeqcPtr->get_input_errors();
+}
+
 int IPhreeqc::RunFile(const char* filename)
 {
 	static const char *sz_routine = "RunFile";
@@ -1009,11 +1546,25 @@ void IPhreeqc::SetOutputStringOn(bool bValue)
 	this->OutputStringOn = bValue;
 }
 
+void IPhreeqc::SetProfilingOn(bool bValue)
+{
+	if (bValue && !this->PhreeqcPtr->profiler.Get_on())
+	{
+		this->PhreeqcPtr->profiler.Clear();
+	}
+	this->PhreeqcPtr->profiler.Set_on(bValue);
+}
+
 void IPhreeqc::SetOutputFileOn(bool bValue)
 {
 	this->OutputFileOn = bValue;
 }
 
+void IPhreeqc::SetSelectedOutputBinaryOnly(bool bValue)
+{
+	this->SelectedOutputBinaryOnly = bValue;
+}
+
 void IPhreeqc::SetSelectedOutputFileName(const char *filename)
 {
 	if (filename && ::strlen(filename))
@@ -1113,6 +1664,15 @@ void IPhreeqc::UnLoadDatabase(void)
 	this->PhreeqcPtr->do_initialize();
 	this->PhreeqcPtr->input_error = 0;
 	this->io_error_count = 0;
+
+	// release shared database
+	//
+	IPhreeqc::ReleaseDatabaseSnapshot(this->DatabaseSnapshot);
+	this->DatabaseSnapshot = 0;
+	this->DatabaseChecksum = 0;
+	this->DatabaseFileSize = -1;
+	this->DatabaseFileTime = -1;
+	this->DatabaseBinaryUsed = false;
 }
 
 int IPhreeqc::EndRow(void)
@@ -1181,11 +1741,20 @@ void IPhreeqc::check_database(const char* sz_routine)
 void IPhreeqc::do_run(const char* sz_routine, std::istream* pis, PFN_PRERUN_CALLBACK pfn_pre, PFN_POSTRUN_CALLBACK pfn_post, void *cookie)
 {
 	char token[MAX_LENGTH];
+	ProfilerScope profiler_scope(this->PhreeqcPtr->profiler, sz_routine);
 
 /*
  *   Maybe should be in read_input
  */
 	this->PhreeqcPtr->first_read_input = TRUE;
+	this->PhreeqcPtr->cell_calculations = 0;
+	this->PhreeqcPtr->cell_warm_starts = 0;
+	this->PhreeqcPtr->cell_iterations = 0;
+	this->PhreeqcPtr->cvode_integrations = 0;
+	this->PhreeqcPtr->cvode_steps_taken = 0;
+	this->PhreeqcPtr->cvode_rhs_evaluations = 0;
+	this->PhreeqcPtr->cvode_jacobian_evaluations = 0;
+	this->PhreeqcPtr->solver_stats_clear();
 
 /*
  *   call pre-run callback
@@ -1232,28 +1801,6 @@ void IPhreeqc::do_run(const char* sz_routine, std::istream* pis, PFN_PRERUN_CALL
 		if (this->PhreeqcPtr->read_input() == EOF)
 			break;
 
-		// bool bWarning = false;
-		std::map< int, SelectedOutput >::iterator mit = this->PhreeqcPtr->SelectedOutput_map.begin();
-		for (; mit != this->PhreeqcPtr->SelectedOutput_map.end(); ++mit)
-		{
-			if (this->SelectedOutputMap.find(mit->first) == this->SelectedOutputMap.end())
-			{
-				// int -> CSelectedOutput*
-				std::map< int, CSelectedOutput* >::value_type item((*mit).first, new CSelectedOutput());
-				this->SelectedOutputMap.insert(item);
-
-				// int -> std::string
-				this->SelectedOutputStringMap.insert(
-					std::map< int, std::string >::value_type((*mit).first, std::string()));
-			}
-			else
-			{
-				ASSERT(this->SelectedOutputMap.find((*mit).first) != this->SelectedOutputMap.end());
-				ASSERT(this->SelectedOutputStringMap.find((*mit).first) != this->SelectedOutputStringMap.end());
-			}
-		}
-		ASSERT(this->PhreeqcPtr->SelectedOutput_map.size() == this->SelectedOutputMap.size());
-		ASSERT(this->PhreeqcPtr->SelectedOutput_map.size() == this->SelectedOutputStringMap.size());
 		if (this->PhreeqcPtr->title_x != NULL)
 		{
 			::sprintf(token, "TITLE");
@@ -1265,108 +1812,8 @@ void IPhreeqc::do_run(const char* sz_routine, std::istream* pis, PFN_PRERUN_CALL
 			}
 		}
 
-#ifdef SWIG_SHARED_OBJ
-		if (this->PhreeqcPtr->SelectedOutput_map.size() > 0)
-		{
-			//
-			// (punch.in == TRUE) when any "RUN" has contained
-			// a SELECTED_OUTPUT block since the last LoadDatabase call.
-			//
-			// Since LoadDatabase inititializes punch.in to FALSE
-			// (via UnLoadDatabase...do_initialize)
-			// and punch.in is set to TRUE in read_selected_output
-			//
-			// This causes the SELECTED_OUTPUT to contain the same headings
-			// until another SELECTED_OUTPUT is defined which sets the variable
-			// punch.new_def to TRUE
-			//
-			// WHAT IF A USER_PUNCH IS DEFINED?? IS punch.new_def SET TO
-			// TRUE ???
-			//
-			//
-			std::map< int, SelectedOutput >::iterator ai = this->PhreeqcPtr->SelectedOutput_map.begin();
-			for (; ai != this->PhreeqcPtr->SelectedOutput_map.end(); ++ai)
-			{
-				if (!this->SelectedOutputFileOnMap[(*ai).first])
-				{
-					ASSERT((*ai).second.Get_punch_ostream() == 0);
-				}
-			}
-
-			if (this->PhreeqcPtr->pr.punch == FALSE)
-			{
-				// No selected_output for this simulation
-				// this happens when
-				//    PRINT;  -selected_output false
-				// is given as input
-				// Note: this also disables the CSelectedOutput object
-				ASSERT(TRUE);
-			}
-			else
-			{
-				std::map< int, SelectedOutput >::iterator it = this->PhreeqcPtr->SelectedOutput_map.begin();
-				for (; it != this->PhreeqcPtr->SelectedOutput_map.end(); ++it)
-				{
-					if (this->SelectedOutputFileOnMap[(*it).first] && !(*it).second.Get_punch_ostream())
-					{
-						//
-						// LoadDatabase
-						// do_run -- containing SELECTED_OUTPUT ****TODO**** check -file option
-						// another do_run without SELECTED_OUTPUT
-						//
-						ASSERT(!this->SelectedOutputFileNameMap[(*it).first].empty());
-						std::string filename = this->SelectedOutputFileNameMap[(*it).first];
-						if (!punch_open(filename.c_str(), std::ios_base::out, (*it).first))
-						{
-							std::ostringstream oss;
-							oss << sz_routine << ": Unable to open:" << "\"" << filename << "\".\n";
-							this->PhreeqcPtr->warning_msg(oss.str().c_str());
-						}
-						else
-						{
-							ASSERT(this->Get_punch_ostream() != NULL);
-							ASSERT((*it).second.Get_punch_ostream() == NULL);
-
-							int n_user = (*it).first;
-							this->PhreeqcPtr->SelectedOutput_map[n_user].Set_punch_ostream(this->Get_punch_ostream());
-							this->Set_punch_ostream(NULL);
-							
-							// output selected_output headings
-							(*it).second.Set_new_def(TRUE);
-							this->PhreeqcPtr->tidy_punch();
-						}
-					}
-				}
-			}
-		}
-		else
-		{
-			ASSERT(TRUE);
-		}
-		
-
-		std::map< int, SelectedOutput >::iterator it = this->PhreeqcPtr->SelectedOutput_map.begin();
-		for (; it != this->PhreeqcPtr->SelectedOutput_map.end(); ++it)
-		{
-			if (this->SelectedOutputFileOnMap[(*it).first])
-			{
-				ASSERT((*it).second.Get_punch_ostream());
-			}
-			else
-			{
-				ASSERT(!(*it).second.Get_punch_ostream());
-			}
-		}
-
-		// Consider this addition
-		{
-			this->PhreeqcPtr->pr.all = (this->OutputFileOn || this->OutputStringOn) ? TRUE : FALSE;
-			//this->PhreeqcPtr->pr.punch = (this->SelectedOutputFileOn || this->SelectedOutputStringOn) ? TRUE : FALSE;
-		}
-		/* the converse is not necessarily true */
+		this->setup_selected_output(sz_routine);
 
-		this->PhreeqcPtr->n_user_punch_index = -1;
-#endif // SWIG_SHARED_OBJ
 		{
 			this->PhreeqcPtr->pr.all = (this->OutputFileOn || this->OutputStringOn) ? TRUE : FALSE;
 		}
@@ -1544,6 +1991,248 @@ void IPhreeqc::do_run(const char* sz_routine, std::istream* pis, PFN_PRERUN_CALL
 	}
 }
 
+void IPhreeqc::do_run_cells(const char* sz_routine, int first_cell, int ncells, const double *c, const double *tc, const double *patm, double *c_out, double *so_out)
+{
+	ProfilerScope profiler_scope(this->PhreeqcPtr->profiler, sz_routine);
+	std::list< std::string > comps = this->ListComponents();
+	std::vector< std::string > names(comps.begin(), comps.end());
+	size_t ncomps = names.size() + 3;
+
+/*
+ *   Load totals, temperature and pressure into the solution of each cell
+ */
+	for (int i = 0; i < ncells; ++i)
+	{
+		cxxSolution *soln_ptr = Utilities::Rxn_find(this->PhreeqcPtr->Rxn_solution_map, first_cell + i);
+		if (soln_ptr == NULL)
+		{
+			std::ostringstream oss;
+			oss << sz_routine << ": Solution " << first_cell + i << " not found.";
+			this->PhreeqcPtr->error_msg(oss.str().c_str(), STOP); // throws
+		}
+		if (c)
+		{
+			cxxNameDouble nd;
+			for (size_t j = 3; j < ncomps; ++j)
+			{
+				nd.add(names[j - 3].c_str(), c[j * ncells + i]);
+			}
+			soln_ptr->Update(c[i], c[ncells + i], c[2 * ncells + i], nd);
+		}
+		if (tc)
+		{
+			soln_ptr->Set_tc(tc[i]);
+		}
+		if (patm)
+		{
+			soln_ptr->Set_patm(patm[i]);
+		}
+	}
+
+	this->setup_selected_output(sz_routine);
+	this->PhreeqcPtr->pr.all = (this->OutputFileOn || this->OutputStringOn) ? TRUE : FALSE;
+
+/*
+ *   Run cells (equivalent to RUN_CELLS; -cells first_cell-last_cell)
+ */
+	StorageBinListItem &cells = this->PhreeqcPtr->run_info.Get_cells();
+	cells.Clear();
+	for (int i = 0; i < ncells; ++i)
+	{
+		cells.Augment(first_cell + i);
+	}
+	cells.Set_defined(true);
+
+	this->PhreeqcPtr->cell_calculations = 0;
+	this->PhreeqcPtr->cell_warm_starts = 0;
+	this->PhreeqcPtr->cell_iterations = 0;
+	this->PhreeqcPtr->cvode_integrations = 0;
+	this->PhreeqcPtr->cvode_steps_taken = 0;
+	this->PhreeqcPtr->cvode_rhs_evaluations = 0;
+	this->PhreeqcPtr->cvode_jacobian_evaluations = 0;
+	this->PhreeqcPtr->solver_stats_clear();
+	bool save_one_step = this->PhreeqcPtr->run_cells_one_step;
+	this->PhreeqcPtr->run_cells_one_step = true;
+	try
+	{
+		this->PhreeqcPtr->run_as_cells();
+	}
+	catch (...)
+	{
+		this->PhreeqcPtr->run_cells_one_step = save_one_step;
+		throw;
+	}
+	this->PhreeqcPtr->run_cells_one_step = save_one_step;
+
+/*
+ *   Copy results
+ */
+	if (c_out)
+	{
+		for (int i = 0; i < ncells; ++i)
+		{
+			cxxSolution *soln_ptr = Utilities::Rxn_find(this->PhreeqcPtr->Rxn_solution_map, first_cell + i);
+			ASSERT(soln_ptr);
+			c_out[i]              = soln_ptr->Get_total_h();
+			c_out[ncells + i]     = soln_ptr->Get_total_o();
+			c_out[2 * ncells + i] = soln_ptr->Get_cb();
+			cxxNameDouble simple = soln_ptr->Get_totals().Simplify_redox();
+			for (size_t j = 3; j < ncomps; ++j)
+			{
+				cxxNameDouble::const_iterator it = simple.find(names[j - 3]);
+				c_out[j * ncells + i] = (it != simple.end()) ? it->second : 0.0;
+			}
+		}
+	}
+	if (so_out)
+	{
+		std::map< int, CSelectedOutput* >::iterator it = this->SelectedOutputMap.find(this->CurrentSelectedOutputUserNumber);
+		if (it != this->SelectedOutputMap.end())
+		{
+			int nrow, ncol;
+			std::vector< double > doubles;
+			(*it).second->Doublize(nrow, ncol, doubles);
+			int nr = (nrow < ncells) ? nrow : ncells;
+			for (int col = 0; col < ncol; ++col)
+			{
+				for (int row = 0; row < nr; ++row)
+				{
+					so_out[col * ncells + row] = doubles[col * nrow + row];
+				}
+			}
+		}
+	}
+}
+
+void IPhreeqc::setup_selected_output(const char* sz_routine)
+{
+	// bool bWarning = false;
+	std::map< int, SelectedOutput >::iterator mit = this->PhreeqcPtr->SelectedOutput_map.begin();
+	for (; mit != this->PhreeqcPtr->SelectedOutput_map.end(); ++mit)
+	{
+		if (this->SelectedOutputMap.find(mit->first) == this->SelectedOutputMap.end())
+		{
+			// int -> CSelectedOutput*
+			std::map< int, CSelectedOutput* >::value_type item((*mit).first, new CSelectedOutput());
+			this->SelectedOutputMap.insert(item);
+
+			// int -> std::string
+			this->SelectedOutputStringMap.insert(
+				std::map< int, std::string >::value_type((*mit).first, std::string()));
+		}
+		else
+		{
+			ASSERT(this->SelectedOutputMap.find((*mit).first) != this->SelectedOutputMap.end());
+			ASSERT(this->SelectedOutputStringMap.find((*mit).first) != this->SelectedOutputStringMap.end());
+		}
+	}
+	ASSERT(this->PhreeqcPtr->SelectedOutput_map.size() == this->SelectedOutputMap.size());
+	ASSERT(this->PhreeqcPtr->SelectedOutput_map.size() == this->SelectedOutputStringMap.size());
+
+#ifdef SWIG_SHARED_OBJ
+	if (this->PhreeqcPtr->SelectedOutput_map.size() > 0)
+	{
+		//
+		// (punch.in == TRUE) when any "RUN" has contained
+		// a SELECTED_OUTPUT block since the last LoadDatabase call.
+		//
+		// Since LoadDatabase inititializes punch.in to FALSE
+		// (via UnLoadDatabase...do_initialize)
+		// and punch.in is set to TRUE in read_selected_output
+		//
+		// This causes the SELECTED_OUTPUT to contain the same headings
+		// until another SELECTED_OUTPUT is defined which sets the variable
+		// punch.new_def to TRUE
+		//
+		// WHAT IF A USER_PUNCH IS DEFINED?? IS punch.new_def SET TO
+		// TRUE ???
+		//
+		//
+		std::map< int, SelectedOutput >::iterator ai = this->PhreeqcPtr->SelectedOutput_map.begin();
+		for (; ai != this->PhreeqcPtr->SelectedOutput_map.end(); ++ai)
+		{
+			if (!this->get_sel_out_file_on((*ai).first))
+			{
+				ASSERT((*ai).second.Get_punch_ostream() == 0);
+			}
+		}
+
+		if (this->PhreeqcPtr->pr.punch == FALSE)
+		{
+			// No selected_output for this simulation
+			// this happens when
+			//    PRINT;  -selected_output false
+			// is given as input
+			// Note: this also disables the CSelectedOutput object
+			ASSERT(TRUE);
+		}
+		else
+		{
+			std::map< int, SelectedOutput >::iterator it = this->PhreeqcPtr->SelectedOutput_map.begin();
+			for (; it != this->PhreeqcPtr->SelectedOutput_map.end(); ++it)
+			{
+				if (this->get_sel_out_file_on((*it).first) && !(*it).second.Get_punch_ostream())
+				{
+					//
+					// LoadDatabase
+					// do_run -- containing SELECTED_OUTPUT ****TODO**** check -file option
+					// another do_run without SELECTED_OUTPUT
+					//
+					ASSERT(!this->SelectedOutputFileNameMap[(*it).first].empty());
+					std::string filename = this->SelectedOutputFileNameMap[(*it).first];
+					if (!punch_open(filename.c_str(), std::ios_base::out, (*it).first))
+					{
+						std::ostringstream oss;
+						oss << sz_routine << ": Unable to open:" << "\"" << filename << "\".\n";
+						this->PhreeqcPtr->warning_msg(oss.str().c_str());
+					}
+					else
+					{
+						ASSERT(this->Get_punch_ostream() != NULL);
+						ASSERT((*it).second.Get_punch_ostream() == NULL);
+
+						int n_user = (*it).first;
+						this->PhreeqcPtr->SelectedOutput_map[n_user].Set_punch_ostream(this->Get_punch_ostream());
+						this->Set_punch_ostream(NULL);
+						
+						// output selected_output headings
+						(*it).second.Set_new_def(TRUE);
+						this->PhreeqcPtr->tidy_punch();
+					}
+				}
+			}
+		}
+	}
+	else
+	{
+		ASSERT(TRUE);
+	}
+	
+
+	std::map< int, SelectedOutput >::iterator it = this->PhreeqcPtr->SelectedOutput_map.begin();
+	for (; it != this->PhreeqcPtr->SelectedOutput_map.end(); ++it)
+	{
+		if (this->get_sel_out_file_on((*it).first))
+		{
+			ASSERT((*it).second.Get_punch_ostream());
+		}
+		else
+		{
+			ASSERT(!(*it).second.Get_punch_ostream());
+		}
+	}
+
+	// Consider this addition
+	{
+		this->PhreeqcPtr->pr.all = (this->OutputFileOn || this->OutputStringOn) ? TRUE : FALSE;
+		//this->PhreeqcPtr->pr.punch = (this->SelectedOutputFileOn || this->SelectedOutputStringOn) ? TRUE : FALSE;
+	}
+	/* the converse is not necessarily true */
+
+	this->PhreeqcPtr->n_user_punch_index = -1;
+#endif // SWIG_SHARED_OBJ
+}
+
 void IPhreeqc::update_errors(void)
 {
 	this->ErrorLines.clear();
@@ -1655,7 +2344,7 @@ void IPhreeqc::punch_msg(const char *str)
 			this->SelectedOutputStringMap[this->PhreeqcPtr->current_selected_output->Get_n_user()] += str;
 		}
 	}
-	ASSERT(!(this->SelectedOutputFileOnMap[this->PhreeqcPtr->current_selected_output->Get_n_user()] != (this->PhreeqcPtr->current_selected_output->Get_punch_ostream() != 0)));
+	ASSERT(!(this->get_sel_out_file_on(this->PhreeqcPtr->current_selected_output->Get_n_user()) != (this->PhreeqcPtr->current_selected_output->Get_punch_ostream() != 0)));
 	this->PHRQ_io::punch_msg(str);
 }
 
@@ -1752,14 +2441,18 @@ void IPhreeqc::fpunchf(const char *name, const char *format, double d)
 {
 	try
 	{
-		this->PHRQ_io::fpunchf(name, format, d);
-		if (this->get_sel_out_string_on(this->PhreeqcPtr->current_selected_output->Get_n_user()) && this->punch_on)
+		int n_user = this->PhreeqcPtr->current_selected_output->Get_n_user();
+		if (!this->SelectedOutputBinaryOnly)
 		{
-			ASSERT(this->SelectedOutputStringMap.find(this->PhreeqcPtr->current_selected_output->Get_n_user()) != this->SelectedOutputStringMap.end());
-			PHRQ_io::fpunchf_helper(&(this->SelectedOutputStringMap[this->PhreeqcPtr->current_selected_output->Get_n_user()]), format, d);
+			this->PHRQ_io::fpunchf(name, format, d);
+			if (this->get_sel_out_string_on(n_user) && this->punch_on)
+			{
+				ASSERT(this->SelectedOutputStringMap.find(n_user) != this->SelectedOutputStringMap.end());
+				PHRQ_io::fpunchf_helper(&(this->SelectedOutputStringMap[n_user]), format, d);
+			}
 		}
-		ASSERT(this->SelectedOutputMap.find(this->PhreeqcPtr->current_selected_output->Get_n_user()) != this->SelectedOutputMap.end());
-		this->SelectedOutputMap[this->PhreeqcPtr->current_selected_output->Get_n_user()]->PushBackDouble(name, d);
+		ASSERT(this->SelectedOutputMap.find(n_user) != this->SelectedOutputMap.end());
+		this->SelectedOutputMap[n_user]->PushBackDouble(name, d);
 	}
 	catch (const std::bad_alloc&)
 	{
@@ -1771,14 +2464,18 @@ void IPhreeqc::fpunchf(const char *name, const char *format, char *s)
 {
 	try
 	{
-		this->PHRQ_io::fpunchf(name, format, s);
-		if (this->get_sel_out_string_on(this->PhreeqcPtr->current_selected_output->Get_n_user()) && this->punch_on)
+		int n_user = this->PhreeqcPtr->current_selected_output->Get_n_user();
+		if (!this->SelectedOutputBinaryOnly)
 		{
-			ASSERT(this->SelectedOutputStringMap.find(this->PhreeqcPtr->current_selected_output->Get_n_user()) != this->SelectedOutputStringMap.end());
-			PHRQ_io::fpunchf_helper(&(this->SelectedOutputStringMap[this->PhreeqcPtr->current_selected_output->Get_n_user()]), format, s);
+			this->PHRQ_io::fpunchf(name, format, s);
+			if (this->get_sel_out_string_on(n_user) && this->punch_on)
+			{
+				ASSERT(this->SelectedOutputStringMap.find(n_user) != this->SelectedOutputStringMap.end());
+				PHRQ_io::fpunchf_helper(&(this->SelectedOutputStringMap[n_user]), format, s);
+			}
 		}
-		ASSERT(this->SelectedOutputMap.find(this->PhreeqcPtr->current_selected_output->Get_n_user()) != this->SelectedOutputMap.end());
-		this->SelectedOutputMap[this->PhreeqcPtr->current_selected_output->Get_n_user()]->PushBackString(name, s);
+		ASSERT(this->SelectedOutputMap.find(n_user) != this->SelectedOutputMap.end());
+		this->SelectedOutputMap[n_user]->PushBackString(name, s);
 	}
 	catch (const std::bad_alloc&)
 	{
@@ -1790,14 +2487,18 @@ void IPhreeqc::fpunchf(const char *name, const char *format, int i)
 {
 	try
 	{
-		this->PHRQ_io::fpunchf(name, format, i);
-		if (this->get_sel_out_string_on(this->PhreeqcPtr->current_selected_output->Get_n_user()) && this->punch_on)
+		int n_user = this->PhreeqcPtr->current_selected_output->Get_n_user();
+		if (!this->SelectedOutputBinaryOnly)
 		{
-			ASSERT(this->SelectedOutputStringMap.find(this->PhreeqcPtr->current_selected_output->Get_n_user()) != this->SelectedOutputStringMap.end());
-			PHRQ_io::fpunchf_helper(&(this->SelectedOutputStringMap[this->PhreeqcPtr->current_selected_output->Get_n_user()]), format, i);
+			this->PHRQ_io::fpunchf(name, format, i);
+			if (this->get_sel_out_string_on(n_user) && this->punch_on)
+			{
+				ASSERT(this->SelectedOutputStringMap.find(n_user) != this->SelectedOutputStringMap.end());
+				PHRQ_io::fpunchf_helper(&(this->SelectedOutputStringMap[n_user]), format, i);
+			}
 		}
-		ASSERT(this->SelectedOutputMap.find(this->PhreeqcPtr->current_selected_output->Get_n_user()) != this->SelectedOutputMap.end());
-		this->SelectedOutputMap[this->PhreeqcPtr->current_selected_output->Get_n_user()]->PushBackLong(name, (long)i);
+		ASSERT(this->SelectedOutputMap.find(n_user) != this->SelectedOutputMap.end());
+		this->SelectedOutputMap[n_user]->PushBackLong(name, (long)i);
 	}
 	catch (const std::bad_alloc&)
 	{
@@ -1812,6 +2513,10 @@ void IPhreeqc::fpunchf_end_row(const char *format)
 
 bool IPhreeqc::get_sel_out_file_on(int n)const
 {
+	if (this->SelectedOutputBinaryOnly)
+	{
+		return false;
+	}
 	// if not found in list SelectedOutputFileOn is false
 	std::map< int, bool >::const_iterator ci = this->SelectedOutputFileOnMap.find(n);
 	if (ci != this->SelectedOutputFileOnMap.end())
@@ -1823,6 +2528,10 @@ bool IPhreeqc::get_sel_out_file_on(int n)const
 
 bool IPhreeqc::get_sel_out_string_on(int n)const
 {
+	if (this->SelectedOutputBinaryOnly)
+	{
+		return false;
+	}
 	// if not found in list SelectedOutputStringOn is false
 	std::map< int, bool >::const_iterator ci = this->SelectedOutputStringOn.find(this->CurrentSelectedOutputUserNumber);
 	if (ci != this->SelectedOutputStringOn.end())
@@ -5,6 +5,7 @@
 #define INC_IPHREEQC_H
 
 #include "Var.h"
+#include "SolverStats.h"
 
 /**
  * @mainpage IPhreeqc Library Documentation (3.5.0-14000)
@@ -264,6 +265,21 @@ extern "C" {
  */
 	IPQ_DLL_EXPORT int         GetCurrentSelectedOutputUserNumber(int id);
 
+
+/**
+ *  Retrieves the CVODE counts of the last call to @ref RunAccumulated, @ref RunCells, @ref RunFile, or @ref RunString.
+ *  @param id                   The instance id returned from @ref CreateIPhreeqc.
+ *  @param integrations         Receives the number of CVODE integrations of <b>KINETICS</b> with <b>-cvode true</b>, restarts included.
+ *  @param steps                Receives the total number of CVODE steps.
+ *  @param rhs_evaluations      Receives the total number of evaluations of the rates by CVODE.
+ *  @param jacobian_evaluations Receives the total number of evaluations of the jacobian of the rates.
+ *  @retval IPQ_OK              Success.
+ *  @retval IPQ_BADINSTANCE     The given id is invalid.
+ *  @remarks
+ *  Any pointer argument may be NULL.
+ */
+	IPQ_DLL_EXPORT IPQ_RESULT  GetCvodeStatistics(int id, int *integrations, int *steps, int *rhs_evaluations, int *jacobian_evaluations);
+
 /**
  *  Retrieves the name of the dump file.  This file name is used if not specified within <B>DUMP</B> input.
  *  The default value is <B><I>dump.id.out</I></B>.
@@ -795,6 +811,34 @@ extern "C" {
 	IPQ_DLL_EXPORT int         GetOutputStringOn(int id);
 
 
+/**
+ *  Retrieves the current value of the profiling switch.
+ *  @param id            The instance id returned from @ref CreateIPhreeqc.
+ *  @return              Non-zero if the calculation phases are timed, 0 (zero) otherwise.
+ *  @see                 GetProfilingString, SetProfilingOn
+ */
+	IPQ_DLL_EXPORT int         GetProfilingOn(int id);
+
+
+/**
+ *  Retrieves the phase timers as JSON.  Each phase is an object with the members <I>name</I>, <I>calls</I>,
+ *  <I>time</I> (wall-clock seconds), <I>self</I> (seconds not spent in the phases it contains) and <I>children</I>.
+ *  @param id            The instance id returned from @ref CreateIPhreeqc.
+ *  @return              A null terminated string containing the JSON object.
+ *  @see                 GetProfilingOn, SetProfilingOn
+ */
+	IPQ_DLL_EXPORT const char* GetProfilingString(int id);
+
+
+/**
+ *  Retrieves the current value of the binary-only selected-output switch.
+ *  @param id            The instance id returned from @ref CreateIPhreeqc.
+ *  @return              Non-zero if selected output is only stored in the in-memory buffers, 0 (zero) otherwise.
+ *  @see                 SetSelectedOutputBinaryOnly
+ */
+	IPQ_DLL_EXPORT int         GetSelectedOutputBinaryOnly(int id);
+
+
 /**
  *  Retrieves the number of columns in the selected-output buffer.
  *  @param id            The instance id returned from @ref CreateIPhreeqc.
@@ -814,6 +858,19 @@ extern "C" {
  */
 	IPQ_DLL_EXPORT int         GetSelectedOutputColumnCount(int id);
 
+/**
+ *  Retrieves the values of one column of the selected-output buffer as a contiguous array of
+ *  (@ref GetSelectedOutputRowCount - 1) doubles, without copying.  The heading is not included.
+ *  @param id            The instance id returned from @ref CreateIPhreeqc.
+ *  @param col           The column index (0 based).
+ *  @return              Pointer to the values, NULL if <I>col</I> is out of range, the buffer has no rows, or the id is invalid.
+ *  @remarks
+ *  Long values are converted to double; empty, error and string values are 1e30.
+ *  The pointer is valid until the next call to @ref RunAccumulated, @ref RunCells, @ref RunFile, or @ref RunString.
+ *  @see                 GetSelectedOutputColumnCount, GetSelectedOutputDoubles, GetSelectedOutputRowCount, GetSelectedOutputValue
+ */
+	IPQ_DLL_EXPORT const double* GetSelectedOutputColumnDoubles(int id, int col);
+
 /**
  *  Retrieves the count of <B>SELECTED_OUTPUT</B> blocks that are currently defined.
  *  @param id            The instance id returned from @ref CreateIPhreeqc.
@@ -837,6 +894,36 @@ extern "C" {
  */
 	IPQ_DLL_EXPORT int         GetSelectedOutputCount(int id);
 
+/**
+ *  Copies all values of the selected-output buffer into a <I>rows</I> x <I>cols</I> array of doubles.
+ *  The headings are not included.
+ *  @param id            The instance id returned from @ref CreateIPhreeqc.
+ *  @param values        Receives the values.
+ *  @param rows          The number of rows of <I>values</I>; at least (@ref GetSelectedOutputRowCount - 1).
+ *  @param cols          The number of columns of <I>values</I>; at least @ref GetSelectedOutputColumnCount.
+ *  @param row_major     Nonzero if the values of each row are contiguous (C order); zero if the values of each column are contiguous (Fortran order).
+ *  @retval IPQ_OK           Success.
+ *  @retval IPQ_INVALIDARG   <I>values</I> is NULL or the array is too small.
+ *  @retval IPQ_BADINSTANCE  The given id is invalid.
+ *  @remarks
+ *  Long values are converted to double; empty, error and string values are 1e30.  Elements beyond the
+ *  selected-output rows and columns are not changed.  The Fortran function uses the dimensions of <I>VALUES</I>.
+ *  @see                 GetSelectedOutputColumnCount, GetSelectedOutputColumnDoubles, GetSelectedOutputRowCount, GetSelectedOutputValue
+ *  @par Fortran90 Interface:
+ *  @htmlonly
+ *  <CODE>
+ *  <PRE>
+ *  FUNCTION GetSelectedOutputDoubles(ID,VALUES)
+ *    INTEGER(KIND=4),   INTENT(IN)   :: ID
+ *    DOUBLE PRECISION,  INTENT(INOUT) :: VALUES(:,:)
+ *    INTEGER(KIND=4)                 :: GetSelectedOutputDoubles
+ *  END FUNCTION GetSelectedOutputDoubles
+ *  </PRE>
+ *  </CODE>
+ *  @endhtmlonly
+ */
+	IPQ_DLL_EXPORT IPQ_RESULT  GetSelectedOutputDoubles(int id, double* values, int rows, int cols, int row_major);
+
 
 /**
  *  Retrieves the name of the current selected output file (see @ref SetCurrentSelectedOutputUserNumber).  This file name is used if not specified within <B>SELECTED_OUTPUT</B> input.
@@ -1339,6 +1426,31 @@ Headings
 	IPQ_DLL_EXPORT IPQ_RESULT  GetSelectedOutputValue2(int id, int row, int col, int *vtype, double* dvalue, char* svalue, unsigned int svalue_length);
 
 
+/**
+ *  Retrieves the solver statistics record @a n of the last call to @ref RunAccumulated, @ref RunCells, @ref RunFile, or @ref RunString.
+ *  @param id               The instance id returned from @ref CreateIPhreeqc.
+ *  @param n                The zero-based index of the record, in the order the cells, or with <b>-solver_stats each</b> the calculations, were first calculated.
+ *  @param stats            Receives the iterations, tries, convergence path and solver times of the record.
+ *  @retval IPQ_OK          Success.
+ *  @retval IPQ_INVALIDARG  @a n is out of range or @a stats is NULL.
+ *  @retval IPQ_BADINSTANCE The given id is invalid.
+ *  @remarks
+ *  Statistics are kept only with <b>KNOBS -solver_stats true</b>, which sums the calculations of each cell of a simulation
+ *  in one record, or <b>KNOBS -solver_stats each</b>, which keeps a record for each calculation.
+ *  @see                    GetSolverStatsCount
+ */
+	IPQ_DLL_EXPORT IPQ_RESULT  GetSolverStats(int id, int n, SolverStats *stats);
+
+
+/**
+ *  Retrieves the number of solver statistics records of the last call to @ref RunAccumulated, @ref RunCells, @ref RunFile, or @ref RunString.
+ *  @param id               The instance id returned from @ref CreateIPhreeqc.
+ *  @return                 The number of records; 0 unless <b>KNOBS -solver_stats</b> is set.  A negative value indicates an error occurred (see @ref IPQ_RESULT).
+ *  @see                    GetSolverStats
+ */
+	IPQ_DLL_EXPORT int         GetSolverStatsCount(int id);
+
+
 /**
  *  Retrieves the string buffer containing the version in the form of X.X.X-XXXX.
  *  @return              A null terminated string containing the IPhreeqc version number.
@@ -1362,6 +1474,21 @@ Headings
 	IPQ_DLL_EXPORT const char* GetVersionString(void);
 
 
+/**
+ *  Retrieves the cell calculation counts of the last call to @ref RunAccumulated, @ref RunCells, @ref RunFile, or @ref RunString.
+ *  @param id               The instance id returned from @ref CreateIPhreeqc.
+ *  @param calculations     Receives the number of cell calculations (batch-reaction, transport and <b>RUN_CELLS</b> steps).
+ *  @param warm_starts      Receives the number of calculations started from the activities saved for the cell (<b>KNOBS -warm_start</b>).
+ *  @param iterations       Receives the total number of Newton iterations of the calculations.
+ *  @retval IPQ_OK          Success.
+ *  @retval IPQ_BADINSTANCE The given id is invalid.
+ *  @remarks
+ *  Any pointer argument may be NULL.  The saved activities are kept from one run to the next until species,
+ *  master species, or phases are defined or a database is loaded.
+ */
+	IPQ_DLL_EXPORT IPQ_RESULT  GetWarmStartStatistics(int id, int *calculations, int *warm_starts, int *iterations);
+
+
 /**
  *  Retrieves the warning messages from the last call to (@ref RunAccumulated, @ref RunFile, @ref RunString, @ref LoadDatabase, or @ref LoadDatabaseString).
  *  @param id            The instance id returned from @ref CreateIPhreeqc.
@@ -1448,6 +1575,23 @@ Headings
 	IPQ_DLL_EXPORT int         LoadDatabase(int id, const char* filename);
 
 
+/**
+ *  Load a database into phreeqc from a binary image written by @ref WriteDatabaseBinary, falling back to
+ *  @ref LoadDatabase when the image cannot be used.
+ *  @param id              The instance id returned from @ref CreateIPhreeqc.
+ *  @param binary_filename The name of the binary database image.
+ *  @param filename        The name of the phreeqc database the image was made from.
+ *  @return                The number of errors encountered.
+ *  @see                   LoadDatabase, WriteDatabaseBinary
+ *  @remarks
+ *  All previous definitions are cleared.  The image is used only if it was written by the same build of IPhreeqc
+ *  from a database with the same contents as <I>filename</I>; otherwise <I>filename</I> is loaded and the image
+ *  is rewritten.  The image is mapped into memory.  The contents are compared by checksum only when the size or
+ *  modification time of <I>filename</I> differs from the one recorded in the image.
+ */
+	IPQ_DLL_EXPORT int         LoadDatabaseBinary(int id, const char* binary_filename, const char* filename);
+
+
 /**
  *  Load the specified string as a database into phreeqc.
  *  @param id            The instance id returned from @ref CreateIPhreeqc.
@@ -1561,6 +1705,48 @@ Headings
 	IPQ_DLL_EXPORT int         RunAccumulated(int id);
 
 
+/**
+ *  Runs the reaction calculations for a contiguous block of cells without parsing any input.
+ *  Cell <I>i</I> corresponds to the reactants (SOLUTION, EQUILIBRIUM_PHASES, EXCHANGE, ...) numbered
+ *  <I>first_cell + i</I>, which must have been defined by a previous run.  Before the calculation, the
+ *  solution of each cell is updated with the given component totals; after the calculation, the reacted
+ *  entities are saved back as with RUN_CELLS.
+ *  @param id            The instance id returned from @ref CreateIPhreeqc.
+ *  @param first_cell    The user number of the first cell.
+ *  @param ncells        The number of cells.
+ *  @param c             Component totals (moles) for each cell, <I>c[j * ncells + i]</I>.  The components are "H", "O", "Charge"
+ *                       followed by the components of @ref GetComponent, so that <I>ncomps</I> is @ref GetComponentCount + 3.
+ *                       The mass of water is calculated from the totals of H and O.
+ *  @param tc            Temperature (Celsius) for each cell, or NULL to keep the temperature of the solution.
+ *  @param patm          Pressure (atm) for each cell, or NULL to keep the pressure of the solution.
+ *  @param c_out         Receives the component totals (moles) of each cell after reaction, in the same layout as <I>c</I>.  May be NULL.
+ *  @param so_out        Receives the current selected output of each cell, <I>so_out[col * ncells + i]</I> for
+ *                       @ref GetSelectedOutputColumnCount columns.  Non-numeric values are set to 1e30.  May be NULL.
+ *  @return              The number of errors encountered during the run.
+ *  @see                 GetComponent, GetComponentCount, RunString, SetCurrentSelectedOutputUserNumber
+ *  @pre                 (@ref LoadDatabase, @ref LoadDatabaseString) must have been called and returned 0 (zero) errors.
+ *  @par Fortran90 Interface:
+ *  @htmlonly
+ *  <CODE>
+ *  <PRE>
+ *  FUNCTION RunCells(ID,FIRST_CELL,NCELLS,C,TC,PATM,C_OUT,SO_OUT)
+ *    INTEGER(KIND=4),   INTENT(IN)  :: ID
+ *    INTEGER(KIND=4),   INTENT(IN)  :: FIRST_CELL
+ *    INTEGER(KIND=4),   INTENT(IN)  :: NCELLS
+ *    DOUBLE PRECISION,  INTENT(IN)  :: C(NCELLS,*)
+ *    DOUBLE PRECISION,  INTENT(IN)  :: TC(NCELLS)
+ *    DOUBLE PRECISION,  INTENT(IN)  :: PATM(NCELLS)
+ *    DOUBLE PRECISION,  INTENT(OUT) :: C_OUT(NCELLS,*)
+ *    DOUBLE PRECISION,  INTENT(OUT) :: SO_OUT(NCELLS,*)
+ *    INTEGER(KIND=4)                :: RunCells
+ *  END FUNCTION RunCells
+ *  </PRE>
+ *  </CODE>
+ *  @endhtmlonly
+ */
+	IPQ_DLL_EXPORT int         RunCells(int id, int first_cell, int ncells, const double *c, const double *tc, const double *patm, double *c_out, double *so_out);
+
+
 /**
  *  Runs the specified phreeqc input file.
  *  @param id            The instance id returned from @ref CreateIPhreeqc.
@@ -2042,6 +2228,34 @@ Headings
 	IPQ_DLL_EXPORT IPQ_RESULT  SetOutputStringOn(int id, int output_string_on);
 
 
+/**
+ *  Sets the profiling switch on or off.  This switch controls whether or not the phases of the calculations
+ *  (reading input, tidying, prep, model, kinetics, printing and punching) are timed.  The initial setting after calling
+ *  @ref CreateIPhreeqc is off.
+ *  @param id                   The instance id returned from @ref CreateIPhreeqc.
+ *  @param profiling_on         If non-zero, clears the timers and times the following calls; if zero, stops timing.
+ *  @retval IPQ_OK              Success.
+ *  @retval IPQ_BADINSTANCE     The given id is invalid.
+ *  @see                        GetProfilingOn, GetProfilingString
+ */
+	IPQ_DLL_EXPORT IPQ_RESULT  SetProfilingOn(int id, int profiling_on);
+
+
+/**
+ *  Sets the binary-only selected-output switch.  While this switch is on, the values of all selected outputs are only
+ *  stored in the in-memory buffers read by @ref GetSelectedOutputValue and @ref GetSelectedOutputDoubles; no values are
+ *  formatted as text and nothing is written to the selected output files or strings, whatever the settings of
+ *  @ref SetSelectedOutputFileOn and @ref SetSelectedOutputStringOn.  The initial setting after calling
+ *  @ref CreateIPhreeqc is off.
+ *  @param id                   The instance id returned from @ref CreateIPhreeqc.
+ *  @param binary_only          If non-zero, only the in-memory buffers are filled; if zero, the file and string switches apply.
+ *  @retval IPQ_OK              Success.
+ *  @retval IPQ_BADINSTANCE     The given id is invalid.
+ *  @see                        GetSelectedOutputBinaryOnly, GetSelectedOutputDoubles, SetSelectedOutputFileOn, SetSelectedOutputStringOn
+ */
+	IPQ_DLL_EXPORT IPQ_RESULT  SetSelectedOutputBinaryOnly(int id, int binary_only);
+
+
 /**
  *  Sets the name of the current selected output file (see @ref SetCurrentSelectedOutputUserNumber).  This file name is used if not specified within <B>SELECTED_OUTPUT</B> input.
  *  The default value is <B><I>selected_n.id.out</I></B>.
@@ -2121,6 +2335,21 @@ Headings
  */
 	IPQ_DLL_EXPORT IPQ_RESULT  SetSelectedOutputStringOn(int id, int sel_string_on);
 
+
+/**
+ *  Writes the loaded database to a binary image that can be reloaded with @ref LoadDatabaseBinary.
+ *  @param id              The instance id returned from @ref CreateIPhreeqc.
+ *  @param binary_filename The name of the binary database image to write.
+ *  @return                The number of errors encountered.
+ *  @see                   LoadDatabaseBinary
+ *  @pre
+ *  @ref LoadDatabase/@ref LoadDatabaseString must have been called and returned 0 (zero) errors.
+ *  @remarks
+ *  The image holds the database tables only; a database that also defines reactants, <B>SELECTED_OUTPUT</B>,
+ *  <B>USER_PRINT</B> or <B>TRANSPORT</B> cannot be written.
+ */
+	IPQ_DLL_EXPORT int         WriteDatabaseBinary(int id, const char* binary_filename);
+
 // TODO int RunWithCallback(PFN_PRERUN_CALLBACK pfn_pre, PFN_POSTRUN_CALLBACK pfn_post, void *cookie, int output_on, int error_on, int log_on, int selected_output_on);
 
 
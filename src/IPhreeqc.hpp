@@ -12,6 +12,7 @@
 #include <cstdarg>
 #include "IPhreeqcCallbacks.h"      /* PFN_PRERUN_CALLBACK, PFN_POSTRUN_CALLBACK, PFN_CATCH_CALLBACK */
 #include "Var.h"                    /* VRESULT */
+#include "SolverStats.h"            /* SolverStats */
 #include "PHRQ_io.h"
 
 #if defined(_WINDLL)
@@ -21,6 +22,7 @@
 #endif
 
 class Phreeqc;
+class IPhreeqcDatabase;
 class IErrorReporter;
 class CSelectedOutput;
 class SelectedOutput;
@@ -96,6 +98,20 @@ public:
 	 */
 	void                     ClearAccumulatedLines(void);
 
+	/**
+	 *  Creates a read-only snapshot of the database currently loaded in this instance.  The snapshot can be
+	 *  attached to any number of instances with @ref LoadDatabaseSnapshot, which avoids reading and tidying
+	 *  the database again; interned names and the species and phase reactions are shared by all attached instances
+	 *  instead of being copied.  Species, phases, and master species are still copied, because they carry the state
+	 *  of the calculations.
+	 *  @return                 The snapshot, or NULL if no database is loaded.  The caller holds one reference,
+	 *                          which must be released with @ref ReleaseDatabaseSnapshot.
+	 *  @see                    LoadDatabase, LoadDatabaseSnapshot, ReleaseDatabaseSnapshot
+	 *  @remarks
+	 *      Normally called right after @ref LoadDatabase; any definitions made since are included in the snapshot.
+	 */
+	IPhreeqcDatabase*        CreateDatabaseSnapshot(void);
+
 	/**
 	 *  Retrieve the accumulated input string.  The accumulated input string can be run
 	 *  with @ref RunAccumulated.
@@ -127,6 +143,26 @@ public:
 	 */
 	int                      GetCurrentSelectedOutputUserNumber(void)const;
 
+	/**
+	 *  Retrieves the CVODE counts of the last call to @ref RunAccumulated, @ref RunCells, @ref RunFile, or @ref RunString.
+	 *  @param integrations     Receives the number of CVODE integrations of <b>KINETICS</b> with <b>-cvode true</b>, restarts included.
+	 *  @param steps            Receives the total number of CVODE steps.
+	 *  @param rhs_evaluations  Receives the total number of evaluations of the rates by CVODE.
+	 *  @param jacobian_evaluations Receives the total number of evaluations of the jacobian of the rates.
+	 *  @remarks
+	 *  Any argument may be NULL.  Each jacobian evaluation calculates the cell once for each kinetic reaction;
+	 *  <b>KINETICS -cvode_jacobian_steps</b> sets the maximum number of steps a jacobian is reused.
+	 */
+	void                     GetCvodeStatistics(int *integrations, int *steps, int *rhs_evaluations, int *jacobian_evaluations)const;
+
+	/**
+	 *  Retrieves whether the loaded database was read from a binary image.
+	 *  @retval true            The last @ref LoadDatabaseBinary used the image.
+	 *  @retval false           The database was read from text, or no database is loaded.
+	 *  @see                    LoadDatabaseBinary, WriteDatabaseBinary
+	 */
+	bool                     GetDatabaseBinaryUsed(void)const;
+
 	/**
 	 *  Retrieves the name of the dump file.  This file name is used if not specified within <B>DUMP</B> input.
 	 *  The default value is <B><I>dump.id.out</I></B>, where id is obtained from @ref GetId.
@@ -340,6 +376,35 @@ public:
 	 */
 	bool                     GetOutputStringOn(void)const;
 
+	/**
+	 *  Retrieves the current value of the profiling switch.
+	 *  @retval true            The calculation phases are timed.
+	 *  @retval false           No timing.
+	 *  @see                    GetProfilingString, SetProfilingOn
+	 */
+	bool                     GetProfilingOn(void)const;
+
+	/**
+	 *  Retrieves the phase timers as JSON.  Each phase is an object with the members <I>name</I>, <I>calls</I>,
+	 *  <I>time</I> (wall-clock seconds), <I>self</I> (seconds not spent in the phases it contains) and <I>children</I>.
+	 *  The root, <I>total</I>, contains one phase for each call of @ref LoadDatabase, @ref RunAccumulated,
+	 *  @ref RunCells, @ref RunFile, or @ref RunString since profiling was switched on.
+	 *  @return                 A null terminated string containing the JSON object.
+	 *  @remarks
+	 *  The times of phases calculated by cell workers (<b>KNOBS -workers</b>) are summed over the workers and may
+	 *  exceed the time of the phase that contains them; <I>self</I> is then 0.
+	 *  @see                    GetProfilingOn, SetProfilingOn
+	 */
+	const char*              GetProfilingString(void);
+
+	/**
+	 *  Retrieves the current value of the binary-only selected-output switch.
+	 *  @retval true            Selected output is only stored in the in-memory buffers.
+	 *  @retval false           Selected output is also written to files and strings as set by @ref SetSelectedOutputFileOn and @ref SetSelectedOutputStringOn.
+	 *  @see                    SetSelectedOutputBinaryOnly
+	 */
+	bool                     GetSelectedOutputBinaryOnly(void)const;
+
 	/**
 	 *  Retrieves the number of columns in the current selected-output buffer (see @ref SetCurrentSelectedOutputUserNumber).
 	 *  @return                 The number of columns.
@@ -347,6 +412,19 @@ public:
 	 */
 	int                      GetSelectedOutputColumnCount(void)const;
 
+	/**
+	 *  Retrieves the values of column <I>col</I> of the current selected-output buffer (see @ref SetCurrentSelectedOutputUserNumber) as
+	 *  a contiguous array of (@ref GetSelectedOutputRowCount - 1) doubles, without copying.  Row 0 of the array is row 1 of the buffer;
+	 *  the heading is not included.
+	 *  @param col              The column index (0 based).
+	 *  @return                 Pointer to the values, NULL if <I>col</I> is out of range or the buffer has no rows.
+	 *  @remarks
+	 *  Long values are converted to double; empty, error and string values are 1e30.
+	 *  The pointer is valid until the next call to @ref RunAccumulated, @ref RunFile, @ref RunString, or @ref RunCells.
+	 *  @see                    GetSelectedOutputColumnCount, GetSelectedOutputDoubles, GetSelectedOutputRowCount, GetSelectedOutputValue
+	 */
+	const double*            GetSelectedOutputColumnDoubles(int col)const;
+
 	/**
 	 *  Retrieves the count of <B>SELECTED_OUTPUT</B> blocks that are currently defined.
 	 *  @return                 The number of <B>SELECTED_OUTPUT</B> blocks.
@@ -354,6 +432,22 @@ public:
 	 */
 	int                      GetSelectedOutputCount(void)const;
 
+	/**
+	 *  Copies all values of the current selected-output buffer (see @ref SetCurrentSelectedOutputUserNumber) into a
+	 *  <I>rows</I> x <I>cols</I> array of doubles; the headings are not included.
+	 *  @param values           Receives the values.
+	 *  @param rows             The number of rows of <I>values</I>; at least (@ref GetSelectedOutputRowCount - 1).
+	 *  @param cols             The number of columns of <I>values</I>; at least @ref GetSelectedOutputColumnCount.
+	 *  @param row_major        If true, the values of each row are contiguous (C order); otherwise the values of each column are contiguous (Fortran order).
+	 *  @retval VR_OK           Success.
+	 *  @retval VR_INVALIDARG   <I>values</I> is NULL or the array is too small.
+	 *  @remarks
+	 *  Long values are converted to double; empty, error and string values are 1e30.  Elements beyond the
+	 *  selected-output rows and columns are not changed.
+	 *  @see                    GetSelectedOutputColumnCount, GetSelectedOutputColumnDoubles, GetSelectedOutputRowCount, GetSelectedOutputValue
+	 */
+	VRESULT                  GetSelectedOutputDoubles(double* values, int rows, int cols, bool row_major = true)const;
+
 	/**
 	 *  Retrieves the name of the current selected output file (see @ref SetCurrentSelectedOutputUserNumber).  This file name is used if not specified within <B>SELECTED_OUTPUT</B> input.
 	 *  The default value is <B><I>selected_n.id.out</I></B>, where id is obtained from @ref GetId.
@@ -587,12 +681,54 @@ public:
 	 */
 	VRESULT                  GetSelectedOutputValue2(int row, int col, int *vtype, double* dvalue, char* svalue, unsigned int svalue_length);
 
+	/**
+	 *  Retrieves the number of species and phase reactions this instance shares with the snapshot it was attached to.
+	 *  @return                 The number of shared reactions; 0 unless @ref LoadDatabaseSnapshot was called.
+	 *  @see                    CreateDatabaseSnapshot, LoadDatabaseSnapshot
+	 *  @remarks
+	 *  Reading <b>SOLUTION_SPECIES</b>, <b>PHASES</b>, or any other species or master species definition gives the
+	 *  instance its own copy of the reactions, after which the count is 0.
+	 */
+	int                      GetSharedReactionCount(void)const;
+
+	/**
+	 *  Retrieves the solver statistics record <I>n</I> of the last call to @ref RunAccumulated, @ref RunCells, @ref RunFile, or @ref RunString.
+	 *  @param n                The zero-based index of the record, in the order the cells, or with <b>-solver_stats each</b> the calculations, were first calculated.
+	 *  @param stats            Receives the iterations, tries, convergence path and solver times of the record.
+	 *  @retval VR_OK           Success.
+	 *  @retval VR_INVALIDARG   <I>n</I> is out of range or <I>stats</I> is NULL.
+	 *  @remarks
+	 *  Statistics are kept only with <b>KNOBS -solver_stats true</b>, which sums the calculations of each cell of a simulation
+	 *  in one record, or <b>KNOBS -solver_stats each</b>, which keeps a record for each calculation.
+	 *  @see                    GetSolverStatsCount
+	 */
+	VRESULT                  GetSolverStats(int n, SolverStats *stats)const;
+
+	/**
+	 *  Retrieves the number of solver statistics records of the last call to @ref RunAccumulated, @ref RunCells, @ref RunFile, or @ref RunString.
+	 *  @return                 The number of records; 0 unless <b>KNOBS -solver_stats</b> is set.
+	 *  @see                    GetSolverStats
+	 */
+	int                      GetSolverStatsCount(void)const;
+
 	/**
 	 *  Retrieves the string buffer containing the version in the form of X.X.X-XXXX.
 	 *  @return                 A null terminated string containing the IPhreeqc version number.
 	 */
 	static const char*       GetVersionString(void);
 
+	/**
+	 *  Retrieves the cell calculation counts of the last call to @ref RunAccumulated, @ref RunCells, @ref RunFile, or @ref RunString.
+	 *  @param calculations     Receives the number of cell calculations (batch-reaction, transport and <b>RUN_CELLS</b> steps).
+	 *  @param warm_starts      Receives the number of calculations started from the activities saved for the cell (<b>KNOBS -warm_start</b>).
+	 *  @param iterations       Receives the total number of Newton iterations of the calculations.
+	 *  @remarks
+	 *  Any argument may be NULL.  Dividing <I>iterations</I> by <I>calculations</I> gives the mean number of iterations per cell.
+	 *  The saved activities are kept from one run to the next until species, master species, or phases are defined or
+	 *  a database is loaded.
+	 */
+	void                     GetWarmStartStatistics(int *calculations, int *warm_starts, int *iterations)const;
+
 	/**
 	 *  Retrieves the warning messages from the last call to @ref RunAccumulated, @ref RunFile, @ref RunString, @ref LoadDatabase, or @ref LoadDatabaseString.
 	 *  @return                 A null terminated string containing warning messages.
@@ -634,6 +770,34 @@ public:
 	 */
 	int                      LoadDatabase(const char* filename);
 
+	/**
+	 *  Load a database into phreeqc from a binary image written by @ref WriteDatabaseBinary, falling back to
+	 *  @ref LoadDatabase when the image cannot be used.
+	 *  @param binary_filename  The name of the binary database image.
+	 *  @param filename         The name of the phreeqc database the image was made from.
+	 *  @return                 The number of errors encountered.
+	 *  @see                    LoadDatabase, WriteDatabaseBinary
+	 *  @remarks
+	 *      All previous definitions are cleared.  The image is used only if it was written by the same build of IPhreeqc
+	 *      from a database with the same contents as <I>filename</I>; otherwise <I>filename</I> is loaded and the image
+	 *      is rewritten.  The image is mapped into memory.  The contents are compared by checksum only when the size or
+	 *      modification time of <I>filename</I> differs from the one recorded in the image.
+	 */
+	int                      LoadDatabaseBinary(const char* binary_filename, const char* filename);
+
+	/**
+	 *  Load a database snapshot created by @ref CreateDatabaseSnapshot into phreeqc.
+	 *  @param snapshot         The snapshot to attach.  This instance holds a reference to the snapshot until
+	 *                          the database is unloaded or the instance is destroyed.
+	 *  @return                 The number of errors encountered.
+	 *  @see                    CreateDatabaseSnapshot, LoadDatabase, ReleaseDatabaseSnapshot
+	 *  @remarks
+	 *      All previous definitions are cleared.  Any number of instances, on any number of threads, may load the same snapshot.
+	 *      The species and phase reactions are shared with the snapshot until this instance reads its own species, phase,
+	 *      or master species definitions (see @ref GetSharedReactionCount).
+	 */
+	int                      LoadDatabaseSnapshot(IPhreeqcDatabase* snapshot);
+
 	/**
 	 *  Load the specified string as a database into phreeqc.
 	 *  @param input            String containing data to be used as the phreeqc database.
@@ -663,6 +827,14 @@ public:
 	 */
 	void                     OutputWarningString(void);
 
+	/**
+	 *  Releases a reference to a database snapshot.  The snapshot is freed when the last instance using it
+	 *  unloads its database and the last reference is released.
+	 *  @param snapshot         The snapshot returned by @ref CreateDatabaseSnapshot.
+	 *  @see                    CreateDatabaseSnapshot, LoadDatabaseSnapshot
+	 */
+	static void              ReleaseDatabaseSnapshot(IPhreeqcDatabase* snapshot);
+
 	/**
 	 *  Runs the input buffer as defined by calls to @ref AccumulateLine.
 	 *  @return                 The number of errors encountered.
@@ -674,6 +846,30 @@ public:
 	 */
 	int                      RunAccumulated(void);
 
+	/**
+	 *  Runs the reaction calculations for a contiguous block of cells without parsing any input.
+	 *  Cell <I>i</I> corresponds to the reactants (SOLUTION, EQUILIBRIUM_PHASES, EXCHANGE, ...) numbered
+	 *  <I>first_cell + i</I>, which must have been defined by a previous run.  Before the calculation, the
+	 *  solution of each cell is updated with the given component totals; after the calculation, the reacted
+	 *  entities are saved back as with RUN_CELLS.
+	 *  @param first_cell       The user number of the first cell.
+	 *  @param ncells           The number of cells.
+	 *  @param c                Component totals (moles) for each cell, <I>c[j * ncells + i]</I> (Fortran <I>c(ncells, ncomps)</I>).
+	 *                          The components are "H", "O", "Charge" followed by the components of @ref ListComponents,
+	 *                          so that <I>ncomps</I> is @ref GetComponentCount + 3.  The mass of water is calculated from
+	 *                          the totals of H and O.
+	 *  @param tc               Temperature (Celsius) for each cell, or NULL to keep the temperature of the solution.
+	 *  @param patm             Pressure (atm) for each cell, or NULL to keep the pressure of the solution.
+	 *  @param c_out            Receives the component totals (moles) of each cell after reaction, in the same layout as <I>c</I>.  May be NULL.
+	 *  @param so_out           Receives the current selected output of each cell, <I>so_out[col * ncells + i]</I> for
+	 *                          @ref GetSelectedOutputColumnCount columns.  Non-numeric values are set to 1e30.  May be NULL.
+	 *  @return                 The number of errors encountered during the run.
+	 *  @see                    GetComponent, GetComponentCount, RunString, SetCurrentSelectedOutputUserNumber
+	 *  @pre
+	 *      @ref LoadDatabase/@ref LoadDatabaseString must have been called and returned 0 (zero) errors.
+	 */
+	int                      RunCells(int first_cell, int ncells, const double *c, const double *tc, const double *patm, double *c_out, double *so_out);
+
 	/**
 	 *  Runs the specified phreeqc input file.
 	 *  @param filename         The name of the phreeqc input file to run.
@@ -831,6 +1027,24 @@ public:
 	 */
 	void                     SetOutputStringOn(bool bValue);
 
+	/**
+	 *  Sets the profiling switch on or off.  This switch controls whether or not the phases of the calculations
+	 *  (reading input, tidying, prep, model, kinetics, printing and punching) are timed.  The initial setting is false.
+	 *  @param bValue           If true, clears the timers and times the following calls; if false, stops timing.
+	 *  @see                    GetProfilingOn, GetProfilingString
+	 */
+	void                     SetProfilingOn(bool bValue);
+
+	/**
+	 *  Sets the binary-only selected-output switch.  While this switch is on, the values of all selected outputs are only
+	 *  stored in the in-memory buffers read by @ref GetSelectedOutputValue and @ref GetSelectedOutputDoubles; no values are
+	 *  formatted as text and nothing is written to the selected output files or strings, whatever the settings of
+	 *  @ref SetSelectedOutputFileOn and @ref SetSelectedOutputStringOn.  The initial setting is false.
+	 *  @param bValue           If true, only the in-memory buffers are filled; if false, the file and string switches apply.
+	 *  @see                    GetSelectedOutputBinaryOnly, GetSelectedOutputDoubles, SetSelectedOutputFileOn, SetSelectedOutputStringOn
+	 */
+	void                     SetSelectedOutputBinaryOnly(bool bValue);
+
 	/**
 	 *  Sets the name of the current selected output file (see @ref SetCurrentSelectedOutputUserNumber).  This file name is used if not specified within <B>SELECTED_OUTPUT</B> input.
 	 *  The default value is <B><I>selected_n.id.out</I></B>, where id is obtained from @ref GetId.
@@ -858,6 +1072,19 @@ public:
 	 */
 	void                     SetSelectedOutputStringOn(bool bValue);
 
+	/**
+	 *  Writes the loaded database to a binary image that can be reloaded with @ref LoadDatabaseBinary.
+	 *  @param binary_filename  The name of the binary database image to write.
+	 *  @return                 The number of errors encountered.
+	 *  @see                    LoadDatabaseBinary
+	 *  @pre
+	 *      @ref LoadDatabase/@ref LoadDatabaseString must have been called and returned 0 (zero) errors.
+	 *  @remarks
+	 *      The image holds the database tables only; a database that also defines reactants, <B>SELECTED_OUTPUT</B>,
+	 *      <B>USER_PRINT</B> or <B>TRANSPORT</B> cannot be written.
+	 */
+	int                      WriteDatabaseBinary(const char* binary_filename);
+
 public:
 	// overrides
 	virtual void error_msg(const char *str, bool stop=false);
@@ -886,11 +1113,14 @@ protected:
 	void open_output_files(const char* sz_routine);
 
 	void do_run(const char* sz_routine, std::istream* pis, PFN_PRERUN_CALLBACK pfn_pre, PFN_POSTRUN_CALLBACK pfn_post, void *cookie);
+	void do_run_cells(const char* sz_routine, int first_cell, int ncells, const double *c, const double *tc, const double *patm, double *c_out, double *so_out);
+	void setup_selected_output(const char* sz_routine);
 
 	void update_errors(void);
 
 	int load_db(const char* filename);
 	int load_db_str(const char* filename);
+	int write_db_binary(const char* binary_filename);
 	int test_db(void);
 
 	bool get_sel_out_file_on(int n)const;
@@ -910,6 +1140,7 @@ protected:
 	bool                       ClearAccumulated;
 	bool                       UpdateComponents;
 	std::map< int, bool >      SelectedOutputFileOnMap;
+	bool                       SelectedOutputBinaryOnly;
 
 	bool                       OutputFileOn;
 
@@ -944,6 +1175,8 @@ protected:
 	std::string                DumpString;
 	std::vector< std::string > DumpLines;
 
+	std::string                ProfilingString;
+
 	std::list< std::string >   Components;
 	std::list< std::string >   EquilibriumPhasesList;
 	const std::list<std::string> &GetEquilibriumPhasesList() { return this->EquilibriumPhasesList; };
@@ -979,6 +1212,11 @@ protected:
 
 protected:
 	Phreeqc* PhreeqcPtr;
+	IPhreeqcDatabase* DatabaseSnapshot;
+	unsigned long long DatabaseChecksum;
+	long long DatabaseFileSize;         // of the loaded database file, -1 if none
+	long long DatabaseFileTime;         // modification time of the file, -1 if none
+	bool DatabaseBinaryUsed;
 	FILE *input_file;
 	FILE *database_file;
 
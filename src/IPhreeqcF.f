@@ -448,6 +448,21 @@
         INTEGER(KIND=4)  :: RunAccumulatedF
         RunAccumulated = RunAccumulatedF(ID)
       END FUNCTION RunAccumulated
+!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+      FUNCTION RunCells(ID,FIRST_CELL,NCELLS,C,TC,PATM,C_OUT,SO_OUT)
+        IMPLICIT NONE
+        INTEGER(KIND=4)  :: ID
+        INTEGER(KIND=4)  :: FIRST_CELL
+        INTEGER(KIND=4)  :: NCELLS
+        DOUBLE PRECISION :: C(NCELLS,*)
+        DOUBLE PRECISION :: TC(NCELLS)
+        DOUBLE PRECISION :: PATM(NCELLS)
+        DOUBLE PRECISION :: C_OUT(NCELLS,*)
+        DOUBLE PRECISION :: SO_OUT(NCELLS,*)
+        INTEGER(KIND=4)  :: RunCells
+        INTEGER(KIND=4)  :: RunCellsF
+        RunCells = RunCellsF(ID,FIRST_CELL,NCELLS,C,TC,PATM,C_OUT,SO_OUT)
+      END FUNCTION RunCells
 !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
       FUNCTION RunFile(ID,FILENAME)
         IMPLICIT NONE
@@ -123,6 +123,18 @@ GetCurrentSelectedOutputUserNumber(int id)
 	return IPQ_BADINSTANCE;
 }
 
+IPQ_RESULT
+GetCvodeStatistics(int id, int *integrations, int *steps, int *rhs_evaluations, int *jacobian_evaluations)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		IPhreeqcPtr->GetCvodeStatistics(integrations, steps, rhs_evaluations, jacobian_evaluations);
+		return IPQ_OK;
+	}
+	return IPQ_BADINSTANCE;
+}
+
 const char*
 GetDumpFileName(int id)
 {
@@ -471,6 +483,54 @@ GetOutputStringOn(int id)
 	return IPQ_BADINSTANCE;
 }
 
+int
+GetProfilingOn(int id)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		if (IPhreeqcPtr->GetProfilingOn())
+		{
+			return 1;
+		}
+		else
+		{
+			return 0;
+		}
+	}
+	return IPQ_BADINSTANCE;
+}
+
+const char*
+GetProfilingString(int id)
+{
+	static const char err_msg[] = "GetProfilingString: Invalid instance id.\n";
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		return IPhreeqcPtr->GetProfilingString();
+	}
+	return err_msg;
+}
+
+int
+GetSelectedOutputBinaryOnly(int id)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		if (IPhreeqcPtr->GetSelectedOutputBinaryOnly())
+		{
+			return 1;
+		}
+		else
+		{
+			return 0;
+		}
+	}
+	return IPQ_BADINSTANCE;
+}
+
 int
 GetSelectedOutputColumnCount(int id)
 {
@@ -482,6 +542,17 @@ GetSelectedOutputColumnCount(int id)
 	return IPQ_BADINSTANCE;
 }
 
+const double*
+GetSelectedOutputColumnDoubles(int id, int col)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		return IPhreeqcPtr->GetSelectedOutputColumnDoubles(col);
+	}
+	return NULL;
+}
+
 int
 GetSelectedOutputCount(int id)
 {
@@ -493,6 +564,21 @@ GetSelectedOutputCount(int id)
 	return IPQ_BADINSTANCE;
 }
 
+IPQ_RESULT
+GetSelectedOutputDoubles(int id, double* values, int rows, int cols, int row_major)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		switch (IPhreeqcPtr->GetSelectedOutputDoubles(values, rows, cols, row_major != 0))
+		{
+		case VR_OK:          return IPQ_OK;
+		default:             return IPQ_INVALIDARG;
+		}
+	}
+	return IPQ_BADINSTANCE;
+}
+
 const char*
 GetSelectedOutputFileName(int id)
 {
@@ -629,12 +715,50 @@ GetSelectedOutputValue2(int id, int row, int col, int *vtype, double* dvalue, ch
 	return IPQ_BADINSTANCE;
 }
 
+IPQ_RESULT
+GetSolverStats(int id, int n, SolverStats *stats)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		switch (IPhreeqcPtr->GetSolverStats(n, stats))
+		{
+		case VR_OK:          return IPQ_OK;
+		default:             return IPQ_INVALIDARG;
+		}
+	}
+	return IPQ_BADINSTANCE;
+}
+
+int
+GetSolverStatsCount(int id)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		return IPhreeqcPtr->GetSolverStatsCount();
+	}
+	return IPQ_BADINSTANCE;
+}
+
 const char*
 GetVersionString(void)
 {
 	return IPhreeqc::GetVersionString();
 }
 
+IPQ_RESULT
+GetWarmStartStatistics(int id, int *calculations, int *warm_starts, int *iterations)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		IPhreeqcPtr->GetWarmStartStatistics(calculations, warm_starts, iterations);
+		return IPQ_OK;
+	}
+	return IPQ_BADINSTANCE;
+}
+
 const char*
 GetWarningString(int id)
 {
@@ -681,6 +805,17 @@ LoadDatabase(int id, const char* filename)
 	return IPQ_BADINSTANCE;
 }
 
+int
+LoadDatabaseBinary(int id, const char* binary_filename, const char* filename)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		return IPhreeqcPtr->LoadDatabaseBinary(binary_filename, filename);
+	}
+	return IPQ_BADINSTANCE;
+}
+
 int
 LoadDatabaseString(int id, const char* input)
 {
@@ -748,6 +883,17 @@ RunAccumulated(int id)
 	return IPQ_BADINSTANCE;
 }
 
+int
+RunCells(int id, int first_cell, int ncells, const double *c, const double *tc, const double *patm, double *c_out, double *so_out)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		return IPhreeqcPtr->RunCells(first_cell, ncells, c, tc, patm, c_out, so_out);
+	}
+	return IPQ_BADINSTANCE;
+}
+
 int
 RunFile(int id, const char* filename)
 {
@@ -968,6 +1114,30 @@ SetOutputStringOn(int id, int value)
 	return IPQ_BADINSTANCE;
 }
 
+IPQ_RESULT
+SetProfilingOn(int id, int value)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		IPhreeqcPtr->SetProfilingOn(value != 0);
+		return IPQ_OK;
+	}
+	return IPQ_BADINSTANCE;
+}
+
+IPQ_RESULT
+SetSelectedOutputBinaryOnly(int id, int value)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		IPhreeqcPtr->SetSelectedOutputBinaryOnly(value != 0);
+		return IPQ_OK;
+	}
+	return IPQ_BADINSTANCE;
+}
+
 IPQ_RESULT
 SetSelectedOutputFileName(int id, const char* filename)
 {
@@ -1004,6 +1174,17 @@ SetSelectedOutputStringOn(int id, int value)
 	return IPQ_BADINSTANCE;
 }
 
+int
+WriteDatabaseBinary(int id, const char* binary_filename)
+{
+	IPhreeqc* IPhreeqcPtr = IPhreeqcLib::GetInstance(id);
+	if (IPhreeqcPtr)
+	{
+		return IPhreeqcPtr->WriteDatabaseBinary(binary_filename);
+	}
+	return IPQ_BADINSTANCE;
+}
+
 // helper functions
 //
 
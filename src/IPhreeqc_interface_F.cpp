@@ -244,6 +244,12 @@ GetSelectedOutputCountF(int *id)
 	return ::GetSelectedOutputCount(*id);
 }
 
+IPQ_RESULT
+GetSelectedOutputDoublesF(int *id, double* values, int *rows, int *cols)
+{
+	return ::GetSelectedOutputDoubles(*id, values, *rows, *cols, 0);
+}
+
 void
 GetSelectedOutputFileNameF(int *id, char* fname, int* fname_length)
 {
@@ -391,6 +397,12 @@ RunAccumulatedF(int *id)
 	return ::RunAccumulated(*id);
 }
 
+int
+RunCellsF(int *id, int *first_cell, int *ncells, double *c, double *tc, double *patm, double *c_out, double *so_out)
+{
+	return ::RunCells(*id, *first_cell, *ncells, c, tc, patm, c_out, so_out);
+}
+
 int
 RunFileF(int *id, char* filename)
 {
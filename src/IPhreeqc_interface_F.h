@@ -41,6 +41,7 @@
 #define GetOutputStringOnF                  FC_FUNC (getoutputstringonf,                  GETOUTPUTSTRINGONF)
 #define GetSelectedOutputColumnCountF       FC_FUNC (getselectedoutputcolumncountf,       GETSELECTEDOUTPUTCOLUMNCOUNTF)
 #define GetSelectedOutputCountF             FC_FUNC (getselectedoutputcountf,             GETSELECTEDOUTPUTCOUNTF)
+#define GetSelectedOutputDoublesF           FC_FUNC (getselectedoutputdoublesf,           GETSELECTEDOUTPUTDOUBLESF)
 #define GetSelectedOutputFileNameF          FC_FUNC (getselectedoutputfilenamef,          GETSELECTEDOUTPUTFILENAMEF)
 #define GetSelectedOutputFileOnF            FC_FUNC (getselectedoutputfileonf,            GETSELECTEDOUTPUTFILEONF)
 #define GetSelectedOutputRowCountF          FC_FUNC (getselectedoutputrowcountf,          GETSELECTEDOUTPUTROWCOUNTF)
@@ -57,6 +58,7 @@
 #define OutputErrorStringF                  FC_FUNC (outputerrorstringf,                  OUTPUTERRORSTRINGF)
 #define OutputWarningStringF                FC_FUNC (outputwarningstringf,                OUTPUTWARNINGSTRINGF)
 #define RunAccumulatedF                     FC_FUNC (runaccumulatedf,                     RUNACCUMULATEDF)
+#define RunCellsF                           FC_FUNC (runcellsf,                           RUNCELLSF)
 #define RunFileF                            FC_FUNC (runfilef,                            RUNFILEF)
 #define RunStringF                          FC_FUNC (runstringf,                          RUNSTRINGF)
 #define SetBasicFortranCallbackF            FC_FUNC (setbasicfortrancallbackf,            SETFOTRANBASICCALLBACKF)
@@ -115,6 +117,7 @@ extern "C" {
   IPQ_DLL_EXPORT int        GetOutputStringOnF(int *id);
   IPQ_DLL_EXPORT int        GetSelectedOutputColumnCountF(int *id);
   IPQ_DLL_EXPORT int        GetSelectedOutputCountF(int *id);
+  IPQ_DLL_EXPORT IPQ_RESULT GetSelectedOutputDoublesF(int *id, double* values, int *rows, int *cols);
   IPQ_DLL_EXPORT void       GetSelectedOutputFileNameF(int *id, char* filename, int* filename_length);
   IPQ_DLL_EXPORT int        GetSelectedOutputFileOnF(int *id);
   IPQ_DLL_EXPORT int        GetSelectedOutputRowCountF(int *id);
@@ -131,6 +134,7 @@ extern "C" {
   IPQ_DLL_EXPORT void       OutputErrorStringF(int *id);
   IPQ_DLL_EXPORT void       OutputWarningStringF(int *id);
   IPQ_DLL_EXPORT int        RunAccumulatedF(int *id);
+  IPQ_DLL_EXPORT int        RunCellsF(int *id, int *first_cell, int *ncells, double *c, double *tc, double *patm, double *c_out, double *so_out);
   IPQ_DLL_EXPORT int        RunFileF(int *id, char* filename);
   IPQ_DLL_EXPORT int        RunStringF(int *id, char* input);
 #ifdef IPHREEQC_NO_FORTRAN_MODULE
@@ -0,0 +1,43 @@
+/*! @file SolverStats.h
+	@brief %IPhreeqc SolverStats Documentation
+*/
+#ifndef _INC_SOLVERSTATS_H
+#define _INC_SOLVERSTATS_H
+
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+
+/*! \brief Statistics of the equilibrium calculations of a cell in a simulation (<b>KNOBS -solver_stats true</b>), or of one
+	calculation of a batch-reaction, transport or <b>RUN_CELLS</b> step (<b>KNOBS -solver_stats each</b>).
+*/
+typedef struct {
+	int    cell;                /*!< Cell, solution or mix number */
+	int    simulation;          /*!< Simulation number */
+	int    calculations;        /*!< Number of calculations summed in the record, 1 with <b>KNOBS -solver_stats each</b> */
+	int    kinetics;            /*!< 1 if a calculation is a trial of a kinetic integration, otherwise 0 */
+	int    converged;           /*!< 1 if every calculation converged, otherwise 0 */
+	int    tries;               /*!< Number of tries with different convergence parameters */
+	int    last_try;            /*!< Convergence parameter set of the last try of the last calculation, 0 is the <b>KNOBS</b> values */
+	int    path;                /*!< Bit j is set if convergence parameter set j was tried */
+	int    iterations;          /*!< Newton iterations of all tries */
+	int    step_cuts;           /*!< Iterations with a Newton step scaled down */
+	int    overflows;           /*!< Iterations with a molality overflow, initial guesses were revised */
+	int    basis_changes;       /*!< Basis species switches */
+	int    infeasible;          /*!< Infeasible solutions of the inequality solver */
+	int    sparse_solves;       /*!< Newton iterations with a square system of equalities only, solved by the LU of <b>KNOBS -sparse_solver</b> */
+	int    numerical_switches;  /*!< Switches to numerical derivatives for a fixed-volume gas phase */
+	double time;                /*!< Wall-clock seconds of the calculations */
+	double time_ineq;           /*!< Seconds in the inequality solver */
+	double time_gammas;         /*!< Seconds in activity coefficients */
+	double time_jacobian;       /*!< Seconds in the jacobian */
+} SolverStats;
+
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _INC_SOLVERSTATS_H */
@@ -196,6 +196,10 @@ IPQ_DLL_EXPORT int  IPQ_DECL IPQ_CASE_UND(runaccumulated, RUNACCUMULATED, runacc
 {
 	return RunAccumulatedF(id);
 }
+IPQ_DLL_EXPORT int  IPQ_DECL IPQ_CASE_UND(runcells, RUNCELLS, runcells_, RUNCELLS_)(int *id, int *first_cell, int *ncells, double *c, double *tc, double *patm, double *c_out, double *so_out)
+{
+	return RunCellsF(id, first_cell, ncells, c, tc, patm, c_out, so_out);
+}
 IPQ_DLL_EXPORT int  IPQ_DECL IPQ_CASE_UND(runfile, RUNFILE, runfile_, RUNFILE_)(int *id, char *filename, size_t len)
 {
 	return RunFileF(id, filename, len);
@@ -441,6 +441,12 @@ RunAccumulatedF(int *id)
 	return ::RunAccumulated(*id);
 }
 
+int
+RunCellsF(int *id, int *first_cell, int *ncells, double *c, double *tc, double *patm, double *c_out, double *so_out)
+{
+	return ::RunCells(*id, *first_cell, *ncells, c, tc, patm, c_out, so_out);
+}
+
 int
 RunFileF(int *id, char* filename, size_t filename_length)
 {
@@ -57,6 +57,7 @@
 #define OutputErrorStringF                  FC_FUNC (outputerrorstringf,                  OUTPUTERRORSTRINGF)
 #define OutputWarningStringF                FC_FUNC (outputwarningstringf,                OUTPUTWARNINGSTRINGF)
 #define RunAccumulatedF                     FC_FUNC (runaccumulatedf,                     RUNACCUMULATEDF)
+#define RunCellsF                           FC_FUNC (runcellsf,                           RUNCELLSF)
 #define RunFileF                            FC_FUNC (runfilef,                            RUNFILEF)
 #define RunStringF                          FC_FUNC (runstringf,                          RUNSTRINGF)
 #define SetBasicFortranCallbackF            FC_FUNC (setbasicfortrancallbackf,            SETFOTRANBASICCALLBACKF)
@@ -130,6 +131,7 @@ extern "C" {
   void       OutputErrorStringF(int *id);
   void       OutputWarningStringF(int *id);
   int        RunAccumulatedF(int *id);
+  int        RunCellsF(int *id, int *first_cell, int *ncells, double *c, double *tc, double *patm, double *c_out, double *so_out);
   int        RunFileF(int *id, char* filename, size_t filename_length);
   int        RunStringF(int *id, char* input, size_t input_length);
   IPQ_RESULT SetBasicFortranCallbackF(int *id, double (*fcn)(double *x1, double *x2, char *str, size_t l));
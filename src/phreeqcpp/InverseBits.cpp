@@ -0,0 +1,220 @@
+#include <cstddef>				// size_t
+#include "InverseBits.h"
+
+void
+InverseBits::Resize(int n)
+{
+	this->count_bits = n;
+	this->words.assign((size_t) (n + BITS_PER_WORD - 1) / BITS_PER_WORD, 0ul);
+}
+
+void
+InverseBits::Clear(void)
+{
+	for (size_t i = 0; i < this->words.size(); i++)
+		this->words[i] = 0ul;
+}
+
+InverseBitsIndex::InverseBitsIndex(void)
+{
+	this->Clear(0);
+}
+
+void
+InverseBitsIndex::Clear(int n)
+{
+	node root;
+	root.child[0] = root.child[1] = -1;
+	root.set = -1;
+	this->nodes.clear();
+	this->nodes.push_back(root);
+	this->sets.clear();
+	this->count_bits = n;
+	this->count_words = (n + InverseBits::BITS_PER_WORD - 1) / InverseBits::BITS_PER_WORD;
+	this->any_bits.assign((size_t) this->count_words, 0ul);
+	this->all_bits.assign((size_t) this->count_words, ~0ul);
+	this->count = 0;
+	this->last_subset = -1;
+	this->last_superset = -1;
+}
+
+bool
+InverseBitsIndex::Insert(const InverseBits &b)
+{
+/*
+ *   Returns false if b was saved already
+ */
+	if (this->Contains(b))
+		return false;
+	int s = this->count;
+	for (int w = 0; w < this->count_words; w++)
+		this->sets.push_back(b.Get_word(w));
+	int n = 0;
+	for (int i = this->count_bits - 1; ; i--)
+	{
+		size_t k = (size_t) n * this->count_words;
+		for (int w = 0; w < this->count_words; w++)
+		{
+			this->any_bits[k + w] |= b.Get_word(w);
+			this->all_bits[k + w] &= b.Get_word(w);
+		}
+		if (this->nodes[n].set < 0)
+			this->nodes[n].set = s;
+		if (i < 0)
+			break;
+		int bit = b.Get(i) ? 1 : 0;
+		if (this->nodes[n].child[bit] < 0)
+		{
+			node child;
+			child.child[0] = child.child[1] = -1;
+			child.set = -1;
+			this->nodes.push_back(child);
+			this->any_bits.resize(this->any_bits.size() + this->count_words, 0ul);
+			this->all_bits.resize(this->all_bits.size() + this->count_words, ~0ul);
+			this->nodes[n].child[bit] = (int) this->nodes.size() - 1;
+		}
+		n = this->nodes[n].child[bit];
+	}
+	this->count++;
+	return true;
+}
+
+bool
+InverseBitsIndex::Contains(const InverseBits &b)const
+{
+	if (this->count == 0)
+		return false;
+	int n = 0;
+	for (int i = this->count_bits - 1; i >= 0 && n >= 0; i--)
+	{
+		n = this->nodes[n].child[b.Get(i) ? 1 : 0];
+	}
+	return (n >= 0);
+}
+
+bool
+InverseBitsIndex::Has_subset_of(const InverseBits &b)const
+{
+/*
+ *   Whether any saved set has no bit that is not in b
+ */
+	if (this->count == 0)
+		return false;
+	if (this->last_subset >= 0 && this->Set_is_subset(this->last_subset, b))
+		return true;
+	int stop = 0;
+	while (stop < this->count_bits && b.Get(stop))
+		stop++;
+	int s = this->Find_subset(0, this->count_bits - 1, stop, b);
+	if (s < 0)
+		return false;
+	this->last_subset = s;
+	return true;
+}
+
+bool
+InverseBitsIndex::Has_superset_of(const InverseBits &b)const
+{
+/*
+ *   Whether any saved set has every bit of b
+ */
+	if (this->count == 0)
+		return false;
+	if (this->last_superset >= 0 && this->Set_is_superset(this->last_superset, b))
+		return true;
+	int stop = 0;
+	while (stop < this->count_bits && !b.Get(stop))
+		stop++;
+	int s = this->Find_superset(0, this->count_bits - 1, stop, b);
+	if (s < 0)
+		return false;
+	this->last_superset = s;
+	return true;
+}
+
+bool
+InverseBitsIndex::Set_is_subset(int s, const InverseBits &b)const
+{
+	size_t k = (size_t) s * this->count_words;
+	for (int w = 0; w < this->count_words; w++)
+	{
+		if ((this->sets[k + w] & ~b.Get_word(w)) != 0)
+			return false;
+	}
+	return true;
+}
+
+bool
+InverseBitsIndex::Set_is_superset(int s, const InverseBits &b)const
+{
+	size_t k = (size_t) s * this->count_words;
+	for (int w = 0; w < this->count_words; w++)
+	{
+		if ((b.Get_word(w) & ~this->sets[k + w]) != 0)
+			return false;
+	}
+	return true;
+}
+
+int
+InverseBitsIndex::Find_subset(int n, int i, int stop, const InverseBits &b)const
+{
+/*
+ *   Returns a saved set below node n that is a subset of b, or -1.
+ *   Every node has at least one saved set below it, so the search ends
+ *   when bits i and below of b are all 1 (i < stop) or when the union of
+ *   the sets below is in b; no set below can be a subset if a bit
+ *   common to all of them is missing from b
+ */
+	const node &nd = this->nodes[n];
+	if (i < stop)
+		return nd.set;
+	size_t k = (size_t) n * this->count_words;
+	bool all = true;
+	for (int w = 0; w < this->count_words; w++)
+	{
+		if ((this->all_bits[k + w] & ~b.Get_word(w)) != 0)
+			return -1;
+		if ((this->any_bits[k + w] & ~b.Get_word(w)) != 0)
+			all = false;
+	}
+	if (all)
+		return nd.set;
+	int s = -1;
+	if (nd.child[0] >= 0)
+		s = this->Find_subset(nd.child[0], i - 1, stop, b);
+	if (s < 0 && b.Get(i) && nd.child[1] >= 0)
+		s = this->Find_subset(nd.child[1], i - 1, stop, b);
+	return s;
+}
+
+int
+InverseBitsIndex::Find_superset(int n, int i, int stop, const InverseBits &b)const
+{
+/*
+ *   Returns a saved set below node n that is a superset of b, or -1.
+ *   The search ends when bits i and below of b are all 0 (i < stop) or
+ *   when b is in the intersection of the sets below; no set below can
+ *   be a superset if a bit of b is missing from all of them
+ */
+	const node &nd = this->nodes[n];
+	if (i < stop)
+		return nd.set;
+	size_t k = (size_t) n * this->count_words;
+	bool all = true;
+	for (int w = 0; w < this->count_words; w++)
+	{
+		if ((b.Get_word(w) & ~this->any_bits[k + w]) != 0)
+			return -1;
+		if ((b.Get_word(w) & ~this->all_bits[k + w]) != 0)
+			all = false;
+	}
+	if (all)
+		return nd.set;
+	int s = -1;
+	if (nd.child[1] >= 0)
+		s = this->Find_superset(nd.child[1], i - 1, stop, b);
+	if (s < 0 && !b.Get(i) && nd.child[0] >= 0)
+		s = this->Find_superset(nd.child[0], i - 1, stop, b);
+	return s;
+}
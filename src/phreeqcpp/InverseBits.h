@@ -0,0 +1,84 @@
+#if !defined(INVERSEBITS_H_INCLUDED)
+#define INVERSEBITS_H_INCLUDED
+#include <vector>               // std::vector
+
+/*
+ *   Set of the phases and solutions of an inverse model, one bit for
+ *   each; phases are in the low bits, solutions above them.
+ */
+class InverseBits
+{
+public:
+	InverseBits(void) : count_bits(0) {};
+	InverseBits(int n) { this->Resize(n); };
+	void Resize(int n);
+	void Clear(void);
+	int Get_count_bits(void)const { return(this->count_bits); };
+	bool Get(int i)const
+	{
+		return ((this->words[i / BITS_PER_WORD] >> (i % BITS_PER_WORD)) & 1ul) != 0;
+	};
+	void Set(int i, bool value)
+	{
+		unsigned long mask = 1ul << (i % BITS_PER_WORD);
+		if (value)
+			this->words[i / BITS_PER_WORD] |= mask;
+		else
+			this->words[i / BITS_PER_WORD] &= ~mask;
+	};
+	int Get_count_words(void)const { return((int) this->words.size()); };
+	unsigned long Get_word(int w)const { return(this->words[w]); };
+	bool operator==(const InverseBits &b)const { return(this->words == b.words); };
+	bool operator!=(const InverseBits &b)const { return(this->words != b.words); };
+
+	enum { BITS_PER_WORD = 8 * sizeof(unsigned long) };
+
+protected:
+	std::vector<unsigned long> words;
+	int count_bits;
+};
+
+/*
+ *   Binary trie of InverseBits, one level for each bit from the highest,
+ *   that finds whether any saved set is a subset or superset of a query
+ *   without scanning every saved set. Each node keeps the union and the
+ *   intersection of the sets below it, so that branches that cannot
+ *   hold an answer are not searched. Consecutive queries of the phase
+ *   enumeration usually have the same answer, so the saved set found by
+ *   the last query is tried first.
+ */
+class InverseBitsIndex
+{
+public:
+	InverseBitsIndex(void);
+	void Clear(int n);
+	bool Insert(const InverseBits &b);
+	bool Contains(const InverseBits &b)const;
+	bool Has_subset_of(const InverseBits &b)const;
+	bool Has_superset_of(const InverseBits &b)const;
+	int Get_count(void)const { return(this->count); };
+
+protected:
+	struct node
+	{
+		int child[2];
+		int set;				/* one of the saved sets below the node */
+	};
+	bool Set_is_subset(int s, const InverseBits &b)const;
+	bool Set_is_superset(int s, const InverseBits &b)const;
+	int Find_subset(int n, int i, int stop, const InverseBits &b)const;
+	int Find_superset(int n, int i, int stop, const InverseBits &b)const;
+
+protected:
+	std::vector<node> nodes;	/* nodes[0] is the root */
+	std::vector<unsigned long> sets;	/* count_words for each saved set */
+	std::vector<unsigned long> any_bits;	/* count_words for each node */
+	std::vector<unsigned long> all_bits;	/* count_words for each node */
+	int count_bits;
+	int count_words;
+	int count;
+	mutable int last_subset;
+	mutable int last_superset;
+};
+
+#endif // !defined(INVERSEBITS_H_INCLUDED)
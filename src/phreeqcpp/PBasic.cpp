@@ -1861,6 +1861,53 @@ stringfactor(std::string & Result, struct LOC_exec * LINK)
 	return Result.c_str();
 }
 
+void * PBasic::
+boundfactor(tokenrec *facttok, struct LOC_exec *LINK)
+{
+	/*
+	 *   A constant name argument, ("name"), is looked up once and kept with
+	 *   the function token until the model changes. Returns NULL, with
+	 *   LINK->t unchanged, if the argument is not a constant or the name is
+	 *   not found; the caller then evaluates the argument.
+	 */
+	tokenrec *t = LINK->t;
+	if (parse_all || t == NULL || t->kind != toklp ||
+		t->next == NULL || t->next->kind != tokstr ||
+		t->next->next == NULL || t->next->next->kind != tokrp)
+	{
+		return (NULL);
+	}
+	if (facttok->bound_generation != PhreeqcPtr->basic_bind_generation)
+	{
+		const char *name = t->next->UU.sp;
+		int l;
+		switch (facttok->kind)
+		{
+		case toksr:
+		case toksi:
+			facttok->bound = PhreeqcPtr->phase_bsearch(name, &l, FALSE);
+			break;
+		case toktot:
+		case toktotmole:
+		case toktotmol:
+		case toktotmoles:
+			/* H and O are totals of the model, not of a master species */
+			facttok->bound = (strcmp(name, "H") == 0 || strcmp(name, "O") == 0) ?
+				NULL : PhreeqcPtr->master_bsearch(name);
+			break;
+		default:
+			facttok->bound = PhreeqcPtr->s_search(name);
+			break;
+		}
+		facttok->bound_generation = PhreeqcPtr->basic_bind_generation;
+	}
+	if (facttok->bound != NULL)
+	{
+		LINK->t = t->next->next->next;
+	}
+	return (facttok->bound);
+}
+
 long PBasic::
 intfactor(struct LOC_exec *LINK)
 {
@@ -2260,6 +2307,12 @@ factor(struct LOC_exec * LINK)
 
 	case tokact:
 		{
+			void *bound = boundfactor(facttok, LINK);
+			if (bound != NULL)
+			{
+				n.UU.val = PhreeqcPtr->activity((struct species *) bound);
+				break;
+			}
 			const char * str = stringfactor(STR1, LINK);
 			n.UU.val = (parse_all) ? 1 : PhreeqcPtr->activity(str);
 		}
@@ -2267,6 +2320,12 @@ factor(struct LOC_exec * LINK)
 
 	case tokgamma:
 		{
+			void *bound = boundfactor(facttok, LINK);
+			if (bound != NULL)
+			{
+				n.UU.val = PhreeqcPtr->activity_coefficient((struct species *) bound);
+				break;
+			}
 			const char * str = stringfactor(STR1, LINK);
 			n.UU.val = (parse_all) ? 1 : PhreeqcPtr->activity_coefficient(str);
 		}
@@ -2274,6 +2333,12 @@ factor(struct LOC_exec * LINK)
 
 	case toklg:
 		{
+			void *bound = boundfactor(facttok, LINK);
+			if (bound != NULL)
+			{
+				n.UU.val = PhreeqcPtr->log_activity_coefficient((struct species *) bound);
+				break;
+			}
 			const char * str = stringfactor(STR1, LINK);
 			n.UU.val = (parse_all) ? 1 : PhreeqcPtr->log_activity_coefficient(str);
 		}
@@ -3328,6 +3393,12 @@ factor(struct LOC_exec * LINK)
 
 	case tokmol:
 		{
+			void *bound = boundfactor(facttok, LINK);
+			if (bound != NULL)
+			{
+				n.UU.val = PhreeqcPtr->molality((struct species *) bound);
+				break;
+			}
 			const char * str = stringfactor(STR1, LINK);
 			n.UU.val = (parse_all) ? 1 : PhreeqcPtr->molality(str);
 		}
@@ -3335,6 +3406,12 @@ factor(struct LOC_exec * LINK)
 
 	case tokla:
 		{
+			void *bound = boundfactor(facttok, LINK);
+			if (bound != NULL)
+			{
+				n.UU.val = PhreeqcPtr->log_activity((struct species *) bound);
+				break;
+			}
 			const char * str = stringfactor(STR1, LINK);
 			n.UU.val = (parse_all) ? 1 : PhreeqcPtr->log_activity(str);
 		}
@@ -3342,6 +3419,12 @@ factor(struct LOC_exec * LINK)
 
 	case toklm:
 		{
+			void *bound = boundfactor(facttok, LINK);
+			if (bound != NULL)
+			{
+				n.UU.val = PhreeqcPtr->log_molality((struct species *) bound);
+				break;
+			}
 			const char * str = stringfactor(STR1, LINK);
 			n.UU.val = (parse_all) ? 1 : PhreeqcPtr->log_molality(str);
 		}
@@ -3349,6 +3432,12 @@ factor(struct LOC_exec * LINK)
 
 	case toksr:
 		{
+			void *bound = boundfactor(facttok, LINK);
+			if (bound != NULL)
+			{
+				n.UU.val = PhreeqcPtr->saturation_ratio((struct phase *) bound);
+				break;
+			}
 			const char * str = stringfactor(STR1, LINK);
 			n.UU.val = (parse_all) ? 1 : PhreeqcPtr->saturation_ratio(str);
 		}
@@ -3574,6 +3663,12 @@ factor(struct LOC_exec * LINK)
 
 	case toksi:
 		{
+			void *bound = boundfactor(facttok, LINK);
+			if (bound != NULL)
+			{
+				PhreeqcPtr->saturation_index((struct phase *) bound, &l_dummy, &n.UU.val);
+				break;
+			}
 			const char * str = stringfactor(STR1, LINK);
 			if (parse_all)
 			{
@@ -3588,6 +3683,12 @@ factor(struct LOC_exec * LINK)
 
 	case toktot:
 		{
+			void *bound = boundfactor(facttok, LINK);
+			if (bound != NULL)
+			{
+				n.UU.val = PhreeqcPtr->total((struct master *) bound);
+				break;
+			}
 			const char * str = stringfactor(STR1, LINK);
 			n.UU.val = (parse_all) ? 1 : PhreeqcPtr->total(str);
 		}
@@ -3597,6 +3698,12 @@ factor(struct LOC_exec * LINK)
 	case toktotmol:
 	case toktotmoles:
 		{
+			void *bound = boundfactor(facttok, LINK);
+			if (bound != NULL)
+			{
+				n.UU.val = PhreeqcPtr->total_mole((struct master *) bound);
+				break;
+			}
 			const char * str = stringfactor(STR1, LINK);
 			n.UU.val = (parse_all) ? 1 : PhreeqcPtr->total_mole(str);
 		}
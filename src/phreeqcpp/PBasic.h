@@ -80,6 +80,8 @@ typedef struct tokenrec
 	size_t n_sz;
 	char *sz_num;
 //#endif
+	void *bound;				/* species, phase or master of a constant name argument */
+	int bound_generation;		/* Phreeqc::basic_bind_generation of bound */
 } tokenrec;
 
 typedef struct linerec
@@ -402,6 +404,7 @@ public:
 	char *stringfactor(char * Result, struct LOC_exec *LINK);
 	const char *stringfactor(std::string & Result, struct LOC_exec * LINK);
 	long intfactor(struct LOC_exec *LINK);
+	void *boundfactor(tokenrec *facttok, struct LOC_exec *LINK);
 	LDBLE realexpr(struct LOC_exec *LINK);
 	char * strexpr(struct LOC_exec * LINK);
 	char * stringexpr(char * Result, struct LOC_exec * LINK);
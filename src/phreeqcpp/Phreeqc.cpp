@@ -37,6 +37,7 @@ const int Phreeqc::count_iso_defaults = (sizeof(iso_defaults) / sizeof(struct co
 Phreeqc::~Phreeqc(void)
 {
 
+	workers_free();
 	clean_up();
 	
 	PHRQ_free_all();
@@ -436,6 +437,10 @@ void Phreeqc::init(void)
 	current_pa                      = NAN;
 	current_mu                      = NAN;
 	mu_terms_in_logk                = true;
+	// auto logk_models
+	logk_model                      = -1;
+	// auto logk_table
+	// auto logk_table_work
 	current_A                       = 0.0;
 	current_x                       = 0.0;
 	fix_current                     = 0.0;
@@ -602,6 +607,15 @@ void Phreeqc::init(void)
 	run_cells_one_step = false;
 	// auto Rxn_reaction_map;
 	/*----------------------------------------------------------------------
+	*   Cell workers
+	*---------------------------------------------------------------------- */
+	count_workers = 1;
+	// auto workers;
+	count_jacobian_workers = 1;
+	// auto jacobian_workers;
+	count_prep = 0;
+	jacobian_prep = -1;
+	/*----------------------------------------------------------------------
 	*   Gas phase
 	*---------------------------------------------------------------------- */
 	// auto Rxn_gas_phase_map;
@@ -640,6 +654,7 @@ void Phreeqc::init(void)
 	count_sum_delta         = 0;
 	max_sum_delta           = 0;
 	sum_delta               = NULL;
+	sum_rows_built          = false;
 	/*----------------------------------------------------------------------
 	*   Solution
 	*---------------------------------------------------------------------- */
@@ -983,6 +998,10 @@ void Phreeqc::init(void)
 	pp_scale				= 1.0;
 	pp_column_scale			= 1.0;
 	diagonal_scale			= FALSE;
+	sparse_solver			= FALSE;
+	analytic_jacobian		= FALSE;
+	logk_grid_dt			= 0.0;
+	logk_grid_tol			= 1e-6;
 	mass_water_switch		= FALSE;
 	delay_mass_water		= FALSE;
 	equi_delay      		= 0;
@@ -1017,6 +1036,9 @@ void Phreeqc::init(void)
 #ifdef HASH
 	// auto strings_hash;
 #endif
+	database_snapshot       = NULL;
+	shared_definitions      = NULL;
+	shared_bind_generation  = 0;
 	elements_hash_table     = NULL;
 	species_hash_table      = NULL;
 	phases_hash_table       = NULL;
@@ -1082,6 +1104,7 @@ void Phreeqc::init(void)
 	s_pTail                 = NULL;
 	/* Basic */
 	basic_interpreter       = NULL;
+	basic_bind_generation   = 1;
 	basic_callback_ptr      = NULL;
 	basic_callback_cookie   = NULL;
 	basic_fortran_callback_ptr  = NULL;
@@ -1174,29 +1197,18 @@ void Phreeqc::init(void)
 	master_alk              = NULL;
 	row_back                = NULL;
 	col_back                = NULL;
-	good                    = NULL;
-	bad                     = NULL;
-	minimal                 = NULL;
-	max_good                = 0;
-	max_bad                 = 0;
-	max_minimal             = 0;
+	// auto good, bad, minimal
 	count_good              = 0;
 	count_bad               = 0;
 	count_minimal           = 0;
 	count_calls             = 0;
 	soln_bits               = 0;
-	phase_bits              = 0;
-	current_bits            = 0;
+	// auto phase_bits, current_bits
 	temp_bits               = 0;
 	netpath_file            = NULL;
 	count_inverse_models    = 0;
 	count_pat_solutions     = 0;
-	for (int i = 0; i < 32; i++)
-	{
-		min_position[i]     = 0;
-		max_position[i]     = 0;
-		now[i]              = 0;
-	}
+	// auto min_position, max_position, now
 	/* kinetics.cpp ------------------------------- */
 	count_pp = count_pg = count_ss = 0; 
 	cvode_kinetics_ptr      = NULL;
@@ -1217,11 +1229,32 @@ void Phreeqc::init(void)
 	kinetics_cvode_mem      = NULL;
 	cvode_pp_assemblage_save= NULL;
 	cvode_ss_assemblage_save= NULL;
+	cvode_integrations      = 0;
+	cvode_steps_taken       = 0;
+	cvode_rhs_evaluations   = 0;
+	cvode_jacobian_evaluations = 0;
 	m_original              = NULL;
 	m_temp                  = NULL;
 	rk_moles                = NULL;
+	rk_reuse                = false;
+	rk_solved               = false;
+	rk_stage_reused         = false;
+	rk_stages_reused        = 0;
+	rk_rate_jacobian_updated = false;
+	// auto rk_solved_moles, rk_stage_delta, rk_rate_jacobian
 	set_and_run_attempt     = 0;
 	x0_moles                = NULL;
+	warm_start              = FALSE;
+	// auto cell_guess_map
+	cell_guess_ptr          = NULL;
+	cell_guess_n            = -2;
+	cell_calculations       = 0;
+	cell_warm_starts        = 0;
+	cell_iterations         = 0;
+	solver_stats_on         = FALSE;
+	memset(&solver_stats_x, 0, sizeof(solver_stats_x));
+	// auto solver_stats_list
+	// auto solver_stats_index
 	/* model.cpp ------------------------------- */
 	gas_in                  = FALSE;
 	min_value               = 1e-10;
@@ -1276,6 +1309,8 @@ void Phreeqc::init(void)
 	count_theta_param		= 0;
 	max_theta_param			= 100;
 	use_etheta				= TRUE;
+	etheta_calls			= 0;
+	etheta_hits				= 0;
 	OTEMP					= -100.;
 	OPRESS					= -100.;
 	A0                      = 0;	
@@ -1301,6 +1336,9 @@ void Phreeqc::init(void)
 		BK[i]				= 0.0;
 		DK[i]				= 0.0;
 	}
+	// auto pz_M0, pz_LG0, pz_dM, pz_dLG, pz_coef
+	pz_AW0                  = 0;
+	pz_BIGZ0                = 0;
 #ifdef PHREEQ98
 	int connect_simulations, graph_initial_solutions;
 	int shifts_as_points;
@@ -1350,6 +1388,9 @@ void Phreeqc::init(void)
 	sit_IPRSNT              = NULL;
 	sit_M                   = NULL;
 	sit_LGAMMA              = NULL;
+	/* sparse_lu.cpp ------------------------------- */
+	slu_n                   = 0;
+	// auto slu_key, slu_perm, slu_pattern, slu_l_*, slu_u_*, slu_work
 	/* tidy.cpp ------------------------------- */
 	a0                      = 0;
 	a1                      = 0;
@@ -1386,6 +1427,14 @@ void Phreeqc::init(void)
 	heat_mix_f_m            = 0;
 	warn_MCD_X              = 0;
 	warn_fixed_Surf         = 0;
+	tk_x2                   = 0;
+	dV_dcell                = 0;
+	find_current            = 0;
+	current_cells           = NULL;
+	sum_R                   = 0;
+	sum_Rd                  = 0;
+	ct                      = NULL;
+	moles_added             = NULL;
 #ifdef PHREEQ98
 	int AutoLoadOutputFile, CreateToC;
 	int ProcessMessages, ShowProgress, ShowProgressWindow, ShowChart;
@@ -1780,6 +1829,14 @@ Phreeqc::InternalCopy(const Phreeqc *pSrc)
 	//bool run_cells_one_step;
 	run_cells_one_step = pSrc->run_cells_one_step;
 	/*----------------------------------------------------------------------
+	*   Cell workers
+	*---------------------------------------------------------------------- */
+	count_workers = pSrc->count_workers;
+	// workers are not copied
+	count_jacobian_workers = pSrc->count_jacobian_workers;
+	count_prep = 0;
+	jacobian_prep = -1;
+	/*----------------------------------------------------------------------
 	*   Species
 	*---------------------------------------------------------------------- */
 	/*
@@ -1834,6 +1891,30 @@ Phreeqc::InternalCopy(const Phreeqc *pSrc)
 		}	
 	}
 	count_logk = pSrc->count_logk;
+	/*
+	 *   An instance that reads its strings from another (a database snapshot
+	 *   or the parent of a cell worker) also points to that instance's
+	 *   species and phase reactions and log K lists instead of copying them.
+	 *   Reaction tokens then point to the owner's species; s_local finds the
+	 *   species of this instance with the same index.
+	 */
+	shared_definitions = NULL;
+	if (database_snapshot != NULL)
+	{
+		shared_definitions = (pSrc->shared_definitions != NULL) ? pSrc->shared_definitions : pSrc;
+		for (int i = 0; i < pSrc->count_s; i++)
+		{
+			if (pSrc->s[i]->number != i)
+			{
+				shared_definitions = NULL;
+				break;
+			}
+		}
+	}
+	if (shared_definitions != NULL)
+	{
+		shared_bind_generation = shared_definitions->basic_bind_generation;
+	}
 	// s, species
 	count_s = 0;
 	//max_s = pSrc->max_s;
@@ -1856,15 +1937,18 @@ Phreeqc::InternalCopy(const Phreeqc *pSrc)
 		s_ptr->primary = NULL;
 		s_ptr->secondary = NULL;
 		//add_logk
-		s_ptr->add_logk = NULL;
-		if (s_ptr->count_add_logk > 0)
+		if (shared_definitions == NULL)
 		{
-			s_ptr->add_logk = (struct name_coef *) PHRQ_malloc((size_t) s_ptr->count_add_logk * sizeof(struct name_coef));
-			if (s_ptr->add_logk == NULL) malloc_error();
-			for (int j = 0; j < s_ptr->count_add_logk; j++)
+			s_ptr->add_logk = NULL;
+			if (s_ptr->count_add_logk > 0)
 			{
-				s_ptr->add_logk[j].coef = pSrc->s[i]->add_logk[j].coef;
-				s_ptr->add_logk[j].name = string_hsave( pSrc->s[i]->add_logk[j].name);
+				s_ptr->add_logk = (struct name_coef *) PHRQ_malloc((size_t) s_ptr->count_add_logk * sizeof(struct name_coef));
+				if (s_ptr->add_logk == NULL) malloc_error();
+				for (int j = 0; j < s_ptr->count_add_logk; j++)
+				{
+					s_ptr->add_logk[j].coef = pSrc->s[i]->add_logk[j].coef;
+					s_ptr->add_logk[j].name = string_hsave( pSrc->s[i]->add_logk[j].name);
+				}
 			}
 		}
 		//next_elt
@@ -1893,20 +1977,23 @@ Phreeqc::InternalCopy(const Phreeqc *pSrc)
 			cxxNameDouble next_sys_total(pSrc->s[i]->next_sys_total);
 			s_ptr->next_sys_total = NameDouble2elt_list(next_sys_total);
 		}
-		//rxn
-		s_ptr->rxn = NULL;
-		if (pSrc->s[i]->rxn != NULL)
-		{
-			cxxChemRxn rxn(pSrc->s[i]->rxn);
-			s_ptr->rxn = cxxChemRxn2rxn(rxn);
-			//s_ptr->rxn = rxn_copy_operator(pSrc->s[i]->rxn);
-		}
-		//rxn_s	
-		s_ptr->rxn_s = NULL;
-		if (pSrc->s[i]->rxn_s != NULL)
+		if (shared_definitions == NULL)
 		{
-			cxxChemRxn rxn_s(pSrc->s[i]->rxn_s);
-			s_ptr->rxn_s = cxxChemRxn2rxn(rxn_s);
+			//rxn
+			s_ptr->rxn = NULL;
+			if (pSrc->s[i]->rxn != NULL)
+			{
+				cxxChemRxn rxn(pSrc->s[i]->rxn);
+				s_ptr->rxn = cxxChemRxn2rxn(rxn);
+				//s_ptr->rxn = rxn_copy_operator(pSrc->s[i]->rxn);
+			}
+			//rxn_s	
+			s_ptr->rxn_s = NULL;
+			if (pSrc->s[i]->rxn_s != NULL)
+			{
+				cxxChemRxn rxn_s(pSrc->s[i]->rxn_s);
+				s_ptr->rxn_s = cxxChemRxn2rxn(rxn_s);
+			}
 		}
 		//rxn_x
 		s_ptr->rxn_x = NULL;
@@ -1944,15 +2031,18 @@ Phreeqc::InternalCopy(const Phreeqc *pSrc)
 		phase_ptr->name = string_hsave(pSrc->phases[i]->name);
 		phase_ptr->formula = string_hsave(pSrc->phases[i]->formula);
 		//add_logk
-		phase_ptr->add_logk = NULL;
-		if (phase_ptr->count_add_logk > 0)
+		if (shared_definitions == NULL)
 		{
-			phase_ptr->add_logk = (struct name_coef *) PHRQ_malloc((size_t) pSrc->phases[i]->count_add_logk * sizeof(struct name_coef));
-			if (phase_ptr->add_logk == NULL) malloc_error();
-			for (int j = 0; j < phase_ptr->count_add_logk; j++)
+			phase_ptr->add_logk = NULL;
+			if (phase_ptr->count_add_logk > 0)
 			{
-				phase_ptr->add_logk[j].coef = pSrc->phases[i]->add_logk[j].coef;
-				phase_ptr->add_logk[j].name = string_hsave( pSrc->phases[i]->add_logk[j].name);
+				phase_ptr->add_logk = (struct name_coef *) PHRQ_malloc((size_t) pSrc->phases[i]->count_add_logk * sizeof(struct name_coef));
+				if (phase_ptr->add_logk == NULL) malloc_error();
+				for (int j = 0; j < phase_ptr->count_add_logk; j++)
+				{
+					phase_ptr->add_logk[j].coef = pSrc->phases[i]->add_logk[j].coef;
+					phase_ptr->add_logk[j].name = string_hsave( pSrc->phases[i]->add_logk[j].name);
+				}
 			}
 		}
 		//next_elt
@@ -1969,19 +2059,22 @@ Phreeqc::InternalCopy(const Phreeqc *pSrc)
 			cxxNameDouble next_sys_total(pSrc->phases[i]->next_sys_total);
 			phase_ptr->next_sys_total = NameDouble2elt_list(next_sys_total);
 		}
-		//rxn
-		phase_ptr->rxn = NULL;
-		if (pSrc->phases[i]->rxn != NULL)
-		{
-			cxxChemRxn rxn(pSrc->phases[i]->rxn);
-			phase_ptr->rxn = cxxChemRxn2rxn(rxn);
-		}
-		//rxn_s
-		//phase_ptr->rxn_s = NULL;
-		if (pSrc->phases[i]->rxn_s != NULL)
+		if (shared_definitions == NULL)
 		{
-			cxxChemRxn rxn_s(pSrc->phases[i]->rxn_s);
-			phase_ptr->rxn_s = cxxChemRxn2rxn(rxn_s);
+			//rxn
+			phase_ptr->rxn = NULL;
+			if (pSrc->phases[i]->rxn != NULL)
+			{
+				cxxChemRxn rxn(pSrc->phases[i]->rxn);
+				phase_ptr->rxn = cxxChemRxn2rxn(rxn);
+			}
+			//rxn_s
+			//phase_ptr->rxn_s = NULL;
+			if (pSrc->phases[i]->rxn_s != NULL)
+			{
+				cxxChemRxn rxn_s(pSrc->phases[i]->rxn_s);
+				phase_ptr->rxn_s = cxxChemRxn2rxn(rxn_s);
+			}
 		}
 		//rxn_x
 		//phase_ptr->rxn_x = NULL;
@@ -2287,6 +2380,12 @@ Phreeqc::InternalCopy(const Phreeqc *pSrc)
 	pp_scale				= pSrc->pp_scale;
 	pp_column_scale			= pSrc->pp_column_scale;
 	diagonal_scale			= pSrc->diagonal_scale;
+	sparse_solver			= pSrc->sparse_solver;
+	analytic_jacobian		= pSrc->analytic_jacobian;
+	logk_grid_dt			= pSrc->logk_grid_dt;
+	logk_grid_tol			= pSrc->logk_grid_tol;
+	warm_start				= pSrc->warm_start;
+	solver_stats_on			= pSrc->solver_stats_on;
 	mass_water_switch		= pSrc->mass_water_switch;
 	delay_mass_water		= pSrc->delay_mass_water;
 	equi_delay      		= pSrc->equi_delay;
@@ -2372,6 +2471,7 @@ Phreeqc::InternalCopy(const Phreeqc *pSrc)
 		{
 			struct rate *rate_new = rate_copy(it->second.Get_rate());
 			it->second.Set_rate(rate_new);
+			it->second.Set_PhreeqcPtr(this);
 		}
 	}
 	
@@ -2677,6 +2777,8 @@ protected:
 		}
 	}
 	use_etheta              = pSrc->use_etheta;
+	etheta_calls            = 0;
+	etheta_hits             = 0;
 	/*
 	OTEMP					= -100.0;
 	OPRESS					= -100.0;
@@ -2685,7 +2787,7 @@ protected:
 	*/
 	if (pSrc->aphi != NULL)
 	{
-		aphi = (struct pitz_param *) malloc(sizeof(struct pitz_param));
+		aphi = pitz_param_alloc();
 		memcpy(aphi, pSrc->aphi, sizeof(struct pitz_param));
 	}
 	/*
@@ -2774,6 +2876,9 @@ protected:
 		sit_param_store(pSrc->sit_params[i], true);
 	}
 	sit_param_map = pSrc->sit_param_map;
+	/* sparse_lu.cpp ------------------------------- */
+	// factorization is not copied
+	slu_n = 0;
 	/* tidy.cpp ------------------------------- */
 	//a0                      = 0;
 	//a1                      = 0;
@@ -2815,6 +2920,14 @@ protected:
 	current_x = pSrc->current_x;
 	current_A = pSrc->current_A;
 	fix_current = pSrc->fix_current;
+	tk_x2                   = pSrc->tk_x2;
+	dV_dcell                = pSrc->dV_dcell;
+	find_current            = pSrc->find_current;
+	current_cells           = NULL;
+	sum_R                   = pSrc->sum_R;
+	sum_Rd                  = pSrc->sum_Rd;
+	ct                      = NULL;
+	moles_added             = NULL;
 
 #ifdef PHREEQ98
 	int AutoLoadOutputFile, CreateToC;
@@ -2848,6 +2961,7 @@ Phreeqc &Phreeqc::operator=(const Phreeqc &rhs)
 		return *this; 
 
 	// clean up this here
+	this->workers_free();
 	this->clean_up();
 
 	this->PHRQ_free_all();
@@ -41,6 +41,8 @@ typedef unsigned char boolean;
 #include "cxxMix.h"
 #include "Use.h"
 #include "Surface.h"
+#include "Profiler.h"
+#include "InverseBits.h"
 #ifdef SWIG_SHARED_OBJ
 #include "thread.h"
 #endif
@@ -100,8 +102,11 @@ public:
 #endif
 
 	LDBLE activity(const char *species_name);
+	LDBLE activity(struct species *s_ptr);
 	LDBLE activity_coefficient(const char *species_name);
+	LDBLE activity_coefficient(struct species *s_ptr);
 	LDBLE log_activity_coefficient(const char *species_name);
+	LDBLE log_activity_coefficient(struct species *s_ptr);
 	LDBLE aqueous_vm(const char *species_name);
 	LDBLE phase_vm(const char *phase_name);
 	LDBLE diff_c(const char *species_name);
@@ -134,13 +139,18 @@ public:
 	LDBLE kinetics_moles(const char *kinetics_name);
 	LDBLE kinetics_moles_delta(const char *kinetics_name);
 	LDBLE log_activity(const char *species_name);
+	LDBLE log_activity(struct species *s_ptr);
 	LDBLE log_molality(const char *species_name);
+	LDBLE log_molality(struct species *s_ptr);
 	LDBLE molality(const char *species_name);
+	LDBLE molality(struct species *s_ptr);
 	LDBLE pressure(void);
 	LDBLE pr_pressure(const char *phase_name);
 	LDBLE pr_phi(const char *phase_name);
 	LDBLE saturation_ratio(const char *phase_name);
+	LDBLE saturation_ratio(struct phase *phase_ptr);
 	int saturation_index(const char *phase_name, LDBLE * iap, LDBLE * si);
+	int saturation_index(struct phase *phase_ptr, LDBLE * iap, LDBLE * si);
 	int solution_number(void);
 	LDBLE solution_sum_secondary(const char *total_name);
 	LDBLE sum_match_gases(const char *stemplate, const char *name);
@@ -169,7 +179,9 @@ public:
 	int system_total_elt(const char *total_name);
 	int system_total_elt_secondary(const char *total_name);
 	LDBLE total(const char *total_name);
+	LDBLE total(struct master *master_ptr);
 	LDBLE total_mole(const char *total_name);
+	LDBLE total_mole(struct master *master_ptr);
 	int system_total_solids(cxxExchange *exchange_ptr,
 		cxxPPassemblage *pp_assemblage_ptr,
 		cxxGasPhase *gas_phase_ptr,
@@ -270,6 +282,13 @@ public:
 	void fpunchf_user(int user_index, const char *format, double d);
 	void fpunchf_user(int user_index, const char *format, char * d);
 	int fpunchf_end_row(const char *format);
+
+	// dbbinary.cpp -------------------------------
+	static unsigned long long database_checksum(const char *str, size_t n);
+	void database_binary_scalars(std::vector< std::pair<void *, size_t> > &fields);
+	int write_database_binary(std::ostream &os, unsigned long long checksum, long long text_size, long long text_time);
+	bool database_binary_stamp(const char *begin, const char *end, long long *text_size, long long *text_time, unsigned long long *checksum);
+	int read_database_binary(const char *begin, const char *end, unsigned long long checksum);
 #ifdef SKIP
 	// dw.cpp -------------------------------
 	int BB(LDBLE T);
@@ -311,7 +330,7 @@ public:
 	// inverse.cpp -------------------------------
 	int inverse_models(void);
 	int add_to_file(const char *filename, const char *string);
-	int bit_print(unsigned long bits, int l);
+	int bit_print(const InverseBits &bits, int l);
 	int carbon_derivs(struct inverse *inv_ptr);
 	int check_isotopes(struct inverse *inv_ptr);
 	int check_solns(struct inverse *inv_ptr);
@@ -323,8 +342,8 @@ public:
 	int post_mortem(void);
 	bool test_cl1_solution(void);
 	unsigned long get_bits(unsigned long bits, int position, int number);
-	unsigned long minimal_solve(struct inverse *inv_ptr,
-		unsigned long minimal_bits);
+	InverseBits minimal_solve(struct inverse *inv_ptr,
+		InverseBits minimal_bits);
 	void dump_netpath(struct inverse *inv_ptr);
 	int dump_netpath_pat(struct inverse *inv_ptr);
 	int next_set_phases(struct inverse *inv_ptr, int first_of_model_size,
@@ -344,11 +363,10 @@ public:
 
 	void print_total_pat(FILE * netpath_file, const char *elt,
 		const char *string);
-	int range(struct inverse *inv_ptr, unsigned long cur_bits);
-	int save_bad(unsigned long bits);
-	int save_good(unsigned long bits);
-	int save_minimal(unsigned long bits);
-	unsigned long set_bit(unsigned long bits, int position, int value);
+	int range(struct inverse *inv_ptr, InverseBits cur_bits);
+	int save_bad(const InverseBits &bits);
+	int save_good(const InverseBits &bits);
+	int save_minimal(const InverseBits &bits);
 	int setup_inverse(struct inverse *inv_ptr);
 	int set_initial_solution(int n_user_old, int n_user_new);
 	int set_ph_c(struct inverse *inv_ptr,
@@ -356,13 +374,13 @@ public:
 		LDBLE d_alk, LDBLE ph_factor, LDBLE alk_factor);
 	int shrink(struct inverse *inv_ptr, LDBLE * array_in,
 		LDBLE * array_out, int *k, int *l, int *m, int *n,
-		unsigned long cur_bits, LDBLE * delta_l, int *col_back_l,
+		const InverseBits &cur_bits, LDBLE * delta_l, int *col_back_l,
 		int *row_back_l);
 	int solve_inverse(struct inverse *inv_ptr);
-	int solve_with_mask(struct inverse *inv_ptr, unsigned long cur_bits);
-	int subset_bad(unsigned long bits);
-	int subset_minimal(unsigned long bits);
-	int superset_minimal(unsigned long bits);
+	int solve_with_mask(struct inverse *inv_ptr, const InverseBits &cur_bits);
+	int subset_bad(const InverseBits &bits);
+	int subset_minimal(const InverseBits &bits);
+	int superset_minimal(const InverseBits &bits);
 	int write_optimize_names(struct inverse *inv_ptr);
 
 	// isotopes.cpp -------------------------------
@@ -415,7 +433,17 @@ public:
 	int set_and_run_wrapper(int i, int use_mix, int use_kinetics, int nsaver,
 		LDBLE step_fraction);
 	int set_advection(int i, int use_mix, int use_kinetics, int nsaver);
+	void cell_guess_save(int n_cell);
+	int cell_guess_apply(void);
+	struct master *cell_guess_master(struct unknown *unknown_ptr);
+	void solver_stats_begin(int i, int use_kinetics);
+	void solver_stats_end(int converge);
+	void solver_stats_add(const struct solver_stats &s);
+	void solver_stats_clear(void);
+	LDBLE solver_time(void);
 	int free_cvode(void);
+	bool cvode_jacobian_column(int i, N_Vector y, const LDBLE *initial_rates, DenseMat J);
+	void cvode_statistics_add(const long int *iopt);
 public:
 	static void f(integertype N, realtype t, N_Vector y, N_Vector ydot,
 		void *f_data);
@@ -428,6 +456,15 @@ public:
 	int calc_kinetic_reaction(cxxKinetics *kinetics_ptr,
 		LDBLE time_step);
 	bool limit_rates(cxxKinetics *kinetics_ptr);
+	int rk_stage_run(int i, cxxKinetics *kinetics_ptr);
+	void rk_reuse_rates(cxxKinetics *kinetics_ptr, LDBLE h);
+	bool rk_reuse_predict(cxxKinetics *kinetics_ptr, LDBLE h, std::vector<LDBLE> &predicted,
+		std::vector<LDBLE> &delta);
+	bool rk_reuse_verify(cxxKinetics *kinetics_ptr, LDBLE h, const std::vector<LDBLE> &predicted,
+		const std::vector<LDBLE> &delta);
+	bool rk_reuse_rejected(cxxKinetics *kinetics_ptr, LDBLE h, bool predicted,
+		const std::vector<LDBLE> &reuse_moles, const std::vector<LDBLE> &reuse_delta,
+		cxxPPassemblage *pp_assemblage_save, cxxSSassemblage *ss_assemblage_save);
 	int rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 		LDBLE step_fraction);
 	int set_reaction(int i, int use_mix, int use_kinetics);
@@ -483,6 +520,7 @@ public:
 	LDBLE ss_f(LDBLE xb, LDBLE a0, LDBLE a1, LDBLE kc, LDBLE kb,
 		LDBLE xcaq, LDBLE xbaq);
 	int numerical_jacobian(void);
+	int numerical_jacobian_column(int i, const LDBLE *base, LDBLE *l_array);
 	void set_inert_moles(void);
 	void unset_inert_moles(void);
 #ifdef SLNQ
@@ -536,6 +574,7 @@ public:
 	struct theta_param *theta_param_alloc(void);
 	int theta_param_init(struct theta_param *theta_param_ptr);
 	void pitzer_make_lists(void);
+	void pitzer_kernels(void);
 	//int gammas_pz(void);
 	int gammas_pz(bool exch_a_f);
 	int model_pz(void);
@@ -564,6 +603,9 @@ public:
 	//LDBLE JAY(LDBLE X);
 	//LDBLE JPRIME(LDBLE Y);
 	int jacobian_pz(void);
+	int pitzer_derivatives(void);
+	int pitzer_tangent(void);
+	void jacobian_difference(const std::vector<LDBLE> &numerical);
 
 	// pitzer_structures.cpp -------------------------------
 	struct pitz_param *pitz_param_alloc(void);
@@ -587,6 +629,9 @@ public:
 	int build_ss_assemblage(void);
 	int build_solution_phase_boundaries(void);
 	int build_species_list(int n);
+	int build_rxn_x_rows(void);
+	int build_sum_rows(void);
+	int gather_s_x_state(void);
 	int build_min_surface(void);
 	LDBLE calc_lk_phase(phase * p_ptr, LDBLE TK, LDBLE pa);
 	LDBLE calc_delta_v(reaction * r_ptr, bool phase);
@@ -639,6 +684,12 @@ public:
 	int check_same_model(void);
 	int k_temp(LDBLE tc, LDBLE pa);
 	LDBLE k_calc(LDBLE * logk, LDBLE tempk, LDBLE presPa);
+	LDBLE k_calc_t(LDBLE * logk, LDBLE tempk);
+	LDBLE k_calc_t_curvature(LDBLE * logk, LDBLE tempk);
+	LDBLE k_calc_p(LDBLE lk_t, LDBLE * logk, LDBLE tempk, LDBLE presPa);
+	void logk_t_fill(LDBLE tempk, LDBLE * lk);
+	void logk_t_model(void);
+	const LDBLE *logk_t_lookup(LDBLE tempk);
 	int prep(void);
 	int reprep(void);
 	int rewrite_master_to_secondary(struct master *master_ptr1,
@@ -648,6 +699,7 @@ public:
 
 	// print.cpp -------------------------------
 	char *sformatf(const char *format, ...);
+	const char *punch_name(const char *prefix, const std::string &name, const char *suffix = "");
 	int array_print(LDBLE * array_l, int row_count, int column_count,
 		int max_column_count);
 	int set_pr_in_false(void);
@@ -786,6 +838,7 @@ public:
 	int dump_entities(void);
 	int delete_entities(void);
 	int run_as_cells(void);
+	int run_as_cell(int i, LDBLE initial_total_time_save);
 	void dump_ostream(std::ostream& os);
 
 	// readtr.cpp -------------------------------
@@ -821,8 +874,16 @@ public:
 	int sit_revise_guesses(void);
 	int PTEMP_SIT(LDBLE tk);
 	void sit_make_lists(void);
+	void sit_kernels(void);
+	int sit_derivatives(void);
+	int sit_tangent(void);
 	int jacobian_sit(void);
 
+	// sparse_lu.cpp -------------------------------
+	int sparse_lu_solve(int n, LDBLE * a, int lda, const int *rows, LDBLE * l_x);
+	int sparse_lu_analyze(int n, LDBLE * a, int lda);
+	int sparse_lu_factor(int n, LDBLE * a, int lda);
+
 	// spread.cpp -------------------------------
 	int read_solution_spread(void);
 	int copy_token_tab(char *token_ptr, char **ptr, int *length);
@@ -927,6 +988,9 @@ public:
 	int s_delete(int i);
 	struct species *s_search(const char *name);
 	struct species *s_store(const char *name, LDBLE z, int replace_if_found);
+	struct species *s_local(struct species *s_ptr);
+	int shared_reaction_count(void)const;
+	void unshare_definitions(void);
 protected:
 	struct save_values *save_values_bsearch(struct save_values *k, int *n);
 	static int save_values_compare(const void *ptr1, const void *ptr2);
@@ -1053,6 +1117,19 @@ public:
 	int solve_misc(LDBLE * xxc1, LDBLE * xxc2, LDBLE tol);
 	int ss_calc_a0_a1(cxxSS *ss_ptr);
 
+	// workers.cpp -------------------------------
+	int run_cells_workers(int task, const std::vector<int> &cells, const std::vector<LDBLE> &kin_times,
+		LDBLE step_fraction, bool punch);
+	void workers_create(int n);
+	void workers_free(void);
+	void worker_copy_cell(Phreeqc *worker_ptr, int i, int task);
+	void worker_sync(Phreeqc *worker_ptr);
+	Phreeqc *worker_clone(void);
+	bool numerical_jacobian_workers(const LDBLE *base);
+	bool jacobian_worker_sync(Phreeqc *worker_ptr);
+	void jacobian_worker_load(Phreeqc *worker_ptr, const std::vector<int> &phase_list);
+	bool cvode_jacobian_workers(N_Vector y, const LDBLE *initial_rates, DenseMat J);
+
 	// transport.cpp -------------------------------
 	int transport(void);
 	void print_punch(int i, boolean active);
@@ -1077,6 +1154,7 @@ public:
 		int n_user_new,
 		bool move_old);
 	void transport_cleanup(void);
+	int transport_workers(int task, LDBLE kin_time, LDBLE step_fraction, bool punch);
 	int init_mix(void);
 	int init_heat_mix(int nmix);
 	int heat_mix(int heat_nmix);
@@ -1153,7 +1231,7 @@ protected:
 	extern int clean_up_null(void);
 #endif
 	int isamong(char c, const char *s_l);
-	Address Hash_multi(HashTable * Table, const char *Key);
+	Address Hash_multi(const char *Key);
 	void ExpandTable_multi(HashTable * Table);
 public:
 	int main_method(int argc, char *argv[]);
@@ -1196,6 +1274,11 @@ protected:
 	LDBLE current_pa;
 	LDBLE current_mu;
 	bool mu_terms_in_logk;
+	/* temperature part of log k by model and interval of KNOBS -logk_grid */
+	std::map<std::vector<LDBLE>, int> logk_models;
+	int logk_model;
+	std::map<std::pair<int, LDBLE>, std::vector<LDBLE> > logk_table;
+	std::vector<LDBLE> logk_table_work;
 
 	/* ----------------------------------------------------------------------
 	*   STRUCTURES
@@ -1353,6 +1436,22 @@ protected:
 	int max_sum_delta;		/* calculated maximum number of elements in sum_delta */
 	struct list2 *sum_delta;	/* array of pointers to sources, targets and coefficients for
 								summing deltas for mass balance equations */
+	/* sum_mb1/2 and sum_jacob0/1/2 compiled into rows by target when a model
+	   is reused; the terms of row k are [*_row_start[k], *_row_start[k + 1]) */
+	bool sum_rows_built;
+	std::vector<LDBLE *> mb_row_target;
+	std::vector<int> mb_row_start;
+	std::vector<const LDBLE *> mb_term_source;
+	std::vector<LDBLE> mb_term_coef;
+	std::vector<int> jacob_row_target;	/* offset in my_array */
+	std::vector<int> jacob_row_start;
+	std::vector<const LDBLE *> jacob_term_source;
+	std::vector<LDBLE> jacob_term_coef;
+	/* moles, dg and la of the species of the model by position in s_x;
+	   terms of the compiled rows read them instead of the species
+	   structures, they are gathered once per call of mb_sums and
+	   jacobian_sums */
+	std::vector<LDBLE> s_x_moles, s_x_dg, s_x_la;
 	/*----------------------------------------------------------------------
 	*   Solution
 	*---------------------------------------------------------------------- */
@@ -1480,6 +1579,19 @@ protected:
 	*---------------------------------------------------------------------- */
 	bool run_cells_one_step;
 	/*----------------------------------------------------------------------
+	*   Cell workers
+	*---------------------------------------------------------------------- */
+	int count_workers;                /* number of clones used to run cells */
+	std::vector<Phreeqc *> workers;
+	int count_jacobian_workers;       /* number of clones used for columns of numerical_jacobian and Jac */
+	std::vector<Phreeqc *> jacobian_workers;
+	int count_prep;                   /* calls of prep */
+	int jacobian_prep;                /* count_prep of the model copied to a jacobian worker */
+	/*----------------------------------------------------------------------
+	*   Timers of the calculation phases
+	*---------------------------------------------------------------------- */
+	Profiler profiler;
+	/*----------------------------------------------------------------------
 	*   Species
 	*---------------------------------------------------------------------- */
 
@@ -1498,6 +1610,11 @@ protected:
 	struct species **s_x;
 	int count_s_x;
 	int max_s_x;
+	/* mass-action equations of s_x in rows by position in s_x; columns are
+	   positions in rxn_x_master, whose la are gathered into rxn_x_la */
+	std::vector<int> rxn_x_start, rxn_x_col;
+	std::vector<LDBLE> rxn_x_coef, rxn_x_la;
+	std::vector<struct species *> rxn_x_master;
 
 	struct species *s_h2o;
 	struct species *s_hplus;
@@ -1674,6 +1791,10 @@ protected:
 	LDBLE pp_scale;
 	LDBLE pp_column_scale;
 	int diagonal_scale;	/* 0 not used, 1 used */
+	int sparse_solver;	/* solve iterations with a square system of equalities, no inequalities or optimization rows, by pivot-reusing LU */
+	int analytic_jacobian;	/* activity coefficient derivatives of Pitzer and SIT from *_derivatives */
+	LDBLE logk_grid_dt;	/* temperature step for interpolating log k, 0 evaluates log k exactly */
+	LDBLE logk_grid_tol;	/* maximal interpolation error of log k */
 	int mass_water_switch;
 	int delay_mass_water;
 	int equi_delay;
@@ -1714,6 +1835,9 @@ protected:
 #ifdef HASH
 	std::hash_map<std::string, std::string *> strings_hash;
 #endif
+	const Phreeqc *database_snapshot; /* read-only instance whose strings are shared, not owned */
+	const Phreeqc *shared_definitions; /* instance whose species and phase reactions are shared, not owned */
+	int shared_bind_generation;	/* basic_bind_generation of shared_definitions when they were shared */
 	HashTable *elements_hash_table;
 	HashTable *species_hash_table;
 	HashTable *phases_hash_table;
@@ -1782,6 +1906,7 @@ protected:
 
 	/* Basic */
 	PBasic * basic_interpreter;
+	int basic_bind_generation;	/* changed when species, phases or master species change */
 	double (*basic_callback_ptr) (double x1, double x2, const char *str, void *cookie);
 	void *basic_callback_cookie;
 #ifdef IPHREEQC_NO_FORTRAN_MODULE
@@ -1834,13 +1959,13 @@ protected:
 	LDBLE toler, error, max_pct, scaled_error;
 	struct master *master_alk;
 	int *row_back, *col_back;
-	unsigned long *good, *bad, *minimal;
-	int max_good, max_bad, max_minimal;
+	InverseBitsIndex good, bad, minimal;
 	int count_good, count_bad, count_minimal, count_calls;
-	unsigned long soln_bits, phase_bits, current_bits, temp_bits;
+	unsigned long soln_bits, temp_bits;
+	InverseBits phase_bits, current_bits;
 	FILE *netpath_file;
 	int count_inverse_models, count_pat_solutions;
-	int min_position[32], max_position[32], now[32];
+	std::vector<int> min_position, max_position, now;
 	std::vector <std::string> inverse_heading_names;
 
 	/* kinetics.cpp ------------------------------- */
@@ -1863,12 +1988,31 @@ public:
 	void *kinetics_cvode_mem;
 	cxxSSassemblage *cvode_ss_assemblage_save;
 	cxxPPassemblage *cvode_pp_assemblage_save;
+	/* CVODE integrations, steps, rate and jacobian evaluations since the last run */
+	int cvode_integrations, cvode_steps_taken, cvode_rhs_evaluations, cvode_jacobian_evaluations;
 protected:
 	LDBLE *m_original;
 	LDBLE *m_temp;
 	LDBLE *rk_moles;
+	/* KINETICS -rk_reuse_tol: stages may use the species of the last calculation */
+	bool rk_reuse, rk_solved, rk_stage_reused;
+	int rk_stages_reused;
+	std::vector<LDBLE> rk_solved_moles, rk_stage_delta;
+	std::vector<LDBLE> rk_rate_jacobian;	/* d(rate)/d(moles), n x n */
+	bool rk_rate_jacobian_updated;
 	int set_and_run_attempt;
 	LDBLE *x0_moles;
+	/* initial guesses saved for each cell, KNOBS -warm_start */
+	int warm_start;
+	std::map<int, struct cell_guess> cell_guess_map;
+	struct cell_guess *cell_guess_ptr;
+	int cell_guess_n;		/* cell of the calculations in -2 */
+	int cell_calculations, cell_warm_starts, cell_iterations;
+	/* statistics by cell, or of each calculation with SOLVER_STATS_EACH, KNOBS -solver_stats */
+	int solver_stats_on;
+	struct solver_stats solver_stats_x;
+	std::vector<struct solver_stats> solver_stats_list;
+	std::map<std::pair<int, int>, size_t> solver_stats_index;	/* (simulation, cell) to solver_stats_list */
 
 	/* model.cpp ------------------------------- */
 	int gas_in;
@@ -1901,6 +2045,7 @@ protected:
 	struct theta_param **theta_params;
 	int count_theta_param, max_theta_param;
 	int use_etheta;
+	int etheta_calls, etheta_hits;	/* E-theta values needed by pitzer() and reused of them */
 	LDBLE OTEMP, OPRESS;
 	LDBLE A0;
 	struct pitz_param *aphi;
@@ -1911,6 +2056,15 @@ protected:
 	int *IPRSNT;
 	LDBLE *M, *LGAMMA;
 	LDBLE BK[23], DK[23];
+	/* param_list sorted by the form of the terms, see pitzer_kernels;
+	   kernel k has entries pzk_start[k] to pzk_start[k + 1] - 1 */
+	std::vector<int> pzk_start, pzk_i0, pzk_i1, pzk_i2;
+	std::vector<LDBLE> pzk_lg0, pzk_lg1, pzk_lg2, pzk_os, pzk_alpha;
+	std::vector<struct theta_param *> pzk_theta;
+	/* base point of the analytic jacobian, see pitzer_derivatives and
+	   sit_derivatives */
+	std::vector<LDBLE> pz_M0, pz_LG0, pz_dM, pz_dLG, pz_coef;
+	LDBLE pz_AW0, pz_BIGZ0;
 
 #ifdef PHREEQ98
 	int connect_simulations, graph_initial_solutions;
@@ -1944,6 +2098,7 @@ protected:
 	runner run_info;
 	char * sformatf_buffer;
 	size_t sformatf_buffer_size;
+	std::string punch_name_buffer;
 
 	/* readtr.cpp */
 	std::string dump_file_name_cpp;
@@ -1958,6 +2113,19 @@ protected:
 	int *sit_IPRSNT;
 	LDBLE *sit_M, *sit_LGAMMA;
 	std::vector<int> s_list, cation_list, neutral_list, anion_list, ion_list, param_list;
+	/* param_list by type, see sit_kernels */
+	std::vector<int> sitk_start, sitk_i0, sitk_i1;
+	std::vector<LDBLE> sitk_lg, sitk_os;
+
+	/* sparse_lu.cpp ------------------------------- */
+	/* pivot order and L/U structure of the last factored ineq system;
+	   slu_key holds the back_eq rows it was built for, slu_pattern and
+	   slu_work are dense n x n */
+	int slu_n;
+	std::vector<int> slu_key, slu_perm;
+	std::vector<char> slu_pattern;
+	std::vector<int> slu_l_start, slu_l_row, slu_u_start, slu_u_col;
+	std::vector<LDBLE> slu_work;
 
 	/* tidy.cpp ------------------------------- */
 	LDBLE a0, a1, kc, kb;
@@ -1986,6 +2154,13 @@ protected:
 	LDBLE heat_mix_f_imm, heat_mix_f_m;
 	int warn_MCD_X, warn_fixed_Surf;
 	LDBLE current_x, current_A, fix_current; // current: coulomb / s, Ampere, fixed current (Ampere)
+	LDBLE tk_x2; // average tx_x of icell and jcell
+	LDBLE dV_dcell; // difference in Volt among icell and jcell
+	int find_current;
+	struct CURRENT_CELLS *current_cells;
+	LDBLE sum_R, sum_Rd; // sum of R, sum of (current_cells[0].dif - current_cells[i].dif) * R
+	struct CT *ct;
+	struct MOLES_ADDED *moles_added;
 
 #ifdef PHREEQ98
 	int AutoLoadOutputFile, CreateToC;
@@ -2011,6 +2186,8 @@ protected:
 	friend class IPhreeqcMMS;
 	friend class IPhreeqcPhast;
 	friend class PhreeqcRM;
+	friend class WorkerIO;
+	friend class DBImageReader;
 
 	std::vector<int> keycount;  // used to mark keywords that have been read 
 
@@ -0,0 +1,156 @@
+#include <cstring>				// strcmp
+#include <string>				// std::string
+#include "Profiler.h"
+#if (__GNUC__ && (__cplusplus >= 201103L)) || (_MSC_VER >= 1700)
+#include <chrono>
+#define PROFILER_CHRONO
+#elif defined(_WIN32)
+#include <windows.h>			// QueryPerformanceCounter
+#else
+#include <sys/time.h>			// gettimeofday
+#endif
+
+Profiler::Profiler(void)
+{
+	this->on = false;
+	this->Clear();
+}
+
+Profiler::~Profiler(void)
+{
+}
+
+void
+Profiler::Clear(void)
+{
+	this->nodes.clear();
+	node root;
+	root.name = "total";
+	root.parent = -1;
+	root.calls = 0;
+	root.time = 0.0;
+	root.start = 0.0;
+	this->nodes.push_back(root);
+	this->current = 0;
+}
+
+int
+Profiler::Find_child(int parent, const char *name)
+{
+	std::vector<int> &children = this->nodes[parent].children;
+	for (size_t i = 0; i < children.size(); i++)
+	{
+		const char *child_name = this->nodes[children[i]].name;
+		if (child_name == name || strcmp(child_name, name) == 0)
+			return children[i];
+	}
+	node child;
+	child.name = name;
+	child.parent = parent;
+	child.calls = 0;
+	child.time = 0.0;
+	child.start = 0.0;
+	this->nodes.push_back(child);
+	int n = (int) this->nodes.size() - 1;
+	this->nodes[parent].children.push_back(n);
+	return n;
+}
+
+void
+Profiler::Begin(const char *name)
+{
+	this->current = this->Find_child(this->current, name);
+	this->nodes[this->current].calls++;
+	this->nodes[this->current].start = Clock();
+}
+
+void
+Profiler::End(void)
+{
+	// Clear while a phase was open
+	if (this->current == 0)
+		return;
+	node &n = this->nodes[this->current];
+	n.time += Clock() - n.start;
+	this->current = n.parent;
+}
+
+void
+Profiler::Merge(const Profiler &other)
+{
+	// adds the phases of other (a worker instance) below the current phase
+	this->Merge_node(other, 0, this->current);
+}
+
+void
+Profiler::Merge_node(const Profiler &other, int other_n, int n)
+{
+	const std::vector<int> &children = other.nodes[other_n].children;
+	for (size_t i = 0; i < children.size(); i++)
+	{
+		const node &other_child = other.nodes[children[i]];
+		int child = this->Find_child(n, other_child.name);
+		this->nodes[child].calls += other_child.calls;
+		this->nodes[child].time += other_child.time;
+		this->Merge_node(other, children[i], child);
+	}
+}
+
+void
+Profiler::Dump_json(std::ostream &os)const
+{
+	std::streamsize precision = os.precision(6);
+	this->Dump_node(os, 0, 0);
+	os << "\n";
+	os.precision(precision);
+}
+
+void
+Profiler::Dump_node(std::ostream &os, int n, int indent)const
+{
+	const node &nd = this->nodes[n];
+	double time = nd.time;
+	double children_time = 0.0;
+	for (size_t i = 0; i < nd.children.size(); i++)
+	{
+		children_time += this->nodes[nd.children[i]].time;
+	}
+	if (n == 0)
+		time = children_time;
+	// phases of workers are summed over threads and may exceed the phase
+	// that contains them
+	double self = (time > children_time) ? time - children_time : 0.0;
+	std::string pad(indent, ' ');
+	os << pad << "{\"name\": \"" << nd.name << "\", \"calls\": " << nd.calls
+		<< ", \"time\": " << time << ", \"self\": " << self;
+	if (nd.children.size() == 0)
+	{
+		os << ", \"children\": []}";
+		return;
+	}
+	os << ", \"children\": [\n";
+	for (size_t i = 0; i < nd.children.size(); i++)
+	{
+		this->Dump_node(os, nd.children[i], indent + 2);
+		os << ((i + 1 < nd.children.size()) ? ",\n" : "\n");
+	}
+	os << pad << "]}";
+}
+
+double
+Profiler::Clock(void)
+{
+	// wall-clock seconds; clock() would count CPU time of all threads
+#if defined(PROFILER_CHRONO)
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#elif defined(_WIN32)
+	LARGE_INTEGER count, frequency;
+	QueryPerformanceCounter(&count);
+	QueryPerformanceFrequency(&frequency);
+	return (double) count.QuadPart / (double) frequency.QuadPart;
+#else
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return (double) tv.tv_sec + 1e-6 * (double) tv.tv_usec;
+#endif
+}
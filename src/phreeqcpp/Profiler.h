@@ -0,0 +1,64 @@
+#if !defined(PROFILER_H_INCLUDED)
+#define PROFILER_H_INCLUDED
+#include <ostream>              // std::ostream
+#include <vector>               // std::vector
+
+/*
+ *   Wall-clock timers of the calculation phases, nested in the order
+ *   the phases are entered; a phase entered from two parents is timed
+ *   separately under each. Names must be string literals.
+ */
+class Profiler
+{
+public:
+	Profiler(void);
+	~Profiler(void);
+	void Set_on(bool tf) { this->on = tf; };
+	bool Get_on(void)const { return(this->on); };
+	void Clear(void);
+	void Begin(const char *name);
+	void End(void);
+	void Merge(const Profiler &other);
+	void Dump_json(std::ostream &os)const;
+	static double Clock(void);
+
+protected:
+	struct node
+	{
+		const char *name;
+		int parent;
+		std::vector<int> children;
+		long calls;
+		double time;
+		double start;
+	};
+	int Find_child(int parent, const char *name);
+	void Merge_node(const Profiler &other, int other_n, int n);
+	void Dump_node(std::ostream &os, int n, int indent)const;
+
+protected:
+	std::vector<node> nodes;	/* nodes[0] is the root */
+	int current;
+	bool on;
+};
+
+/*
+ *   Times the enclosing block as a child of the current phase
+ */
+class ProfilerScope
+{
+public:
+	ProfilerScope(Profiler &p, const char *name) : profiler(p), started(p.Get_on())
+	{
+		if (this->started) this->profiler.Begin(name);
+	};
+	~ProfilerScope(void)
+	{
+		if (this->started) this->profiler.End();
+	};
+
+protected:
+	Profiler &profiler;
+	bool started;
+};
+#endif // !defined(PROFILER_H_INCLUDED)
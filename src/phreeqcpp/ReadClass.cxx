@@ -459,6 +459,7 @@ int Phreeqc::
 run_as_cells(void)
 /* ---------------------------------------------------------------------- */
 {
+	ProfilerScope profiler_scope(profiler, "run_as_cells");
 	struct save save_data;
 	LDBLE kin_time;
 	int count_steps, use_mix;
@@ -669,11 +670,7 @@ int Phreeqc::
 run_as_cells(void)
 /* ---------------------------------------------------------------------- */
 {
-	struct save save_data;
-	LDBLE kin_time;
-	int count_steps, use_mix;
-	char token[2 * MAX_LENGTH];
-
+	ProfilerScope profiler_scope(profiler, "run_as_cells");
 	state = REACTION;
 	if (run_info.Get_cells().Get_numbers().size() == 0 ||
 		!(run_info.Get_cells().Get_defined())) return(OK);
@@ -692,8 +689,8 @@ run_as_cells(void)
 		initial_total_time_save = initial_total_time;
 	}
 
+	std::vector<int> cells;
 	std::set < int >::iterator it = run_info.Get_cells().Get_numbers().begin();
-
 	for ( ; it != run_info.Get_cells().Get_numbers().end(); it++)
 	{
 		int i = *it;
@@ -701,141 +698,171 @@ run_as_cells(void)
 		if (Utilities::Rxn_find(Rxn_solution_map, i) == NULL
 			&& Utilities::Rxn_find(Rxn_mix_map, i) == NULL)
 			continue;
-		initial_total_time = initial_total_time_save;
-		set_advection(i, TRUE, TRUE, i);
+		cells.push_back(i);
+	}
+	// mixes may use the results of previous cells, run them in order
+	if (count_workers > 1 && cells.size() > 1 && Rxn_mix_map.size() == 0)
+	{
+		run_cells_workers(WORKER_RUN_CELLS, cells, std::vector<LDBLE>(), 1.0, false);
+	}
+	else
+	{
+		for (size_t j = 0; j < cells.size(); j++)
+		{
+			run_as_cell(cells[j], initial_total_time_save);
+		}
+	}
+	initial_total_time += rate_sim_time;
+	run_info.Get_cells().Set_defined(false);
+	// not running cells
+	run_info.Set_run_cells(false);
+	return (OK);
+}
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+run_as_cell(int i, LDBLE initial_total_time_save)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Runs the reaction steps of cell i, results are saved in cell i
+ */
+	struct save save_data;
+	LDBLE kin_time;
+	int count_steps, use_mix;
+	char token[2 * MAX_LENGTH];
+
+	initial_total_time = initial_total_time_save;
+	set_advection(i, TRUE, TRUE, i);
+	cell_guess_n = i;
 /*
  *   Run reaction step
  */
-		/*
-		*   Find maximum number of steps
-		*/
-		dup_print("Beginning of batch-reaction calculations.", TRUE);
-		count_steps = 1;
-		if (!this->run_cells_one_step)
+	/*
+	*   Find maximum number of steps
+	*/
+	dup_print("Beginning of batch-reaction calculations.", TRUE);
+	count_steps = 1;
+	if (!this->run_cells_one_step)
+	{
+		if (use.Get_reaction_in() == TRUE && use.Get_reaction_ptr() != NULL)
 		{
-			if (use.Get_reaction_in() == TRUE && use.Get_reaction_ptr() != NULL)
-			{
-				int count = use.Get_reaction_ptr()->Get_reaction_steps();
-				if (count > count_steps)
-					count_steps = count;
-			}
-			if (use.Get_kinetics_in() == TRUE && use.Get_kinetics_ptr() != NULL)
-			{
-				if (use.Get_kinetics_ptr()->Get_reaction_steps() > count_steps)
-					count_steps = use.Get_kinetics_ptr()->Get_reaction_steps();
-			}
-			if (use.Get_temperature_in() == TRUE && use.Get_temperature_ptr() != NULL)
+			int count = use.Get_reaction_ptr()->Get_reaction_steps();
+			if (count > count_steps)
+				count_steps = count;
+		}
+		if (use.Get_kinetics_in() == TRUE && use.Get_kinetics_ptr() != NULL)
+		{
+			if (use.Get_kinetics_ptr()->Get_reaction_steps() > count_steps)
+				count_steps = use.Get_kinetics_ptr()->Get_reaction_steps();
+		}
+		if (use.Get_temperature_in() == TRUE && use.Get_temperature_ptr() != NULL)
+		{
+			int count = use.Get_temperature_ptr()->Get_countTemps();
+			if (count > count_steps)
 			{
-				int count = use.Get_temperature_ptr()->Get_countTemps();
-				if (count > count_steps)
-				{
-					count_steps = count;
-				}
+				count_steps = count;
 			}
-			if (use.Get_pressure_in() == TRUE && use.Get_pressure_ptr() != NULL)
+		}
+		if (use.Get_pressure_in() == TRUE && use.Get_pressure_ptr() != NULL)
+		{
+			int count = use.Get_pressure_ptr()->Get_count();
+			if (count > count_steps)
 			{
-				int count = use.Get_pressure_ptr()->Get_count();
-				if (count > count_steps)
-				{
-					count_steps = count;
-				}
+				count_steps = count;
 			}
 		}
-		count_total_steps = count_steps;
+	}
+	count_total_steps = count_steps;
+	/*
+	*  save data for saving solutions
+	*/
+	memcpy(&save_data, &save, sizeof(struct save));
+	/* 
+	*Copy everything to -2
+	*/
+	copy_use(-2);
+	rate_sim_time_start = 0;
+	rate_sim_time = 0;
+	for (reaction_step = 1; reaction_step <= count_steps; reaction_step++)
+	{
+		sprintf(token, "Reaction step %d.", reaction_step);
+		if (reaction_step > 1 && incremental_reactions == FALSE)
+		{
+			copy_use(-2);
+		}
+		set_initial_moles(-2);
+		dup_print(token, FALSE);
 		/*
-		*  save data for saving solutions
-		*/
-		memcpy(&save_data, &save, sizeof(struct save));
-		/* 
-		*Copy everything to -2
+		*  Determine time step for kinetics
 		*/
-		copy_use(-2);
-		rate_sim_time_start = 0;
-		rate_sim_time = 0;
-		for (reaction_step = 1; reaction_step <= count_steps; reaction_step++)
+		kin_time = 0.0;
+		if (use.Get_kinetics_in() == TRUE)
 		{
-			sprintf(token, "Reaction step %d.", reaction_step);
-			if (reaction_step > 1 && incremental_reactions == FALSE)
-			{
-				copy_use(-2);
-			}
-			set_initial_moles(-2);
-			dup_print(token, FALSE);
-			/*
-			*  Determine time step for kinetics
-			*/
-			kin_time = 0.0;
-			if (use.Get_kinetics_in() == TRUE)
+			// runner kin_time
+			// equivalent to kin_time in count_steps
+			if (run_info.Get_time_step() != NA)
 			{
-				// runner kin_time
-				// equivalent to kin_time in count_steps
-				if (run_info.Get_time_step() != NA)
+				if (incremental_reactions == FALSE)
 				{
-					if (incremental_reactions == FALSE)
-					{
-						/* not incremental reactions */
-						kin_time = reaction_step * run_info.Get_time_step() / ((LDBLE) count_steps);
-					}
-					else
-					{
-						/* incremental reactions */
-						kin_time = run_info.Get_time_step() / ((LDBLE) count_steps);
-					}
+					/* not incremental reactions */
+					kin_time = reaction_step * run_info.Get_time_step() / ((LDBLE) count_steps);
 				}
-				// runner kin_time not defined
 				else
 				{
-					cxxKinetics *kinetics_ptr = Utilities::Rxn_find(Rxn_kinetics_map, -2);
-					kin_time = kinetics_ptr->Current_step((incremental_reactions==TRUE), reaction_step);
+					/* incremental reactions */
+					kin_time = run_info.Get_time_step() / ((LDBLE) count_steps);
 				}
 			}
-			if (incremental_reactions == FALSE ||
-				(incremental_reactions == TRUE && reaction_step == 1))
-			{
-				use_mix = TRUE;
-			}
-			else
-			{
-				use_mix = FALSE;
-			}
-			/*
-			*   Run reaction step
-			*/
-			run_reactions(-2, kin_time, use_mix, 1.0);
-			if (incremental_reactions == TRUE)
-			{
-				rate_sim_time_start += kin_time;
-				rate_sim_time = rate_sim_time_start;
-			}
+			// runner kin_time not defined
 			else
 			{
-				rate_sim_time = kin_time;
-			}
-			if (state != ADVECTION)
-			{
-				punch_all();
-				print_all();
-			}
-			/* saves back into -2 */
-			if (reaction_step < count_steps)
-			{
-				saver();
+				cxxKinetics *kinetics_ptr = Utilities::Rxn_find(Rxn_kinetics_map, -2);
+				kin_time = kinetics_ptr->Current_step((incremental_reactions==TRUE), reaction_step);
 			}
 		}
+		if (incremental_reactions == FALSE ||
+			(incremental_reactions == TRUE && reaction_step == 1))
+		{
+			use_mix = TRUE;
+		}
+		else
+		{
+			use_mix = FALSE;
+		}
 		/*
-		*   save end of reaction
+		*   Run reaction step
 		*/
-		memcpy(&save, &save_data, sizeof(struct save));
-		if (use.Get_kinetics_in() == TRUE)
+		run_reactions(-2, kin_time, use_mix, 1.0);
+		if (incremental_reactions == TRUE)
 		{
-			Utilities::Rxn_copy(Rxn_kinetics_map, -2, use.Get_n_kinetics_user());
+			rate_sim_time_start += kin_time;
+			rate_sim_time = rate_sim_time_start;
+		}
+		else
+		{
+			rate_sim_time = kin_time;
+		}
+		if (state != ADVECTION)
+		{
+			punch_all();
+			print_all();
+		}
+		/* saves back into -2 */
+		if (reaction_step < count_steps)
+		{
+			saver();
 		}
-		saver();
 	}
-	initial_total_time += rate_sim_time;
-	run_info.Get_cells().Set_defined(false);
-	// not running cells
-	run_info.Set_run_cells(false);
+	/*
+	*   save end of reaction
+	*/
+	memcpy(&save, &save_data, sizeof(struct save));
+	if (use.Get_kinetics_in() == TRUE)
+	{
+		Utilities::Rxn_copy(Rxn_kinetics_map, -2, use.Get_n_kinetics_user());
+	}
+	saver();
+	cell_guess_n = -2;
 	return (OK);
 }
 #endif
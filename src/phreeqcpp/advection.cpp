@@ -10,6 +10,7 @@ int Phreeqc::
 advection(void)
 /* ---------------------------------------------------------------------- */
 {
+	ProfilerScope profiler_scope(profiler, "advection");
 	int i;
 	LDBLE kin_time;
 /*
@@ -16,10 +16,16 @@ LDBLE Phreeqc::
 activity(const char *species_name)
 /* ---------------------------------------------------------------------- */
 {
-	struct species *s_ptr;
+	return (activity(s_search(species_name)));
+}
+
+/* ---------------------------------------------------------------------- */
+LDBLE Phreeqc::
+activity(struct species *s_ptr)
+/* ---------------------------------------------------------------------- */
+{
 	LDBLE a;
 
-	s_ptr = s_search(species_name);
 	if (s_ptr == s_h2o)
 	{
 		a = pow((LDBLE) 10., s_h2o->la);
@@ -44,10 +50,16 @@ LDBLE Phreeqc::
 activity_coefficient(const char *species_name)
 /* ---------------------------------------------------------------------- */
 {
-	struct species *s_ptr;
+	return (activity_coefficient(s_search(species_name)));
+}
+
+/* ---------------------------------------------------------------------- */
+LDBLE Phreeqc::
+activity_coefficient(struct species *s_ptr)
+/* ---------------------------------------------------------------------- */
+{
 	LDBLE g, dum = 0.0;
 
-	s_ptr = s_search(species_name);
 	if (s_ptr != NULL && s_ptr->in != FALSE && ((s_ptr->type < EMINUS) || (s_ptr->type == EX) || (s_ptr->type == SURF)))
 	{
 		if (s_ptr->type == EX && s_ptr->equiv && s_ptr->alk)
@@ -66,10 +78,16 @@ LDBLE Phreeqc::
 log_activity_coefficient(const char *species_name)
 /* ---------------------------------------------------------------------- */
 {
-	struct species *s_ptr;
+	return (log_activity_coefficient(s_search(species_name)));
+}
+
+/* ---------------------------------------------------------------------- */
+LDBLE Phreeqc::
+log_activity_coefficient(struct species *s_ptr)
+/* ---------------------------------------------------------------------- */
+{
 	LDBLE g, dum = 0.0;
 
-	s_ptr = s_search(species_name);
 	if (s_ptr != NULL && s_ptr->in != FALSE && ((s_ptr->type < EMINUS) || (s_ptr->type == EX) || (s_ptr->type == SURF)))
 	{
 		if (s_ptr->type == EX && s_ptr->equiv && s_ptr->alk)
@@ -650,16 +668,18 @@ calc_logk_p(const char *name)
 		/*
 		*   Print saturation index
 		*/
-		reaction_ptr->logk[delta_v] = calc_delta_v(reaction_ptr, true) -
+		LDBLE r_logk[MAX_LOG_K_INDICES];
+		memcpy(r_logk, reaction_ptr->logk, sizeof(r_logk));
+		r_logk[delta_v] = calc_delta_v(reaction_ptr, true) -
 			phase_ptr->logk[vm0];
-		if (reaction_ptr->logk[delta_v])
+		if (r_logk[delta_v])
 			mu_terms_in_logk = true;
 		for (i = 0; i < MAX_LOG_K_INDICES; i++)
 		{
 			l_logk[i] = 0.0;
 		}
 		//lk = k_calc(reaction_ptr->logk, tk_x, patm_x * PASCAL_PER_ATM);
-		select_log_k_expression(reaction_ptr->logk, l_logk);
+		select_log_k_expression(r_logk, l_logk);
 		add_other_logk(l_logk, phase_ptr->count_add_logk, phase_ptr->add_logk); 
 		lk = k_calc(l_logk, tk_x, patm_x * PASCAL_PER_ATM);
 	}
@@ -1516,10 +1536,15 @@ LDBLE Phreeqc::
 log_activity(const char *species_name)
 /* ---------------------------------------------------------------------- */
 {
-	struct species *s_ptr;
-	LDBLE la;
+	return (log_activity(s_search(species_name)));
+}
 
-	s_ptr = s_search(species_name);
+/* ---------------------------------------------------------------------- */
+LDBLE Phreeqc::
+log_activity(struct species *s_ptr)
+/* ---------------------------------------------------------------------- */
+{
+	LDBLE la;
 
 	if (s_ptr == s_eminus)
 	{
@@ -1545,10 +1570,15 @@ LDBLE Phreeqc::
 log_molality(const char *species_name)
 /* ---------------------------------------------------------------------- */
 {
-	struct species *s_ptr;
-	LDBLE lm;
+	return (log_molality(s_search(species_name)));
+}
 
-	s_ptr = s_search(species_name);
+/* ---------------------------------------------------------------------- */
+LDBLE Phreeqc::
+log_molality(struct species *s_ptr)
+/* ---------------------------------------------------------------------- */
+{
+	LDBLE lm;
 
 	if (s_ptr == s_eminus)
 	{
@@ -1574,10 +1604,16 @@ LDBLE Phreeqc::
 molality(const char *species_name)
 /* ---------------------------------------------------------------------- */
 {
-	struct species *s_ptr;
+	return (molality(s_search(species_name)));
+}
+
+/* ---------------------------------------------------------------------- */
+LDBLE Phreeqc::
+molality(struct species *s_ptr)
+/* ---------------------------------------------------------------------- */
+{
 	LDBLE m;
 
-	s_ptr = s_search(species_name);
 	if (s_ptr == NULL || s_ptr == s_eminus || s_ptr->in == FALSE)
 	{
 		m = 1e-99;
@@ -1644,12 +1680,9 @@ LDBLE Phreeqc::
 saturation_ratio(const char *phase_name)
 /* ---------------------------------------------------------------------- */
 {
-	struct rxn_token *rxn_ptr;
 	struct phase *phase_ptr;
 	int l;
-	LDBLE si, iap;
 
-	iap = 0.0;
 	phase_ptr = phase_bsearch(phase_name, &l, FALSE);
 	if (phase_ptr == NULL)
 	{
@@ -1657,7 +1690,19 @@ saturation_ratio(const char *phase_name)
 		warning_msg(error_string);
 		return (1e-99);
 	}
-	else if (phase_ptr->in != FALSE)
+	return (saturation_ratio(phase_ptr));
+}
+
+/* ---------------------------------------------------------------------- */
+LDBLE Phreeqc::
+saturation_ratio(struct phase *phase_ptr)
+/* ---------------------------------------------------------------------- */
+{
+	struct rxn_token *rxn_ptr;
+	LDBLE si, iap;
+
+	iap = 0.0;
+	if (phase_ptr->in != FALSE)
 	{
 		for (rxn_ptr = phase_ptr->rxn_x->token + 1; rxn_ptr->s != NULL;
 			 rxn_ptr++)
@@ -1676,20 +1721,31 @@ int Phreeqc::
 saturation_index(const char *phase_name, LDBLE * iap, LDBLE * si)
 /* ---------------------------------------------------------------------- */
 {
-	struct rxn_token *rxn_ptr;
 	struct phase *phase_ptr;
 	int l;
 
-	*si = -99.99;
-	*iap = 0.0;
 	phase_ptr = phase_bsearch(phase_name, &l, FALSE);
 	if (phase_ptr == NULL)
 	{
 		error_string = sformatf( "Mineral %s, not found.", phase_name);
 		warning_msg(error_string);
 		*si = -99;
+		*iap = 0.0;
+		return (OK);
 	}
-	else if (phase_ptr->in != FALSE)
+	return (saturation_index(phase_ptr, iap, si));
+}
+
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+saturation_index(struct phase *phase_ptr, LDBLE * iap, LDBLE * si)
+/* ---------------------------------------------------------------------- */
+{
+	struct rxn_token *rxn_ptr;
+
+	*si = -99.99;
+	*iap = 0.0;
+	if (phase_ptr->in != FALSE)
 	{
 		for (rxn_ptr = phase_ptr->rxn_x->token + 1; rxn_ptr->s != NULL;
 			 rxn_ptr++)
@@ -2449,17 +2505,18 @@ surf_total(const char *total_name, const char *surface_name)
 		{
 			for (rxn_ptr = s_x[j]->rxn_s->token + 1; rxn_ptr->s != NULL; rxn_ptr++)
 			{
-				if (redox && rxn_ptr->s->secondary)
+				struct species *s_ptr = s_local(rxn_ptr->s);
+				if (redox && s_ptr->secondary)
 				{
-					token = rxn_ptr->s->secondary->elt->name;
+					token = s_ptr->secondary->elt->name;
 				}
-				else if (!redox && rxn_ptr->s->secondary)
+				else if (!redox && s_ptr->secondary)
 				{
-					token = rxn_ptr->s->secondary->elt->primary->elt->name;
+					token = s_ptr->secondary->elt->primary->elt->name;
 				}
-				else if (!redox && rxn_ptr->s->primary)
+				else if (!redox && s_ptr->primary)
 				{
-					token = rxn_ptr->s->primary->elt->name;
+					token = s_ptr->primary->elt->name;
 				}
 				else
 				{
@@ -2473,7 +2530,7 @@ surf_total(const char *total_name, const char *surface_name)
 				else
 					// sum all sites in case total_name is a surface name without underscore surf ("Hfo_w", "Hfo")
 				{
-					if (rxn_ptr->s->type == SURF)
+					if (s_ptr->type == SURF)
 					{
 						if (token.find("_") != std::string::npos)
 						{
@@ -2581,17 +2638,18 @@ surf_total(const char *total_name, const char *surface_name)
 		struct rxn_token *rxn_ptr;
 		for (rxn_ptr = s_x[j]->rxn_s->token + 1; rxn_ptr->s != NULL; rxn_ptr++)
 		{
-			if (redox && rxn_ptr->s->secondary)
+			struct species *s_ptr = s_local(rxn_ptr->s);
+			if (redox && s_ptr->secondary)
 			{
-				token = rxn_ptr->s->secondary->elt->name;
+				token = s_ptr->secondary->elt->name;
 			}
-			else if (!redox && rxn_ptr->s->secondary)
+			else if (!redox && s_ptr->secondary)
 			{
-				token = rxn_ptr->s->secondary->elt->primary->elt->name;
+				token = s_ptr->secondary->elt->primary->elt->name;
 			}
-			else if (!redox && rxn_ptr->s->primary)
+			else if (!redox && s_ptr->primary)
 			{
-				token = rxn_ptr->s->primary->elt->name;
+				token = s_ptr->primary->elt->name;
 			}
 			else
 			{
@@ -2605,7 +2663,7 @@ surf_total(const char *total_name, const char *surface_name)
 			else
 			// sum all sites in case total_name is a surface name without underscore surf ("Hfo_w", "Hfo")
 			{
-				if (rxn_ptr->s->type == SURF)
+				if (s_ptr->type == SURF)
 				{
 					if (token.find("_") != std::string::npos)
 					{
@@ -2715,8 +2773,6 @@ total(const char *total_name)
 /* ---------------------------------------------------------------------- */
 {
 	struct master *master_ptr;
-	LDBLE t;
-	int i;
 
 	if (strcmp(total_name, "H") == 0)
 	{
@@ -2727,7 +2783,6 @@ total(const char *total_name)
 		return (total_o_x / mass_water_aq_x);
 	}
 	master_ptr = master_bsearch(total_name);
-	t = 0.0;
 	if (master_ptr == NULL)
 	{
 		if (strcmp_nocase(total_name, "water") == 0)
@@ -2743,11 +2798,23 @@ total(const char *total_name)
 	         total_name);
         warning_msg (error_string);
 */
+		return (0.0);
 	}
+	return (total(master_ptr));
+}
+
+/* ---------------------------------------------------------------------- */
+LDBLE Phreeqc::
+total(struct master *master_ptr)
+/* ---------------------------------------------------------------------- */
+{
+	LDBLE t;
+	int i;
+
 /*
  *  Primary master species
  */
-	else if (master_ptr->primary == TRUE)
+	if (master_ptr->primary == TRUE)
 	{
 		/*
 		 *  Not a redox element
@@ -2785,8 +2852,6 @@ total_mole(const char *total_name)
 /* ---------------------------------------------------------------------- */
 {
 	struct master *master_ptr;
-	LDBLE t;
-	int i;
 
 	if (strcmp(total_name, "H") == 0)
 	{
@@ -2797,7 +2862,6 @@ total_mole(const char *total_name)
 		return (total_o_x);
 	}
 	master_ptr = master_bsearch(total_name);
-	t = 0.0;
 	if (master_ptr == NULL)
 	{
 		if (strcmp_nocase(total_name, "water") == 0)
@@ -2813,11 +2877,23 @@ total_mole(const char *total_name)
 	         total_name);
         warning_msg (error_string);
 */
+		return (0.0);
 	}
+	return (total_mole(master_ptr));
+}
+
+/* ---------------------------------------------------------------------- */
+LDBLE Phreeqc::
+total_mole(struct master *master_ptr)
+/* ---------------------------------------------------------------------- */
+{
+	LDBLE t;
+	int i;
+
 /*
  *  Primary master species
  */
-	else if (master_ptr->primary == TRUE)
+	if (master_ptr->primary == TRUE)
 	{
 		/*
 		 *  Not a redox element
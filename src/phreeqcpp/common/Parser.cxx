@@ -386,7 +386,7 @@ CParser::STATUS_TYPE CParser::check_units(std::string & tot_units,
 	using
 		Utilities::squeeze_white;
 
-	static const char *
+	static const char * const
 		units[] = {
 		"Mol/l",				/* 0 */
 		"mMol/l",				/* 1 */
@@ -464,14 +464,16 @@ CVDenseSetup(CVodeMem cv_mem, int convfail, N_Vector ypred,
 	booleantype jbad, jok;
 	realtype dgamma;
 	integertype ier;
+	long int msbj;
 	CVDenseMem cvdense_mem;
 
 	cvdense_mem = (CVDenseMem) lmem;
 
 	/* Use nst, gamma/gammap, and convfail to set J eval. flag jok */
 
+	msbj = (iopt != NULL && iopt[DENSE_MSBJ] > 0) ? iopt[DENSE_MSBJ] : CVD_MSBJ;
 	dgamma = ABS((gamma / gammap) - ONE);
-	jbad = (nst == 0) || (nst > nstlj + CVD_MSBJ) ||
+	jbad = (nst == 0) || (nst > nstlj + msbj) ||
 		((convfail == FAIL_BAD_J) && (dgamma < CVD_DGMAX)) ||
 		(convfail == FAIL_OTHER);
 	jok = !jbad;
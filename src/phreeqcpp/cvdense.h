@@ -94,10 +94,16 @@
  * iopt[DENSE_LIW] : size (in integertype words) of integer       *
  *                   workspace vectors used by this solver.       *
  *                                                                *
+ * The optional CVDENSE input is:                                 *
+ *                                                                *
+ * iopt[DENSE_MSBJ] : maximum number of steps between Jacobian    *
+ *                    evaluations; CVD_MSBJ is used if it is not  *
+ *                    positive.                                   *
+ *                                                                *
  ******************************************************************/
 
 	enum
-	{ DENSE_NJE = CVODE_IOPT_SIZE, DENSE_LRW, DENSE_LIW };
+	{ DENSE_NJE = CVODE_IOPT_SIZE, DENSE_LRW, DENSE_LIW, DENSE_MSBJ };
 
 
 /******************************************************************
@@ -31,6 +31,8 @@ cxxKinetics::cxxKinetics(PHRQ_io *io)
 	use_cvode = false;
 	cvode_steps = 100;
 	cvode_order = 5;
+	cvode_jacobian_steps = 0;
+	rk_reuse_tol = 0.0;
 	totals.type = cxxNameDouble::ND_ELT_MOLES;
 	equalIncrements = false;
 	count = 0;
@@ -46,6 +48,8 @@ cxxNumKeyword(io)
 	use_cvode = false;
 	cvode_steps = 100;
 	cvode_order = 5;
+	cvode_jacobian_steps = 0;
+	rk_reuse_tol = 0.0;
 	totals.type = cxxNameDouble::ND_ELT_MOLES;
 	equalIncrements = false;
 	count = 0;
@@ -142,6 +146,12 @@ cxxKinetics::dump_raw(std::ostream & s_oss, unsigned int indent, int * n_out) co
 	s_oss << indent1;
 	s_oss << "-cvode_order               " << this->cvode_order << "\n";
 
+	s_oss << indent1;
+	s_oss << "-cvode_jacobian_steps      " << this->cvode_jacobian_steps << "\n";
+
+	s_oss << indent1;
+	s_oss << "-rk_reuse_tol              " << this->rk_reuse_tol << "\n";
+
 	// kineticsComps structures
 	for (size_t k = 0; k < this->kinetics_comps.size(); k++)
 	{
@@ -376,6 +386,24 @@ cxxKinetics::read_raw(CParser & parser, bool check)
 			}
 			cvode_order_defined = true;
 
+			break;
+		case 12:			// cvode_jacobian_steps
+			if (!(parser.get_iss() >> this->cvode_jacobian_steps))
+			{
+				this->cvode_jacobian_steps = 0;
+				parser.incr_input_error();
+				parser.error_msg("Expected integer value for cvode_jacobian_steps.",
+								 PHRQ_io::OT_CONTINUE);
+			}
+			break;
+		case 13:			// rk_reuse_tol
+			if (!(parser.get_iss() >> this->rk_reuse_tol))
+			{
+				this->rk_reuse_tol = 0.0;
+				parser.incr_input_error();
+				parser.error_msg("Expected numeric value for rk_reuse_tol.",
+								 PHRQ_io::OT_CONTINUE);
+			}
 			break;
 		case 9:				// equalIncrements
 		case 11:			// equal_increments
@@ -484,6 +512,8 @@ cxxKinetics::add(const cxxKinetics & addee, LDBLE extensive)
 	this->use_cvode = addee.use_cvode;
 	this->cvode_steps = addee.cvode_steps;
 	this->cvode_order = addee.cvode_order;
+	this->cvode_jacobian_steps = addee.cvode_jacobian_steps;
+	this->rk_reuse_tol = addee.rk_reuse_tol;
 	this->equalIncrements = addee.equalIncrements;
 	this->count = addee.count;
 }
@@ -590,6 +620,8 @@ cxxKinetics::Serialize(Dictionary & dictionary, std::vector < int >&ints,
 	ints.push_back(this->use_cvode ? 1 : 0);
 	ints.push_back(this->cvode_steps);
 	ints.push_back(this->cvode_order);
+	ints.push_back(this->cvode_jacobian_steps);
+	doubles.push_back(this->rk_reuse_tol);
 	this->totals.Serialize(dictionary, ints, doubles);
 }
 
@@ -623,6 +655,8 @@ cxxKinetics::Deserialize(Dictionary & dictionary, std::vector < int >&ints,
 	this->use_cvode = (ints[ii++] != 0);
 	this->cvode_steps = ints[ii++];
 	this->cvode_order = ints[ii++];
+	this->cvode_jacobian_steps = ints[ii++];
+	this->rk_reuse_tol = doubles[dd++];
 	this->totals.Deserialize(dictionary, ints, doubles, ii, dd);
 }
 
@@ -639,6 +673,8 @@ const std::vector< std::string >::value_type temp_vopts[] = {
 	std::vector< std::string >::value_type("cvode_order"),             // 8 
 	std::vector< std::string >::value_type("equalincrements"),         // 9 
 	std::vector< std::string >::value_type("count"),                   // 10
-	std::vector< std::string >::value_type("equal_increments")         // 11
+	std::vector< std::string >::value_type("equal_increments"),        // 11
+	std::vector< std::string >::value_type("cvode_jacobian_steps"),    // 12
+	std::vector< std::string >::value_type("rk_reuse_tol")             // 13
 };
 const std::vector< std::string > cxxKinetics::vopts(temp_vopts, temp_vopts + sizeof temp_vopts / sizeof temp_vopts[0]);
@@ -41,6 +41,10 @@ class cxxKinetics:public cxxNumKeyword
 	void Set_cvode_steps(int t) {cvode_steps = t;}
 	int Get_cvode_order(void) const {return cvode_order;}
 	void Set_cvode_order(int t) {cvode_order = t;}
+	int Get_cvode_jacobian_steps(void) const {return cvode_jacobian_steps;}
+	void Set_cvode_jacobian_steps(int t) {cvode_jacobian_steps = t;}
+	LDBLE Get_rk_reuse_tol(void) const {return rk_reuse_tol;}
+	void Set_rk_reuse_tol(LDBLE t) {rk_reuse_tol = t;}
 	std::vector < cxxKineticsComp > &Get_kinetics_comps(void) {return kinetics_comps;}
 	const std::vector < cxxKineticsComp > &Get_kinetics_comps(void)const {return kinetics_comps;}
 	cxxNameDouble & Get_totals(void) {return this->totals;}
@@ -70,6 +74,8 @@ class cxxKinetics:public cxxNumKeyword
 	bool use_cvode;
 	int cvode_steps;
 	int cvode_order;
+	int cvode_jacobian_steps;
+	LDBLE rk_reuse_tol;
 	// internal variables
 	cxxNameDouble totals;
 	const static std::vector < std::string > vopts;
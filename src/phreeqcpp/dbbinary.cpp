@@ -0,0 +1,1056 @@
+#include "Utils.h"
+#include "Phreeqc.h"
+#include "phqalloc.h"
+
+/* ----------------------------------------------------------------------
+ *   Binary database image
+ *
+ *   The tables read from a database (elements, named log K's, species,
+ *   phases, master species, rates, isotopes, LLNL, Pitzer and SIT
+ *   parameters, KNOBS-type settings) are written as a flat stream of
+ *   records with no pointers.  Elements and species are written first
+ *   as name tables; element lists and reactions refer to them by
+ *   position, so the image is read back without parsing formulas or
+ *   searching for names.  The image is bound to the build that wrote it
+ *   (sizes of the raw structures and settings, byte order) and to the
+ *   text of the database it was made from, and is rejected if either
+ *   differs.  The size and modification time of the database file are
+ *   kept with the checksum of its text, so that an unchanged file need
+ *   not be read to check the image.
+ * ---------------------------------------------------------------------- */
+#define DBBINARY_MAGIC   "PHRQDBI"
+#define DBBINARY_VERSION 9
+/*
+ *   Sizes of the raw structures and of the settings (DBB_SCALARS) of
+ *   DBBINARY_VERSION on LP64 builds with double LDBLE; checked when
+ *   compiling database_binary_scalars
+ */
+#define DBB_LP64_SPECIES         736
+#define DBB_LP64_PHASE           552
+#define DBB_LP64_MASTER          152
+#define DBB_LP64_LOGK            384
+#define DBB_LP64_MASTER_ISOTOPE  64
+#define DBB_LP64_PITZ_PARAM      152
+#define DBB_LP64_THETA_PARAM     48
+#define DBB_LP64_PRINTS          132
+#define DBB_LP64_SCALARS         443
+
+/*
+ *   Settings read from a database that are not part of a table, members
+ *   of Phreeqc
+ */
+#define DBB_SCALARS(X) \
+	X(current_tc) \
+	X(current_pa) \
+	X(current_mu) \
+	X(mu_terms_in_logk) \
+	X(MIN_LM) \
+	X(LOG_ZERO_MOLALITY) \
+	X(MIN_RELATED_LOG_ACTIVITY) \
+	X(MIN_TOTAL) \
+	X(MIN_TOTAL_SS) \
+	X(MIN_RELATED_SURFACE) \
+	X(high_precision) \
+	X(count_workers) \
+	X(count_jacobian_workers) \
+	X(pr) \
+	X(simulation) \
+	X(incremental_reactions) \
+	X(debug_model) \
+	X(debug_prep) \
+	X(debug_set) \
+	X(debug_diffuse_layer) \
+	X(debug_inverse) \
+	X(inv_tol_default) \
+	X(itmax) \
+	X(max_tries) \
+	X(ineq_tol) \
+	X(convergence_tolerance) \
+	X(step_size) \
+	X(pe_step_size) \
+	X(pp_scale) \
+	X(pp_column_scale) \
+	X(diagonal_scale) \
+	X(sparse_solver) \
+	X(analytic_jacobian) \
+	X(warm_start) \
+	X(solver_stats_on) \
+	X(logk_grid_dt) \
+	X(logk_grid_tol) \
+	X(mass_water_switch) \
+	X(delay_mass_water) \
+	X(equi_delay) \
+	X(dampen_ah2o) \
+	X(censor) \
+	X(aqueous_only) \
+	X(negative_concentrations) \
+	X(numerical_deriv) \
+	X(initial_solution_isotopes) \
+	X(print_density) \
+	X(print_viscosity) \
+	X(viscos) \
+	X(viscos_0) \
+	X(viscos_0_25) \
+	X(pitzer_model) \
+	X(sit_model) \
+	X(pitzer_pe) \
+	X(full_pitzer) \
+	X(always_full_pitzer) \
+	X(ICON) \
+	X(IC) \
+	X(use_etheta)
+
+enum DBBINARY_SECTION
+{
+	DBB_ELEMENTS = 1,
+	DBB_LOGK,
+	DBB_SPECIES,
+	DBB_PHASES,
+	DBB_MASTER,
+	DBB_RATES,
+	DBB_LLNL,
+	DBB_ISOTOPES,
+	DBB_PITZER,
+	DBB_SIT,
+	DBB_SCALARS,
+	DBB_END
+};
+
+class DBImageWriter
+{
+public:
+	DBImageWriter(std::ostream &os): os(os) {}
+
+	template <typename T> void put(const T &t)
+	{
+		os.write((const char *) &t, sizeof(T));
+	}
+	void put_raw(const void *p, size_t n)
+	{
+		os.write((const char *) p, (std::streamsize) n);
+	}
+	void put_string(const char *str)
+	{
+		// a NULL string is written as length -1
+		int n = (str == NULL) ? -1 : (int) strlen(str);
+		put(n);
+		if (n > 0) put_raw(str, (size_t) n);
+	}
+	void put_name_coef(const struct name_coef *nc, int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			put_string(nc[i].name);
+			put(nc[i].coef);
+		}
+	}
+	void put_element(const struct element *elt_ptr)
+	{
+		// index in the element table, or -1 and the name
+		std::map<const struct element *, int>::const_iterator it = element_index.find(elt_ptr);
+		put(it != element_index.end() ? it->second : -1);
+		if (it == element_index.end()) put_string(elt_ptr->name);
+	}
+	void put_species(const struct species *s_ptr)
+	{
+		// index in the species table, -2 for NULL, or -1 and the name and charge
+		std::map<const struct species *, int>::const_iterator it = species_index.find(s_ptr);
+		put(s_ptr == NULL ? -2 : (it != species_index.end() ? it->second : -1));
+		if (s_ptr != NULL && it == species_index.end())
+		{
+			put_string(s_ptr->name);
+			put(s_ptr->z);
+		}
+	}
+	void put_elt_list(const struct elt_list *elt_list_ptr)
+	{
+		int count = -1;
+		if (elt_list_ptr != NULL)
+		{
+			for (count = 0; elt_list_ptr[count].elt != NULL; count++);
+		}
+		put(count);
+		for (int i = 0; i < count; i++)
+		{
+			put_element(elt_list_ptr[i].elt);
+			put(elt_list_ptr[i].coef);
+		}
+	}
+	void put_rxn(const struct reaction *rxn_ptr)
+	{
+		// tokens as counted by cxxChemRxn: the first, then up to s == NULL and name == NULL
+		int count = -1;
+		if (rxn_ptr != NULL)
+		{
+			for (count = 1; rxn_ptr->token[count].s != NULL || rxn_ptr->token[count].name != NULL; count++);
+		}
+		put(count);
+		if (rxn_ptr == NULL) return;
+		put_raw(rxn_ptr->logk, MAX_LOG_K_INDICES * sizeof(LDBLE));
+		put_raw(rxn_ptr->dz, 3 * sizeof(LDBLE));
+		for (int i = 0; i < count; i++)
+		{
+			const struct rxn_token *token_ptr = &rxn_ptr->token[i];
+			put_species(token_ptr->s);
+			put(token_ptr->coef);
+			// the token name is almost always the species name
+			char same = (token_ptr->s != NULL && token_ptr->name != NULL &&
+				strcmp(token_ptr->s->name, token_ptr->name) == 0);
+			put(same);
+			if (!same) put_string(token_ptr->name);
+		}
+	}
+	void put_pitz_param(const struct pitz_param *pzp_ptr)
+	{
+		struct pitz_param pzp_raw = *pzp_ptr;
+		for (int j = 0; j < 3; j++)
+		{
+			pzp_raw.species[j] = NULL;
+			put_string(pzp_ptr->species[j]);
+		}
+		pzp_raw.thetas = NULL;
+		put(pzp_raw);
+	}
+
+	std::map<const struct element *, int> element_index;
+	std::map<const struct species *, int> species_index;
+
+protected:
+	std::ostream &os;
+};
+
+class DBImageReader
+{
+public:
+	DBImageReader(Phreeqc *p, const char *begin, const char *end)
+	: phreeqc_ptr(p), ptr(begin), end(end), ok(true) {}
+
+	bool Get_ok(void) const {return this->ok;}
+
+	void section(int tag)
+	{
+		// the header has been checked, so a mismatch here is a damaged image
+		if (get<int>() != tag || !ok)
+		{
+			phreeqc_ptr->error_msg("Binary database image is damaged.", STOP);
+		}
+	}
+	void get_raw(void *p, size_t n)
+	{
+		if (!ok || (size_t) (end - ptr) < n)
+		{
+			ok = false;
+			memset(p, 0, n);
+			return;
+		}
+		memcpy(p, ptr, n);
+		ptr += n;
+	}
+	template <typename T> T get(void)
+	{
+		T t;
+		get_raw(&t, sizeof(T));
+		return t;
+	}
+	bool get_string(std::string &str)
+	{
+		int n = get<int>();
+		str.clear();
+		if (n < 0 || !ok) return false;
+		if (end - ptr < n)
+		{
+			ok = false;
+			return false;
+		}
+		str.assign(ptr, (size_t) n);
+		ptr += n;
+		return true;
+	}
+	const char *get_hsave(void)
+	{
+		return get_string(str) ? phreeqc_ptr->string_hsave(str.c_str()) : NULL;
+	}
+	struct name_coef *get_name_coef(int count)
+	{
+		if (count <= 0) return NULL;
+		struct name_coef *nc = (struct name_coef *) phreeqc_ptr->PHRQ_malloc((size_t) count * sizeof(struct name_coef));
+		if (nc == NULL) phreeqc_ptr->malloc_error();
+		for (int i = 0; i < count; i++)
+		{
+			nc[i].name = get_hsave();
+			nc[i].coef = get<LDBLE>();
+		}
+		return nc;
+	}
+	struct element *get_element(void)
+	{
+		int i = get<int>();
+		if (i >= 0 && i < (int) elements.size()) return elements[i];
+		if (i != -1) damaged();
+		get_string(str);
+		return phreeqc_ptr->element_store(str.c_str());
+	}
+	struct species *get_species(void)
+	{
+		int i = get<int>();
+		if (i == -2) return NULL;
+		if (i >= 0 && i < (int) species.size()) return species[i];
+		if (i != -1) damaged();
+		get_string(str);
+		LDBLE z = get<LDBLE>();
+		return phreeqc_ptr->s_store(str.c_str(), z, FALSE);
+	}
+	struct elt_list *get_elt_list(void)
+	{
+		int count = get<int>();
+		if (count < 0 || !ok) return NULL;
+		struct elt_list *elt_list_ptr = (struct elt_list *) phreeqc_ptr->PHRQ_malloc((size_t) (count + 1) * sizeof(struct elt_list));
+		if (elt_list_ptr == NULL) phreeqc_ptr->malloc_error();
+		for (int i = 0; i < count; i++)
+		{
+			elt_list_ptr[i].elt = get_element();
+			elt_list_ptr[i].coef = get<LDBLE>();
+		}
+		elt_list_ptr[count].elt = NULL;
+		elt_list_ptr[count].coef = 0.0;
+		return elt_list_ptr;
+	}
+	struct reaction *get_rxn(void)
+	{
+		int count = get<int>();
+		if (count < 0 || !ok) return NULL;
+		struct reaction *rxn_ptr = phreeqc_ptr->rxn_alloc(count + 1);
+		get_raw(rxn_ptr->logk, MAX_LOG_K_INDICES * sizeof(LDBLE));
+		get_raw(rxn_ptr->dz, 3 * sizeof(LDBLE));
+		for (int i = 0; i < count; i++)
+		{
+			struct rxn_token *token_ptr = &rxn_ptr->token[i];
+			token_ptr->s = get_species();
+			token_ptr->coef = get<LDBLE>();
+			if (get<char>() && token_ptr->s != NULL)
+			{
+				token_ptr->name = token_ptr->s->name;
+			}
+			else
+			{
+				token_ptr->name = get_hsave();
+			}
+		}
+		return rxn_ptr;
+	}
+	void get_pitz_param(struct pitz_param *pzp_ptr, std::string species_name[3])
+	{
+		// species names are left in species_name for the caller to store
+		bool have[3];
+		for (int j = 0; j < 3; j++)
+		{
+			have[j] = get_string(species_name[j]);
+		}
+		get_raw(pzp_ptr, sizeof(struct pitz_param));
+		for (int j = 0; j < 3; j++)
+		{
+			pzp_ptr->species[j] = have[j] ? species_name[j].c_str() : NULL;
+		}
+		pzp_ptr->thetas = NULL;
+	}
+
+	std::vector<struct element *> elements;
+	std::vector<struct species *> species;
+
+protected:
+	void damaged(void)
+	{
+		phreeqc_ptr->error_msg("Binary database image is damaged.", STOP);
+	}
+	Phreeqc *phreeqc_ptr;
+	const char *ptr;
+	const char *end;
+	bool ok;
+	std::string str;
+};
+
+/* ---------------------------------------------------------------------- */
+unsigned long long Phreeqc::
+database_checksum(const char *str, size_t n)
+/* ---------------------------------------------------------------------- */
+{
+	/*
+	 *   64-bit FNV-1a hash of a block of bytes
+	 */
+	unsigned long long h = 14695981039346656037ULL;
+	for (size_t i = 0; i < n; i++)
+	{
+		h ^= (unsigned char) str[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+database_binary_scalars(std::vector< std::pair<void *, size_t> > &fields)
+/* ---------------------------------------------------------------------- */
+{
+	/*
+	 *   Settings read from a database that are not part of a table;
+	 *   the same list is used to write and to read the image.
+	 */
+#define DBB_FIELD(x) fields.push_back(std::pair<void *, size_t>((void *) &(x), sizeof(x)));
+	DBB_SCALARS(DBB_FIELD)
+#undef DBB_FIELD
+#if __cplusplus >= 201103L && defined(__LP64__)
+	/*
+	 *   A change of the raw structures or of the settings changes the
+	 *   fingerprint, so older images are rejected anyway; this check makes
+	 *   the change visible where DBBINARY_VERSION is set
+	 */
+#define DBB_SIZE(x) + sizeof(x)
+	static_assert(sizeof(LDBLE) != 8 ||
+		(sizeof(struct species) == DBB_LP64_SPECIES &&
+		sizeof(struct phase) == DBB_LP64_PHASE &&
+		sizeof(struct master) == DBB_LP64_MASTER &&
+		sizeof(struct logk) == DBB_LP64_LOGK &&
+		sizeof(struct master_isotope) == DBB_LP64_MASTER_ISOTOPE &&
+		sizeof(struct pitz_param) == DBB_LP64_PITZ_PARAM &&
+		sizeof(struct theta_param) == DBB_LP64_THETA_PARAM &&
+		sizeof(struct prints) == DBB_LP64_PRINTS &&
+		(0 DBB_SCALARS(DBB_SIZE)) == DBB_LP64_SCALARS),
+		"Binary database image layout changed: increase DBBINARY_VERSION and update the DBB_LP64 sizes.");
+#undef DBB_SIZE
+#endif
+}
+
+/* ---------------------------------------------------------------------- */
+static void
+database_binary_fingerprint(std::vector<unsigned int> &fp,
+	const std::vector< std::pair<void *, size_t> > &fields)
+/* ---------------------------------------------------------------------- */
+{
+	/*
+	 *   Sizes of the structures and settings written raw, and the byte order
+	 */
+	fp.clear();
+	fp.push_back(0x01020304);
+	fp.push_back((unsigned int) sizeof(LDBLE));
+	fp.push_back((unsigned int) MAX_LOG_K_INDICES);
+	fp.push_back((unsigned int) sizeof(struct species));
+	fp.push_back((unsigned int) sizeof(struct phase));
+	fp.push_back((unsigned int) sizeof(struct master));
+	fp.push_back((unsigned int) sizeof(struct logk));
+	fp.push_back((unsigned int) sizeof(struct master_isotope));
+	fp.push_back((unsigned int) sizeof(struct pitz_param));
+	fp.push_back((unsigned int) sizeof(struct theta_param));
+	fp.push_back((unsigned int) sizeof(struct prints));
+	fp.push_back((unsigned int) fields.size());
+	for (size_t i = 0; i < fields.size(); i++)
+	{
+		fp.push_back((unsigned int) fields[i].second);
+	}
+}
+
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+write_database_binary(std::ostream &os, unsigned long long checksum,
+	long long text_size, long long text_time)
+/* ---------------------------------------------------------------------- */
+{
+	/*
+	 *   Writes the database tables as a binary image.
+	 *   checksum identifies the database text the tables were read from,
+	 *   text_size and text_time the database file (-1 if there is none).
+	 *
+	 *   Returns ERROR, with a warning, if the tables hold data that
+	 *   the image does not record (reactants, SELECTED_OUTPUT,
+	 *   USER_PRINT or TRANSPORT definitions read from the database).
+	 */
+	const char *unsupported = NULL;
+	if (Rxn_solution_map.size() || Rxn_exchange_map.size() || Rxn_surface_map.size() ||
+		Rxn_kinetics_map.size() || Rxn_gas_phase_map.size() || Rxn_ss_assemblage_map.size() ||
+		Rxn_pp_assemblage_map.size() || Rxn_reaction_map.size() || Rxn_temperature_map.size() ||
+		Rxn_pressure_map.size() || Rxn_mix_map.size())
+	{
+		unsupported = "reactant definitions";
+	}
+	else if (SelectedOutput_map.size() || UserPunch_map.size())
+	{
+		unsupported = "SELECTED_OUTPUT or USER_PUNCH";
+	}
+	else if (user_print->commands != NULL)
+	{
+		unsupported = "USER_PRINT";
+	}
+	else if (simul_tr > 0 || change_surf_count > 0)
+	{
+		unsupported = "TRANSPORT";
+	}
+	if (unsupported != NULL)
+	{
+		error_string = sformatf("Database contains %s, binary database image not written.",
+			unsupported);
+		warning_msg(error_string);
+		return (ERROR);
+	}
+
+	DBImageWriter w(os);
+	std::vector< std::pair<void *, size_t> > fields;
+	database_binary_scalars(fields);
+	/*
+	 *   Header
+	 */
+	std::vector<unsigned int> fp;
+	database_binary_fingerprint(fp, fields);
+	w.put_raw(DBBINARY_MAGIC, sizeof(DBBINARY_MAGIC));
+	w.put((unsigned int) DBBINARY_VERSION);
+	w.put((unsigned int) fp.size());
+	w.put_raw(&fp[0], fp.size() * sizeof(unsigned int));
+	w.put(text_size);
+	w.put(text_time);
+	w.put(checksum);
+	/*
+	 *   Elements
+	 */
+	w.put((int) DBB_ELEMENTS);
+	w.put(count_elements);
+	for (int i = 0; i < count_elements; i++)
+	{
+		w.put_string(elements[i]->name);
+		w.put(elements[i]->gfw);
+		w.element_index[elements[i]] = i;
+	}
+	/*
+	 *   Named log K's
+	 */
+	w.put((int) DBB_LOGK);
+	w.put(count_logk);
+	for (int i = 0; i < count_logk; i++)
+	{
+		struct logk logk_raw = *logk[i];
+		logk_raw.name = NULL;
+		logk_raw.add_logk = NULL;
+		w.put_string(logk[i]->name);
+		w.put(logk_raw);
+		w.put_name_coef(logk[i]->add_logk, logk[i]->count_add_logk);
+	}
+	/*
+	 *   Species, all names first so that reactions can refer to any species
+	 */
+	w.put((int) DBB_SPECIES);
+	w.put(count_s);
+	for (int i = 0; i < count_s; i++)
+	{
+		w.put_string(s[i]->name);
+		w.put(s[i]->z);
+		w.species_index[s[i]] = i;
+	}
+	for (int i = 0; i < count_s; i++)
+	{
+		struct species *s_ptr = s[i];
+		struct species s_raw = *s_ptr;
+		s_raw.name = NULL;
+		s_raw.mole_balance = NULL;
+		s_raw.primary = s_raw.secondary = NULL;
+		s_raw.add_logk = NULL;
+		s_raw.next_elt = s_raw.next_secondary = s_raw.next_sys_total = NULL;
+		s_raw.rxn = s_raw.rxn_s = s_raw.rxn_x = NULL;
+		w.put(s_raw);
+		w.put_string(s_ptr->mole_balance);
+		w.put_name_coef(s_ptr->add_logk, s_ptr->count_add_logk);
+		w.put_elt_list(s_ptr->next_elt);
+		w.put_elt_list(s_ptr->next_secondary);
+		w.put_elt_list(s_ptr->next_sys_total);
+		w.put_rxn(s_ptr->rxn);
+		w.put_rxn(s_ptr->rxn_s);
+		w.put_rxn(s_ptr->rxn_x);
+	}
+	/*
+	 *   Phases
+	 */
+	w.put((int) DBB_PHASES);
+	w.put(count_phases);
+	for (int i = 0; i < count_phases; i++)
+	{
+		struct phase *phase_ptr = phases[i];
+		struct phase phase_raw = *phase_ptr;
+		phase_raw.name = phase_raw.formula = NULL;
+		phase_raw.add_logk = NULL;
+		phase_raw.next_elt = phase_raw.next_sys_total = NULL;
+		phase_raw.rxn = phase_raw.rxn_s = phase_raw.rxn_x = NULL;
+		w.put_string(phase_ptr->name);
+		w.put(phase_raw);
+		w.put_string(phase_ptr->formula);
+		w.put_name_coef(phase_ptr->add_logk, phase_ptr->count_add_logk);
+		w.put_elt_list(phase_ptr->next_elt);
+		w.put_elt_list(phase_ptr->next_sys_total);
+		w.put_rxn(phase_ptr->rxn);
+		w.put_rxn(phase_ptr->rxn_s);
+		w.put_rxn(phase_ptr->rxn_x);
+	}
+	/*
+	 *   Master species
+	 */
+	w.put((int) DBB_MASTER);
+	w.put(count_master);
+	for (int i = 0; i < count_master; i++)
+	{
+		struct master *master_ptr = master[i];
+		struct master master_raw = *master_ptr;
+		master_raw.elt = NULL;
+		master_raw.gfw_formula = NULL;
+		master_raw.unknown = NULL;
+		master_raw.s = NULL;
+		master_raw.rxn_primary = master_raw.rxn_secondary = NULL;
+		master_raw.pe_rxn = NULL;
+		w.put(master_raw);
+		w.put_string(master_ptr->gfw_formula);
+		w.put_element(master_ptr->elt);
+		w.put_species(master_ptr->s);
+		w.put_rxn(master_ptr->rxn_primary);
+		w.put_rxn(master_ptr->rxn_secondary);
+		w.put_string(master_ptr->pe_rxn);
+	}
+	/*
+	 *   Rates
+	 */
+	w.put((int) DBB_RATES);
+	w.put(count_rates);
+	for (int i = 0; i < count_rates; i++)
+	{
+		w.put_string(rates[i].name);
+		w.put_string(rates[i].commands);
+	}
+	/*
+	 *   LLNL aqueous model parameters
+	 */
+	w.put((int) DBB_LLNL);
+	w.put(llnl_count_temp);
+	w.put_raw(llnl_temp, (size_t) llnl_count_temp * sizeof(LDBLE));
+	w.put(llnl_count_adh);
+	w.put_raw(llnl_adh, (size_t) llnl_count_adh * sizeof(LDBLE));
+	w.put(llnl_count_bdh);
+	w.put_raw(llnl_bdh, (size_t) llnl_count_bdh * sizeof(LDBLE));
+	w.put(llnl_count_bdot);
+	w.put_raw(llnl_bdot, (size_t) llnl_count_bdot * sizeof(LDBLE));
+	w.put(llnl_count_co2_coefs);
+	w.put_raw(llnl_co2_coefs, (size_t) llnl_count_co2_coefs * sizeof(LDBLE));
+	/*
+	 *   Isotopes
+	 */
+	w.put((int) DBB_ISOTOPES);
+	w.put(count_master_isotope);
+	for (int i = 0; i < count_master_isotope; i++)
+	{
+		struct master_isotope master_isotope_raw = *master_isotope[i];
+		master_isotope_raw.name = NULL;
+		master_isotope_raw.master = NULL;
+		master_isotope_raw.elt = NULL;
+		master_isotope_raw.units = NULL;
+		w.put_string(master_isotope[i]->name);
+		w.put(master_isotope_raw);
+		w.put_string(master_isotope[i]->master ? master_isotope[i]->master->elt->name : NULL);
+		w.put_string(master_isotope[i]->elt ? master_isotope[i]->elt->name : NULL);
+		w.put_string(master_isotope[i]->units);
+	}
+	w.put(count_calculate_value);
+	for (int i = 0; i < count_calculate_value; i++)
+	{
+		w.put_string(calculate_value[i]->name);
+		w.put(calculate_value[i]->value);
+		w.put_string(calculate_value[i]->commands);
+	}
+	w.put(count_isotope_ratio);
+	for (int i = 0; i < count_isotope_ratio; i++)
+	{
+		w.put_string(isotope_ratio[i]->name);
+		w.put_string(isotope_ratio[i]->isotope_name);
+		w.put(isotope_ratio[i]->ratio);
+		w.put(isotope_ratio[i]->converted_ratio);
+	}
+	w.put(count_isotope_alpha);
+	for (int i = 0; i < count_isotope_alpha; i++)
+	{
+		w.put_string(isotope_alpha[i]->name);
+		w.put_string(isotope_alpha[i]->named_logk);
+		w.put(isotope_alpha[i]->value);
+	}
+	/*
+	 *   Pitzer
+	 */
+	w.put((int) DBB_PITZER);
+	w.put(count_pitz_param);
+	for (int i = 0; i < count_pitz_param; i++)
+	{
+		w.put_pitz_param(pitz_params[i]);
+	}
+	w.put(count_theta_param);
+	for (int i = 0; i < count_theta_param; i++)
+	{
+		w.put(*theta_params[i]);
+	}
+	w.put((char) (aphi != NULL));
+	if (aphi != NULL)
+	{
+		w.put_pitz_param(aphi);
+	}
+	/*
+	 *   SIT
+	 */
+	w.put((int) DBB_SIT);
+	w.put(count_sit_param);
+	for (int i = 0; i < count_sit_param; i++)
+	{
+		w.put_pitz_param(sit_params[i]);
+	}
+	/*
+	 *   Settings
+	 */
+	w.put((int) DBB_SCALARS);
+	w.put((int) fields.size());
+	for (size_t i = 0; i < fields.size(); i++)
+	{
+		w.put_raw(fields[i].first, fields[i].second);
+	}
+	w.put((int) DBB_END);
+	os.flush();
+	return (os.good() ? OK : ERROR);
+}
+
+/* ---------------------------------------------------------------------- */
+static bool
+database_binary_header(DBImageReader &r, const std::vector< std::pair<void *, size_t> > &fields,
+	long long *text_size, long long *text_time, unsigned long long *checksum)
+/* ---------------------------------------------------------------------- */
+{
+	/*
+	 *   Reads the header; false if the image was written by another build
+	 */
+	char magic[sizeof(DBBINARY_MAGIC)];
+	r.get_raw(magic, sizeof(magic));
+	if (!r.Get_ok() || memcmp(magic, DBBINARY_MAGIC, sizeof(magic)) != 0 ||
+		r.get<unsigned int>() != DBBINARY_VERSION)
+	{
+		return false;
+	}
+	std::vector<unsigned int> fp;
+	database_binary_fingerprint(fp, fields);
+	if (r.get<unsigned int>() != fp.size())
+	{
+		return false;
+	}
+	for (size_t i = 0; i < fp.size(); i++)
+	{
+		if (r.get<unsigned int>() != fp[i])
+		{
+			return false;
+		}
+	}
+	*text_size = r.get<long long>();
+	*text_time = r.get<long long>();
+	*checksum = r.get<unsigned long long>();
+	return r.Get_ok();
+}
+
+/* ---------------------------------------------------------------------- */
+bool Phreeqc::
+database_binary_stamp(const char *begin, const char *end,
+	long long *text_size, long long *text_time, unsigned long long *checksum)
+/* ---------------------------------------------------------------------- */
+{
+	/*
+	 *   Size, modification time and checksum of the database an image was
+	 *   made from.  Returns false if the image was written by another build.
+	 */
+	std::vector< std::pair<void *, size_t> > fields;
+	database_binary_scalars(fields);
+	DBImageReader r(this, begin, end);
+	return database_binary_header(r, fields, text_size, text_time, checksum);
+}
+
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+read_database_binary(const char *begin, const char *end, unsigned long long checksum)
+/* ---------------------------------------------------------------------- */
+{
+	/*
+	 *   Restores the database tables from a binary image written by
+	 *   write_database_binary, held in memory from begin to end (the
+	 *   file may be mapped).  Must be called on a freshly initialized
+	 *   instance.
+	 *
+	 *   Returns ERROR without changing the instance if the image was
+	 *   written by a different build or for a database with a different
+	 *   checksum.  Stops with an error if the image is damaged.
+	 */
+	std::vector< std::pair<void *, size_t> > fields;
+	database_binary_scalars(fields);
+	DBImageReader r(this, begin, end);
+	long long text_size, text_time;
+	unsigned long long image_checksum;
+	/*
+	 *   Header
+	 */
+	if (!database_binary_header(r, fields, &text_size, &text_time, &image_checksum) ||
+		image_checksum != checksum)
+	{
+		return (ERROR);
+	}
+
+	std::string name;
+	/*
+	 *   Elements
+	 */
+	r.section(DBB_ELEMENTS);
+	int count = r.get<int>();
+	for (int i = 0; i < count; i++)
+	{
+		r.get_string(name);
+		struct element *elt_ptr = element_store(name.c_str());
+		elt_ptr->gfw = r.get<LDBLE>();
+		r.elements.push_back(elt_ptr);
+	}
+	element_h_one = element_store("H(1)");
+	/*
+	 *   Named log K's
+	 */
+	r.section(DBB_LOGK);
+	count = r.get<int>();
+	for (int i = 0; i < count; i++)
+	{
+		r.get_string(name);
+		char * ptr = string_duplicate(name.c_str());
+		struct logk *logk_ptr = logk_store(ptr, FALSE);
+		free_check_null(ptr);
+		r.get_raw(logk_ptr, sizeof(struct logk));
+		logk_ptr->name = string_hsave(name.c_str());
+		logk_ptr->add_logk = r.get_name_coef(logk_ptr->count_add_logk);
+	}
+	/*
+	 *   Species
+	 */
+	r.section(DBB_SPECIES);
+	count = r.get<int>();
+	for (int i = 0; i < count; i++)
+	{
+		r.get_string(name);
+		LDBLE z = r.get<LDBLE>();
+		r.species.push_back(s_store(name.c_str(), z, FALSE));
+	}
+	for (int i = 0; i < count; i++)
+	{
+		struct species *s_ptr = r.species[i];
+		const char *s_name = s_ptr->name;
+		r.get_raw(s_ptr, sizeof(struct species));
+		s_ptr->name = s_name;
+		s_ptr->mole_balance = r.get_hsave();
+		s_ptr->add_logk = r.get_name_coef(s_ptr->count_add_logk);
+		s_ptr->next_elt = r.get_elt_list();
+		s_ptr->next_secondary = r.get_elt_list();
+		s_ptr->next_sys_total = r.get_elt_list();
+		s_ptr->rxn = r.get_rxn();
+		s_ptr->rxn_s = r.get_rxn();
+		s_ptr->rxn_x = r.get_rxn();
+	}
+	s_h2o					= s_search("H2O");
+	s_hplus					= s_search("H+");
+	s_h3oplus				= s_search("H3O+");
+	s_eminus				= s_search("e-");
+	s_co3					= s_search("CO3-2");
+	s_h2					= s_search("H2");
+	s_o2					= s_search("O2");
+	/*
+	 *   Phases
+	 */
+	r.section(DBB_PHASES);
+	count = r.get<int>();
+	for (int i = 0; i < count; i++)
+	{
+		r.get_string(name);
+		struct phase *phase_ptr = phase_store(name.c_str());
+		const char *phase_name = phase_ptr->name;
+		r.get_raw(phase_ptr, sizeof(struct phase));
+		phase_ptr->name = phase_name;
+		phase_ptr->formula = r.get_hsave();
+		phase_ptr->add_logk = r.get_name_coef(phase_ptr->count_add_logk);
+		phase_ptr->next_elt = r.get_elt_list();
+		phase_ptr->next_sys_total = r.get_elt_list();
+		phase_ptr->rxn = r.get_rxn();
+		phase_ptr->rxn_s = r.get_rxn();
+		phase_ptr->rxn_x = r.get_rxn();
+	}
+	/*
+	 *   Master species
+	 */
+	r.section(DBB_MASTER);
+	count_master = r.get<int>();
+	space((void **)((void *)&master), count_master, &max_master,
+		sizeof(struct master *));
+	dbg_master = master;
+	for (int i = 0; i < count_master; i++)
+	{
+		master[i] = (struct master *) PHRQ_malloc(sizeof(struct master));
+		if (master[i] == NULL) malloc_error();
+		r.get_raw(master[i], sizeof(struct master));
+		master[i]->gfw_formula = r.get_hsave();
+		master[i]->elt = r.get_element();
+		master[i]->s = r.get_species();
+		master[i]->rxn_primary = r.get_rxn();
+		master[i]->rxn_secondary = r.get_rxn();
+		master[i]->pe_rxn = r.get_hsave();
+	}
+	/*
+	 *   Rates
+	 */
+	r.section(DBB_RATES);
+	count_rates = r.get<int>();
+	if (count_rates > 0)
+	{
+		rates = (struct rate *) free_check_null(rates);
+		rates = (struct rate *) PHRQ_malloc((size_t) count_rates * sizeof(struct rate));
+		if (rates == NULL) malloc_error();
+		for (int i = 0; i < count_rates; i++)
+		{
+			rates[i].name = r.get_hsave();
+			rates[i].commands = r.get_string(name) ? string_duplicate(name.c_str()) : NULL;
+			rates[i].new_def = TRUE;
+			rates[i].linebase = NULL;
+			rates[i].varbase = NULL;
+			rates[i].loopbase = NULL;
+		}
+	}
+	/*
+	 *   LLNL aqueous model parameters
+	 */
+	r.section(DBB_LLNL);
+	LDBLE **llnl_arrays[] = {&llnl_temp, &llnl_adh, &llnl_bdh, &llnl_bdot, &llnl_co2_coefs};
+	int *llnl_counts[] = {&llnl_count_temp, &llnl_count_adh, &llnl_count_bdh, &llnl_count_bdot,
+		&llnl_count_co2_coefs};
+	for (int j = 0; j < 5; j++)
+	{
+		*llnl_counts[j] = r.get<int>();
+		if (*llnl_counts[j] > 0)
+		{
+			*llnl_arrays[j] = (LDBLE *) free_check_null(*llnl_arrays[j]);
+			*llnl_arrays[j] = (LDBLE *) PHRQ_malloc((size_t) *llnl_counts[j] * sizeof(LDBLE));
+			if (*llnl_arrays[j] == NULL) malloc_error();
+			r.get_raw(*llnl_arrays[j], (size_t) *llnl_counts[j] * sizeof(LDBLE));
+		}
+	}
+	/*
+	 *   Isotopes
+	 */
+	r.section(DBB_ISOTOPES);
+	count = r.get<int>();
+	for (int i = 0; i < count; i++)
+	{
+		r.get_string(name);
+		struct master_isotope *master_isotope_ptr = master_isotope_store(name.c_str(), FALSE);
+		r.get_raw(master_isotope_ptr, sizeof(struct master_isotope));
+		master_isotope_ptr->name = string_hsave(name.c_str());
+		master_isotope_ptr->master = NULL;
+		if (r.get_string(name))
+		{
+			int n;
+			char * ptr = string_duplicate(name.c_str());
+			master_isotope_ptr->master = master_search(ptr, &n);
+			free_check_null(ptr);
+		}
+		master_isotope_ptr->elt = NULL;
+		if (r.get_string(name))
+		{
+			master_isotope_ptr->elt = element_store(name.c_str());
+		}
+		master_isotope_ptr->units = r.get_hsave();
+	}
+	count = r.get<int>();
+	for (int i = 0; i < count; i++)
+	{
+		r.get_string(name);
+		struct calculate_value *calculate_value_ptr = calculate_value_store(name.c_str(), FALSE);
+		calculate_value_ptr->value = r.get<LDBLE>();
+		if (r.get_string(name))
+		{
+			calculate_value_ptr->commands = string_duplicate(name.c_str());
+		}
+	}
+	count = r.get<int>();
+	for (int i = 0; i < count; i++)
+	{
+		r.get_string(name);
+		struct isotope_ratio *isotope_ratio_ptr = isotope_ratio_store(name.c_str(), FALSE);
+		isotope_ratio_ptr->name = string_hsave(name.c_str());
+		isotope_ratio_ptr->isotope_name = r.get_hsave();
+		isotope_ratio_ptr->ratio = r.get<LDBLE>();
+		isotope_ratio_ptr->converted_ratio = r.get<LDBLE>();
+	}
+	count = r.get<int>();
+	for (int i = 0; i < count; i++)
+	{
+		r.get_string(name);
+		struct isotope_alpha *isotope_alpha_ptr = isotope_alpha_store(name.c_str(), FALSE);
+		isotope_alpha_ptr->named_logk = r.get_hsave();
+		isotope_alpha_ptr->value = r.get<LDBLE>();
+	}
+	/*
+	 *   Pitzer
+	 */
+	r.section(DBB_PITZER);
+	std::string species[3];
+	struct pitz_param pzp;
+	count = r.get<int>();
+	for (int i = 0; i < count; i++)
+	{
+		r.get_pitz_param(&pzp, species);
+		pitz_param_store(&pzp, true);
+	}
+	count_theta_param = r.get<int>();
+	max_theta_param = count_theta_param;
+	space((void **)((void *)&theta_params), count_theta_param, &max_theta_param,
+		sizeof(struct theta_param *));
+	for (int i = 0; i < count_theta_param; i++)
+	{
+		theta_params[i] = theta_param_alloc();
+		r.get_raw(theta_params[i], sizeof(struct theta_param));
+	}
+	if (r.get<char>())
+	{
+		r.get_pitz_param(&pzp, species);
+		aphi = pitz_param_alloc();
+		memcpy(aphi, &pzp, sizeof(struct pitz_param));
+		for (int j = 0; j < 3; j++)
+		{
+			if (aphi->species[j] != NULL)
+			{
+				aphi->species[j] = string_hsave(aphi->species[j]);
+			}
+		}
+	}
+	/*
+	 *   SIT
+	 */
+	r.section(DBB_SIT);
+	count = r.get<int>();
+	for (int i = 0; i < count; i++)
+	{
+		r.get_pitz_param(&pzp, species);
+		sit_param_store(&pzp, true);
+	}
+	/*
+	 *   Settings
+	 */
+	r.section(DBB_SCALARS);
+	if (r.get<int>() != (int) fields.size())
+	{
+		error_msg("Binary database image is damaged.", STOP);
+	}
+	for (size_t i = 0; i < fields.size(); i++)
+	{
+		r.get_raw(fields[i].first, fields[i].second);
+	}
+	r.section(DBB_END);
+	step_size_now = step_size;
+	pe_step_size_now = pe_step_size;
+
+	// make sure new_model gets set
+	this->keycount[Keywords::KEY_SOLUTION_SPECIES] = 1;
+	this->tidy_model();
+	return (OK);
+}
@@ -42,6 +42,13 @@
 #define STAG 3
 #define NOMIX 4
 
+/* tasks for cell workers */
+#define WORKER_RUN_CELLS 0
+#define WORKER_NOMIX 1
+#define WORKER_DISP 2
+/* KNOBS -solver_stats each, a record for each calculation */
+#define SOLVER_STATS_EACH 2
+
 #define CONVERGED 2
 #define MASS_BALANCE 3
 
@@ -151,13 +158,7 @@
 /*
  *   Hash definitions
  */
-# define SegmentSize		    256
-# define SegmentSizeShift	  8	/* log2(SegmentSize) */
-# define DirectorySize	    256
-# define DirectorySizeShift      8	/* log2(DirectorySize)  */
-# define Prime1			  37
-# define Prime2			  1048583
-# define DefaultMaxLoadFactor   5
+# define HashMinSlots		    256	/* power of 2 */
 //
 // Typedefs and structure definitions
 //
@@ -199,31 +200,16 @@ typedef enum
 typedef enum
 { preorder, postorder, endorder, leaf } VISIT;
 
-typedef struct Element
-{
-	/*
-	 ** The user only sees the first two fields,
-	 ** as we pretend to pass back only a pointer to ENTRY.
-	 ** {S}he doesn`t know what else is in here.
-	 */
-	const char *Key;
-	char *Data;
-	struct Element *Next;		/* secret from user    */
-} Element, *Segment;
+typedef unsigned long Address;
 
 typedef struct
 {
-	short p;					/* Next bucket to be split      */
-	short maxp;					/* upper bound on p during expansion */
+	ENTRY *Slots;				/* open addressing, key NULL is empty */
+	Address *Hashes;			/* hash of the key in each slot */
+	Address Mask;				/* # slots - 1, # slots is a power of 2 */
 	long KeyCount;				/* current # keys       */
-	short SegmentCount;			/* current # segments   */
-	short MinLoadFactor;
-	short MaxLoadFactor;
-	Segment *Directory[DirectorySize];
 } HashTable;
 
-typedef unsigned long Address;
-
 typedef struct PHRQMemHeader
 {
 	struct PHRQMemHeader *pNext;	/* memory allocated just after this one */
@@ -1059,6 +1045,56 @@ struct M_S
 	const char *name;
 	LDBLE tot1, tot2;
 };
+struct CURRENT_CELLS
+{
+	LDBLE dif, ele, R; // diffusive and electric components, relative cell resistance
+};
+struct V_M   // For calculating Vinograd and McBain's zero-charge, diffusive tranfer of individual solutes
+{
+	LDBLE grad, D, z, c, zc, Dz, Dzc;
+	LDBLE b_ij; // harmonic mean of cell properties, with EDL enrichment
+};
+struct CT /* summed parts of V_M and mcd transfer in a timestep for all cells, for free + DL water */
+{
+	LDBLE dl_s, Dz2c, Dz2c_dl, visc1, visc2, J_ij_sum;
+	LDBLE A_ij_il, Dz2c_il, mixf_il;
+	int J_ij_count_spec, J_ij_il_count_spec;
+	struct V_M *v_m, *v_m_il;
+	struct J_ij *J_ij, *J_ij_il;
+};
+struct MOLES_ADDED /* total moles added to balance negative conc's */
+{
+	char *name;
+	LDBLE moles;
+};
+struct cell_guess /* converged activities of a cell, initial guesses for its next calculation */
+{
+	std::vector<int> master;	/* numbers of the master species of the unknowns, in x order */
+	std::vector<LDBLE> la;
+	LDBLE mu;
+};
+struct solver_stats /* equilibrium calculations of set_and_run_wrapper of a cell, or one with SOLVER_STATS_EACH */
+{
+	int cell;				/* cell, solution or mix number */
+	int simulation;
+	int calculations;		/* calculations summed in the record */
+	int kinetics;			/* TRUE if a calculation is a trial of kinetic integration */
+	int converged;			/* TRUE if the last try of every calculation converged */
+	int tries;				/* calls to set_and_run */
+	int last_try;			/* convergence parameter set of the last try of the last calculation, 0 is KNOBS */
+	int path;				/* bit j is set if parameter set j was tried */
+	int iterations;			/* Newton iterations of all tries */
+	int step_cuts;			/* iterations with aqueous deltas scaled down in reset */
+	int overflows;			/* molality overflows, guesses revised */
+	int basis_changes;
+	int infeasible;			/* infeasible solutions of ineq */
+	int sparse_solves;		/* ineq solutions by sparse_lu_solve */
+	int numerical_switches;	/* switches to numerical derivatives for fixed-volume gas */
+	LDBLE time;				/* wall-clock seconds of the calculation */
+	LDBLE time_ineq;
+	LDBLE time_gammas;
+	LDBLE time_jacobian;
+};
 // Pitzer definitions
 typedef enum
 { TYPE_B0, TYPE_B1, TYPE_B2, TYPE_C0, TYPE_THETA, TYPE_LAMDA, TYPE_ZETA,
@@ -1102,6 +1138,8 @@ struct theta_param
 	LDBLE zk;
 	LDBLE etheta;
 	LDBLE ethetap;
+	LDBLE I;		/* ionic strength and A0 of etheta, ethetap; I < 0 if none */
+	LDBLE A0;
 };
 
 struct const_iso
@@ -5,7 +5,6 @@
 #include "SolutionIsotope.h"
 
 
-#define MAX_MODELS 20
 #define MIN_TOTAL_INVERSE 1e-14
 
 /* variables local to module */
@@ -21,6 +20,7 @@ inverse_models(void)
  *   Go through list of inverse models, make calculations
  *   for any marked "new".
  */
+	ProfilerScope profiler_scope(profiler, "inverse_models");
 	int n/*, print1*/;
 	char string[MAX_LENGTH];
 	if (count_inverse <= 0) return OK;
@@ -47,9 +47,6 @@ inverse_models(void)
 	row_name = NULL;
 	min_delta = NULL;
 	max_delta = NULL;
-	good = NULL;
-	bad = NULL;
-	minimal = NULL;
 
 	state = INVERSE;
 	dl_type_x = cxxSurface::NO_DL;
@@ -487,13 +484,14 @@ setup_inverse(struct inverse *inv_ptr)
 		col_name[column] = phase_ptr->name;
 		for (j = 1; rxn_ptr->token[j].s != NULL; j++)
 		{
-			if (rxn_ptr->token[j].s->secondary != NULL)
+			struct species *s_ptr = s_local(rxn_ptr->token[j].s);
+			if (s_ptr->secondary != NULL)
 			{
-				master_ptr = rxn_ptr->token[j].s->secondary;
+				master_ptr = s_ptr->secondary;
 			}
 			else
 			{
-				master_ptr = rxn_ptr->token[j].s->primary;
+				master_ptr = s_ptr->primary;
 			}
 			if (master_ptr == NULL)
 			{
@@ -1074,10 +1072,10 @@ solve_inverse(struct inverse *inv_ptr)
  *      -range   on or off
  *      
  */
-	int i, j, n;
+	int i, n;
 	int quit, print, first;
 	int first_of_model_size, model_size;
-	unsigned long minimal_bits, good_bits;
+	InverseBits minimal_bits, good_bits;
 	char token[MAX_LENGTH];
 
 	n = count_unknowns;			/* columns in A, C, E */
@@ -1085,29 +1083,13 @@ solve_inverse(struct inverse *inv_ptr)
 	nklmd = n + klmd;
 	n2d = n + 2;
 
-	max_good = MAX_MODELS;
-	max_bad = MAX_MODELS;
-	max_minimal = MAX_MODELS;
-
-	good =
-		(unsigned long *) PHRQ_malloc((size_t) max_good *
-									  sizeof(unsigned long));
-	if (good == NULL)
-		malloc_error();
+	good.Clear(inv_ptr->count_phases + inv_ptr->count_solns);
 	count_good = 0;
 
-	bad =
-		(unsigned long *) PHRQ_malloc((size_t) max_bad *
-									  sizeof(unsigned long));
-	if (bad == NULL)
-		malloc_error();
+	bad.Clear(inv_ptr->count_phases + inv_ptr->count_solns);
 	count_bad = 0;
 
-	minimal =
-		(unsigned long *) PHRQ_malloc((size_t) max_minimal *
-									  sizeof(unsigned long));
-	if (minimal == NULL)
-		malloc_error();
+	minimal.Clear(inv_ptr->count_phases + inv_ptr->count_solns);
 	count_minimal = 0;
 
 	col_back = (int *) PHRQ_malloc((size_t) max_column_count * sizeof(int));
@@ -1141,17 +1123,20 @@ solve_inverse(struct inverse *inv_ptr)
  *   Set current bits to complete list.
  */
 	soln_bits = 0;
-	if (inv_ptr->count_solns + inv_ptr->count_phases > 32)
+	if (inv_ptr->count_solns > 32)
 	{
 		error_msg
-			("For inverse modeling, sum of initial solutions and phases must be <= 32.\n\tFor all reasonable calculations, the sum should be much less than 32.",
+			("For inverse modeling, number of solutions must be <= 32.\n\tFor all reasonable calculations, the number should be much less than 32.",
 			 STOP);
 	}
 	for (i = inv_ptr->count_solns; i > 0; i--)
 	{
-		temp_bits = 1 << (i - 1);
+		temp_bits = 1ul << (i - 1);
 		soln_bits += temp_bits;
 	}
+	min_position.assign(inv_ptr->count_phases, 0);
+	max_position.assign(inv_ptr->count_phases, 0);
+	now.assign(inv_ptr->count_phases, 0);
 	if (check_solns(inv_ptr) == ERROR)
 	{
 		error_msg("Calculations terminating.", STOP);
@@ -1179,8 +1164,12 @@ solve_inverse(struct inverse *inv_ptr)
 				   == TRUE)
 			{
 				first_of_model_size = FALSE;
-				current_bits =
-					(soln_bits << inv_ptr->count_phases) + phase_bits;
+				current_bits = phase_bits;
+				for (i = 0; i < inv_ptr->count_solns; i++)
+				{
+					current_bits.Set(inv_ptr->count_phases + i,
+									 get_bits(soln_bits, i, 1) != 0);
+				}
 
 				if (subset_bad(current_bits) == TRUE
 					|| subset_minimal(current_bits) == TRUE)
@@ -1219,30 +1208,21 @@ solve_inverse(struct inverse *inv_ptr)
 					if (equal(inv_delta1[i + inv_ptr->count_solns], 0.0, TOL) ==
 						TRUE)
 					{
-						good_bits = set_bit(good_bits, i, 0);
+						good_bits.Set(i, false);
 					}
 				}
 				for (i = 0; i < inv_ptr->count_solns; i++)
 				{
 					if (equal(inv_delta1[i], 0.0, TOL) == TRUE)
 					{
-						good_bits =
-							set_bit(good_bits, i + inv_ptr->count_phases, 0);
+						good_bits.Set(i + inv_ptr->count_phases, false);
 					}
 				}
 /*
- *   Determine if model is new
- */
-				for (j = 0; j < count_good; j++)
-				{
-					if (good_bits == good[j])
-						break;
-				}
-/*
- *  Calculate ranges and print model only if NOT looking for minimal models
+ *  Calculate ranges and print model only if new and NOT looking for minimal models
  */
 				print = FALSE;
-				if (j >= count_good && inv_ptr->minimal == FALSE)
+				if (!good.Contains(good_bits) && inv_ptr->minimal == FALSE)
 				{
 					print = TRUE;
 					save_good(good_bits);
@@ -1288,12 +1268,7 @@ solve_inverse(struct inverse *inv_ptr)
 						output_msg(sformatf( "%s\n\n", token));
 					}
 				}
-				for (j = 0; j < count_good; j++)
-				{
-					if (minimal_bits == good[j])
-						break;
-				}
-				if (j >= count_good)
+				if (!good.Contains(minimal_bits))
 				{
 					save_good(minimal_bits);
 					if (inv_ptr->range == TRUE)
@@ -1350,16 +1325,16 @@ solve_inverse(struct inverse *inv_ptr)
 	row_back = (int *) free_check_null(row_back);
 	min_delta = (LDBLE *) free_check_null(min_delta);
 	max_delta = (LDBLE *) free_check_null(max_delta);
-	good = (unsigned long *) free_check_null(good);
-	bad = (unsigned long *) free_check_null(bad);
-	minimal = (unsigned long *) free_check_null(minimal);
+	good.Clear(0);
+	bad.Clear(0);
+	minimal.Clear(0);
 
 	return (OK);
 }
 
 /* ---------------------------------------------------------------------- */
-unsigned long Phreeqc::
-minimal_solve(struct inverse *inv_ptr, unsigned long minimal_bits)
+InverseBits Phreeqc::
+minimal_solve(struct inverse *inv_ptr, InverseBits minimal_bits)
 /* ---------------------------------------------------------------------- */
 {
 /*
@@ -1367,7 +1342,6 @@ minimal_solve(struct inverse *inv_ptr, unsigned long minimal_bits)
  *   remove phases to find minimal solution
  */
 	int i;
-	unsigned long temp_bits_l;
 	if (debug_inverse == TRUE)
 	{
 		output_msg(sformatf( "Beginning minimal solve: \n"));
@@ -1375,11 +1349,9 @@ minimal_solve(struct inverse *inv_ptr, unsigned long minimal_bits)
 	}
 	for (i = 0; i < inv_ptr->count_phases + inv_ptr->count_solns - 1; i++)
 	{
-		if (get_bits(minimal_bits, i, 1) == 0)
+		if (!minimal_bits.Get(i))
 			continue;
-		temp_bits_l = 1 << i;	/* 0's and one 1 */
-		temp_bits_l = ~temp_bits_l;	/* 1's and one 0 */
-		minimal_bits = minimal_bits & temp_bits_l;
+		minimal_bits.Set(i, false);
 		if (debug_inverse == TRUE)
 		{
 			output_msg(sformatf( "Solving for minimal\n"));
@@ -1395,14 +1367,14 @@ minimal_solve(struct inverse *inv_ptr, unsigned long minimal_bits)
 		if (subset_bad(minimal_bits) == TRUE)
 		{
 			/* put bit back */
-			minimal_bits = minimal_bits | ~temp_bits_l;	/* 0's and one 1 */
+			minimal_bits.Set(i, true);
 			continue;
 		}
 		if (solve_with_mask(inv_ptr, minimal_bits) == ERROR)
 		{
 			save_bad(minimal_bits);
 			/* put bit back */
-			minimal_bits = minimal_bits | ~temp_bits_l;	/* 0's and one 1 */
+			minimal_bits.Set(i, true);
 		}
 
 	}
@@ -1413,19 +1385,19 @@ minimal_solve(struct inverse *inv_ptr, unsigned long minimal_bits)
 	}
 
 	solve_with_mask(inv_ptr, minimal_bits);
-	unsigned long actual_bits = 0;
+	InverseBits actual_bits(inv_ptr->count_phases + inv_ptr->count_solns);
 	for (i = 0; i < inv_ptr->count_solns; i++)
 	{
 		if (equal(inv_delta1[i], 0.0, TOL) == FALSE)
 		{
-			actual_bits = set_bit(actual_bits, i + inv_ptr->count_phases, 1);
+			actual_bits.Set(i + inv_ptr->count_phases, true);
 		}
 	}
 	for (i = 0; i < inv_ptr->count_phases; i++)
 	{
 		if (equal(inv_delta1[i + inv_ptr->count_solns], 0.0, TOL) == FALSE)
 		{
-			actual_bits = set_bit(actual_bits, i, 1);
+			actual_bits.Set(i, true);
 		}
 	}
 	if (actual_bits != minimal_bits)
@@ -1437,7 +1409,7 @@ minimal_solve(struct inverse *inv_ptr, unsigned long minimal_bits)
 
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
-solve_with_mask(struct inverse *inv_ptr, unsigned long cur_bits)
+solve_with_mask(struct inverse *inv_ptr, const InverseBits &cur_bits)
 /* ---------------------------------------------------------------------- */
 {
 /*
@@ -1603,149 +1575,101 @@ get_bits(unsigned long bits, int position, int number)
 
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
-save_minimal(unsigned long bits)
+save_minimal(const InverseBits &bits)
 /* ---------------------------------------------------------------------- */
 {
 /*
  *   Keeps list of minimal models
  */
-	minimal[count_minimal] = bits;
+	minimal.Insert(bits);
 	count_minimal++;
-	if (count_minimal >= max_minimal)
-	{
-		max_minimal *= 2;
-		minimal =
-			(unsigned long *) PHRQ_realloc(minimal,
-										   (size_t) max_minimal *
-										   sizeof(unsigned long));
-		if (minimal == NULL)
-			malloc_error();
-	}
 	return (TRUE);
 }
 
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
-save_good(unsigned long bits)
+save_good(const InverseBits &bits)
 /* ---------------------------------------------------------------------- */
 {
 /*
  *   Keeps list of good models, not necessarily minimal
  */
-	good[count_good] = bits;
+	good.Insert(bits);
 	count_good++;
-	if (count_good >= max_good)
-	{
-		max_good *= 2;
-		good =
-			(unsigned long *) PHRQ_realloc(good,
-										   (size_t) max_good *
-										   sizeof(unsigned long));
-		if (good == NULL)
-			malloc_error();
-	}
 	return (TRUE);
 }
 
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
-save_bad(unsigned long bits)
+save_bad(const InverseBits &bits)
 /* ---------------------------------------------------------------------- */
 {
 /*
  *   Keeps list of sets of phases with no feasible solution
  */
-	bad[count_bad] = bits;
+	bad.Insert(bits);
 	count_bad++;
-	if (count_bad >= max_bad)
-	{
-		max_bad *= 2;
-		bad =
-			(unsigned long *) PHRQ_realloc(bad,
-										   (size_t) max_bad *
-										   sizeof(unsigned long));
-		if (bad == NULL)
-			malloc_error();
-	}
 	return (TRUE);
 }
 
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
-superset_minimal(unsigned long bits)
+superset_minimal(const InverseBits &bits)
 /* ---------------------------------------------------------------------- */
 {
 /*
  *   Checks whether bits is a superset of any of the minimal models
  */
-	int i;
-	unsigned long temp_bits_l;
-	for (i = 0; i < count_minimal; i++)
+	if (minimal.Has_subset_of(bits))
 	{
-		temp_bits_l = bits | minimal[i];
-		if (temp_bits_l == bits)
-		{
-			return (TRUE);
-		}
+		return (TRUE);
 	}
 	return (FALSE);
 }
 
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
-subset_bad(unsigned long bits)
+subset_bad(const InverseBits &bits)
 /* ---------------------------------------------------------------------- */
 {
 /*
- *   Checks whether bits is a superset of any of the bad models
+ *   Checks whether bits is a subset of any of the bad models
  */
-	int i;
-	unsigned long temp_bits_l;
-	for (i = 0; i < count_bad; i++)
+	if (bad.Has_superset_of(bits))
 	{
-		temp_bits_l = bits | bad[i];
-		if (temp_bits_l == bad[i])
-		{
-			return (TRUE);
-		}
+		return (TRUE);
 	}
 	return (FALSE);
 }
 
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
-subset_minimal(unsigned long bits)
+subset_minimal(const InverseBits &bits)
 /* ---------------------------------------------------------------------- */
 {
 /*
  *   Checks whether bits is a subset of any of the minimal models
  */
-	int i;
-	unsigned long temp_bits_l;
-	for (i = 0; i < count_minimal; i++)
+	if (minimal.Has_superset_of(bits))
 	{
-		temp_bits_l = bits | minimal[i];
-		if (temp_bits_l == minimal[i])
-		{
-			return (TRUE);
-		}
+		return (TRUE);
 	}
 	return (FALSE);
 }
 
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
-bit_print(unsigned long bits, int l)
+bit_print(const InverseBits &bits, int l)
 /* ---------------------------------------------------------------------- */
 {
 /*
- *   Prints l bits of an unsigned long
+ *   Prints l bits of an InverseBits
  */
 	int i;
 
 	for (i = l - 1; i >= 0; i--)
 	{
-		output_msg(sformatf( "%lu  ", get_bits(bits, i, 1)));
+		output_msg(sformatf( "%d  ", bits.Get(i) ? 1 : 0));
 	}
 	output_msg(sformatf( "\n"));
 	return (OK);
@@ -2359,29 +2283,6 @@ punch_model(struct inverse *inv_ptr)
 	return (OK);
 }
 
-/* ---------------------------------------------------------------------- */
-unsigned long Phreeqc::
-set_bit(unsigned long bits, int position, int value)
-/* ---------------------------------------------------------------------- */
-{
-/*
- *   Sets a single bit
- */
-	unsigned long temp_bits_l;
-
-	temp_bits_l = 1 << position;
-	if (value == 0)
-	{
-		temp_bits_l = ~temp_bits_l;
-		temp_bits_l = bits & temp_bits_l;
-	}
-	else
-	{
-		temp_bits_l = bits | temp_bits_l;
-	}
-	return (temp_bits_l);
-}
-
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
 next_set_phases(struct inverse *inv_ptr,
@@ -2389,7 +2290,6 @@ next_set_phases(struct inverse *inv_ptr,
 /* ---------------------------------------------------------------------- */
 {
 	int i, j, k;
-	unsigned long temp_bits_l;
 
 /*
  *   min_ and max_position are arrays, logically with length
@@ -2440,18 +2340,24 @@ next_set_phases(struct inverse *inv_ptr,
 /*
  *   Set bits which switch in phases
  */
-	temp_bits_l = 0;
+	if (phase_bits.Get_count_bits() != inv_ptr->count_phases + inv_ptr->count_solns)
+	{
+		phase_bits.Resize(inv_ptr->count_phases + inv_ptr->count_solns);
+	}
+	else
+	{
+		phase_bits.Clear();
+	}
 	for (j = 0; j < model_size; j++)
 	{
-		temp_bits_l += (1 << now[j]);
+		phase_bits.Set(now[j], true);
 	}
-	phase_bits = temp_bits_l;
 	return (TRUE);
 }
 
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
-range(struct inverse *inv_ptr, unsigned long cur_bits)
+range(struct inverse *inv_ptr, InverseBits cur_bits)
 /* ---------------------------------------------------------------------- */
 {
 /*
@@ -2462,7 +2368,6 @@ range(struct inverse *inv_ptr, unsigned long cur_bits)
 	int i, j;
 	int k, l, m, n;
 	int f;
-	unsigned long bits;
 	LDBLE error2;
 /*
  *   Include forced solutions and phases in range calculation
@@ -2473,14 +2378,14 @@ range(struct inverse *inv_ptr, unsigned long cur_bits)
 		{
 			if (inv_ptr->phases[i].force == TRUE)
 			{
-				cur_bits = set_bit(cur_bits, i, 1);
+				cur_bits.Set(i, true);
 			}
 		}
 		else
 		{
 			if (inv_ptr->force_solns[i - inv_ptr->count_phases] == TRUE)
 			{
-				cur_bits = set_bit(cur_bits, i, 1);
+				cur_bits.Set(i, true);
 			}
 		}
 	}
@@ -2490,16 +2395,7 @@ range(struct inverse *inv_ptr, unsigned long cur_bits)
 	memcpy((void *) &(max_delta[0]), (void *) &(inv_zero[0]),
 		   (size_t) max_column_count * sizeof(LDBLE));
 /*
- *   Switch bits so that phases are high and solutions are low
- */
-	bits =
-		get_bits(cur_bits, inv_ptr->count_phases + inv_ptr->count_solns - 1,
-				 inv_ptr->count_solns);
-	bits +=
-		(get_bits(cur_bits, inv_ptr->count_phases - 1, inv_ptr->count_phases)
-		 << inv_ptr->count_solns);
-/*
- *   Do range calculation
+ *   Do range calculation, solutions are in the first columns
  */
 	for (i = 0; i < inv_ptr->count_solns + inv_ptr->count_phases; i++)
 	{
@@ -2509,7 +2405,12 @@ range(struct inverse *inv_ptr, unsigned long cur_bits)
 			max_delta[i] = 1.0;
 			continue;
 		}
-		if (get_bits(bits, i, 1) == 0)
+		if (i < inv_ptr->count_solns)
+		{
+			if (!cur_bits.Get(inv_ptr->count_phases + i))
+				continue;
+		}
+		else if (!cur_bits.Get(i - inv_ptr->count_solns))
 			continue;
 /*
  *   Calculate min and max
@@ -2650,7 +2551,7 @@ range(struct inverse *inv_ptr, unsigned long cur_bits)
 int Phreeqc::
 shrink(struct inverse *inv_ptr, LDBLE * array_in, LDBLE * array_out,
 	   int *k, int *l, int *m, int *n,
-	   unsigned long cur_bits,
+	   const InverseBits &cur_bits,
 	   LDBLE * delta_l, int *col_back_l, int *row_back_l)
 /* ---------------------------------------------------------------------- */
 {
@@ -2690,7 +2591,7 @@ shrink(struct inverse *inv_ptr, LDBLE * array_in, LDBLE * array_out,
  */
 	for (i = 0; i < inv_ptr->count_phases; i++)
 	{
-		if (get_bits(cur_bits, i, 1) == 0)
+		if (!cur_bits.Get(i))
 		{
 			col_back_l[col_phases + i] = -1;
 			/* drop isotopes */
@@ -2710,7 +2611,7 @@ shrink(struct inverse *inv_ptr, LDBLE * array_in, LDBLE * array_out,
  */
 	for (i = 0; i < (inv_ptr->count_solns - 1); i++)
 	{
-		if (get_bits(cur_bits, inv_ptr->count_phases + i, 1) == 0)
+		if (!cur_bits.Get(inv_ptr->count_phases + i))
 		{
 			col_back_l[i] = -1;
 			/* drop all epsilons for the solution */
@@ -2930,7 +2831,7 @@ check_solns(struct inverse *inv_ptr)
 	int i, j;
 	int k, l, m, n;
 	int return_value;
-	unsigned long bits;
+	InverseBits bits(inv_ptr->count_phases + inv_ptr->count_solns);
 	LDBLE error2;
 
 	memcpy((void *) &(min_delta[0]), (void *) &(inv_zero[0]),
@@ -2944,8 +2845,8 @@ check_solns(struct inverse *inv_ptr)
 	return_value = OK;
 	for (i = 0; i < inv_ptr->count_solns; i++)
 	{
-		bits = 0;
-		bits += 1 << (inv_ptr->count_phases + i);
+		bits.Clear();
+		bits.Set(inv_ptr->count_phases + i, true);
 /*
  *   Check for feasibility of charge balance with given uncertainties
  */
@@ -5109,27 +5010,28 @@ dump_netpath_pat(struct inverse *inv_ptr)
 		for (rxn_ptr = inv_ptr->phases[i].phase->rxn_s->token + 1;
 			 rxn_ptr->s != NULL; rxn_ptr++)
 		{
-			if (rxn_ptr->s == s_hplus)
+			struct species *s_ptr = s_local(rxn_ptr->s);
+			if (s_ptr == s_hplus)
 				continue;
-			if (rxn_ptr->s == s_h2o)
+			if (s_ptr == s_h2o)
 				continue;
-			if (rxn_ptr->s->secondary == NULL && rxn_ptr->s != s_eminus)
+			if (s_ptr->secondary == NULL && s_ptr != s_eminus)
 				continue;
-			if (rxn_ptr->s == s_o2)
+			if (s_ptr == s_o2)
 			{
 				sum += 4 * rxn_ptr->coef;
 			}
-			else if (rxn_ptr->s == s_h2)
+			else if (s_ptr == s_h2)
 			{
 				sum += -2 * rxn_ptr->coef;
 			}
-			else if (rxn_ptr->s == s_eminus)
+			else if (s_ptr == s_eminus)
 			{
 				sum += -1 * rxn_ptr->coef;
 			}
 			else
 			{
-				string = rxn_ptr->s->secondary->elt->name;
+				string = s_ptr->secondary->elt->name;
 				replace("(", " ", string);
 				replace(")", " ", string);
 				std::string::iterator b = string.begin();
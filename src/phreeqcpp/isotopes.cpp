@@ -864,12 +864,12 @@ punch_isotopes(void)
 		}
 		if (!current_selected_output->Get_high_precision())
 		{
-			fpunchf(sformatf("I_%s", current_selected_output->Get_isotopes()[i].first.c_str()), "%12.4e\t",
+			fpunchf(punch_name("I_", current_selected_output->Get_isotopes()[i].first), "%12.4e\t",
 				(double) iso);
 		}
 		else
 		{
-			fpunchf(sformatf("I_%s", current_selected_output->Get_isotopes()[i].first.c_str()), "%20.12e\t",
+			fpunchf(punch_name("I_", current_selected_output->Get_isotopes()[i].first), "%20.12e\t",
 				(double) iso);
 		}
 
@@ -960,12 +960,12 @@ punch_calculate_values(void)
 		}
 		if (!current_selected_output->Get_high_precision())
 		{
-		  fpunchf(sformatf("V_%s", current_selected_output->Get_calculate_values()[i].first.c_str()),
+		  fpunchf(punch_name("V_", current_selected_output->Get_calculate_values()[i].first),
 				"%12.4e\t", (double) result);
 		}
 		else
 		{
-		  fpunchf(sformatf("V_%s", current_selected_output->Get_calculate_values()[i].first.c_str()),
+		  fpunchf(punch_name("V_", current_selected_output->Get_calculate_values()[i].first),
 				"%20.12e\t", (double) result);
 		}
 	}
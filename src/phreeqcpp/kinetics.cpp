@@ -50,6 +50,7 @@ calc_kinetic_reaction(cxxKinetics *kinetics_ptr, LDBLE time_step)
  *	a list of elements and amounts in
  *	the reaction.
  */
+	ProfilerScope profiler_scope(profiler, "calc_kinetic_reaction");
 	int j, return_value;
 	LDBLE coef;
 	char l_command[] = "run";
@@ -411,6 +412,8 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 	LDBLE l_error, error_max, safety, moles_max, moles_reduction;
 	cxxKinetics *kinetics_ptr;
 	int equal_rate, zero_rate;
+	bool predicted;
+	std::vector<LDBLE> reuse_moles, reuse_delta;
 
 	cxxPPassemblage *pp_assemblage_save = NULL;
 	cxxSSassemblage *ss_assemblage_save = NULL;
@@ -443,6 +446,12 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 	rk_moles = (LDBLE *) free_check_null(rk_moles);
 	rk_moles = (LDBLE *) PHRQ_malloc((size_t) 6 * n_reactions * sizeof(LDBLE));
 	if (rk_moles == NULL) malloc_error();
+	rk_solved_moles.assign(n_reactions, 0.0);
+	rk_stage_delta.assign(n_reactions, 0.0);
+	rk_rate_jacobian.assign((size_t) n_reactions * n_reactions, 0.0);
+	rk_rate_jacobian_updated = false;
+	reuse_moles.assign(n_reactions, 0.0);
+	reuse_delta.assign(n_reactions, 0.0);
 
 	/*if (use_mix != NOMIX) last_model.force_prep = TRUE; */
 	set_and_run_wrapper(i, use_mix, FALSE, i, step_fraction);
@@ -517,6 +526,7 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 /*
  *   find k1
  */
+		rk_stages_reused = 0;
 		if (l_bad == TRUE)
 		{
 			for (size_t j = 0; j < kinetics_ptr->Get_kinetics_comps().size(); j++)
@@ -567,7 +577,11 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 				cxxKineticsComp * kinetics_comp_ptr = &(kinetics_ptr->Get_kinetics_comps()[j]);
 				kinetics_comp_ptr->Set_moles(0.);
 				m_temp[j] = kinetics_comp_ptr->Get_m();
+				rk_solved_moles[j] = 0.0;
 			}
+			/* species are those of the last saver() */
+			rk_solved = true;
+			rk_reuse = (kinetics_ptr->Get_rk_reuse_tol() > 0);
 
 			rate_sim_time = rate_sim_time_start + h_sum;
 			calc_kinetic_reaction(kinetics_ptr, h);
@@ -612,6 +626,7 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 						kinetics_comp_ptr->Set_m(0);
 					kinetics_comp_ptr->Set_moles(0.);
 				}
+				rk_solved = false;
 				if (set_and_run_wrapper(i, NOMIX, TRUE, i, 0.) ==
 					MASS_BALANCE)
 				{
@@ -665,14 +680,11 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 /*
  * Continue with rk ...
  */
-		calc_final_kinetic_reaction(kinetics_ptr);
-		if (set_and_run_wrapper(i, NOMIX, TRUE, i, 0.) == MASS_BALANCE)
+		if (rk_stage_run(i, kinetics_ptr) == MASS_BALANCE)
 		{
-			run_reactions_iterations += iterations;
 			moles_reduction = 9;
 			goto MOLES_TOO_LARGE;
 		}
-		run_reactions_iterations += iterations;
 
 /*
  *   find k2
@@ -685,6 +697,7 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 		}
 		rate_sim_time = rate_sim_time_start + h_sum + 0.2 * h;
 		calc_kinetic_reaction(kinetics_ptr, h);
+		rk_reuse_rates(kinetics_ptr, h);
 
 		/*   Reset to values of last saver() */
 		if (pp_assemblage_save != NULL)
@@ -746,9 +759,12 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 					kinetics_comp_ptr->Set_m(0);
 				kinetics_comp_ptr->Set_moles(0.);
 			}
+
+			predicted = rk_reuse_predict(kinetics_ptr, h, reuse_moles, reuse_delta);
 			if (set_and_run_wrapper(i, NOMIX, TRUE, i, 0.) == MASS_BALANCE)
 			{
 				run_reactions_iterations += iterations;
+				rk_solved = false;
 				moles_reduction = 9;
 				goto MOLES_TOO_LARGE;
 			}
@@ -767,6 +783,14 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 					break;
 				}
 			}
+			if (rk_reuse_rejected(kinetics_ptr, h, predicted, reuse_moles, reuse_delta,
+				pp_assemblage_save, ss_assemblage_save))
+			{
+				/* repeat the step with equilibrium calculations for all stages */
+				h_old = h;
+				l_bad = TRUE;
+				continue;
+			}
 			if (equal_rate)
 				kinetics_ptr->Set_rk(1);
 
@@ -789,14 +813,11 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 /*
  * Continue runge_kutta..
  */
-		calc_final_kinetic_reaction(kinetics_ptr);
-		if (set_and_run_wrapper(i, NOMIX, TRUE, i, 0.) == MASS_BALANCE)
+		if (rk_stage_run(i, kinetics_ptr) == MASS_BALANCE)
 		{
-			run_reactions_iterations += iterations;
 			moles_reduction = 9;
 			goto MOLES_TOO_LARGE;
 		}
-		run_reactions_iterations += iterations;
 /*
  *   find k3
  */
@@ -809,6 +830,7 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 		}
 		rate_sim_time = rate_sim_time_start + h_sum + 0.3 * h;
 		calc_kinetic_reaction(kinetics_ptr, h);
+		rk_reuse_rates(kinetics_ptr, h);
 
 		/*   Reset to values of last saver() */
 		if (pp_assemblage_save != NULL)
@@ -869,9 +891,11 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 				kinetics_comp_ptr->Set_moles(0.);
 			}
 
+			predicted = rk_reuse_predict(kinetics_ptr, h, reuse_moles, reuse_delta);
 			if (set_and_run_wrapper(i, NOMIX, TRUE, i, 0.) == MASS_BALANCE)
 			{
 				run_reactions_iterations += iterations;
+				rk_solved = false;
 				moles_reduction = 9;
 				goto MOLES_TOO_LARGE;
 			}
@@ -890,6 +914,14 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 					break;
 				}
 			}
+			if (rk_reuse_rejected(kinetics_ptr, h, predicted, reuse_moles, reuse_delta,
+				pp_assemblage_save, ss_assemblage_save))
+			{
+				/* repeat the step with equilibrium calculations for all stages */
+				h_old = h;
+				l_bad = TRUE;
+				continue;
+			}
 			if (equal_rate)
 				kinetics_ptr->Set_rk(1);
 
@@ -913,14 +945,11 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
  * Continue runge_kutta..
  */
 
-		calc_final_kinetic_reaction(kinetics_ptr);
-		if (set_and_run_wrapper(i, NOMIX, TRUE, i, 0.) == MASS_BALANCE)
+		if (rk_stage_run(i, kinetics_ptr) == MASS_BALANCE)
 		{
-			run_reactions_iterations += iterations;
 			moles_reduction = 9;
 			goto MOLES_TOO_LARGE;
 		}
-		run_reactions_iterations += iterations;
 /*
  *   find k4
  */
@@ -932,6 +961,7 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 		}
 		rate_sim_time = rate_sim_time_start + h_sum + 0.6 * h;
 		calc_kinetic_reaction(kinetics_ptr, h);
+		rk_reuse_rates(kinetics_ptr, h);
 
 		/*   Reset to values of last saver() */
 		if (pp_assemblage_save != NULL)
@@ -965,14 +995,11 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 		}
 		if (moles_reduction > 1.0)
 			goto MOLES_TOO_LARGE;
-		calc_final_kinetic_reaction(kinetics_ptr);
-		if (set_and_run_wrapper(i, NOMIX, TRUE, i, 0.) == MASS_BALANCE)
+		if (rk_stage_run(i, kinetics_ptr) == MASS_BALANCE)
 		{
-			run_reactions_iterations += iterations;
 			moles_reduction = 9;
 			goto MOLES_TOO_LARGE;
 		}
-		run_reactions_iterations += iterations;
 /*
  *   find k5
  */
@@ -984,6 +1011,7 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 		}
 		rate_sim_time = rate_sim_time_start + h_sum + h;
 		calc_kinetic_reaction(kinetics_ptr, h);
+		rk_reuse_rates(kinetics_ptr, h);
 
 		/*   Reset to values of last saver() */
 		if (pp_assemblage_save != NULL)
@@ -1018,14 +1046,11 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 		}
 		if (moles_reduction > 1.0)
 			goto MOLES_TOO_LARGE;
-		calc_final_kinetic_reaction(kinetics_ptr);
-		if (set_and_run_wrapper(i, NOMIX, TRUE, i, 0.) == MASS_BALANCE)
+		if (rk_stage_run(i, kinetics_ptr) == MASS_BALANCE)
 		{
-			run_reactions_iterations += iterations;
 			moles_reduction = 9;
 			goto MOLES_TOO_LARGE;
 		}
-		run_reactions_iterations += iterations;
 /*
  *   find k6
  */
@@ -1037,6 +1062,7 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 		}
 		rate_sim_time = rate_sim_time_start + h_sum + 0.875 * h;
 		calc_kinetic_reaction(kinetics_ptr, h);
+		rk_reuse_rates(kinetics_ptr, h);
 
 		/*   Reset to values of last saver() */
 		if (pp_assemblage_save != NULL)
@@ -1114,9 +1140,11 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 				kinetics_comp_ptr->Set_moles(0.);
 			}
 
+			predicted = rk_reuse_predict(kinetics_ptr, h, reuse_moles, reuse_delta);
 			if (set_and_run_wrapper(i, NOMIX, TRUE, i, 0.) == MASS_BALANCE)
 			{
 				run_reactions_iterations += iterations;
+				rk_solved = false;
 				moles_reduction = 9;
 				goto MOLES_TOO_LARGE;
 			}
@@ -1135,6 +1163,14 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 					break;
 				}
 			}
+			if (rk_reuse_rejected(kinetics_ptr, h, predicted, reuse_moles, reuse_delta,
+				pp_assemblage_save, ss_assemblage_save))
+			{
+				/* repeat the step with equilibrium calculations for all stages */
+				h_old = h;
+				l_bad = TRUE;
+				continue;
+			}
 			if (equal_rate && kinetics_ptr->Get_rk() < 6)
 				kinetics_ptr->Set_rk(1);
 
@@ -1246,6 +1282,176 @@ rk_kinetics(int i, LDBLE kin_time, int use_mix, int nsaver,
 	}
 	return (OK);
 }
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+rk_stage_run(int i, cxxKinetics *kinetics_ptr)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Calculates the equilibrium of cell i with the reaction of a
+ *   Runge-Kutta stage. With KINETICS -rk_reuse_tol, the calculation is
+ *   skipped when the moles of each reaction differ by less than the
+ *   tolerance from those of the last calculation; rk_reuse_rates then
+ *   linearizes the rates of the stage around that calculation.
+ *   Returns MASS_BALANCE if the calculation fails.
+ */
+	std::vector<cxxKineticsComp> &comps = kinetics_ptr->Get_kinetics_comps();
+	size_t j;
+
+	calc_final_kinetic_reaction(kinetics_ptr);
+	rk_stage_reused = false;
+	if (rk_reuse && rk_solved)
+	{
+		for (j = 0; j < comps.size(); j++)
+		{
+			rk_stage_delta[j] = comps[j].Get_moles() - rk_solved_moles[j];
+			if (fabs(rk_stage_delta[j]) > kinetics_ptr->Get_rk_reuse_tol())
+				break;
+		}
+		if (j == comps.size())
+		{
+			rk_stage_reused = true;
+			rk_stages_reused++;
+			return (OK);
+		}
+	}
+	for (j = 0; j < comps.size(); j++)
+	{
+		rk_solved_moles[j] = comps[j].Get_moles();
+	}
+	int converge = set_and_run_wrapper(i, NOMIX, TRUE, i, 0.);
+	run_reactions_iterations += iterations;
+	rk_solved = (converge != MASS_BALANCE);
+	return (converge);
+}
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+rk_reuse_rates(cxxKinetics *kinetics_ptr, LDBLE h)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Adds the linear change of the rates with the moles of reaction since
+ *   the last calculation to the moles of a stage calculated with the
+ *   species of that calculation.
+ */
+	if (!rk_stage_reused)
+		return;
+	size_t n = kinetics_ptr->Get_kinetics_comps().size();
+	for (size_t j = 0; j < n; j++)
+	{
+		cxxKineticsComp * kinetics_comp_ptr = &(kinetics_ptr->Get_kinetics_comps()[j]);
+		LDBLE d_rate = 0.0;
+		for (size_t k = 0; k < n; k++)
+		{
+			d_rate += rk_rate_jacobian[j * n + k] * rk_stage_delta[k];
+		}
+		kinetics_comp_ptr->Set_moles(kinetics_comp_ptr->Get_moles() + d_rate * h);
+	}
+}
+/* ---------------------------------------------------------------------- */
+bool Phreeqc::
+rk_reuse_predict(cxxKinetics *kinetics_ptr, LDBLE h, std::vector<LDBLE> &predicted,
+				 std::vector<LDBLE> &delta)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Before the equilibrium calculation at the end point of a step,
+ *   calculates the moles of the rates as a stage that reuses the species
+ *   of the last calculation would. delta is the reaction since that
+ *   calculation. Returns false if species cannot be reused, or if no
+ *   stage of the step reused species and the linearization has had its
+ *   first update; the prediction costs an evaluation of the rates.
+ */
+	if (!rk_reuse || !rk_solved)
+		return (false);
+	if (rk_stages_reused == 0 && rk_rate_jacobian_updated)
+		return (false);
+	size_t n = kinetics_ptr->Get_kinetics_comps().size();
+	for (size_t j = 0; j < n; j++)
+	{
+		cxxKineticsComp * kinetics_comp_ptr = &(kinetics_ptr->Get_kinetics_comps()[j]);
+		delta[j] = m_temp[j] - kinetics_comp_ptr->Get_m() - rk_solved_moles[j];
+		rk_stage_delta[j] = delta[j];
+	}
+	calc_kinetic_reaction(kinetics_ptr, h);
+	rk_stage_reused = true;
+	rk_reuse_rates(kinetics_ptr, h);
+	rk_stage_reused = false;
+	for (size_t j = 0; j < n; j++)
+	{
+		cxxKineticsComp * kinetics_comp_ptr = &(kinetics_ptr->Get_kinetics_comps()[j]);
+		predicted[j] = kinetics_comp_ptr->Get_moles();
+		kinetics_comp_ptr->Set_moles(0.);
+	}
+	return (true);
+}
+/* ---------------------------------------------------------------------- */
+bool Phreeqc::
+rk_reuse_verify(cxxKinetics *kinetics_ptr, LDBLE h, const std::vector<LDBLE> &predicted,
+				const std::vector<LDBLE> &delta)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Compares the moles of the rates after the equilibrium calculation at
+ *   the end point of a step with the prediction of rk_reuse_predict, and
+ *   corrects the linearization with a rank-one (Broyden) update from the
+ *   difference. Returns false if any reaction differs by more than its
+ *   -tol; stages that reused species are not valid then.
+ */
+	size_t n = kinetics_ptr->Get_kinetics_comps().size();
+	LDBLE delta2 = 0.0;
+	bool ok = true;
+	for (size_t k = 0; k < n; k++)
+	{
+		delta2 += delta[k] * delta[k];
+	}
+	for (size_t j = 0; j < n; j++)
+	{
+		cxxKineticsComp * kinetics_comp_ptr = &(kinetics_ptr->Get_kinetics_comps()[j]);
+		LDBLE diff = kinetics_comp_ptr->Get_moles() - predicted[j];
+		if (fabs(diff) > kinetics_comp_ptr->Get_tol())
+			ok = false;
+		if (delta2 > 0 && h > 0)
+		{
+			for (size_t k = 0; k < n; k++)
+			{
+				rk_rate_jacobian[j * n + k] += diff / h * delta[k] / delta2;
+			}
+			rk_rate_jacobian_updated = true;
+		}
+	}
+	return (ok);
+}
+/* ---------------------------------------------------------------------- */
+bool Phreeqc::
+rk_reuse_rejected(cxxKinetics *kinetics_ptr, LDBLE h, bool predicted,
+				  const std::vector<LDBLE> &reuse_moles, const std::vector<LDBLE> &reuse_delta,
+				  cxxPPassemblage *pp_assemblage_save, cxxSSassemblage *ss_assemblage_save)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   After the equilibrium calculation at the end point of a step, checks
+ *   the prediction of rk_reuse_predict. If it is off and stages of the
+ *   step reused species, resets the assemblages to those of the last
+ *   saver() and stops reusing species; the caller repeats the step.
+ *   Returns true if the step must be repeated.
+ */
+	if (!predicted || rk_reuse_verify(kinetics_ptr, h, reuse_moles, reuse_delta)
+		|| rk_stages_reused == 0)
+		return (false);
+	if (pp_assemblage_save != NULL)
+	{
+		Rxn_pp_assemblage_map[pp_assemblage_save->Get_n_user()] = *pp_assemblage_save;
+		use.Set_pp_assemblage_ptr(Utilities::Rxn_find(Rxn_pp_assemblage_map, pp_assemblage_save->Get_n_user()));
+	}
+	if (ss_assemblage_save != NULL)
+	{
+		Rxn_ss_assemblage_map[ss_assemblage_save->Get_n_user()] = *ss_assemblage_save;
+		use.Set_ss_assemblage_ptr(Utilities::Rxn_find(Rxn_ss_assemblage_map, ss_assemblage_save->Get_n_user()));
+	}
+	rk_reuse = false;
+	return (true);
+}
 
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
@@ -1281,6 +1487,7 @@ set_and_run_wrapper(int i, int use_mix, int use_kinetics, int nsaver,
 	old_pp_column_scale = pp_column_scale;
 	int old_equi_delay = equi_delay;
 
+	solver_stats_begin(i, use_kinetics);
 	if (state == TRANSPORT || state == PHAST)
 	{
 		set_transport(i, use_mix, use_kinetics, i);
@@ -1534,6 +1741,9 @@ restart:
 			}
 		}
 		set_and_run_attempt = j;
+		solver_stats_x.tries++;
+		solver_stats_x.last_try = j;
+		solver_stats_x.path |= (1 << j);
 
 		converge =
 			set_and_run(i, use_mix, use_kinetics, nsaver, step_fraction);
@@ -1568,6 +1778,7 @@ restart:
 		warning_msg(error_string);
 		converge = MASS_BALANCE;
 	}
+	solver_stats_end(converge);
 	if (converge == FALSE)
 	{
 /*
@@ -1623,7 +1834,7 @@ set_and_run(int i, int use_mix, int use_kinetics, int nsaver,
  *   nsaver	   --user number to store solution
  *   step_fraction--fraction of irreversible reaction to add
  */
-	int converge;
+	int converge, n_cell;
 	if (state == TRANSPORT || state == PHAST)
 	{
 		set_transport(i, use_mix, use_kinetics, nsaver);
@@ -1692,14 +1903,212 @@ set_and_run(int i, int use_mix, int use_kinetics, int nsaver,
 	{
 		prep();
 		k_temp(use.Get_solution_ptr()->Get_tc(), use.Get_solution_ptr()->Get_patm());
+		/*
+		 *  First attempt starts from the guesses saved for this cell;
+		 *  RUN_CELLS calculations run in -2, cell_guess_n is the cell.
+		 *  Trial states of the kinetic integrators are not used
+		 */
+		n_cell = (i == -2) ? cell_guess_n : i;
+		cell_guess_ptr = NULL;
+		if (warm_start == TRUE && use_kinetics == FALSE && set_and_run_attempt == 0)
+		{
+			std::map<int, struct cell_guess>::iterator it = cell_guess_map.find(n_cell);
+			if (it != cell_guess_map.end())
+				cell_guess_ptr = &it->second;
+		}
 		set(FALSE);
+		cell_guess_ptr = NULL;
 		converge = model();
+		if (warm_start == TRUE && use_kinetics == FALSE && converge == TRUE)
+		{
+			cell_guess_save(n_cell);
+		}
 	}
+	cell_calculations++;
+	cell_iterations += iterations;
 	sum_species();
 	viscosity();
 	return (converge);
 }
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+cell_guess_save(int n_cell)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Saves the converged activities of the master unknowns and the
+ *   ionic strength as initial guesses for the next calculation of n_cell
+ *   Master species are saved by number, the guesses can be copied to
+ *   and from worker instances
+ */
+	struct cell_guess &guess = cell_guess_map[n_cell];
+	guess.master.clear();
+	guess.la.clear();
+	for (int i = 0; i < count_unknowns; i++)
+	{
+		struct master *master_ptr = cell_guess_master(x[i]);
+		if (master_ptr == NULL)
+			continue;
+		guess.master.push_back(master_ptr->number);
+		guess.la.push_back(master_ptr->s->la);
+	}
+	guess.mu = mu_x;
+}
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+cell_guess_apply(void)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Copies the guesses in cell_guess_ptr into the master species if
+ *   they were saved for the same set of unknowns.
+ *   Returns OK if the guesses were used.
+ */
+	struct cell_guess *guess = cell_guess_ptr;
+	size_t n = 0;
+	int i;
 
+	if (guess == NULL)
+		return (ERROR);
+	for (i = 0; i < count_unknowns; i++)
+	{
+		struct master *master_ptr = cell_guess_master(x[i]);
+		if (master_ptr == NULL)
+			continue;
+		if (n >= guess->master.size() || guess->master[n] != master_ptr->number)
+			return (ERROR);
+		n++;
+	}
+	if (n != guess->master.size())
+		return (ERROR);
+	for (n = 0; n < guess->master.size(); n++)
+	{
+		master[guess->master[n]]->s->la = guess->la[n];
+	}
+	mu_x = guess->mu;
+	cell_warm_starts++;
+	return (OK);
+}
+/* ---------------------------------------------------------------------- */
+struct master * Phreeqc::
+cell_guess_master(struct unknown *unknown_ptr)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Master species whose log activity is the value of the unknown, or NULL
+ *   (ionic strength, mass of water, phase, gas and solid-solution moles)
+ */
+	switch (unknown_ptr->type)
+	{
+	case MB:
+	case ALK:
+	case CB:
+	case SOLUTION_PHASE_BOUNDARY:
+	case AH2O:
+	case MH:
+	case EXCH:
+	case SURFACE:
+	case SURFACE_CB:
+	case SURFACE_CB1:
+	case SURFACE_CB2:
+		return (unknown_ptr->master[0]);
+	}
+	return (NULL);
+}
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+solver_stats_begin(int i, int use_kinetics)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Starts the statistics of a calculation of set_and_run_wrapper;
+ *   counters are incremented by model and reset whether or not
+ *   KNOBS -solver_stats is set
+ */
+	memset(&solver_stats_x, 0, sizeof(solver_stats_x));
+	solver_stats_x.cell = (i == -2) ? cell_guess_n : i;
+	solver_stats_x.simulation = simulation;
+	solver_stats_x.kinetics = use_kinetics;
+	solver_stats_x.time = solver_time();
+}
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+solver_stats_end(int converge)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Saves the statistics of the calculation in solver_stats_list
+ */
+	if (!solver_stats_on)
+		return;
+	if (solver_stats_x.cell < 0)
+		solver_stats_x.cell = solution_number();
+	solver_stats_x.calculations = 1;
+	solver_stats_x.converged = (converge == TRUE) ? TRUE : FALSE;
+	solver_stats_x.time = solver_time() - solver_stats_x.time;
+	solver_stats_add(solver_stats_x);
+}
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+solver_stats_add(const struct solver_stats &s)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Appends s with KNOBS -solver_stats each, otherwise sums it into the
+ *   record of its simulation and cell, so that the list grows with the
+ *   cells and not with the steps
+ */
+	if (solver_stats_on == SOLVER_STATS_EACH)
+	{
+		solver_stats_list.push_back(s);
+		return;
+	}
+	std::pair<std::map<std::pair<int, int>, size_t>::iterator, bool> it =
+		solver_stats_index.insert(std::make_pair(std::make_pair(s.simulation, s.cell), solver_stats_list.size()));
+	if (it.second)
+	{
+		solver_stats_list.push_back(s);
+		return;
+	}
+	struct solver_stats &r = solver_stats_list[it.first->second];
+	r.calculations += s.calculations;
+	r.kinetics = (r.kinetics || s.kinetics) ? TRUE : FALSE;
+	r.converged = (r.converged && s.converged) ? TRUE : FALSE;
+	r.tries += s.tries;
+	r.last_try = s.last_try;
+	r.path |= s.path;
+	r.iterations += s.iterations;
+	r.step_cuts += s.step_cuts;
+	r.overflows += s.overflows;
+	r.basis_changes += s.basis_changes;
+	r.infeasible += s.infeasible;
+	r.sparse_solves += s.sparse_solves;
+	r.numerical_switches += s.numerical_switches;
+	r.time += s.time;
+	r.time_ineq += s.time_ineq;
+	r.time_gammas += s.time_gammas;
+	r.time_jacobian += s.time_jacobian;
+}
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+solver_stats_clear(void)
+/* ---------------------------------------------------------------------- */
+{
+	solver_stats_list.clear();
+	solver_stats_index.clear();
+}
+/* ---------------------------------------------------------------------- */
+LDBLE Phreeqc::
+solver_time(void)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Wall-clock seconds for the solver statistics, 0 if they are off
+ */
+	if (!solver_stats_on)
+		return (0.0);
+	return ((LDBLE) Profiler::Clock());
+}
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
 set_transport(int i, int use_mix, int use_kinetics, int nsaver)
@@ -2143,6 +2552,7 @@ run_reactions(int i, LDBLE kin_time, int use_mix, LDBLE step_fraction)
 	}
 	else
 	{
+		ProfilerScope profiler_scope(profiler, "kinetics");
 /*
  *   Save moles of kinetic reactants for printout...
  */
@@ -2295,6 +2705,7 @@ run_reactions(int i, LDBLE kin_time, int use_mix, LDBLE step_fraction)
 			 */
 			iopt[MXSTEP] = kinetics_ptr->Get_cvode_steps();
 			iopt[MAXORD] = kinetics_ptr->Get_cvode_order();
+			iopt[DENSE_MSBJ] = kinetics_ptr->Get_cvode_jacobian_steps();
 			kinetics_cvode_mem =
 				CVodeMalloc(n_reactions, f, 0.0, kinetics_y, BDF, NEWTON, SV,
 							&reltol, kinetics_abstol, this, NULL, TRUE, iopt,
@@ -2344,6 +2755,7 @@ RESTART:
 				tout1 = tout - sum_t;
 				t = 0;
 				N_VScale(1.0, cvode_last_good_y, kinetics_y);
+				cvode_statistics_add(iopt);
 				for (int j = 0; j < OPT_SIZE; j++)
 				{
 					iopt[j] = 0;
@@ -2352,6 +2764,7 @@ RESTART:
 				CVodeFree(kinetics_cvode_mem);	/* Free the CVODE problem memory */
 				iopt[MXSTEP] = kinetics_ptr->Get_cvode_steps();
 				iopt[MAXORD] = kinetics_ptr->Get_cvode_order();
+				iopt[DENSE_MSBJ] = kinetics_ptr->Get_cvode_jacobian_steps();
 				kinetics_cvode_mem =
 					CVodeMalloc(n_reactions, f, 0.0, kinetics_y, BDF, NEWTON,
 								SV, &reltol, kinetics_abstol, this, NULL,
@@ -2424,6 +2837,7 @@ RESTART:
 			{
 				Utilities::Rxn_copy(Rxn_solution_map, save_old, i);
 			}
+			cvode_statistics_add(iopt);
 			free_cvode();
 			use.Set_mix_in(use_save.Get_mix_in());
 			use.Set_mix_ptr(use_save.Get_mix_ptr());
@@ -2536,6 +2950,7 @@ run_reactions(int i, LDBLE kin_time, int use_mix, LDBLE step_fraction)
 	}
 	else
 	{
+		ProfilerScope profiler_scope(profiler, "kinetics");
 /*
  *   Save moles of kinetic reactants for printout...
  */
@@ -2677,6 +3092,7 @@ run_reactions(int i, LDBLE kin_time, int use_mix, LDBLE step_fraction)
 			 */
 			iopt[MXSTEP] = kinetics_ptr->Get_cvode_steps();
 			iopt[MAXORD] = kinetics_ptr->Get_cvode_order();
+			iopt[DENSE_MSBJ] = kinetics_ptr->Get_cvode_jacobian_steps();
 			kinetics_cvode_mem =
 				CVodeMalloc(n_reactions, f, 0.0, kinetics_y, BDF, NEWTON, SV,
 							&reltol, kinetics_abstol, this, NULL, TRUE, iopt,
@@ -2733,6 +3149,7 @@ run_reactions(int i, LDBLE kin_time, int use_mix, LDBLE step_fraction)
 				tout1 = tout - sum_t;
 				t = 0;
 				N_VScale(1.0, cvode_last_good_y, kinetics_y);
+				cvode_statistics_add(iopt);
 				for (int j = 0; j < OPT_SIZE; j++)
 				{
 					iopt[j] = 0;
@@ -2741,6 +3158,7 @@ run_reactions(int i, LDBLE kin_time, int use_mix, LDBLE step_fraction)
 				CVodeFree(kinetics_cvode_mem);	/* Free the CVODE problem memory */
 				iopt[MXSTEP] = kinetics_ptr->Get_cvode_steps();
 				iopt[MAXORD] = kinetics_ptr->Get_cvode_order();
+				iopt[DENSE_MSBJ] = kinetics_ptr->Get_cvode_jacobian_steps();
 				kinetics_cvode_mem =
 					CVodeMalloc(n_reactions, f, 0.0, kinetics_y, BDF, NEWTON,
 								SV, &reltol, kinetics_abstol, this, NULL,
@@ -2807,6 +3225,7 @@ run_reactions(int i, LDBLE kin_time, int use_mix, LDBLE step_fraction)
 			{
 				Utilities::Rxn_copy(Rxn_solution_map, save_old, i);
 			}
+			cvode_statistics_add(iopt);
 			free_cvode();
 			use.Set_mix_in(use_save.Get_mix_in());
 			use.Set_mix_ptr(use_save.Get_mix_ptr());
@@ -3321,11 +3740,9 @@ Jac(integertype N, DenseMat J, RhsFn f, void *f_data,
 					 long int *nfePtr, N_Vector vtemp1, N_Vector vtemp2,
 					 N_Vector vtemp3)
 {
-	int count_cvode_errors;
 	int n_reactions, n_user;
-	LDBLE *initial_rates, del;
+	LDBLE *initial_rates;
 	cxxKinetics *kinetics_ptr;
-	LDBLE step_fraction;
 
 	Phreeqc *pThis = (Phreeqc *) f_data;
 
@@ -3333,7 +3750,6 @@ Jac(integertype N, DenseMat J, RhsFn f, void *f_data,
 	n_reactions = pThis->cvode_n_reactions;
 	n_user = pThis->cvode_n_user;
 	kinetics_ptr = (cxxKinetics *) pThis->cvode_kinetics_ptr;
-	step_fraction = pThis->cvode_step_fraction;
 	pThis->rate_sim_time = pThis->cvode_rate_sim_time;
 
 	initial_rates =
@@ -3396,86 +3812,17 @@ Jac(integertype N, DenseMat J, RhsFn f, void *f_data,
 		cxxKineticsComp * kinetics_comp_ptr = &(kinetics_ptr->Get_kinetics_comps()[i]);
 		initial_rates[i] = kinetics_comp_ptr->Get_moles();
 	}
-	for (size_t i = 0; i < kinetics_ptr->Get_kinetics_comps().size(); i++)
+	/*
+	 *   columns of the jacobian, on jacobian workers if KNOBS -jacobian_workers > 1
+	 */
+	if (!pThis->cvode_jacobian_workers(y, initial_rates, J))
 	{
-		cxxKineticsComp * kinetics_comp_i_ptr = &(kinetics_ptr->Get_kinetics_comps()[i]);
-		/* calculate reaction up to current time */
-		del = 1e-12;
-		pThis->cvode_error = TRUE;
-		count_cvode_errors = 0;
-		while (pThis->cvode_error == TRUE)
+		for (int i = 0; i < n_reactions; i++)
 		{
-			del /= 10.;
-			for (size_t j = 0; j < kinetics_ptr->Get_kinetics_comps().size(); j++)
-			{
-				cxxKineticsComp * kinetics_comp_j_ptr = &(kinetics_ptr->Get_kinetics_comps()[j]);
-				/*
-				   kinetics_ptr->comps[j].moles = y[j + 1];
-				   kinetics_ptr->comps[j].m = m_original[j] - y[j + 1];
-				 */
-				kinetics_comp_j_ptr->Set_moles(Ith(y, j + 1));
-				kinetics_comp_j_ptr->Set_m(pThis->m_original[j] - Ith(y, j + 1));
-				if (kinetics_comp_i_ptr->Get_m() < 0)
-				{
-					/*
-					   NOTE: y is not correct if it is greater than m_original
-					   However, it seems to work to let y wander off, but use
-					   .moles as the correct integral.
-					   It does not work to reset Y to m_original, presumably
-					   because the rational extrapolation gets screwed up.
-					 */
-
-					/*
-					   Ith(y,i + 1) = m_original[i];
-					 */
-					kinetics_comp_i_ptr->Set_moles(pThis->m_original[i]);
-					kinetics_comp_i_ptr->Set_m(0.0);
-				}
-			}
-
-			/* Add small amount of ith reaction */
-			kinetics_comp_i_ptr->Set_m(kinetics_comp_i_ptr->Get_m() - del);
-			if (kinetics_comp_i_ptr->Get_m() < 0)
-			{
-				kinetics_comp_i_ptr->Set_m(0);
-			}
-			kinetics_comp_i_ptr->Set_moles(kinetics_comp_i_ptr->Get_moles() + del);
-			pThis->calc_final_kinetic_reaction(kinetics_ptr);
-			if (pThis->use.Get_pp_assemblage_ptr() != NULL)
-			{
-				pThis->Rxn_pp_assemblage_map[pThis->cvode_pp_assemblage_save->Get_n_user()] = *pThis->cvode_pp_assemblage_save;
-				pThis->use.Set_pp_assemblage_ptr(Utilities::Rxn_find(pThis->Rxn_pp_assemblage_map, pThis->cvode_pp_assemblage_save->Get_n_user()));
-			}
-			if (pThis->set_and_run_wrapper
-				(n_user, FALSE, TRUE, n_user, step_fraction) == MASS_BALANCE)
-			{
-				count_cvode_errors++;
-				pThis->cvode_error = TRUE;
-				if (count_cvode_errors > 30)
-				{
-					initial_rates = (LDBLE *) pThis->free_check_null(initial_rates);
-					return;
-				}
-				pThis->run_reactions_iterations += pThis->iterations;
-				continue;
-			}
-			pThis->cvode_error = FALSE;
-			pThis->run_reactions_iterations += pThis->iterations;
-			/*kinetics_ptr->comps[i].moles -= del; */
-			for (size_t j = 0; j < kinetics_ptr->Get_kinetics_comps().size(); j++)
-			{
-				cxxKineticsComp * kinetics_comp_ptr = &(kinetics_ptr->Get_kinetics_comps()[j]);
-				kinetics_comp_ptr->Set_moles(0.0);
-			}
-			pThis->calc_kinetic_reaction(kinetics_ptr, 1.0);
-
-			/* calculate new rates for df/dy[i] */
-			/* dfdx[i + 1] = 0.0; */
-			for (size_t j = 0; j < kinetics_ptr->Get_kinetics_comps().size(); j++)
+			if (!pThis->cvode_jacobian_column(i, y, initial_rates, J))
 			{
-				cxxKineticsComp * kinetics_comp_ptr = &(kinetics_ptr->Get_kinetics_comps()[j]);
-				IJth(J, j + 1, i + 1) =
-					(kinetics_comp_ptr->Get_moles() - initial_rates[j]) / del;
+				initial_rates = (LDBLE *) pThis->free_check_null(initial_rates);
+				return;
 			}
 		}
 	}
@@ -3488,6 +3835,104 @@ Jac(integertype N, DenseMat J, RhsFn f, void *f_data,
 	return;
 }
 
+/* ---------------------------------------------------------------------- */
+bool Phreeqc::
+cvode_jacobian_column(int i, N_Vector y, const LDBLE *initial_rates, DenseMat J)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Calculates column i of the jacobian of the kinetic rates by adding a
+ *   small amount of reaction i to the reactants of cell cvode_n_user.
+ *   Returns false if the cell does not converge after 30 decrements of
+ *   the amount; cvode_error is TRUE in that case.
+ */
+	int count_cvode_errors;
+	int n_user = cvode_n_user;
+	LDBLE del;
+	LDBLE step_fraction = cvode_step_fraction;
+	cxxKinetics *kinetics_ptr = (cxxKinetics *) cvode_kinetics_ptr;
+
+	cxxKineticsComp * kinetics_comp_i_ptr = &(kinetics_ptr->Get_kinetics_comps()[i]);
+	/* calculate reaction up to current time */
+	del = 1e-12;
+	cvode_error = TRUE;
+	count_cvode_errors = 0;
+	while (cvode_error == TRUE)
+	{
+		del /= 10.;
+		for (size_t j = 0; j < kinetics_ptr->Get_kinetics_comps().size(); j++)
+		{
+			cxxKineticsComp * kinetics_comp_j_ptr = &(kinetics_ptr->Get_kinetics_comps()[j]);
+			/*
+			   kinetics_ptr->comps[j].moles = y[j + 1];
+			   kinetics_ptr->comps[j].m = m_original[j] - y[j + 1];
+			 */
+			kinetics_comp_j_ptr->Set_moles(Ith(y, j + 1));
+			kinetics_comp_j_ptr->Set_m(m_original[j] - Ith(y, j + 1));
+			if (kinetics_comp_i_ptr->Get_m() < 0)
+			{
+				/*
+				   NOTE: y is not correct if it is greater than m_original
+				   However, it seems to work to let y wander off, but use
+				   .moles as the correct integral.
+				   It does not work to reset Y to m_original, presumably
+				   because the rational extrapolation gets screwed up.
+				 */
+
+				/*
+				   Ith(y,i + 1) = m_original[i];
+				 */
+				kinetics_comp_i_ptr->Set_moles(m_original[i]);
+				kinetics_comp_i_ptr->Set_m(0.0);
+			}
+		}
+
+		/* Add small amount of ith reaction */
+		kinetics_comp_i_ptr->Set_m(kinetics_comp_i_ptr->Get_m() - del);
+		if (kinetics_comp_i_ptr->Get_m() < 0)
+		{
+			kinetics_comp_i_ptr->Set_m(0);
+		}
+		kinetics_comp_i_ptr->Set_moles(kinetics_comp_i_ptr->Get_moles() + del);
+		calc_final_kinetic_reaction(kinetics_ptr);
+		if (use.Get_pp_assemblage_ptr() != NULL)
+		{
+			Rxn_pp_assemblage_map[cvode_pp_assemblage_save->Get_n_user()] = *cvode_pp_assemblage_save;
+			use.Set_pp_assemblage_ptr(Utilities::Rxn_find(Rxn_pp_assemblage_map, cvode_pp_assemblage_save->Get_n_user()));
+		}
+		if (set_and_run_wrapper
+			(n_user, FALSE, TRUE, n_user, step_fraction) == MASS_BALANCE)
+		{
+			count_cvode_errors++;
+			cvode_error = TRUE;
+			if (count_cvode_errors > 30)
+			{
+				return false;
+			}
+			run_reactions_iterations += iterations;
+			continue;
+		}
+		cvode_error = FALSE;
+		run_reactions_iterations += iterations;
+		/*kinetics_ptr->comps[i].moles -= del; */
+		for (size_t j = 0; j < kinetics_ptr->Get_kinetics_comps().size(); j++)
+		{
+			cxxKineticsComp * kinetics_comp_ptr = &(kinetics_ptr->Get_kinetics_comps()[j]);
+			kinetics_comp_ptr->Set_moles(0.0);
+		}
+		calc_kinetic_reaction(kinetics_ptr, 1.0);
+
+		/* calculate new rates for df/dy[i] */
+		/* dfdx[i + 1] = 0.0; */
+		for (size_t j = 0; j < kinetics_ptr->Get_kinetics_comps().size(); j++)
+		{
+			cxxKineticsComp * kinetics_comp_ptr = &(kinetics_ptr->Get_kinetics_comps()[j]);
+			IJth(J, j + 1, i + 1) =
+				(kinetics_comp_ptr->Get_moles() - initial_rates[j]) / del;
+		}
+	}
+	return true;
+}
 void Phreeqc::
 cvode_init(void)
 {
@@ -3510,6 +3955,20 @@ cvode_init(void)
 	cvode_ss_assemblage_save = NULL;
 	return;
 }
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+cvode_statistics_add(const long int *iopt)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Adds the counters of a CVODE integration, read from iopt before the
+ *   problem memory is freed, to the statistics of the run
+ */
+	cvode_integrations++;
+	cvode_steps_taken += (int) iopt[NST];
+	cvode_rhs_evaluations += (int) iopt[NFE];
+	cvode_jacobian_evaluations += (int) iopt[DENSE_NJE];
+}
 bool Phreeqc::
 cvode_update_reactants(int i, int nsaver, bool save_it)
 {
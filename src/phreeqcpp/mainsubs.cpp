@@ -592,6 +592,7 @@ initial_solutions(int print)
  *   Go through list of solutions, make initial solution calculations
  *   for any marked "new".
  */
+	ProfilerScope profiler_scope(profiler, "initial_solutions");
 	int converge, converge1;
 	int last, n_user, print1;
 	char token[2 * MAX_LENGTH];
@@ -739,6 +740,7 @@ initial_exchangers(int print)
  *   for any marked "new" that are defined to be in equilibrium with a
  *   solution.
  */
+	ProfilerScope profiler_scope(profiler, "initial_exchangers");
 	int i, converge, converge1;
 	int last, n_user, print1;
 	char token[2 * MAX_LENGTH];
@@ -826,6 +828,7 @@ initial_gas_phases(int print)
  *   for any marked "new" that are defined to be in equilibrium with a
  *   solution.
  */
+	ProfilerScope profiler_scope(profiler, "initial_gas_phases");
 	int converge, converge1;
 	int last, n_user, print1;
 	char token[2 * MAX_LENGTH];
@@ -952,6 +955,7 @@ initial_surfaces(int print)
  *   for any marked "new" that are defined to be in equilibrium with a
  *   solution.
  */
+	ProfilerScope profiler_scope(profiler, "initial_surfaces");
 	int last, n_user, print1;
 
 	state = INITIAL_SURFACE;
@@ -1030,6 +1034,7 @@ reactions(void)
  *      mixture,
  *      or irreversible reaction.
  */
+	ProfilerScope profiler_scope(profiler, "reactions");
 	int count_steps, use_mix;
 	char token[2 * MAX_LENGTH];
 	struct save save_data;
@@ -2402,6 +2407,7 @@ int Phreeqc::
 read_database(void)
 /* ---------------------------------------------------------------------- */
 {
+	ProfilerScope profiler_scope(profiler, "read_database");
 	simulation = 0;
 
 /*
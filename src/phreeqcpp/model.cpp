@@ -37,11 +37,13 @@ model(void)
  *	  An additional pass through may be needed if unstable phases still exist
  *		 in the phase assemblage.
  */
+	ProfilerScope profiler_scope(profiler, "model");
 	int l_kode, return_kode;
 	int r;
 	int count_infeasible, count_basis_change;
 	int debug_model_save;
 	int mass_water_switch_save;
+	LDBLE t0;
 
 	set_inert_moles();
 /*	debug_model = TRUE; */
@@ -125,6 +127,7 @@ model(void)
 /*
  *   Calculate jacobian
  */
+			t0 = solver_time();
 			if (state >= REACTION && numerical_deriv)
 			{
 				//jacobian_sums();
@@ -136,11 +139,13 @@ model(void)
 				numerical_jacobian();
 
 			}
+			solver_stats_x.time_jacobian += solver_time() - t0;
 /*
  *   Full matrix with pure phases
  */
 			if (r == OK || remove_unstable_phases == TRUE)
 			{
+				t0 = solver_time();
 				return_kode = ineq(l_kode);
 				if (return_kode != OK)
 				{
@@ -160,11 +165,15 @@ model(void)
 				{
 					ineq(0);
 				}
+				solver_stats_x.time_ineq += solver_time() - t0;
 				reset();
 			}
+			t0 = solver_time();
 			gammas(mu_x);
+			solver_stats_x.time_gammas += solver_time() - t0;
 			if (molalities(FALSE) == ERROR)
 			{
+				solver_stats_x.overflows++;
 				revise_guesses();
 /*				adjust_step_size(); */
 			}
@@ -183,7 +192,9 @@ model(void)
 			{
 				count_basis_change++;
 				reprep();
+				t0 = solver_time();
 				gammas(mu_x);
+				solver_stats_x.time_gammas += solver_time() - t0;
 				molalities(TRUE);
 				if (use.Get_surface_ptr() != NULL &&
 					use.Get_surface_ptr()->Get_dl_type() != cxxSurface::NO_DL &&
@@ -244,6 +255,9 @@ model(void)
 	log_msg(sformatf( "Number of basis changes: %d\n\n",
 			   count_basis_change));
 	log_msg(sformatf( "Number of iterations: %d\n\n", iterations));
+	solver_stats_x.infeasible += count_infeasible;
+	solver_stats_x.basis_changes += count_basis_change;
+	solver_stats_x.iterations += iterations;
 	debug_model = debug_model_save;
 	set_forward_output_to_log(FALSE);
 	unset_inert_moles();
@@ -1795,12 +1809,26 @@ ineq(int in_kode)
 	memcpy((void *) &(slnq_delta1[0]), (void *) &(zero[0]),
 		   (size_t) max_column_count * sizeof(LDBLE));
 #endif
+/*
+ *   Square system of equalities only, solve by sparse LU if requested
+ */
+	if (sparse_solver == TRUE && k == 0 && m == 0 && l == n &&
+		sparse_lu_solve(n, ineq_array, l_n2d, back_eq, delta1) == OK)
+	{
+		solver_stats_x.sparse_solves++;
+		l_kode = 0;
+		l_iter = 0;
+		l_error = 0.0;
+	}
+	else
+	{
 /*
  *   Call CL1
  */
-	cl1(k, l, m, n,
-		l_nklmd, l_n2d, ineq_array,
-		&l_kode, ineq_tol, &l_iter, delta1, res, &l_error, cu, iu, is, FALSE);
+		cl1(k, l, m, n,
+			l_nklmd, l_n2d, ineq_array,
+			&l_kode, ineq_tol, &l_iter, delta1, res, &l_error, cu, iu, is, FALSE);
+	}
 /*   Set return_kode */
 	if (l_kode == 1)
 	{
@@ -1949,7 +1977,7 @@ jacobian_sums(void)
 {
 /*
  *   Fills in jacobian array, uses arrays sum_jacob0, sum_jacob1, and
- *   sum_jacob2.
+ *   sum_jacob2, or the rows compiled from them in build_sum_rows.
  */
 	int i, j, k;
 	LDBLE sinh_constant;
@@ -1966,25 +1994,44 @@ jacobian_sums(void)
 			   (void *) &(my_array[0]), (size_t) count_unknowns * sizeof(LDBLE));
 	}
 /*
- *   Add constant terms
+ *   Reused model, add terms, one row of jacob_term_* for each element of my_array
  */
-	for (k = 0; k < count_sum_jacob0; k++)
+	if (sum_rows_built)
 	{
-		*sum_jacob0[k].target += sum_jacob0[k].coef;
+		gather_s_x_state();
+		for (i = 0; i < (int) jacob_row_target.size(); i++)
+		{
+			LDBLE sum = my_array[jacob_row_target[i]];
+			for (k = jacob_row_start[i]; k < jacob_row_start[i + 1]; k++)
+			{
+				sum += *jacob_term_source[k] * jacob_term_coef[k];
+			}
+			my_array[jacob_row_target[i]] = sum;
+		}
 	}
+	else
+	{
+/*
+ *   Add constant terms
+ */
+		for (k = 0; k < count_sum_jacob0; k++)
+		{
+			*sum_jacob0[k].target += sum_jacob0[k].coef;
+		}
 /*
  *   Add terms with coefficients of 1.0
  */
-	for (k = 0; k < count_sum_jacob1; k++)
-	{
-		*sum_jacob1[k].target += *sum_jacob1[k].source;
-	}
+		for (k = 0; k < count_sum_jacob1; k++)
+		{
+			*sum_jacob1[k].target += *sum_jacob1[k].source;
+		}
 /*
  *   Add terms with coefficients != 1.0
  */
-	for (k = 0; k < count_sum_jacob2; k++)
-	{
-		*sum_jacob2[k].target += *sum_jacob2[k].source * sum_jacob2[k].coef;
+		for (k = 0; k < count_sum_jacob2; k++)
+		{
+			*sum_jacob2[k].target += *sum_jacob2[k].source * sum_jacob2[k].coef;
+		}
 	}
 /*
  *   Make final adustments to jacobian array
@@ -2135,7 +2182,8 @@ mb_sums(void)
  *   and pure_phases. After this routine total calcium calculated from all
  *   calcium species in solution is stored in x[i]->f.  Also calculates
  *   x[i]->sum for some types of unknowns. Uses arrays sum_mb1 and
- *   sum_mb1, which are generated in prep and reprep.
+ *   sum_mb2, which are generated in prep and reprep, or the rows
+ *   compiled from them in build_sum_rows.
  */
 	int k;
 /*
@@ -2146,6 +2194,23 @@ mb_sums(void)
 		x[k]->f = 0.0;
 		x[k]->sum = 0.0;
 	}
+/*
+ *   Reused model, add terms, one row of mb_term_* for each target
+ */
+	if (sum_rows_built)
+	{
+		gather_s_x_state();
+		for (size_t i = 0; i < mb_row_target.size(); i++)
+		{
+			LDBLE sum = *mb_row_target[i];
+			for (k = mb_row_start[i]; k < mb_row_start[i + 1]; k++)
+			{
+				sum += *mb_term_source[k] * mb_term_coef[k];
+			}
+			*mb_row_target[i] = sum;
+		}
+		return (OK);
+	}
 /*
  *   Add terms with coefficients of 1.0
  */
@@ -2369,7 +2434,6 @@ molalities(int allow_overflow)
  */
 	int i, j;
 	LDBLE total_g;
-	struct rxn_token *rxn_ptr;
 /*
  *   la for master species
  */
@@ -2391,45 +2455,38 @@ molalities(int allow_overflow)
 		s_h2o->tot_g_moles = s_h2o->moles;
 		s_h2o->tot_dh2o_moles = 0.0;
 	}
+	for (i = 0; i < (int) rxn_x_master.size(); i++)
+	{
+		rxn_x_la[i] = rxn_x_master[i]->la;
+	}
 	for (i = 0; i < count_s_x; i++)
 	{
-		if (s_x[i]->type > HPLUS && s_x[i]->type != EX
-			&& s_x[i]->type != SURF)
+		struct species *s_ptr = s_x[i];
+		if (s_ptr->type > HPLUS && s_ptr->type != EX
+			&& s_ptr->type != SURF)
 			continue;
 /*
  *   lm and moles for all aqueous species
  */
-		s_x[i]->lm = s_x[i]->lk - s_x[i]->lg;
-		for (rxn_ptr = s_x[i]->rxn_x->token + 1; rxn_ptr->s != NULL;
-			 rxn_ptr++)
-		{
-			s_x[i]->lm += rxn_ptr->s->la * rxn_ptr->coef;
-			/*
-			if (isnan(rxn_ptr->s->la))
-			{
-				fprintf(stderr,"molalities la %s %e\n", rxn_ptr->s->name, rxn_ptr->s->la);
-			}
-			*/
-		}
-		if (s_x[i]->type == EX)
+		LDBLE lm = s_ptr->lk - s_ptr->lg;
+		for (j = rxn_x_start[i]; j < rxn_x_start[i + 1]; j++)
 		{
-			s_x[i]->moles = Utilities::safe_exp(s_x[i]->lm * LOG_10);
-
+			lm += rxn_x_la[rxn_x_col[j]] * rxn_x_coef[j];
 		}
-		else if (s_x[i]->type == SURF)
+		s_ptr->lm = lm;
+		if (s_ptr->type == EX || s_ptr->type == SURF)
 		{
-			s_x[i]->moles = Utilities::safe_exp(s_x[i]->lm * LOG_10);
-
+			s_ptr->moles = Utilities::safe_exp(lm * LOG_10);
 		}
 		else
 		{
-			s_x[i]->moles = under(s_x[i]->lm) * mass_water_aq_x;
-			if (s_x[i]->moles / mass_water_aq_x > 100)
+			s_ptr->moles = under(lm) * mass_water_aq_x;
+			if (s_ptr->moles / mass_water_aq_x > 100)
 			{
 				log_msg(sformatf( "Overflow: %s\t%e\t%e\t%d\n",
-						   s_x[i]->name,
-						   (double) (s_x[i]->moles / mass_water_aq_x),
-						   (double) s_x[i]->lm, iterations));
+						   s_ptr->name,
+						   (double) (s_ptr->moles / mass_water_aq_x),
+						   (double) lm, iterations));
 
 				if (iterations >= 0 && allow_overflow == FALSE)
 				{
@@ -2856,6 +2913,7 @@ calc_gas_pressures(void)
 				{
 					//V_m *= 1; /* debug */
 					numerical_fixed_volume = true;
+					solver_stats_x.numerical_switches++;
 					//switch_numerical = true;
 					warning_msg
 						("Numerical method failed, switching to numerical derivatives.");
@@ -3543,6 +3601,8 @@ reset(void)
 				   (double) sum_deltas));
 		output_msg(sformatf( "Factor: %12.4e\n", (double) factor));
 	}
+	if (factor > 1.0)
+		solver_stats_x.step_cuts++;
 	factor = 1.0 / factor;
 
 	for (i = 0; i < count_unknowns; i++)
@@ -4826,6 +4886,8 @@ set(int initial)
 	s_hplus->lm = s_hplus->la;
 	s_hplus->moles = exp(s_hplus->lm * LOG_10) * mass_water_aq_x;
 	s_eminus->la = -solution_ptr->Get_pe();
+	if (cell_guess_ptr != NULL)
+		cell_guess_apply();
 	if (initial == TRUE)
 		initial_guesses();
 	if (dl_type_x != cxxSurface::NO_DL)
@@ -5406,6 +5468,7 @@ free_model_allocs(void)
 	residual = (LDBLE *) free_check_null(residual);
 	s_x = (struct species **) free_check_null(s_x);
 	count_s_x = 0;
+	build_rxn_x_rows();
 	sum_mb1 = (struct list1 *) free_check_null(sum_mb1);
 	count_sum_mb1 = 0;
 	sum_mb2 = (struct list2 *) free_check_null(sum_mb2);
@@ -5418,6 +5481,7 @@ free_model_allocs(void)
 	count_sum_jacob2 = 0;
 	sum_delta = (struct list2 *) free_check_null(sum_delta);
 	count_sum_delta = 0;
+	sum_rows_built = false;
 	return (OK);
 }
 
@@ -5560,8 +5624,7 @@ numerical_jacobian(void)
 /* ---------------------------------------------------------------------- */
 {
 	LDBLE *base;
-	LDBLE d, d1, d2;
-	int i, j;
+	int i;
 	cxxGasPhase *gas_phase_ptr = use.Get_gas_phase_ptr();
 	if (!
 		(numerical_deriv ||
@@ -5597,208 +5660,237 @@ numerical_jacobian(void)
 	{
 		base[i] = residual[i];
 	}
+	if (!numerical_jacobian_workers(base))
+	{
+		for (i = 0; i < count_unknowns; i++)
+		{
+			numerical_jacobian_column(i, base, my_array);
+		}
+	}
+	molalities(TRUE);
+	mb_sums();
+	mb_gases();
+	mb_ss();
+	residuals();
+	free_check_null(base);
+	calculating_deriv = FALSE;
+	return OK;
+}
+
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+numerical_jacobian_column(int i, const LDBLE *base, LDBLE *l_array)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Perturbs unknown i, stores the changes of the residuals from base in
+ *   column i of l_array and restores unknown i.  The perturbed value is
+ *   saved and put back, not recomputed by subtraction, so that every
+ *   column starts from the same state, whether the columns are calculated
+ *   in turn or on jacobian workers.
+ */
+	LDBLE d, d1, d2;
+	LDBLE value_save = 0.0, bulk_save = mass_water_bulk_x;
+	int j;
+
 	d = 0.0001;
 	d1 = d * LOG_10;
 	d2 = 0;
-	for (i = 0; i < count_unknowns; i++)
-	{
-		switch (x[i]->type)
-		{
-		case MB:
-		case ALK:
-		case CB:
-		case SOLUTION_PHASE_BOUNDARY:
-		case EXCH:
-		case SURFACE:
-		case SURFACE_CB:
-		case SURFACE_CB1:
-		case SURFACE_CB2:
-			x[i]->master[0]->s->la += d;
-			d2 = d * LOG_10;
-			break;
-		case MH:
-			s_eminus->la += d;
-			d2 = d * LOG_10;
-			break;
-		case AH2O:
-			x[i]->master[0]->s->la += d;
-			d2 = d * LOG_10;
-			break;
-		case PITZER_GAMMA:
-			x[i]->s->lg += d;
-			d2 = d;
-			break;
-		case MH2O:
-			//mass_water_aq_x *= (1 + d);
-			//x[i]->master[0]->s->moles = mass_water_aq_x / gfw_water;
-			//d2 = log(1.0 + d);
-			//break;
-			// DL_pitz
-			d1 = mass_water_aq_x * d;
-			mass_water_aq_x += d1;
-			if (use.Get_surface_in() && dl_type_x == cxxSurface::DONNAN_DL)
-				mass_water_bulk_x += d1;
-			x[i]->master[0]->s->moles = mass_water_aq_x / gfw_water;
-			d2 = d1;
-			break;
-		case MU:
-			d2 = d * mu_x;
-			mu_x += d2;
-			gammas(mu_x);
-			break;
-		case PP:
-			for (j = 0; j < count_unknowns; j++)
-			{
-				delta[j] = 0.0;
-			}
-			d2 = -1e-8;
-			delta[i] = d2;
-			reset();
-			d2 = delta[i];
-			break;
-		case SS_MOLES:
-			if (x[i]->ss_in == FALSE)
-				continue;
-			for (j = 0; j < count_unknowns; j++)
-			{
-				delta[j] = 0.0;
-			}
-			/*d2 = -1e-8; */
-			d2 = d * 10 * x[i]->moles;
-			//d2 = -.1 * x[i]->moles;
-			/*
-			   if (d2 > -1e-10) d2 = -1e-10;
-			   calculating_deriv = FALSE;
-			 */
-			delta[i] = d2;
-			/*fprintf (stderr, "delta before reset %e\n", delta[i]); */
-			reset();
-			d2 = delta[i];
-			/*fprintf (stderr, "delta after reset %e\n", delta[i]); */
-			break;
-		case GAS_MOLES:
-			if (gas_in == FALSE)
-				continue;
-
-			d2 = d * x[i]->moles;
-			if (d2 < 1e-14)
-				d2 = 1e-14;
-			x[i]->moles += d2;
-			break;
+	switch (x[i]->type)
+	{
+	case MB:
+	case ALK:
+	case CB:
+	case SOLUTION_PHASE_BOUNDARY:
+	case EXCH:
+	case SURFACE:
+	case SURFACE_CB:
+	case SURFACE_CB1:
+	case SURFACE_CB2:
+		value_save = x[i]->master[0]->s->la;
+		x[i]->master[0]->s->la += d;
+		d2 = d * LOG_10;
+		break;
+	case MH:
+		value_save = s_eminus->la;
+		s_eminus->la += d;
+		d2 = d * LOG_10;
+		break;
+	case AH2O:
+		value_save = x[i]->master[0]->s->la;
+		x[i]->master[0]->s->la += d;
+		d2 = d * LOG_10;
+		break;
+	case PITZER_GAMMA:
+		value_save = x[i]->s->lg;
+		x[i]->s->lg += d;
+		d2 = d;
+		break;
+	case MH2O:
+		//mass_water_aq_x *= (1 + d);
+		//x[i]->master[0]->s->moles = mass_water_aq_x / gfw_water;
+		//d2 = log(1.0 + d);
+		//break;
+		// DL_pitz
+		value_save = mass_water_aq_x;
+		d1 = mass_water_aq_x * d;
+		mass_water_aq_x += d1;
+		if (use.Get_surface_in() && dl_type_x == cxxSurface::DONNAN_DL)
+			mass_water_bulk_x += d1;
+		x[i]->master[0]->s->moles = mass_water_aq_x / gfw_water;
+		d2 = d1;
+		break;
+	case MU:
+		value_save = mu_x;
+		d2 = d * mu_x;
+		mu_x += d2;
+		gammas(mu_x);
+		break;
+	case PP:
+		for (j = 0; j < count_unknowns; j++)
+		{
+			delta[j] = 0.0;
 		}
-		molalities(TRUE);
-		mb_sums();
+		d2 = -1e-8;
+		delta[i] = d2;
+		reset();
+		d2 = delta[i];
+		break;
+	case SS_MOLES:
+		if (x[i]->ss_in == FALSE)
+			return (OK);
+		for (j = 0; j < count_unknowns; j++)
+		{
+			delta[j] = 0.0;
+		}
+		/*d2 = -1e-8; */
+		d2 = d * 10 * x[i]->moles;
+		//d2 = -.1 * x[i]->moles;
 		/*
-		   mb_ss();
-		   mb_gases();
+		   if (d2 > -1e-10) d2 = -1e-10;
+		   calculating_deriv = FALSE;
 		 */
-		residuals();
-		//output_msg(sformatf( "%d\n", i));
-		for (j = 0; j < count_unknowns; j++)
+		delta[i] = d2;
+		/*fprintf (stderr, "delta before reset %e\n", delta[i]); */
+		reset();
+		d2 = delta[i];
+		/*fprintf (stderr, "delta after reset %e\n", delta[i]); */
+		break;
+	case GAS_MOLES:
+		if (gas_in == FALSE)
+			return (OK);
+
+		value_save = x[i]->moles;
+		d2 = d * x[i]->moles;
+		if (d2 < 1e-14)
+			d2 = 1e-14;
+		x[i]->moles += d2;
+		break;
+	}
+	molalities(TRUE);
+	mb_sums();
+	/*
+	   mb_ss();
+	   mb_gases();
+	 */
+	residuals();
+	//output_msg(sformatf( "%d\n", i));
+	for (j = 0; j < count_unknowns; j++)
+	{
+		// avoid overflow
+		if (residual[j] > 1.0e101)
 		{
-			// avoid overflow
-			if (residual[j] > 1.0e101)
-			{
-			  LDBLE t = (LDBLE) pow((LDBLE) 10.0, (LDBLE) (DBL_MAX_10_EXP - 50.0));
-				if (residual[j]  > t)
-				{
-					my_array[j * (count_unknowns + 1) + i] = -pow(10.0, DBL_MAX_10_EXP - 50.0);
-				}
-				else
-				{
-					my_array[j * (count_unknowns + 1) + i] = -(residual[j] - base[j]) / d2;
-					if (x[i]->type == MH2O) // DL_pitz
-						my_array[j * (count_unknowns + 1) + i] *= mass_water_aq_x;
-				}
-			}
-			else if (residual[j] < -1.0e101)
+		  LDBLE t = (LDBLE) pow((LDBLE) 10.0, (LDBLE) (DBL_MAX_10_EXP - 50.0));
+			if (residual[j]  > t)
 			{
-				LDBLE t = pow((LDBLE) 10.0, (LDBLE) (DBL_MIN_10_EXP + 50.0));
-				if (residual[j]  < -t)
-				{
-					my_array[j * (count_unknowns + 1) + i] = pow(10.0, DBL_MIN_10_EXP + 50.0);
-				}
-				else
-				{
-					my_array[j * (count_unknowns + 1) + i] = -(residual[j] - base[j]) / d2;
-					if (x[i]->type == MH2O) // DL_pitz
-						my_array[j * (count_unknowns + 1) + i] *= mass_water_aq_x;
-				}
+				l_array[j * (count_unknowns + 1) + i] = -pow(10.0, DBL_MAX_10_EXP - 50.0);
 			}
 			else
 			{
-				my_array[j * (count_unknowns + 1) + i] = -(residual[j] - base[j]) / d2;
+				l_array[j * (count_unknowns + 1) + i] = -(residual[j] - base[j]) / d2;
 				if (x[i]->type == MH2O) // DL_pitz
-					my_array[j * (count_unknowns + 1) + i] *= mass_water_aq_x;
-				if (!PHR_ISFINITE(my_array[j * (count_unknowns + 1) + i]))
-				{
-					//fprintf(stderr, "oops, got NaN: %e, %e, %e, %e\n", residual[j], base[j], d2, array[j * (count_unknowns + 1) + i]);
-				}
+					l_array[j * (count_unknowns + 1) + i] *= mass_water_aq_x;
 			}
-
-			//output_msg(sformatf( "\t%d %e %e %e %e\n", j, array[j*(count_unknowns + 1) + i] , residual[j], base[j], d2));
 		}
-		switch (x[i]->type)
+		else if (residual[j] < -1.0e101)
 		{
-		case MB:
-		case ALK:
-		case CB:
-		case SOLUTION_PHASE_BOUNDARY:
-		case EXCH:
-		case SURFACE:
-		case SURFACE_CB:
-		case SURFACE_CB1:
-		case SURFACE_CB2:
-		case AH2O:
-			x[i]->master[0]->s->la -= d;
-			break;
-		case MH:
-			s_eminus->la -= d;
-			if (my_array[i * (count_unknowns + 1) + i] == 0)
+			LDBLE t = pow((LDBLE) 10.0, (LDBLE) (DBL_MIN_10_EXP + 50.0));
+			if (residual[j]  < -t)
 			{
-				/*output_msg(sformatf( "Zero diagonal for MH\n")); */
-				my_array[i * (count_unknowns + 1) + i] =
-				  under(s_h2->lm) * 2;
+				l_array[j * (count_unknowns + 1) + i] = pow(10.0, DBL_MIN_10_EXP + 50.0);
+			}
+			else
+			{
+				l_array[j * (count_unknowns + 1) + i] = -(residual[j] - base[j]) / d2;
+				if (x[i]->type == MH2O) // DL_pitz
+					l_array[j * (count_unknowns + 1) + i] *= mass_water_aq_x;
 			}
-			break;
-		case PITZER_GAMMA:
-			x[i]->s->lg -= d;
-			break;
-		case MH2O:
-			//mass_water_aq_x /= (1 + d);
-			//x[i]->master[0]->s->moles = mass_water_aq_x / gfw_water;
-			//break;
-			//DL_pitz
-			mass_water_aq_x -= d1;
-			if (use.Get_surface_in() && dl_type_x == cxxSurface::DONNAN_DL)
-				mass_water_bulk_x -= d1;
-			x[i]->master[0]->s->moles = mass_water_aq_x / gfw_water;
-			break;
-		case MU:
-			mu_x -= d2;
-			gammas(mu_x);
-			break;
-		case PP:
-			delta[i] = -d2;
-			reset();
-			break;
-		case SS_MOLES:
-			delta[i] = -d2;
-			reset();
-			break;
-		case GAS_MOLES:
-			x[i]->moles -= d2;
-			break;
 		}
+		else
+		{
+			l_array[j * (count_unknowns + 1) + i] = -(residual[j] - base[j]) / d2;
+			if (x[i]->type == MH2O) // DL_pitz
+				l_array[j * (count_unknowns + 1) + i] *= mass_water_aq_x;
+			if (!PHR_ISFINITE(l_array[j * (count_unknowns + 1) + i]))
+			{
+				//fprintf(stderr, "oops, got NaN: %e, %e, %e, %e\n", residual[j], base[j], d2, array[j * (count_unknowns + 1) + i]);
+			}
+		}
+
+		//output_msg(sformatf( "\t%d %e %e %e %e\n", j, array[j*(count_unknowns + 1) + i] , residual[j], base[j], d2));
+	}
+	switch (x[i]->type)
+	{
+	case MB:
+	case ALK:
+	case CB:
+	case SOLUTION_PHASE_BOUNDARY:
+	case EXCH:
+	case SURFACE:
+	case SURFACE_CB:
+	case SURFACE_CB1:
+	case SURFACE_CB2:
+	case AH2O:
+		x[i]->master[0]->s->la = value_save;
+		break;
+	case MH:
+		s_eminus->la = value_save;
+		if (l_array[i * (count_unknowns + 1) + i] == 0)
+		{
+			/*output_msg(sformatf( "Zero diagonal for MH\n")); */
+			l_array[i * (count_unknowns + 1) + i] =
+			  under(s_h2->lm) * 2;
+		}
+		break;
+	case PITZER_GAMMA:
+		x[i]->s->lg = value_save;
+		break;
+	case MH2O:
+		//mass_water_aq_x /= (1 + d);
+		//x[i]->master[0]->s->moles = mass_water_aq_x / gfw_water;
+		//break;
+		//DL_pitz
+		mass_water_aq_x = value_save;
+		mass_water_bulk_x = bulk_save;
+		x[i]->master[0]->s->moles = mass_water_aq_x / gfw_water;
+		break;
+	case MU:
+		mu_x = value_save;
+		gammas(mu_x);
+		break;
+	case PP:
+		delta[i] = -d2;
+		reset();
+		break;
+	case SS_MOLES:
+		delta[i] = -d2;
+		reset();
+		break;
+	case GAS_MOLES:
+		x[i]->moles = value_save;
+		break;
 	}
-	molalities(TRUE);
-	mb_sums();
-	mb_gases();
-	mb_ss();
-	residuals();
-	free_check_null(base);
-	calculating_deriv = FALSE;
-	return OK;
+	return (OK);
 }
 
 /* ---------------------------------------------------------------------- */
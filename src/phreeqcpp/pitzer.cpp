@@ -4,6 +4,13 @@
 #include "Solution.h"
 #define PITZER_LISTS
 #define PITZER
+/* kernels of pitzer_kernels */
+#define PZK_PAIR   0
+#define PZK_C0     1
+#define PZK_B      2
+#define PZK_ETHETA 3
+#define PZK_TRIPLE 4
+#define PZK_COUNT  5
 
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
@@ -810,6 +817,7 @@ C
 	{
 		calc_pitz_param(mcc0, TK, TR);
 	}
+	pitzer_kernels();
 #endif
 	calc_dielectrics(TK - 273.15, patm_x);
 	OTEMP = TK;
@@ -1334,132 +1342,92 @@ pitzer(void)
 	{
 		for (i = 0; i < count_theta_param; i++)
 		{
+			/* same charges, ionic strength and A0 give the same values */
+			etheta_calls++;
+			if (theta_params[i]->I == I && theta_params[i]->A0 == A0)
+			{
+				etheta_hits++;
+				continue;
+			}
 			z0 = theta_params[i]->zj;
 			z1 = theta_params[i]->zk;
 			ETHETAS(z0, z1, I, &etheta, &ethetap);
 			theta_params[i]->etheta = etheta;
 			theta_params[i]->ethetap = ethetap;
+			theta_params[i]->I = I;
+			theta_params[i]->A0 = A0;
 		}
 	}
 	/*
-	 *  Sums for F, LGAMMA, and OSMOT
+	 *  Sums for F, LGAMMA, and OSMOT, by kernel
 	 */
- 	for (size_t j = 0; j < param_list.size(); j++)
- 	{
- 		int i = param_list[j];
-		i0 = pitz_params[i]->ispec[0];
-		i1 = pitz_params[i]->ispec[1];
-		z0 = spec[i0]->z;
-		z1 = spec[i1]->z;
-		param = pitz_params[i]->p;
-		l_alpha = pitz_params[i]->alpha;
-		F_var = 0;
-		switch (pitz_params[i]->type)
-		{
-		case TYPE_B0:
-			LGAMMA[i0] += M[i1] * 2.0 * param;
-			LGAMMA[i1] += M[i0] * 2.0 * param;
-			OSMOT += M[i0] * M[i1] * param;
-			break;
-		case TYPE_B1:
-			if (param != 0.0)
-			{
-				F_var = M[i0] * M[i1] * param * GP(l_alpha * DI) / I;
-				LGAMMA[i0] += M[i1] * 2.0 * param * G(l_alpha * DI);
-				LGAMMA[i1] += M[i0] * 2.0 * param * G(l_alpha * DI);
-				OSMOT += M[i0] * M[i1] * param * exp(-l_alpha * DI);
-			}
-			break;
-		case TYPE_B2:
-			if (param != 0.0)
-			{
-				F_var = M[i0] * M[i1] * param * GP(l_alpha * DI) / I;
-				LGAMMA[i0] += M[i1] * 2.0 * param * G(l_alpha * DI);
-				LGAMMA[i1] += M[i0] * 2.0 * param * G(l_alpha * DI);
-				OSMOT += M[i0] * M[i1] * param * exp(-l_alpha * DI);
-			}
-			break;
-		case TYPE_C0:
-			CSUM +=
-				M[i0] * M[i1] * pitz_params[i]->p / (2.0 *
-													 sqrt(fabs(z0 * z1)));
-			LGAMMA[i0] += M[i1] * BIGZ * param / (2.0 * sqrt(fabs(z0 * z1)));
-			LGAMMA[i1] += M[i0] * BIGZ * param / (2.0 * sqrt(fabs(z0 * z1)));
-			OSMOT +=
-				M[i0] * M[i1] * BIGZ * param / (2.0 * sqrt(fabs(z0 * z1)));
-			break;
-		case TYPE_THETA:
-			LGAMMA[i0] += 2.0 * M[i1] * (param /*+ ETHETA(z0, z1, I) */ );
-			LGAMMA[i1] += 2.0 * M[i0] * (param /*+ ETHETA(z0, z1, I) */ );
-			OSMOT += M[i0] * M[i1] * param;
-			break;
-		case TYPE_ETHETA:
-			/*
-			   ETHETAS(z0, z1, I, &etheta, &ethetap);
-			 */
-			if (use_etheta == TRUE)
-			{
-				etheta = pitz_params[i]->thetas->etheta;
-				ethetap = pitz_params[i]->thetas->ethetap;
-				F_var = M[i0] * M[i1] * ethetap;
-				LGAMMA[i0] += 2.0 * M[i1] * etheta;
-				LGAMMA[i1] += 2.0 * M[i0] * etheta;
-				OSMOT += M[i0] * M[i1] * (etheta + I * ethetap);
-			}
-			break;
-		case TYPE_PSI:
-			i2 = pitz_params[i]->ispec[2];
-			if (IPRSNT[i2] == FALSE)
-				continue;
-			LGAMMA[i0] += M[i1] * M[i2] * param;
-			LGAMMA[i1] += M[i0] * M[i2] * param;
-			LGAMMA[i2] += M[i0] * M[i1] * param;
-			OSMOT += M[i0] * M[i1] * M[i2] * param;
-			break;
-		case TYPE_LAMDA:
-			LGAMMA[i0] += M[i1] * param * pitz_params[i]->ln_coef[0];
-			LGAMMA[i1] += M[i0] * param * pitz_params[i]->ln_coef[1];
-			OSMOT += M[i0] * M[i1] * param * pitz_params[i]->os_coef;
-			break;
-		case TYPE_ZETA:
-			i2 = pitz_params[i]->ispec[2];
-			if (IPRSNT[i2] == FALSE)
-				continue;
-			LGAMMA[i0] += M[i1] * M[i2] * param;
-			LGAMMA[i1] += M[i0] * M[i2] * param;
-			LGAMMA[i2] += M[i0] * M[i1] * param;
-			OSMOT += M[i0] * M[i1] * M[i2] * param;
-			break;
-		case TYPE_MU:
-			i2 = pitz_params[i]->ispec[2];
-			if (IPRSNT[i2] == FALSE)
-				continue;
-
-			LGAMMA[i0] += M[i1] * M[i2] * param * pitz_params[i]->ln_coef[0];
-			LGAMMA[i1] += M[i0] * M[i2] * param * pitz_params[i]->ln_coef[1];
-			LGAMMA[i2] += M[i0] * M[i1] * param * pitz_params[i]->ln_coef[2];
-			OSMOT += M[i0] * M[i1] * M[i2] * param * pitz_params[i]->os_coef;
-			break;
-		case TYPE_ETA:
-			i2 = pitz_params[i]->ispec[2];
-			if (IPRSNT[i2] == FALSE)
-				continue;
-			LGAMMA[i0] += M[i1] * M[i2] * param;
-			LGAMMA[i1] += M[i0] * M[i2] * param;
-			LGAMMA[i2] += M[i0] * M[i1] * param;
-			OSMOT += M[i0] * M[i1] * M[i2] * param;
-			break;
-		case TYPE_ALPHAS:
-			break;
-		case TYPE_Other:
-		default:
-			error_msg("TYPE_Other in pitz_param list.", STOP);
-			break;
-		}
-		F += F_var;
-		F1 += F_var;
-		F2 += F_var;
+	const int *k_i0 = pzk_i0.empty() ? NULL : &pzk_i0[0];
+	const int *k_i1 = pzk_i1.empty() ? NULL : &pzk_i1[0];
+	const int *k_i2 = pzk_i2.empty() ? NULL : &pzk_i2[0];
+	const LDBLE *k_lg0 = pzk_lg0.empty() ? NULL : &pzk_lg0[0];
+	const LDBLE *k_lg1 = pzk_lg1.empty() ? NULL : &pzk_lg1[0];
+	const LDBLE *k_lg2 = pzk_lg2.empty() ? NULL : &pzk_lg2[0];
+	const LDBLE *k_os = pzk_os.empty() ? NULL : &pzk_os[0];
+	int k;
+	F_var = 0.0;
+	/* B0, THETA, LAMDA */
+	for (k = pzk_start[PZK_PAIR]; k < pzk_start[PZK_PAIR + 1]; k++)
+	{
+		i0 = k_i0[k];
+		i1 = k_i1[k];
+		LGAMMA[i0] += k_lg0[k] * M[i1];
+		LGAMMA[i1] += k_lg1[k] * M[i0];
+		OSMOT += k_os[k] * M[i0] * M[i1];
+	}
+	/* C0 */
+	for (k = pzk_start[PZK_C0]; k < pzk_start[PZK_C0 + 1]; k++)
+	{
+		i0 = k_i0[k];
+		i1 = k_i1[k];
+		CSUM += k_os[k] * M[i0] * M[i1];
+		LGAMMA[i0] += k_os[k] * M[i1] * BIGZ;
+		LGAMMA[i1] += k_os[k] * M[i0] * BIGZ;
+		OSMOT += k_os[k] * M[i0] * M[i1] * BIGZ;
+	}
+	/* B1, B2 */
+	for (k = pzk_start[PZK_B]; k < pzk_start[PZK_B + 1]; k++)
+	{
+		i0 = k_i0[k];
+		i1 = k_i1[k];
+		l_alpha = pzk_alpha[k] * DI;
+		param = k_lg0[k] * G(l_alpha);
+		F_var += k_os[k] * M[i0] * M[i1] * GP(l_alpha) / I;
+		LGAMMA[i0] += param * M[i1];
+		LGAMMA[i1] += param * M[i0];
+		OSMOT += k_os[k] * M[i0] * M[i1] * exp(-l_alpha);
+	}
+	/* ETHETA */
+	for (k = pzk_start[PZK_ETHETA]; k < pzk_start[PZK_ETHETA + 1]; k++)
+	{
+		i0 = k_i0[k];
+		i1 = k_i1[k];
+		etheta = pzk_theta[k]->etheta;
+		ethetap = pzk_theta[k]->ethetap;
+		F_var += M[i0] * M[i1] * ethetap;
+		LGAMMA[i0] += 2.0 * M[i1] * etheta;
+		LGAMMA[i1] += 2.0 * M[i0] * etheta;
+		OSMOT += M[i0] * M[i1] * (etheta + I * ethetap);
+	}
+	/* ZETA, PSI, MU, ETA; terms with an absent third species are zero */
+	for (k = pzk_start[PZK_TRIPLE]; k < pzk_start[PZK_TRIPLE + 1]; k++)
+	{
+		i0 = k_i0[k];
+		i1 = k_i1[k];
+		i2 = k_i2[k];
+		param = (LDBLE) IPRSNT[i2];
+		LGAMMA[i0] += k_lg0[k] * M[i1] * M[i2] * param;
+		LGAMMA[i1] += k_lg1[k] * M[i0] * M[i2] * param;
+		LGAMMA[i2] += k_lg2[k] * M[i0] * M[i1] * param;
+		OSMOT += k_os[k] * M[i0] * M[i1] * M[i2] * param;
 	}
+	F += F_var;
+	F1 += F_var;
+	F2 += F_var;
 
 	/*
 	 *  Add F and CSUM terms to LGAMMA
@@ -1745,6 +1713,8 @@ set_pz(int initial)
 	s_hplus->lm = s_hplus->la;
 	s_hplus->moles = exp(s_hplus->lm * LOG_10) * mass_water_aq_x;
 	s_eminus->la = -solution_ptr->Get_pe();
+	if (cell_guess_ptr != NULL && cell_guess_apply() == OK)
+		AW = pow((LDBLE) 10.0, s_h2o->la);
 	if (initial == TRUE)
 		pitzer_initial_guesses();
 	if (dl_type_x != cxxSurface::NO_DL)
@@ -1988,6 +1958,21 @@ jacobian_pz(void)
 	LDBLE *base;
 	LDBLE d, d1, d2;
 	int i, j;
+	/*
+	 *   With KNOBS -analytic_jacobian the activity coefficients of each
+	 *   perturbed column come from the derivatives of pitzer() instead of
+	 *   a new pitzer(); debug_model also builds the numerical jacobian and
+	 *   prints the largest difference
+	 */
+	bool analytic = (analytic_jacobian == TRUE && full_pitzer == TRUE);
+	std::vector<LDBLE> numerical;
+	if (analytic && debug_model == TRUE)
+	{
+		analytic_jacobian = FALSE;
+		jacobian_pz();
+		analytic_jacobian = TRUE;
+		numerical.assign(my_array, my_array + count_unknowns * (count_unknowns + 1));
+	}
 
 	calculating_deriv = 1;
 Restart:
@@ -1998,6 +1983,8 @@ Restart:
 		molalities(TRUE);
 		pitzer();
 		residuals();
+		if (analytic)
+			pitzer_derivatives();
 	}
 	base = (LDBLE *) PHRQ_malloc((size_t) count_unknowns * sizeof(LDBLE));
 	if (base == NULL)
@@ -2105,7 +2092,13 @@ Restart:
 			goto Restart;
 		}
 		if (full_pitzer == TRUE)
-			pitzer();
+		{
+			/* ionic strength is not a variable of the derivatives */
+			if (analytic && x[i]->type != MU)
+				pitzer_tangent();
+			else
+				pitzer();
+		}
 		mb_sums();
 		residuals();
 		for (j = 0; j < count_unknowns; j++)
@@ -2172,8 +2165,195 @@ Restart:
 	residuals();
 	free_check_null(base);
 	calculating_deriv = 0;
+	if (numerical.size() == (size_t) count_unknowns * (count_unknowns + 1))
+		jacobian_difference(numerical);
 	return OK;
 }
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+jacobian_difference(const std::vector<LDBLE> &numerical)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *	Prints the largest difference of my_array from the numerical
+ *	jacobian, relative to the largest numerical entry of its row.
+ */
+	LDBLE diff_max = 0.0;
+	int i, j, row = 0, col = 0;
+
+	for (j = 0; j < count_unknowns; j++)
+	{
+		const LDBLE *n_row = &numerical[j * (count_unknowns + 1)];
+		const LDBLE *a_row = &my_array[j * (count_unknowns + 1)];
+		LDBLE scale = 0.0;
+		for (i = 0; i < count_unknowns; i++)
+		{
+			if (fabs(n_row[i]) > scale)
+				scale = fabs(n_row[i]);
+		}
+		if (scale == 0.0)
+			continue;
+		for (i = 0; i < count_unknowns; i++)
+		{
+			if (fabs(a_row[i] - n_row[i]) / scale > diff_max)
+			{
+				diff_max = fabs(a_row[i] - n_row[i]) / scale;
+				row = j;
+				col = i;
+			}
+		}
+	}
+	output_msg(sformatf(
+		"Analytic jacobian: largest difference from numerical %e, row %s, column %s\n",
+		(double) diff_max, x[row]->description, x[col]->description));
+}
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+pitzer_derivatives(void)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *	Saves the molalities, LGAMMA and AW of the last pitzer() and, for the
+ *	B1, B2 and ETHETA kernels, the factors of the molality products in
+ *	LGAMMA, F and OSMOT at the current ionic strength (pz_coef, 3 per
+ *	kernel entry).  The other kernels do not depend on the ionic
+ *	strength.  pitzer_tangent uses them to change the activity
+ *	coefficients to first order in the molalities.
+ */
+	LDBLE I, DI, l_alpha;
+	int k;
+
+	I = mu_x;
+	DI = sqrt(I);
+	pz_M0.assign(3 * count_s, 0.0);
+	pz_LG0.assign(3 * count_s, 0.0);
+	pz_dM.assign(3 * count_s, 0.0);
+	pz_dLG.assign(3 * count_s, 0.0);
+	pz_AW0 = AW;
+	pz_BIGZ0 = 0.0;
+	for (size_t j = 0; j < s_list.size(); j++)
+	{
+		int i = s_list[j];
+		pz_M0[i] = M[i];
+		pz_LG0[i] = LGAMMA[i];
+		pz_BIGZ0 += M[i] * fabs(spec[i]->z);
+	}
+	pz_coef.assign(3 * pzk_i0.size(), 0.0);
+	for (k = pzk_start[PZK_B]; k < pzk_start[PZK_B + 1]; k++)
+	{
+		l_alpha = pzk_alpha[k] * DI;
+		pz_coef[3 * k] = pzk_lg0[k] * G(l_alpha);
+		pz_coef[3 * k + 1] = pzk_os[k] * GP(l_alpha) / I;
+		pz_coef[3 * k + 2] = pzk_os[k] * exp(-l_alpha);
+	}
+	for (k = pzk_start[PZK_ETHETA]; k < pzk_start[PZK_ETHETA + 1]; k++)
+	{
+		pz_coef[3 * k] = 2.0 * pzk_theta[k]->etheta;
+		pz_coef[3 * k + 1] = pzk_theta[k]->ethetap;
+		pz_coef[3 * k + 2] = pzk_theta[k]->etheta + I * pzk_theta[k]->ethetap;
+	}
+	/* weight of the terms with a third species, as in pitzer() */
+	for (k = pzk_start[PZK_TRIPLE]; k < pzk_start[PZK_TRIPLE + 1]; k++)
+	{
+		pz_coef[3 * k] = (LDBLE) IPRSNT[pzk_i2[k]];
+	}
+	return (OK);
+}
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+pitzer_tangent(void)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *	Sets lg_pitzer and AW from the values saved by pitzer_derivatives
+ *	plus their derivatives with respect to the molalities times the
+ *	change of the molalities.  The ionic strength is that of the saved
+ *	values.
+ */
+	LDBLE dBIGZ, dOSUM, dF, dCSUM, dOSMOT, dPHIMAC, z0, d01, w;
+	const LDBLE *M0 = &pz_M0[0];
+	LDBLE *dM = &pz_dM[0], *dLG = &pz_dLG[0];
+	int i0, i1, i2, k;
+
+	dBIGZ = dOSUM = dF = dCSUM = dOSMOT = 0.0;
+	for (size_t j = 0; j < s_list.size(); j++)
+	{
+		int i = s_list[j];
+		LDBLE m = 0.0;
+		if (spec[i]->in == TRUE)
+			m = under(spec[i]->lm);
+		dM[i] = m - M0[i];
+		dLG[i] = 0.0;
+		dBIGZ += dM[i] * fabs(spec[i]->z);
+		dOSUM += dM[i];
+	}
+	for (k = pzk_start[PZK_PAIR]; k < pzk_start[PZK_PAIR + 1]; k++)
+	{
+		i0 = pzk_i0[k];
+		i1 = pzk_i1[k];
+		dLG[i0] += pzk_lg0[k] * dM[i1];
+		dLG[i1] += pzk_lg1[k] * dM[i0];
+		dOSMOT += pzk_os[k] * (dM[i0] * M0[i1] + M0[i0] * dM[i1]);
+	}
+	for (k = pzk_start[PZK_C0]; k < pzk_start[PZK_C0 + 1]; k++)
+	{
+		i0 = pzk_i0[k];
+		i1 = pzk_i1[k];
+		d01 = dM[i0] * M0[i1] + M0[i0] * dM[i1];
+		dCSUM += pzk_os[k] * d01;
+		dLG[i0] += pzk_os[k] * (dM[i1] * pz_BIGZ0 + M0[i1] * dBIGZ);
+		dLG[i1] += pzk_os[k] * (dM[i0] * pz_BIGZ0 + M0[i0] * dBIGZ);
+		dOSMOT += pzk_os[k] * (d01 * pz_BIGZ0 + M0[i0] * M0[i1] * dBIGZ);
+	}
+	/* B1, B2 and ETHETA, adjacent kernels of the same form with pz_coef */
+	for (k = pzk_start[PZK_B]; k < pzk_start[PZK_ETHETA + 1]; k++)
+	{
+		i0 = pzk_i0[k];
+		i1 = pzk_i1[k];
+		d01 = dM[i0] * M0[i1] + M0[i0] * dM[i1];
+		dLG[i0] += pz_coef[3 * k] * dM[i1];
+		dLG[i1] += pz_coef[3 * k] * dM[i0];
+		dF += pz_coef[3 * k + 1] * d01;
+		dOSMOT += pz_coef[3 * k + 2] * d01;
+	}
+	for (k = pzk_start[PZK_TRIPLE]; k < pzk_start[PZK_TRIPLE + 1]; k++)
+	{
+		i0 = pzk_i0[k];
+		i1 = pzk_i1[k];
+		i2 = pzk_i2[k];
+		w = pz_coef[3 * k];
+		d01 = dM[i0] * M0[i1] + M0[i0] * dM[i1];
+		dLG[i0] += w * pzk_lg0[k] * (dM[i1] * M0[i2] + M0[i1] * dM[i2]);
+		dLG[i1] += w * pzk_lg1[k] * (dM[i0] * M0[i2] + M0[i0] * dM[i2]);
+		dLG[i2] += w * pzk_lg2[k] * d01;
+		dOSMOT += w * pzk_os[k] * (d01 * M0[i2] + M0[i0] * M0[i1] * dM[i2]);
+	}
+	/*
+	 *  F and CSUM terms, MacInnes convention
+	 */
+	for (size_t j = 0; j < ion_list.size(); j++)
+	{
+		int i = ion_list[j];
+		z0 = fabs(spec[i]->z);
+		dLG[i] += z0 * z0 * dF + z0 * dCSUM;
+	}
+	if (ICON == TRUE)
+	{
+		dPHIMAC = dLG[IC];
+		for (size_t j = 0; j < s_list.size(); j++)
+		{
+			int i = s_list[j];
+			dLG[i] += spec[i]->z * dPHIMAC;
+		}
+	}
+	AW = pz_AW0 * (1.0 - (dOSUM + 2.0 * dOSMOT) / 55.50837);
+	for (size_t j = 0; j < s_list.size(); j++)
+	{
+		int i = s_list[j];
+		spec[i]->lg_pitzer = (pz_LG0[i] + dLG[i]) / LOG_10;
+	}
+	return (OK);
+}
 
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
@@ -2209,6 +2389,8 @@ model_pz(void)
 	int count_infeasible, count_basis_change;
 	int debug_model_save;
 	int mass_water_switch_save;
+	LDBLE t0;
+	int etheta_calls_save = etheta_calls, etheta_hits_save = etheta_hits;
 
 /*	debug_model = TRUE; */
 /*	debug_prep = TRUE; */
@@ -2284,14 +2466,19 @@ model_pz(void)
 			/*
 			 *   Calculate jacobian
 			 */
+			t0 = solver_time();
 			gammas_pz(false); // appt: no gammas_a_f here
+			solver_stats_x.time_gammas += solver_time() - t0;
+			t0 = solver_time();
 			jacobian_sums();
 			jacobian_pz();
+			solver_stats_x.time_jacobian += solver_time() - t0;
 			/*
 			 *   Full matrix with pure phases
 			 */
 			if (r == OK || remove_unstable_phases == TRUE)
 			{
+				t0 = solver_time();
 				return_kode = ineq(l_kode);
 				if (return_kode != OK)
 				{
@@ -2311,12 +2498,15 @@ model_pz(void)
 				{
 					ineq(0);
 				}
+				solver_stats_x.time_ineq += solver_time() - t0;
 				reset();
 			}
 			// appt calculate gammas_a_f here
+			t0 = solver_time();
 			gammas_pz(true);
 			if (full_pitzer == TRUE)
 				pitzer();
+			solver_stats_x.time_gammas += solver_time() - t0;
 			if (always_full_pitzer == TRUE)
 			{
 				full_pitzer = TRUE;
@@ -2327,6 +2517,7 @@ model_pz(void)
 			}
 			if (molalities(FALSE) == ERROR)
 			{
+				solver_stats_x.overflows++;
 				pitzer_revise_guesses();
 			}
 			if (use.Get_surface_ptr() != NULL &&
@@ -2413,6 +2604,14 @@ model_pz(void)
 			   count_basis_change));
 	log_msg(sformatf( "Number of iterations: %d\n", iterations));
 	log_msg(sformatf( "Number of gamma iterations: %d\n\n", gamma_iterations));
+	solver_stats_x.infeasible += count_infeasible;
+	solver_stats_x.basis_changes += count_basis_change;
+	solver_stats_x.iterations += iterations;
+	if (etheta_calls > etheta_calls_save)
+	{
+		log_msg(sformatf( "E-theta values reused: %d of %d\n\n",
+				   etheta_hits - etheta_hits_save, etheta_calls - etheta_calls_save));
+	}
 	debug_model = debug_model_save;
 	set_forward_output_to_log(FALSE);
 	if (stop_program == TRUE)
@@ -2613,13 +2812,13 @@ pitzer_make_lists(void)
 /* ---------------------------------------------------------------------- */
 {
 	double log_min = log10(MIN_TOTAL);
+	std::vector<int> param_list_save;
+	param_list_save.swap(param_list);
 	s_list.clear();
 	cation_list.clear();
 	neutral_list.clear();
 	anion_list.clear();
 	ion_list.clear();
-	param_list.clear();
-	OTEMP = -100.0;
 	for (int j = 0; j < 3; j++)
 	{
 		int min, max;
@@ -2698,4 +2897,108 @@ pitzer_make_lists(void)
 		}
 		param_list.push_back(i);
 	}
-}
\ No newline at end of file
+	/* parameters and kernels of PTEMP are kept for the same list */
+	if (param_list != param_list_save)
+		OTEMP = -100.0;
+}
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+pitzer_kernels(void)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *	Sorts the parameters of param_list into contiguous arrays by the form
+ *	of their terms in pitzer(), with the coefficients at the temperature
+ *	and pressure of the last PTEMP:
+ *	  PZK_PAIR    B0, THETA, LAMDA: lg0, lg1 and os multiply the molalities
+ *	  PZK_C0      C0: os = p / (2 sqrt|z0 z1|), also multiplied by BIGZ
+ *	  PZK_B       B1, B2 with p != 0: lg0 = 2 p, os = p, alpha
+ *	  PZK_ETHETA  ETHETA, if use_etheta: pzk_theta
+ *	  PZK_TRIPLE  ZETA, PSI, MU, ETA: lg0, lg1, lg2 and os
+ */
+	pzk_start.assign(PZK_COUNT + 1, 0);
+	pzk_i0.clear();
+	pzk_i1.clear();
+	pzk_i2.clear();
+	pzk_lg0.clear();
+	pzk_lg1.clear();
+	pzk_lg2.clear();
+	pzk_os.clear();
+	pzk_alpha.clear();
+	pzk_theta.clear();
+	for (int k = 0; k < PZK_COUNT; k++)
+	{
+		pzk_start[k] = (int) pzk_i0.size();
+		for (size_t j = 0; j < param_list.size(); j++)
+		{
+			struct pitz_param *pz_ptr = pitz_params[param_list[j]];
+			LDBLE param = pz_ptr->p;
+			LDBLE lg0 = 0, lg1 = 0, lg2 = 0, os = 0;
+			int kernel;
+			switch (pz_ptr->type)
+			{
+			case TYPE_B0:
+			case TYPE_THETA:
+				kernel = PZK_PAIR;
+				lg0 = lg1 = 2.0 * param;
+				os = param;
+				break;
+			case TYPE_LAMDA:
+				kernel = PZK_PAIR;
+				lg0 = param * pz_ptr->ln_coef[0];
+				lg1 = param * pz_ptr->ln_coef[1];
+				os = param * pz_ptr->os_coef;
+				break;
+			case TYPE_B1:
+			case TYPE_B2:
+				if (param == 0.0)
+					continue;
+				kernel = PZK_B;
+				lg0 = 2.0 * param;
+				os = param;
+				break;
+			case TYPE_C0:
+				kernel = PZK_C0;
+				os = param / (2.0 * sqrt(fabs(spec[pz_ptr->ispec[0]]->z *
+					spec[pz_ptr->ispec[1]]->z)));
+				break;
+			case TYPE_ETHETA:
+				if (use_etheta == FALSE)
+					continue;
+				kernel = PZK_ETHETA;
+				break;
+			case TYPE_PSI:
+			case TYPE_ZETA:
+			case TYPE_ETA:
+				kernel = PZK_TRIPLE;
+				lg0 = lg1 = lg2 = os = param;
+				break;
+			case TYPE_MU:
+				kernel = PZK_TRIPLE;
+				lg0 = param * pz_ptr->ln_coef[0];
+				lg1 = param * pz_ptr->ln_coef[1];
+				lg2 = param * pz_ptr->ln_coef[2];
+				os = param * pz_ptr->os_coef;
+				break;
+			case TYPE_ALPHAS:
+				continue;
+			case TYPE_Other:
+			default:
+				error_msg("TYPE_Other in pitz_param list.", STOP);
+				continue;
+			}
+			if (kernel != k)
+				continue;
+			pzk_i0.push_back(pz_ptr->ispec[0]);
+			pzk_i1.push_back(pz_ptr->ispec[1]);
+			pzk_i2.push_back(kernel == PZK_TRIPLE ? pz_ptr->ispec[2] : 0);
+			pzk_lg0.push_back(lg0);
+			pzk_lg1.push_back(lg1);
+			pzk_lg2.push_back(lg2);
+			pzk_os.push_back(os);
+			pzk_alpha.push_back(pz_ptr->alpha);
+			pzk_theta.push_back(pz_ptr->thetas);
+		}
+	}
+	pzk_start[PZK_COUNT] = (int) pzk_i0.size();
+}
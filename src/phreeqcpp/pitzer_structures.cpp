@@ -337,6 +337,8 @@ theta_param_init(struct theta_param *theta_param_ptr)
 	theta_param_ptr->zk = 0;
 	theta_param_ptr->etheta = 0;
 	theta_param_ptr->ethetap = 0;
+	theta_param_ptr->I = -1.0;
+	theta_param_ptr->A0 = 0;
 	return (OK);
 }
 
@@ -25,8 +25,10 @@ prep(void)
  *   Routine builds a set of lists for calculating mass balance and
  *      for building jacobian.
  */
+	ProfilerScope profiler_scope(profiler, "prep");
 	cxxSolution *solution_ptr;
 
+	count_prep++;
 	if (state >= REACTION)
 	{
 		same_model = check_same_model();
@@ -119,6 +121,10 @@ prep(void)
  *   If model is same, just update masses, don`t rebuild unknowns and lists
  */
 		quick_setup();
+		if (!sum_rows_built)
+		{
+			build_sum_rows();
+		}
 	}
 	if (debug_mass_balance)
 	{
@@ -1141,6 +1147,7 @@ build_model(void)
  *    Guts of prep. Determines species in model, rewrites equations,
  *    builds lists for mass balance and jacobian sums.
  */
+	ProfilerScope profiler_scope(profiler, "build_model");
 	int i, j, j0, k;
 	LDBLE coef_e;
 
@@ -1158,10 +1165,13 @@ build_model(void)
 	// clear sum_species_map, which is built from s_x
 	sum_species_map_db.clear();
 	sum_species_map.clear();
+	// log k table is numbered again at the end, logk_t_model
+	logk_model = -1;
 
 	space((void **) ((void *) &s_x), INIT, &max_s_x,
 		  sizeof(struct species *));
 
+	sum_rows_built = false;
 	max_sum_mb1 = MAX_SUM_MB;
 	count_sum_mb1 = 0;
 	space((void **) ((void *) &sum_mb1), INIT, &max_sum_mb1,
@@ -1332,6 +1342,7 @@ build_model(void)
 			build_species_list(i);
 		}
 	}
+	build_rxn_x_rows();
 	if (dl_type_x != cxxSurface::NO_DL && (/*pitzer_model == TRUE || */sit_model == TRUE)) //DL_pitz
 	{
 		error_msg("-diffuse_layer option not available for Pizer or SIT model",
@@ -1430,6 +1441,7 @@ build_model(void)
  *   Save model description
  */
 	save_model();
+	logk_t_model();
 
 	if (input_error > 0)
 	{
@@ -1795,6 +1807,204 @@ build_species_list(int n)
 	return (OK);
 }
 
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+build_rxn_x_rows(void)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Mass-action equations of the species in the model: one row per species
+ *   by position in s_x, columns are the distinct species on the right-hand
+ *   side of rxn_x (the master species of the model)
+ */
+	std::vector<int> col(count_s, -1);
+	rxn_x_start.assign(1, 0);
+	rxn_x_col.clear();
+	rxn_x_coef.clear();
+	rxn_x_master.clear();
+	for (int i = 0; i < count_s_x; i++)
+	{
+		for (struct rxn_token *rxn_ptr = s_x[i]->rxn_x->token + 1;
+			 rxn_ptr->s != NULL; rxn_ptr++)
+		{
+			int n = rxn_ptr->s->number;
+			if (col[n] < 0)
+			{
+				col[n] = (int) rxn_x_master.size();
+				rxn_x_master.push_back(rxn_ptr->s);
+			}
+			rxn_x_col.push_back(col[n]);
+			rxn_x_coef.push_back(rxn_ptr->coef);
+		}
+		rxn_x_start.push_back((int) rxn_x_col.size());
+	}
+	rxn_x_la.resize(rxn_x_master.size());
+	return (OK);
+}
+/* ---------------------------------------------------------------------- */
+static const LDBLE *
+s_x_state_source(const std::map<const LDBLE *, const LDBLE *> &state, const LDBLE *source)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   The array element that mirrors source, or source itself
+ */
+	std::map<const LDBLE *, const LDBLE *>::const_iterator it = state.find(source);
+	return (it == state.end()) ? source : it->second;
+}
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+build_sum_rows(void)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Compiles sum_mb1 and sum_mb2, and sum_jacob0, sum_jacob1, and
+ *   sum_jacob2, into rows by target, so that mb_sums and jacobian_sums
+ *   accumulate each target once. The terms of a row keep the order in
+ *   which the lists were summed; constants get a source of 1.0 and the
+ *   terms of sum_mb1 and sum_jacob1 a coef of 1.0, so the sums are unchanged.
+ *   Called by prep when a model is reused; compiling costs about as much
+ *   as ten evaluations of the lists, so a model that is built for a
+ *   single calculation keeps using the lists.
+ */
+	static const LDBLE one = 1.0;
+	std::vector<int> row, start;
+	int i, k, n;
+/*
+ *   Terms that read moles, dg or la of a species of the model read the
+ *   arrays by position in s_x instead
+ */
+	s_x_moles.assign(count_s_x, 0.0);
+	s_x_dg.assign(count_s_x, 0.0);
+	s_x_la.assign(count_s_x, 0.0);
+	std::map<const LDBLE *, const LDBLE *> state;
+	for (i = 0; i < count_s_x; i++)
+	{
+		state[&s_x[i]->moles] = &s_x_moles[i];
+		state[&s_x[i]->dg] = &s_x_dg[i];
+		state[&s_x[i]->la] = &s_x_la[i];
+	}
+/*
+ *   Mass balance sums, targets are unknown->f; rows are found in a hash
+ *   table of the targets that is never more than half full
+ */
+	n = count_sum_mb1 + count_sum_mb2;
+	size_t size = 2;
+	while (size < 2 * (size_t) n)
+		size *= 2;
+	std::vector<std::pair<LDBLE *, int> > table(size, std::pair<LDBLE *, int>((LDBLE *) NULL, -1));
+	row.resize(n);
+	mb_row_target.clear();
+	for (k = 0; k < n; k++)
+	{
+		LDBLE *target = (k < count_sum_mb1) ? sum_mb1[k].target : sum_mb2[k - count_sum_mb1].target;
+		size_t h = (((size_t) target) >> 3) * 2654435761u;
+		for (h &= size - 1; table[h].first != NULL && table[h].first != target; h = (h + 1) & (size - 1));
+		if (table[h].first == NULL)
+		{
+			table[h].first = target;
+			table[h].second = (int) mb_row_target.size();
+			mb_row_target.push_back(target);
+		}
+		row[k] = table[h].second;
+	}
+	start.assign(mb_row_target.size() + 1, 0);
+	for (k = 0; k < n; k++)
+		start[row[k] + 1]++;
+	for (i = 0; i < (int) mb_row_target.size(); i++)
+		start[i + 1] += start[i];
+	mb_row_start = start;
+	mb_term_source.resize(n);
+	mb_term_coef.resize(n);
+	for (k = 0; k < count_sum_mb1; k++)
+	{
+		int j = start[row[k]]++;
+		mb_term_source[j] = s_x_state_source(state, sum_mb1[k].source);
+		mb_term_coef[j] = 1.0;
+	}
+	for (k = count_sum_mb1; k < n; k++)
+	{
+		int j = start[row[k]]++;
+		mb_term_source[j] = s_x_state_source(state, sum_mb2[k - count_sum_mb1].source);
+		mb_term_coef[j] = sum_mb2[k - count_sum_mb1].coef;
+	}
+/*
+ *   Jacobian sums, targets are elements of my_array; rows in the order of
+ *   my_array from a counting sort by offset
+ */
+	int n0 = count_sum_jacob0;
+	int n1 = n0 + count_sum_jacob1;
+	n = n1 + count_sum_jacob2;
+	row.resize(n);
+	int max_offset = -1;
+	for (k = 0; k < n0; k++)
+		row[k] = (int) (sum_jacob0[k].target - my_array);
+	for (k = n0; k < n1; k++)
+		row[k] = (int) (sum_jacob1[k - n0].target - my_array);
+	for (k = n1; k < n; k++)
+		row[k] = (int) (sum_jacob2[k - n1].target - my_array);
+	for (k = 0; k < n; k++)
+	{
+		if (row[k] > max_offset)
+			max_offset = row[k];
+	}
+	start.assign(max_offset + 2, 0);
+	for (k = 0; k < n; k++)
+		start[row[k] + 1]++;
+	jacob_row_target.clear();
+	jacob_row_start.clear();
+	for (i = 0; i <= max_offset; i++)
+	{
+		if (start[i + 1] > 0)
+		{
+			jacob_row_target.push_back(i);
+			jacob_row_start.push_back(start[i]);
+		}
+		start[i + 1] += start[i];
+	}
+	jacob_row_start.push_back(n);
+	jacob_term_source.resize(n);
+	jacob_term_coef.resize(n);
+	for (k = 0; k < n0; k++)
+	{
+		int j = start[row[k]]++;
+		jacob_term_source[j] = &one;
+		jacob_term_coef[j] = sum_jacob0[k].coef;
+	}
+	for (k = n0; k < n1; k++)
+	{
+		int j = start[row[k]]++;
+		jacob_term_source[j] = s_x_state_source(state, sum_jacob1[k - n0].source);
+		jacob_term_coef[j] = 1.0;
+	}
+	for (k = n1; k < n; k++)
+	{
+		int j = start[row[k]]++;
+		jacob_term_source[j] = s_x_state_source(state, sum_jacob2[k - n1].source);
+		jacob_term_coef[j] = sum_jacob2[k - n1].coef;
+	}
+	sum_rows_built = true;
+	return (OK);
+}
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+gather_s_x_state(void)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Copies moles, dg and la of the species of the model into the arrays
+ *   read by the rows of build_sum_rows
+ */
+	for (int i = 0; i < count_s_x; i++)
+	{
+		const struct species *s_ptr = s_x[i];
+		s_x_moles[i] = s_ptr->moles;
+		s_x_dg[i] = s_ptr->dg;
+		s_x_la[i] = s_ptr->la;
+	}
+	return (OK);
+}
+
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
 clear(void)
@@ -2246,8 +2456,9 @@ is_special(struct species *l_spec)
 	for (token_ptr = l_spec->rxn_s->token + 1; token_ptr->s != NULL;
 		 token_ptr++)
 	{
-		if (token_ptr->s != s_hplus &&
-			token_ptr->s != s_h2o && token_ptr->s != s_eminus)
+		struct species *s_ptr = s_local(token_ptr->s);
+		if (s_ptr != s_hplus &&
+			s_ptr != s_h2o && s_ptr != s_eminus)
 		{
 			special = FALSE;
 			break;
@@ -5508,7 +5719,7 @@ calc_delta_v(reaction *r_ptr, bool phase)
 			//if (!strcmp(r_ptr->token[i].s->name, "e-"))
 			//	continue;
 			//else if (r_ptr->token[i].s->logk[vm_tc])
-			d_v += r_ptr->token[i].coef * r_ptr->token[i].s->logk[vm_tc];
+			d_v += r_ptr->token[i].coef * s_local(r_ptr->token[i].s)->logk[vm_tc];
 		}
 	}
 	else
@@ -5522,7 +5733,7 @@ calc_delta_v(reaction *r_ptr, bool phase)
 			//if (!strcmp(r_ptr->token[i].s->name, "e-"))
 			//	continue;
 			//else if (r_ptr->token[i].s->logk[vm_tc])
-			d_v -= r_ptr->token[i].coef * r_ptr->token[i].s->logk[vm_tc];
+			d_v -= r_ptr->token[i].coef * s_local(r_ptr->token[i].s)->logk[vm_tc];
 		}
 	}
 	return d_v;
@@ -5553,7 +5764,7 @@ calc_lk_phase(phase *p_ptr, LDBLE TK, LDBLE pa)
 	{
 		if (!r_ptr->token[i].s)
 			continue;
-		s_ptr = r_ptr->token[i].s;
+		s_ptr = s_local(r_ptr->token[i].s);
 		//if (!strcmp(s_ptr->name, "H+"))
 		if (s_ptr == s_hplus)
 			continue;
@@ -5617,11 +5828,18 @@ calc_lk_phase(phase *p_ptr, LDBLE TK, LDBLE pa)
 			continue;
 	}
 	d_v -= p_ptr->logk[vm0];
-	r_ptr->logk[delta_v] = d_v;
 	if (r_ptr->token[0].name && !strcmp(r_ptr->token[0].name, "H2O(g)"))
-		r_ptr->logk[delta_v] = 0.0;
-
-	return k_calc(r_ptr->logk, TK, pa * PASCAL_PER_ATM);
+		d_v = 0.0;
+	if (r_ptr == p_ptr->rxn_x || shared_definitions == NULL)
+	{
+		r_ptr->logk[delta_v] = d_v;
+		return k_calc(r_ptr->logk, TK, pa * PASCAL_PER_ATM);
+	}
+	/* rxn_s belongs to the database snapshot */
+	LDBLE l_logk[MAX_LOG_K_INDICES];
+	memcpy(l_logk, r_ptr->logk, sizeof(l_logk));
+	l_logk[delta_v] = d_v;
+	return k_calc(l_logk, TK, pa * PASCAL_PER_ATM);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -5725,6 +5943,7 @@ k_temp(LDBLE tc, LDBLE pa) /* pa - pressure in atm */
 
 	int i;
 	LDBLE tempk = tc + 273.15;
+	const LDBLE *lk_t;
 /*
  *  Calculate log k for all aqueous species
  */
@@ -5736,6 +5955,8 @@ k_temp(LDBLE tc, LDBLE pa) /* pa - pressure in atm */
 
 	calc_vm(tc, pa);
 
+	/* the temperature part of log k is taken from the table */
+	lk_t = logk_t_lookup(tempk);
 	mu_terms_in_logk = false;
 	for (i = 0; i < count_s_x; i++)
 	{
@@ -5745,7 +5966,7 @@ k_temp(LDBLE tc, LDBLE pa) /* pa - pressure in atm */
 		if (tc == current_tc && s_x[i]->rxn_x->logk[delta_v] == 0)
 			continue;
 		mu_terms_in_logk = true;
-		s_x[i]->lk = k_calc(s_x[i]->rxn_x->logk, tempk, pa * PASCAL_PER_ATM);
+		s_x[i]->lk = k_calc_p(lk_t[i], s_x[i]->rxn_x->logk, tempk, pa * PASCAL_PER_ATM);
 	}
 /*
  *    Calculate log k for all pure phases
@@ -5759,7 +5980,7 @@ k_temp(LDBLE tc, LDBLE pa) /* pa - pressure in atm */
 				phases[i]->logk[vm0];
 			if (phases[i]->rxn_x->logk[delta_v])
 				mu_terms_in_logk = true;
-			phases[i]->lk = k_calc(phases[i]->rxn_x->logk, tempk, pa * PASCAL_PER_ATM);
+			phases[i]->lk = k_calc_p(lk_t[count_s_x + i], phases[i]->rxn_x->logk, tempk, pa * PASCAL_PER_ATM);
 
 		}
 	}
@@ -5796,14 +6017,21 @@ k_calc(LDBLE * l_logk, LDBLE tempk, LDBLE presPa)
 	 *
 	 *   delta_v is in cm3/mol.
 	 */
+	return k_calc_p(k_calc_t(l_logk, tempk), l_logk, tempk, presPa);
+}
+/* ---------------------------------------------------------------------- */
+LDBLE Phreeqc::
+k_calc_t(LDBLE * l_logk, LDBLE tempk)
+/* ---------------------------------------------------------------------- */
+{
+	/*
+	 *   Calculates log k at specified temperature and the reference pressure
+	 */
 
 	/* Molar energy */
 	LDBLE me = tempk * R_KJ_DEG_MOL;
 
-	/* Pressure difference */
-	LDBLE delta_p = presPa - REF_PRES_PASCAL;
-
-	/* Calculate new log k value for this temperature and pressure */
+	/* Calculate new log k value for this temperature */
 	LDBLE lk = l_logk[logK_T0] 
 		- l_logk[delta_h] * (298.15 - tempk) / (LOG_10 * me * 298.15)
 		+ l_logk[T_A1]
@@ -5812,12 +6040,195 @@ k_calc(LDBLE * l_logk, LDBLE tempk, LDBLE presPa)
 		+ l_logk[T_A4] * log10(tempk)
 		+ l_logk[T_A5] / (tempk * tempk)
 		+ l_logk[T_A6] * tempk * tempk;
+	return lk;
+}
+/* ---------------------------------------------------------------------- */
+LDBLE Phreeqc::
+k_calc_t_curvature(LDBLE * l_logk, LDBLE tempk)
+/* ---------------------------------------------------------------------- */
+{
+	/*
+	 *   Bound of |d2(log k)/dT2| of k_calc_t at temperatures >= tempk.
+	 *   The terms in 1/T (A3 and delta_h), 1/T^2 and log10(T) have second
+	 *   derivatives that decrease in magnitude with T, A6 T^2 has a
+	 *   constant one, A1 and A2 T have none.
+	 */
+	LDBLE a3 = l_logk[T_A3] - l_logk[delta_h] / (LOG_10 * R_KJ_DEG_MOL);
+	LDBLE t2 = tempk * tempk;
+
+	return 2.0 * fabs(a3) / (t2 * tempk)
+		+ fabs(l_logk[T_A4]) / (LOG_10 * t2)
+		+ 6.0 * fabs(l_logk[T_A5]) / (t2 * t2)
+		+ 2.0 * fabs(l_logk[T_A6]);
+}
+/* ---------------------------------------------------------------------- */
+LDBLE Phreeqc::
+k_calc_p(LDBLE lk_t, LDBLE * l_logk, LDBLE tempk, LDBLE presPa)
+/* ---------------------------------------------------------------------- */
+{
+	/*
+	 *   Adds the pressure correction to lk_t, log k at tempk and the
+	 *   reference pressure
+	 */
+
+	/* Molar energy */
+	LDBLE me = tempk * R_KJ_DEG_MOL;
+
+	/* Pressure difference */
+	LDBLE delta_p = presPa - REF_PRES_PASCAL;
+
+	LDBLE lk = lk_t;
 	if (delta_p > 0)
 		/* cm3 * J /mol = 1e-9 m3 * kJ /mol */
 		lk -= l_logk[delta_v] * 1E-9 * delta_p / (LOG_10 * me);
 	return lk;
 }
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+logk_t_fill(LDBLE tempk, LDBLE * lk)
+/* ---------------------------------------------------------------------- */
+{
+	/*
+	 *   Temperature part of log k of the aqueous species in the model,
+	 *   followed by the pure phases
+	 */
+	int i;
 
+	for (i = 0; i < count_s_x; i++)
+	{
+		lk[i] = k_calc_t(s_x[i]->rxn_x->logk, tempk);
+	}
+	for (i = 0; i < count_phases; i++)
+	{
+		lk[count_s_x + i] = (phases[i]->in == TRUE && phases[i]->rxn_x != NULL) ?
+			k_calc_t(phases[i]->rxn_x->logk, tempk) : 0.0;
+	}
+}
+#define LOGK_MODELS_MAX 64	/* sets of reactions kept */
+#define LOGK_TABLE_MAX 1024	/* grid intervals kept */
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+logk_t_model(void)
+/* ---------------------------------------------------------------------- */
+{
+	/*
+	 *   Numbers the set of log k coefficients of the model, after the
+	 *   mass-action equations are rewritten in build_model
+	 */
+	std::vector<LDBLE> key;
+	int i, j;
+
+	key.reserve((size_t) (count_s_x + count_phases) * (T_A6 - logK_T0 + 2));
+	for (i = 0; i < count_s_x; i++)
+	{
+		for (j = logK_T0; j <= T_A6; j++)
+			key.push_back(s_x[i]->rxn_x->logk[j]);
+	}
+	for (i = 0; i < count_phases; i++)
+	{
+		if (phases[i]->in != TRUE || phases[i]->rxn_x == NULL)
+			continue;
+		key.push_back((LDBLE) i);
+		for (j = logK_T0; j <= T_A6; j++)
+			key.push_back(phases[i]->rxn_x->logk[j]);
+	}
+	key.push_back((LDBLE) count_s_x);
+	key.push_back((LDBLE) count_phases);
+	std::map<std::vector<LDBLE>, int>::iterator it = logk_models.find(key);
+	if (it != logk_models.end())
+	{
+		logk_model = it->second;
+		return;
+	}
+	if (logk_models.size() >= LOGK_MODELS_MAX)
+	{
+		logk_models.clear();
+		logk_table.clear();
+	}
+	logk_model = (int) logk_models.size();
+	logk_models[key] = logk_model;
+}
+/* ---------------------------------------------------------------------- */
+const LDBLE * Phreeqc::
+logk_t_lookup(LDBLE tempk)
+/* ---------------------------------------------------------------------- */
+{
+	/*
+	 *   Returns the temperature part of log k for logk_t_fill order.
+	 *   Without KNOBS -logk_grid, log k is evaluated exactly at tempk.
+	 *   With -logk_grid, log k is interpolated linearly in the interval of
+	 *   the grid containing tempk.  The error of linear interpolation is at
+	 *   most dt^2/8 times the largest |d2(log k)/dT2| in the interval
+	 *   (k_calc_t_curvature at its lower end); reactions for which this
+	 *   bound exceeds logk_grid_tol are evaluated exactly in that interval,
+	 *   so interpolated values differ from k_calc_t by at most
+	 *   logk_grid_tol, apart from rounding.
+	 *   Intervals are kept for each set of reactions (logk_t_model), cells
+	 *   alternating among models keep their values.
+	 */
+	size_t i, n = (size_t) (count_s_x + count_phases);
+	std::map<std::pair<int, LDBLE>, std::vector<LDBLE> >::iterator it;
+
+	if (n == 0)
+		return (NULL);
+	if (logk_model < 0 || logk_grid_dt <= 0.0)
+	{
+		logk_table_work.resize(n);
+		logk_t_fill(tempk, &logk_table_work[0]);
+		return (&logk_table_work[0]);
+	}
+	/*
+	 *   Interval of the grid, values at the lower end and slopes
+	 */
+	LDBLE k = floor(tempk / logk_grid_dt);
+	LDBLE t0 = k * logk_grid_dt;
+	it = logk_table.find(std::make_pair(logk_model, k));
+	if (it == logk_table.end())
+	{
+		if (logk_table.size() >= LOGK_TABLE_MAX)
+			logk_table.clear();
+		std::vector<LDBLE> &c = logk_table[std::make_pair(logk_model, k)];
+		std::vector<LDBLE> hi(n);
+		LDBLE h2 = logk_grid_dt * logk_grid_dt / 8.0;
+		c.resize(2 * n);
+		logk_t_fill(t0, &c[0]);
+		logk_t_fill(t0 + logk_grid_dt, &hi[0]);
+		for (i = 0; i < n; i++)
+		{
+			LDBLE slope = NAN;
+			LDBLE *l_logk = NULL;
+			if (i < (size_t) count_s_x)
+				l_logk = s_x[i]->rxn_x->logk;
+			else if (phases[i - count_s_x]->in == TRUE && phases[i - count_s_x]->rxn_x != NULL)
+				l_logk = phases[i - count_s_x]->rxn_x->logk;
+			if (l_logk == NULL)
+				slope = 0.0;
+			else if (t0 > 0.0 && h2 * k_calc_t_curvature(l_logk, t0) <= logk_grid_tol)
+				slope = (hi[i] - c[i]) / logk_grid_dt;
+			c[n + i] = slope;
+		}
+		it = logk_table.find(std::make_pair(logk_model, k));
+	}
+	const std::vector<LDBLE> &c = it->second;
+	LDBLE dt = tempk - t0;
+	logk_table_work.resize(n);
+	for (i = 0; i < n; i++)
+	{
+		if (c[n + i] == c[n + i])
+		{
+			logk_table_work[i] = c[i] + dt * c[n + i];
+		}
+		else if (i < (size_t) count_s_x)
+		{
+			logk_table_work[i] = k_calc_t(s_x[i]->rxn_x->logk, tempk);
+		}
+		else
+		{
+			logk_table_work[i] = k_calc_t(phases[i - count_s_x]->rxn_x->logk, tempk);
+		}
+	}
+	return (&logk_table_work[0]);
+}
 
 /* ---------------------------------------------------------------------- */
  int Phreeqc::
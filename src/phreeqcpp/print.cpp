@@ -85,6 +85,7 @@ print_all(void)
  *   Each routine is controlled by a variable in structure print.
  *   print.all == FALSE will turn off all prints.
  */
+	ProfilerScope profiler_scope(profiler, "print_all");
 	if (pr.all == FALSE)
 	{
 		set_pr_in_false();
@@ -129,6 +130,7 @@ int Phreeqc::
 punch_all(void)
 /* ---------------------------------------------------------------------- */
 {
+	ProfilerScope profiler_scope(profiler, "punch_all");
 //#ifndef PHREEQ98		/* if not PHREEQ98 use the standard declaration */
 //	if (pr.hdf == FALSE && (punch.in == FALSE || pr.punch == FALSE) && user_graph->commands == NULL)
 //		return (OK);
@@ -1213,8 +1215,10 @@ print_saturation_indices(void)
 	LDBLE si, iap;
 	LDBLE lk;
 	LDBLE la_eminus;
+	LDBLE l_logk[MAX_LOG_K_INDICES];
 	struct rxn_token *rxn_ptr;
 	struct reaction *reaction_ptr;
+	struct species *s_ptr;
 	bool gas = true;
 
 	if (pr.saturation_indices == FALSE || pr.all == FALSE)
@@ -1224,7 +1228,7 @@ print_saturation_indices(void)
 		iap = 0;
 		for (size_t tok = 1; tok < pe_x[default_pe_x].Get_tokens().size(); tok++)
 		{
-			iap += pe_x[default_pe_x].Get_tokens()[tok].coef * pe_x[default_pe_x].Get_tokens()[tok].s->la;
+			iap += pe_x[default_pe_x].Get_tokens()[tok].coef * s_local(pe_x[default_pe_x].Get_tokens()[tok].s)->la;
 			/* fprintf(output,"\t%s\t%f\t%f\n", rxn_ptr->s->name, rxn_ptr->coef, rxn_ptr->s->la ); */
 		}
 		lk = k_calc(pe_x[default_pe_x].Get_logk(), tk_x, patm_x * PASCAL_PER_ATM);
@@ -1265,18 +1269,20 @@ print_saturation_indices(void)
 /*
  *   Print saturation index
  */
-		reaction_ptr->logk[delta_v] = calc_delta_v(reaction_ptr, true) -
+		memcpy(l_logk, reaction_ptr->logk, sizeof(l_logk));
+		l_logk[delta_v] = calc_delta_v(reaction_ptr, true) -
 			 phases[i]->logk[vm0];
-		if (reaction_ptr->logk[delta_v])
+		if (l_logk[delta_v])
 				mu_terms_in_logk = true;
-		lk = k_calc(reaction_ptr->logk, tk_x, patm_x * PASCAL_PER_ATM);
+		lk = k_calc(l_logk, tk_x, patm_x * PASCAL_PER_ATM);
 		iap = 0.0;
 		for (rxn_ptr = reaction_ptr->token + 1; rxn_ptr->s != NULL;
 			 rxn_ptr++)
 		{
-			if (rxn_ptr->s != s_eminus)
+			s_ptr = s_local(rxn_ptr->s);
+			if (s_ptr != s_eminus)
 			{
-				iap += (rxn_ptr->s->lm + rxn_ptr->s->lg) * rxn_ptr->coef;
+				iap += (s_ptr->lm + s_ptr->lg) * rxn_ptr->coef;
 			}
 			else
 			{
@@ -1330,9 +1336,11 @@ print_pp_assemblage(void)
  */
 	int j, k;
 	LDBLE si, iap, lk;
+	LDBLE l_logk[MAX_LOG_K_INDICES];
 	char token[MAX_LENGTH];
 	struct rxn_token *rxn_ptr;
 	struct phase *phase_ptr;
+	struct species *s_ptr;
 
 	if (pr.pp_assemblage == FALSE || pr.all == FALSE)
 		return (OK);
@@ -1368,17 +1376,19 @@ print_pp_assemblage(void)
 		else
 		{
 			phase_ptr = x[j]->phase;
-			phase_ptr->rxn->logk[delta_v] = calc_delta_v(phase_ptr->rxn, true) -
+			memcpy(l_logk, phase_ptr->rxn->logk, sizeof(l_logk));
+			l_logk[delta_v] = calc_delta_v(phase_ptr->rxn, true) -
 				phase_ptr->logk[vm0];
-			if (phase_ptr->rxn->logk[delta_v])
+			if (l_logk[delta_v])
 				mu_terms_in_logk = true;
-			lk = k_calc(phase_ptr->rxn->logk, tk_x, patm_x * PASCAL_PER_ATM);
+			lk = k_calc(l_logk, tk_x, patm_x * PASCAL_PER_ATM);
 			for (rxn_ptr = phase_ptr->rxn->token + 1; rxn_ptr->s != NULL;
 				 rxn_ptr++)
 			{
-				if (rxn_ptr->s != s_eminus)
+				s_ptr = s_local(rxn_ptr->s);
+				if (s_ptr != s_eminus)
 				{
-					iap += (rxn_ptr->s->lm + rxn_ptr->s->lg) * rxn_ptr->coef;
+					iap += (s_ptr->lm + s_ptr->lg) * rxn_ptr->coef;
 				}
 				else
 				{
@@ -2615,11 +2625,11 @@ punch_gas_phase(void)
 		}
 		if (!current_selected_output->Get_high_precision())
 		{
-			fpunchf(sformatf("g_%s", current_selected_output->Get_gases()[i].first.c_str()), "%12.4e\t", (double) moles);
+			fpunchf(punch_name("g_", current_selected_output->Get_gases()[i].first), "%12.4e\t", (double) moles);
 		}
 		else
 		{
-			fpunchf(sformatf("g_%s", current_selected_output->Get_gases()[i].first.c_str()), "%20.12e\t",
+			fpunchf(punch_name("g_", current_selected_output->Get_gases()[i].first), "%20.12e\t",
 					(double) moles);
 		}
 	}
@@ -2665,12 +2675,12 @@ punch_ss_assemblage(void)
 						}
 						if (!current_selected_output->Get_high_precision())
 						{
-							fpunchf(sformatf("s_%s", current_selected_output->Get_s_s()[k].first.c_str()),
+							fpunchf(punch_name("s_", current_selected_output->Get_s_s()[k].first),
 									"%12.4e\t", (double) moles);
 						}
 						else
 						{
-							fpunchf(sformatf("s_%s", current_selected_output->Get_s_s()[k].first.c_str()),
+							fpunchf(punch_name("s_", current_selected_output->Get_s_s()[k].first),
 									"%20.12e\t", (double) moles);
 						}
 						found = TRUE;
@@ -2685,11 +2695,11 @@ punch_ss_assemblage(void)
 		{
 			if (!current_selected_output->Get_high_precision())
 			{
-				fpunchf(sformatf("s_%s", current_selected_output->Get_s_s()[k].first.c_str()), "%12.4e\t", (double) 0.0);
+				fpunchf(punch_name("s_", current_selected_output->Get_s_s()[k].first), "%12.4e\t", (double) 0.0);
 			}
 			else
 			{
-				fpunchf(sformatf("s_%s", current_selected_output->Get_s_s()[k].first.c_str()), "%20.12e\t",
+				fpunchf(punch_name("s_", current_selected_output->Get_s_s()[k].first), "%20.12e\t",
 						(double) 0.0);
 			}
 		}
@@ -2730,12 +2740,12 @@ punch_totals(void)
 		}
 		if (!current_selected_output->Get_high_precision())
 		{
-			fpunchf(sformatf("%s(mol/kgw)", current_selected_output->Get_totals()[j].first.c_str()),
+			fpunchf(punch_name("", current_selected_output->Get_totals()[j].first, "(mol/kgw)"),
 					"%12.4e\t", (double) molality);
 		}
 		else
 		{
-			fpunchf(sformatf("%s(mol/kgw)", current_selected_output->Get_totals()[j].first.c_str()),
+			fpunchf(punch_name("", current_selected_output->Get_totals()[j].first, "(mol/kgw)"),
 					"%20.12e\t", (double) molality);
 		}
 	}
@@ -2763,12 +2773,12 @@ punch_molalities(void)
 		}
 		if (!current_selected_output->Get_high_precision())
 		{
-			fpunchf(sformatf("m_%s(mol/kgw)", current_selected_output->Get_molalities()[j].first.c_str()),
+			fpunchf(punch_name("m_", current_selected_output->Get_molalities()[j].first, "(mol/kgw)"),
 					"%12.4e\t", (double) molality);
 		}
 		else
 		{
-			fpunchf(sformatf("m_%s(mol/kgw)", current_selected_output->Get_molalities()[j].first.c_str()),
+			fpunchf(punch_name("m_", current_selected_output->Get_molalities()[j].first, "(mol/kgw)"),
 					"%20.12e\t", (double) molality);
 		}
 	}
@@ -2797,12 +2807,12 @@ punch_activities(void)
 		}
 		if (!current_selected_output->Get_high_precision())
 		{
-			fpunchf(sformatf("la_%s", current_selected_output->Get_activities()[j].first.c_str()), "%12.4e\t",
+			fpunchf(punch_name("la_", current_selected_output->Get_activities()[j].first), "%12.4e\t",
 					(double) la);
 		}
 		else
 		{
-			fpunchf(sformatf("la_%s", current_selected_output->Get_activities()[j].first.c_str()),
+			fpunchf(punch_name("la_", current_selected_output->Get_activities()[j].first),
 					"%20.12e\t", (double) la);
 		}
 	}
@@ -2855,13 +2865,13 @@ punch_pp_assemblage(void)
 		if (!current_selected_output->Get_high_precision())
 		{
 			fpunchf(current_selected_output->Get_pure_phases()[i].first.c_str(), "%12.4e\t", (double) moles);
-			fpunchf(sformatf("d_%s", current_selected_output->Get_pure_phases()[i].first.c_str()), "%12.4e\t",
+			fpunchf(punch_name("d_", current_selected_output->Get_pure_phases()[i].first), "%12.4e\t",
 					(double) delta_moles);
 		}
 		else
 		{
 			fpunchf(current_selected_output->Get_pure_phases()[i].first.c_str(), "%20.12e\t", (double) moles);
-			fpunchf(sformatf("d_%s", current_selected_output->Get_pure_phases()[i].first.c_str()),
+			fpunchf(punch_name("d_", current_selected_output->Get_pure_phases()[i].first),
 					"%20.12e\t", (double) delta_moles);
 		}
 	}
@@ -3247,11 +3257,11 @@ punch_saturation_indices(void)
 		}
 		if (!current_selected_output->Get_high_precision())
 		{
-			fpunchf(sformatf("si_%s", current_selected_output->Get_si()[i].first.c_str()), "%12.4f\t", (double) si);
+			fpunchf(punch_name("si_", current_selected_output->Get_si()[i].first), "%12.4f\t", (double) si);
 		}
 		else
 		{
-			fpunchf(sformatf("si_%s", current_selected_output->Get_si()[i].first.c_str()), "%20.12e\t", (double) si);
+			fpunchf(punch_name("si_", current_selected_output->Get_si()[i].first), "%20.12e\t", (double) si);
 		}
 	}
 	return (OK);
@@ -3311,16 +3321,16 @@ punch_kinetics(void)
 		}
 		if (!current_selected_output->Get_high_precision())
 		{
-			fpunchf(sformatf("k_%s", current_selected_output->Get_kinetics()[i].first.c_str()), "%12.4e\t",
+			fpunchf(punch_name("k_", current_selected_output->Get_kinetics()[i].first), "%12.4e\t",
 					(double) moles);
-			fpunchf(sformatf("dk_%s", current_selected_output->Get_kinetics()[i].first.c_str()), "%12.4e\t",
+			fpunchf(punch_name("dk_", current_selected_output->Get_kinetics()[i].first), "%12.4e\t",
 					(double) delta_moles);
 		}
 		else
 		{
-			fpunchf(sformatf("k_%s", current_selected_output->Get_kinetics()[i].first.c_str()), "%20.12e\t",
+			fpunchf(punch_name("k_", current_selected_output->Get_kinetics()[i].first), "%20.12e\t",
 					(double) moles);
-			fpunchf(sformatf("dk_%s", current_selected_output->Get_kinetics()[i].first.c_str()), "%20.12e\t",
+			fpunchf(punch_name("dk_", current_selected_output->Get_kinetics()[i].first), "%20.12e\t",
 					(double) delta_moles);
 		}
 	}
@@ -3596,6 +3606,22 @@ sformatf(const char *format, ...)
 	return sformatf_buffer;
 }
 
+/* ---------------------------------------------------------------------- */
+const char * Phreeqc::
+punch_name(const char *prefix, const std::string &name, const char *suffix)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Builds the selected-output column name prefix + name + suffix
+ *   without going through vsnprintf; the buffer is reused, so the
+ *   result is valid until the next call.
+ */
+	punch_name_buffer.assign(prefix);
+	punch_name_buffer.append(name);
+	punch_name_buffer.append(suffix);
+	return punch_name_buffer.c_str();
+}
+
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
 print_alkalinity(void)
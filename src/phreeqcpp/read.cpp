@@ -24,6 +24,7 @@ int Phreeqc::
 read_input(void)
 /* ---------------------------------------------------------------------- */
 {
+	ProfilerScope profiler_scope(profiler, "read_input");
 	int i, j, l;
 	char *ptr;
 	char token[2 * MAX_LENGTH];
@@ -33,6 +34,7 @@ read_input(void)
 	input_error = 0;
 	next_keyword = Keywords::KEY_NONE;
 	count_warnings = 0;
+	workers_free();
 
 	Rxn_new_exchange.clear();
 	Rxn_new_gas_phase.clear();
@@ -94,6 +96,20 @@ read_input(void)
 		{
 			keycount[next_keyword]++;
 		}
+		// species, phases, master species, or log K expressions are about to change
+		if (shared_definitions != NULL &&
+			(next_keyword == Keywords::KEY_SOLUTION_SPECIES ||
+			next_keyword == Keywords::KEY_SOLUTION_MASTER_SPECIES ||
+			next_keyword == Keywords::KEY_PHASES ||
+			next_keyword == Keywords::KEY_EXCHANGE_SPECIES ||
+			next_keyword == Keywords::KEY_EXCHANGE_MASTER_SPECIES ||
+			next_keyword == Keywords::KEY_SURFACE_SPECIES ||
+			next_keyword == Keywords::KEY_SURFACE_MASTER_SPECIES ||
+			next_keyword == Keywords::KEY_NAMED_EXPRESSIONS ||
+			next_keyword == Keywords::KEY_DATABASE))
+		{
+			unshare_definitions();
+		}
 		switch (next_keyword)
 		{
 		case Keywords::KEY_NONE:				/* Have not read line with keyword */
@@ -2048,9 +2064,11 @@ read_kinetics(void)
 		"cvode",				/* 12 */
 		"cvode_steps",			/* 13 */
 		"cvode_order",			/* 14 */
-		"time_steps"			/* 15 */
+		"time_steps",			/* 15 */
+		"cvode_jacobian_steps",	/* 16 */
+		"rk_reuse_tol"			/* 17 */
 	};
-	int count_opt_list = 16;
+	int count_opt_list = 18;
 
 /*
  *   Read kinetics number
@@ -2445,6 +2463,39 @@ read_kinetics(void)
 				}
 			}
 			break;
+		case 16:				/* cvode_jacobian_steps */
+			{
+				int j = copy_token(token, &next_char);
+				if (j == DIGIT)
+				{
+					temp_kinetics.Set_cvode_jacobian_steps((int) strtod(token.c_str(), &ptr));
+				}
+				else if (j == EMPTY)
+				{
+				}
+				else
+				{
+					error_string = sformatf(
+						"Expecting maximum number of cvode steps between jacobian evaluations.");
+					error_msg(error_string, CONTINUE);
+					input_error++;
+				}
+			}
+			break;
+		case 17:				/* rk_reuse_tol */
+			if (copy_token(token, &next_char) == DIGIT)
+			{
+				sscanf(token.c_str(), SCANFORMAT, &dummy);
+				temp_kinetics.Set_rk_reuse_tol(dummy);
+			}
+			else
+			{
+				error_string = sformatf(
+						"Expecting numerical value for rk_reuse_tol.");
+				error_msg(error_string, CONTINUE);
+				input_error++;
+			}
+			break;
 		}
 		if (return_value == EOF || return_value == KEYWORD)
 			break;
@@ -8388,9 +8439,16 @@ read_debug(void)
 		"minimum_total",                   /* 21 */  
 		"min_total",                       /* 22 */   
 		"debug_mass_action",               /* 23 */
-		"debug_mass_balance"               /* 24 */
+		"debug_mass_balance",              /* 24 */
+		"workers",                         /* 25 */
+		"sparse_solver",                   /* 26 */
+		"warm_start",                      /* 27 */
+		"logk_grid",                       /* 28 */
+		"analytic_jacobian",               /* 29 */
+		"jacobian_workers",                /* 30 */
+		"solver_stats"                     /* 31 */
 	};
-	int count_opt_list = 25;
+	int count_opt_list = 32;
 /*
  *   Read parameters:
  *	ineq_tol;
@@ -8498,6 +8556,52 @@ read_debug(void)
 		case 24:				/* debug_mass_balance */
 			debug_mass_balance = get_true_false(next_char, TRUE);
 			break;
+		case 25:				/* workers */
+			sscanf(next_char, "%d", &count_workers);
+			if (count_workers < 1)
+				count_workers = 1;
+			break;
+		case 26:				/* sparse_solver */
+			sparse_solver = get_true_false(next_char, TRUE);
+			break;
+		case 27:				/* warm_start */
+			warm_start = get_true_false(next_char, TRUE);
+			break;
+		case 28:				/* logk_grid */
+			{
+				LDBLE dt = 0.0, tol = logk_grid_tol;
+				sscanf(next_char, SCANFORMAT SCANFORMAT, &dt, &tol);
+				if (dt < 0.0 || tol <= 0.0)
+				{
+					input_error++;
+					error_msg("Expected temperature step >= 0 and tolerance > 0 for -logk_grid.", CONTINUE);
+					error_msg(line_save, CONTINUE);
+					break;
+				}
+				logk_grid_dt = dt;
+				logk_grid_tol = tol;
+				logk_table.clear();
+			}
+			break;
+		case 29:				/* analytic_jacobian */
+			analytic_jacobian = get_true_false(next_char, TRUE);
+			break;
+		case 30:				/* jacobian_workers */
+			sscanf(next_char, "%d", &count_jacobian_workers);
+			if (count_jacobian_workers < 1)
+				count_jacobian_workers = 1;
+			break;
+		case 31:				/* solver_stats */
+			{
+				char token[MAX_LENGTH];
+				char *ptr = next_char;
+				int l;
+				if (copy_token(token, &ptr, &l) != EMPTY && (token[0] == 'e' || token[0] == 'E'))
+					solver_stats_on = SOLVER_STATS_EACH;
+				else
+					solver_stats_on = get_true_false(next_char, TRUE);
+			}
+			break;
 		}
 		if (return_value == EOF || return_value == KEYWORD)
 			break;
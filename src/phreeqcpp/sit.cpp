@@ -2,6 +2,10 @@
 #include "phqalloc.h"
 #include "Exchange.h"
 #include "Solution.h"
+/* kernels of sit_kernels */
+#define SITK_EPSILON    0
+#define SITK_EPSILON_MU 1
+#define SITK_COUNT      2
 
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
@@ -471,8 +475,8 @@ int Phreeqc::
 sit(void)
 /* ---------------------------------------------------------------------- */
 {
-  int i, i0, i1;
-  LDBLE param, z0, z1;
+  int i, i0, i1, k;
+  LDBLE z0;
   LDBLE A, AGAMMA, T;
 	/*
 	   LDBLE CONV, XI, XX, OSUM, BIGZ, DI, F, XXX, GAMCLM, 
@@ -582,49 +586,21 @@ sit(void)
 	 *  Sums for sit_LGAMMA, and OSMOT
 	 *  epsilons are tabulated for log10 gamma (not ln gamma)
 	 */
-	//for (i = 0; i < count_sit_param; i++)
-	//{
-	for (size_t j = 0; j < param_list.size(); j++)
+	for (k = sitk_start[SITK_EPSILON]; k < sitk_start[SITK_EPSILON + 1]; k++)
 	{
-		int i = param_list[j];
-		i0 = sit_params[i]->ispec[0];
-		i1 = sit_params[i]->ispec[1];
-		//if (sit_IPRSNT[i0] == FALSE || sit_IPRSNT[i1] == FALSE) continue;
-		z0 = spec[i0]->z;
-		z1 = spec[i1]->z;
-		param = sit_params[i]->p;
-		switch (sit_params[i]->type)
-		{
-		case TYPE_SIT_EPSILON:
-			sit_LGAMMA[i0] += sit_M[i1] * param;
-			sit_LGAMMA[i1] += sit_M[i0] * param;
-			if (z0 == 0.0 && z1 == 0.0)
-			{
-				OSMOT += sit_M[i0] * sit_M[i1] * param / 2.0;
-			}
-			else
-			{
-				OSMOT += sit_M[i0] * sit_M[i1] * param;
-			}
-			break;
-		case TYPE_SIT_EPSILON_MU:
-			sit_LGAMMA[i0] += sit_M[i1] * I * param;
-			sit_LGAMMA[i1] += sit_M[i0] * I * param;
-			OSMOT += sit_M[i0] * sit_M[i1] * param;
-			if (z0 == 0.0 && z1 == 0.0)
-			{
-				OSMOT += sit_M[i0] * sit_M[i1] * param * I / 2.0;
-			}
-			else
-			{
-				OSMOT += sit_M[i0] * sit_M[i1] * param * I;
-			}
-			break;
-		default:
-		case TYPE_Other:
-			error_msg("TYPE_Other in pitz_param list.", STOP);
-			break;
-		}
+		i0 = sitk_i0[k];
+		i1 = sitk_i1[k];
+		sit_LGAMMA[i0] += sit_M[i1] * sitk_lg[k];
+		sit_LGAMMA[i1] += sit_M[i0] * sitk_lg[k];
+		OSMOT += sit_M[i0] * sit_M[i1] * sitk_os[k];
+	}
+	for (k = sitk_start[SITK_EPSILON_MU]; k < sitk_start[SITK_EPSILON_MU + 1]; k++)
+	{
+		i0 = sitk_i0[k];
+		i1 = sitk_i1[k];
+		sit_LGAMMA[i0] += sit_M[i1] * I * sitk_lg[k];
+		sit_LGAMMA[i1] += sit_M[i0] * I * sitk_lg[k];
+		OSMOT += sit_M[i0] * sit_M[i1] * (sitk_lg[k] + sitk_os[k] * I);
 	}
 
 	/*
@@ -752,6 +728,8 @@ set_sit(int initial)
 	s_hplus->lm = s_hplus->la;
 	s_hplus->moles = exp(s_hplus->lm * LOG_10) * mass_water_aq_x;
 	s_eminus->la = -solution_ptr->Get_pe();
+	if (cell_guess_ptr != NULL && cell_guess_apply() == OK)
+		AW = pow((LDBLE) 10.0E0, s_h2o->la);
 	if (initial == TRUE) sit_initial_guesses();
 	if (dl_type_x != cxxSurface::NO_DL)	initial_surface_water();
 	sit_revise_guesses();
@@ -993,6 +971,16 @@ jacobian_sit(void)
 	LDBLE *base;
 	LDBLE d, d1, d2;
 	int i, j;
+	/* KNOBS -analytic_jacobian, as in jacobian_pz */
+	bool analytic = (analytic_jacobian == TRUE && full_pitzer == TRUE);
+	std::vector<LDBLE> numerical;
+	if (analytic && debug_model == TRUE)
+	{
+		analytic_jacobian = FALSE;
+		jacobian_sit();
+		analytic_jacobian = TRUE;
+		numerical.assign(my_array, my_array + count_unknowns * (count_unknowns + 1));
+	}
 Restart:
 	int pz_max_unknowns = max_unknowns;
 	//k_temp(tc_x, patm_x);
@@ -1001,6 +989,8 @@ Restart:
 		molalities(TRUE);
 		sit();
 		residuals();
+		if (analytic)
+			sit_derivatives();
 	}
 	base = (LDBLE *) PHRQ_malloc((size_t) count_unknowns * sizeof(LDBLE));
 	if (base == NULL)
@@ -1091,7 +1081,12 @@ Restart:
 			goto Restart;
 		}
 		if (full_pitzer == TRUE)
-			sit();
+		{
+			if (analytic && x[i]->type != MU)
+				sit_tangent();
+			else
+				sit();
+		}
 		mb_sums();
 		residuals();
 		for (j = 0; j < count_unknowns; j++)
@@ -1146,8 +1141,92 @@ Restart:
 	mb_sums();
 	residuals();
 	free_check_null(base);
+	if (numerical.size() == (size_t) count_unknowns * (count_unknowns + 1))
+		jacobian_difference(numerical);
 	return OK;
 }
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+sit_derivatives(void)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *	Saves the molalities, sit_LGAMMA and AW of the last sit() and, for
+ *	each kernel entry, the factors of its molalities in sit_LGAMMA and of
+ *	their product in OSMOT at the current ionic strength (pz_coef, 2 per
+ *	entry), for sit_tangent.
+ */
+	LDBLE I = mu_x;
+	int k;
+
+	pz_M0.assign(3 * count_s, 0.0);
+	pz_LG0.assign(3 * count_s, 0.0);
+	pz_dM.assign(3 * count_s, 0.0);
+	pz_dLG.assign(3 * count_s, 0.0);
+	pz_AW0 = AW;
+	for (size_t j = 0; j < s_list.size(); j++)
+	{
+		int i = s_list[j];
+		pz_M0[i] = sit_M[i];
+		pz_LG0[i] = sit_LGAMMA[i];
+	}
+	pz_coef.assign(2 * sitk_i0.size(), 0.0);
+	for (k = sitk_start[SITK_EPSILON]; k < sitk_start[SITK_EPSILON + 1]; k++)
+	{
+		pz_coef[2 * k] = sitk_lg[k];
+		pz_coef[2 * k + 1] = sitk_os[k];
+	}
+	for (k = sitk_start[SITK_EPSILON_MU]; k < sitk_start[SITK_EPSILON_MU + 1]; k++)
+	{
+		pz_coef[2 * k] = I * sitk_lg[k];
+		pz_coef[2 * k + 1] = sitk_lg[k] + sitk_os[k] * I;
+	}
+	return (OK);
+}
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+sit_tangent(void)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *	Sets lg_pitzer and AW from the values saved by sit_derivatives for
+ *	the molalities of the current species.  sit_LGAMMA is linear in the
+ *	molalities at constant ionic strength, AW is changed to first order.
+ */
+	LDBLE dOSUM, dOSMOT, d01;
+	const LDBLE *M0 = &pz_M0[0];
+	LDBLE *dM = &pz_dM[0], *dLG = &pz_dLG[0];
+	double log_min = log10(MIN_TOTAL);
+	int i0, i1, k;
+
+	dOSUM = dOSMOT = 0.0;
+	for (size_t j = 0; j < s_list.size(); j++)
+	{
+		int i = s_list[j];
+		LDBLE m = 0.0;
+		if (spec[i]->lm > log_min)
+			m = under(spec[i]->lm);
+		dM[i] = m - M0[i];
+		dLG[i] = 0.0;
+		dOSUM += dM[i];
+	}
+	for (k = 0; k < sitk_start[SITK_COUNT]; k++)
+	{
+		i0 = sitk_i0[k];
+		i1 = sitk_i1[k];
+		d01 = dM[i0] * M0[i1] + M0[i0] * dM[i1];
+		dLG[i0] += pz_coef[2 * k] * dM[i1];
+		dLG[i1] += pz_coef[2 * k] * dM[i0];
+		dOSMOT += pz_coef[2 * k + 1] * d01;
+	}
+	AW = pz_AW0 * (1.0 - (dOSUM + LOG_10 * dOSMOT) / 55.50837e0);
+	for (size_t j = 0; j < s_list.size(); j++)
+	{
+		int i = s_list[j];
+		spec[i]->lg_pitzer = pz_LG0[i] + dLG[i];
+	}
+	return (OK);
+}
 
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
@@ -1183,6 +1262,7 @@ model_sit(void)
 	int count_infeasible, count_basis_change;
 	int debug_model_save;
 	int mass_water_switch_save;
+	LDBLE t0;
 
 /*	debug_model = TRUE; */
 /*	debug_prep = TRUE; */
@@ -1256,14 +1336,19 @@ model_sit(void)
 			/*
 			 *   Calculate jacobian
 			 */
+			t0 = solver_time();
 			gammas_sit();
+			solver_stats_x.time_gammas += solver_time() - t0;
+			t0 = solver_time();
 			jacobian_sums();
 			jacobian_sit();
+			solver_stats_x.time_jacobian += solver_time() - t0;
 			/*
 			 *   Full matrix with pure phases
 			 */
 			if (r == OK || remove_unstable_phases == TRUE)
 			{
+				t0 = solver_time();
 				return_kode = ineq(l_kode);
 				if (return_kode != OK)
 				{
@@ -1283,11 +1368,14 @@ model_sit(void)
 				{
 					ineq(0);
 				}
+				solver_stats_x.time_ineq += solver_time() - t0;
 				reset();
 			}
+			t0 = solver_time();
 			gammas_sit();
 			if (full_pitzer == TRUE)
 				sit();
+			solver_stats_x.time_gammas += solver_time() - t0;
 			if (always_full_pitzer == TRUE)
 			{
 				full_pitzer = TRUE;
@@ -1298,6 +1386,7 @@ model_sit(void)
 			}
 			if (molalities(FALSE) == ERROR)
 			{
+				solver_stats_x.overflows++;
 				sit_revise_guesses();
 			}
 			if (use.Get_surface_ptr() != NULL &&
@@ -1384,6 +1473,9 @@ model_sit(void)
 			   count_basis_change));
 	log_msg(sformatf( "Number of iterations: %d\n", iterations));
 	log_msg(sformatf( "Number of gamma iterations: %d\n\n", gamma_iterations));
+	solver_stats_x.infeasible += count_infeasible;
+	solver_stats_x.basis_changes += count_basis_change;
+	solver_stats_x.iterations += iterations;
 	debug_model = debug_model_save;
 	set_forward_output_to_log(FALSE);
 	if (stop_program == TRUE)
@@ -1627,6 +1719,7 @@ C     Set DW0
 		int i = param_list[j];
 		calc_sit_param(sit_params[i], TK, TR);
 	}
+	sit_kernels();
 	calc_dielectrics(TK - 273.15, patm_x);
 	sit_A0 = A0;
 	OTEMP = TK;
@@ -1640,13 +1733,13 @@ sit_make_lists(void)
 /* ---------------------------------------------------------------------- */
 {
 	double log_min = log10(MIN_TOTAL);
+	std::vector<int> param_list_save;
+	param_list_save.swap(param_list);
 	s_list.clear();
 	cation_list.clear();
 	neutral_list.clear();
 	anion_list.clear();
 	ion_list.clear();
-	param_list.clear();
-	OTEMP = -100.0;	
 	for (int j = 0; j < 3; j++)
 	{
 		int min, max;
@@ -1706,4 +1799,58 @@ sit_make_lists(void)
 		if (sit_IPRSNT[i0] == FALSE || sit_IPRSNT[i1] == FALSE) continue;
 		param_list.push_back(i);
 	}
-}
\ No newline at end of file
+	/* parameters and kernels of PTEMP_SIT are kept for the same list */
+	if (param_list != param_list_save)
+		OTEMP = -100.0;
+}
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+sit_kernels(void)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *	Copies the parameters of param_list into contiguous arrays by type,
+ *	with the epsilons at the temperature of the last PTEMP_SIT:
+ *	  SITK_EPSILON     sit_LGAMMA[i0] += lg M[i1], OSMOT += os M[i0] M[i1]
+ *	  SITK_EPSILON_MU  lg and os are also multiplied by I, and OSMOT has
+ *	                   lg M[i0] M[i1] in addition
+ *	os is halved for two neutral species.
+ */
+	sitk_start.assign(SITK_COUNT + 1, 0);
+	sitk_i0.clear();
+	sitk_i1.clear();
+	sitk_lg.clear();
+	sitk_os.clear();
+	for (int k = 0; k < SITK_COUNT; k++)
+	{
+		sitk_start[k] = (int) sitk_i0.size();
+		for (size_t j = 0; j < param_list.size(); j++)
+		{
+			struct pitz_param *pz_ptr = sit_params[param_list[j]];
+			int kernel;
+			switch (pz_ptr->type)
+			{
+			case TYPE_SIT_EPSILON:
+				kernel = SITK_EPSILON;
+				break;
+			case TYPE_SIT_EPSILON_MU:
+				kernel = SITK_EPSILON_MU;
+				break;
+			default:
+			case TYPE_Other:
+				error_msg("TYPE_Other in pitz_param list.", STOP);
+				continue;
+			}
+			if (kernel != k)
+				continue;
+			LDBLE os = pz_ptr->p;
+			if (spec[pz_ptr->ispec[0]]->z == 0.0 && spec[pz_ptr->ispec[1]]->z == 0.0)
+				os /= 2.0;
+			sitk_i0.push_back(pz_ptr->ispec[0]);
+			sitk_i1.push_back(pz_ptr->ispec[1]);
+			sitk_lg.push_back(pz_ptr->p);
+			sitk_os.push_back(os);
+		}
+	}
+	sitk_start[SITK_COUNT] = (int) sitk_i0.size();
+}
@@ -0,0 +1,305 @@
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+#include "Phreeqc.h"
+#include "phqalloc.h"
+
+/* ----------------------------------------------------------------------
+ *   Sparse LU for the Newton equations of ineq
+ *
+ *   Used with KNOBS -sparse_solver only when an iteration has no
+ *   inequality or optimization rows and the equalities form a square
+ *   system (k == 0, m == 0, l == n in ineq).  Iterations with mineral,
+ *   gas or surface inequalities, and all other systems, are solved by
+ *   cl1 as before.  The first factorization picks
+ *   the pivot rows (threshold partial pivoting, preferring the sparsest
+ *   candidate row) and records the fill pattern of L and U.  Later
+ *   systems with the same rows and a pattern contained in the recorded
+ *   one are refactored with the same pivot order, touching only the
+ *   recorded nonzeros.  The pattern is rebuilt when the rows change, a
+ *   new nonzero appears or a reused pivot becomes too small.
+ *
+ *   Storage is dense: ineq passes a dense n x n array, slu_pattern and
+ *   slu_work are n x n, and each call scans the whole array for new
+ *   nonzeros.  Only the arithmetic of the elimination is sparse, so the
+ *   memory and the scan are O(n^2); this is small for the equation
+ *   counts of a chemical system.
+ * ---------------------------------------------------------------------- */
+#define SLU_PIVOT_THRESHOLD 0.1
+#define SLU_RESIDUAL_TOL    1e-10
+
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+sparse_lu_solve(int n, LDBLE * a, int lda, const int *rows, LDBLE * l_x)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *	Solves the n equations in a (row stride lda, right-hand side in
+ *	column n) for l_x.
+ *	rows identifies the equations, the pattern is reused only while
+ *	rows is unchanged.
+ *	Returns ERROR if the system is singular or the solution is not
+ *	accurate; the caller then uses cl1.
+ */
+	int i, j, k, r;
+	bool analyze;
+
+	if (n <= 0)
+		return (ERROR);
+/*
+ *   Keep the pattern if the equations are the same and no new nonzero
+ */
+	analyze = false;
+	if (n != slu_n || !std::equal(rows, rows + n, slu_key.begin()))
+	{
+		slu_n = n;
+		slu_key.assign(rows, rows + n);
+		slu_pattern.assign((size_t) n * n, 0);
+		analyze = true;
+	}
+	for (i = 0; i < n; i++)
+	{
+		const LDBLE *a_row = &a[i * lda];
+		char *p_row = &slu_pattern[i * n];
+		for (j = 0; j < n; j++)
+		{
+			if (a_row[j] != 0.0 && p_row[j] == 0)
+			{
+				p_row[j] = 1;
+				analyze = true;
+			}
+		}
+	}
+	if (!analyze && sparse_lu_factor(n, a, lda) != OK)
+	{
+		if (debug_model == TRUE)
+		{
+			output_msg(sformatf("Sparse LU: pivot order rejected, iteration %d\n",
+					   iterations));
+		}
+		analyze = true;
+	}
+	if (analyze && sparse_lu_analyze(n, a, lda) != OK)
+	{
+		/* keep nothing from a singular system */
+		slu_n = 0;
+		return (ERROR);
+	}
+/*
+ *   Forward and back substitution
+ */
+	for (k = 0; k < n; k++)
+	{
+		l_x[k] = a[slu_perm[k] * lda + n];
+	}
+	for (k = 0; k < n; k++)
+	{
+		LDBLE yk = l_x[k];
+		if (yk == 0.0)
+			continue;
+		for (j = slu_l_start[k]; j < slu_l_start[k + 1]; j++)
+		{
+			r = slu_l_row[j];
+			l_x[r] -= slu_work[r * n + k] * yk;
+		}
+	}
+	for (k = n - 1; k >= 0; k--)
+	{
+		LDBLE sum = l_x[k];
+		for (j = slu_u_start[k]; j < slu_u_start[k + 1]; j++)
+		{
+			sum -= slu_work[k * n + slu_u_col[j]] * l_x[slu_u_col[j]];
+		}
+		l_x[k] = sum / slu_work[k * n + k];
+	}
+/*
+ *   Check residual of each equation against the size of its terms
+ */
+	for (i = 0; i < n; i++)
+	{
+		const LDBLE *a_row = &a[i * lda];
+		const char *p_row = &slu_pattern[i * n];
+		LDBLE resid = -a_row[n];
+		LDBLE scale = fabs(a_row[n]);
+		for (j = 0; j < n; j++)
+		{
+			if (p_row[j] == 0)
+				continue;
+			resid += a_row[j] * l_x[j];
+			scale += fabs(a_row[j] * l_x[j]);
+		}
+		if (!(fabs(resid) <= SLU_RESIDUAL_TOL * scale))
+		{
+			if (debug_model == TRUE)
+			{
+				output_msg(sformatf("Sparse LU: residual %e in row %d, using cl1\n",
+						   (double) resid, i));
+			}
+			return (ERROR);
+		}
+	}
+	return (OK);
+}
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+sparse_lu_analyze(int n, LDBLE * a, int lda)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *	Factors a with threshold partial pivoting on slu_pattern and
+ *	records the pivot order and the structure of L and U.
+ *	slu_work holds L and U on return, rows in pivot order.
+ */
+	int i, j, k, r, p;
+	std::vector<char> s(slu_pattern);
+	std::vector<int> row_count(n);
+	std::vector<LDBLE> col_max(n, 0.0);
+
+	slu_work.resize((size_t) n * n);
+	slu_perm.resize(n);
+	for (i = 0; i < n; i++)
+	{
+		slu_perm[i] = i;
+		row_count[i] = 0;
+		for (j = 0; j < n; j++)
+		{
+			slu_work[i * n + j] = a[i * lda + j];
+			row_count[i] += s[i * n + j];
+			if (fabs(a[i * lda + j]) > col_max[j])
+				col_max[j] = fabs(a[i * lda + j]);
+		}
+	}
+	for (k = 0; k < n; k++)
+	{
+		/*
+		 *   Largest candidate in the column, then the sparsest row
+		 *   within the threshold of it
+		 */
+		LDBLE big = 0.0;
+		for (r = k; r < n; r++)
+		{
+			if (s[r * n + k] && fabs(slu_work[r * n + k]) > big)
+				big = fabs(slu_work[r * n + k]);
+		}
+		if (big <= DBL_EPSILON * col_max[k])
+			return (ERROR);
+		p = -1;
+		for (r = k; r < n; r++)
+		{
+			if (s[r * n + k] && fabs(slu_work[r * n + k]) >= SLU_PIVOT_THRESHOLD * big
+				&& (p < 0 || row_count[r] < row_count[p]))
+				p = r;
+		}
+		if (p != k)
+		{
+			for (j = 0; j < n; j++)
+			{
+				LDBLE t = slu_work[k * n + j];
+				slu_work[k * n + j] = slu_work[p * n + j];
+				slu_work[p * n + j] = t;
+				char c = s[k * n + j];
+				s[k * n + j] = s[p * n + j];
+				s[p * n + j] = c;
+			}
+			std::swap(slu_perm[k], slu_perm[p]);
+			std::swap(row_count[k], row_count[p]);
+		}
+		LDBLE pivot = slu_work[k * n + k];
+		for (r = k + 1; r < n; r++)
+		{
+			if (s[r * n + k] == 0)
+				continue;
+			LDBLE l = slu_work[r * n + k] / pivot;
+			slu_work[r * n + k] = l;
+			for (j = k + 1; j < n; j++)
+			{
+				if (s[k * n + j] == 0)
+					continue;
+				slu_work[r * n + j] -= l * slu_work[k * n + j];
+				if (s[r * n + j] == 0)
+				{
+					s[r * n + j] = 1;
+					row_count[r]++;
+				}
+			}
+		}
+	}
+/*
+ *   Structure of L by column and of U by row, in pivot order
+ */
+	slu_l_start.assign(n + 1, 0);
+	slu_u_start.assign(n + 1, 0);
+	slu_l_row.clear();
+	slu_u_col.clear();
+	for (k = 0; k < n; k++)
+	{
+		slu_l_start[k] = (int) slu_l_row.size();
+		for (r = k + 1; r < n; r++)
+		{
+			if (s[r * n + k])
+				slu_l_row.push_back(r);
+		}
+		slu_u_start[k] = (int) slu_u_col.size();
+		for (j = k + 1; j < n; j++)
+		{
+			if (s[k * n + j])
+				slu_u_col.push_back(j);
+		}
+	}
+	slu_l_start[n] = (int) slu_l_row.size();
+	slu_u_start[n] = (int) slu_u_col.size();
+	if (debug_model == TRUE)
+	{
+		output_msg(sformatf("Sparse LU: analyzed %d equations, %d in L, %d in U\n",
+				   n, (int) slu_l_row.size(), (int) slu_u_col.size() + n));
+	}
+	return (OK);
+}
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+sparse_lu_factor(int n, LDBLE * a, int lda)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *	Factors a with the pivot order and structure of the last analysis.
+ *	Returns ERROR if a pivot falls below the threshold of its column.
+ */
+	int i, j, k, r, jj;
+
+	for (k = 0; k < n; k++)
+	{
+		const LDBLE *a_row = &a[slu_perm[k] * lda];
+		LDBLE *w_row = &slu_work[k * n];
+		for (j = 0; j < n; j++)
+		{
+			w_row[j] = a_row[j];
+		}
+	}
+	for (k = 0; k < n; k++)
+	{
+		LDBLE pivot = slu_work[k * n + k];
+		LDBLE big = fabs(pivot);
+		for (i = slu_l_start[k]; i < slu_l_start[k + 1]; i++)
+		{
+			LDBLE t = fabs(slu_work[slu_l_row[i] * n + k]);
+			if (t > big)
+				big = t;
+		}
+		if (big == 0.0 || fabs(pivot) < SLU_PIVOT_THRESHOLD * big)
+			return (ERROR);
+		for (i = slu_l_start[k]; i < slu_l_start[k + 1]; i++)
+		{
+			r = slu_l_row[i];
+			LDBLE l = slu_work[r * n + k] / pivot;
+			slu_work[r * n + k] = l;
+			if (l == 0.0)
+				continue;
+			for (jj = slu_u_start[k]; jj < slu_u_start[k + 1]; jj++)
+			{
+				j = slu_u_col[jj];
+				slu_work[r * n + j] -= l * slu_work[k * n + j];
+			}
+		}
+	}
+	return (OK);
+}
@@ -25,6 +25,9 @@ clean_up(void)
  *   Free all allocated memory, except strings
  */
 	int i, j;
+
+	/* workers may share this instance's strings */
+	workers_free();
 #if defined MULTICHART
 	chart_handler.End_timer();
 	output_flush();
@@ -130,6 +133,7 @@ clean_up(void)
 		phases[j] = (struct phase *) free_check_null(phases[j]);
 	}
 	phases = (struct phase **) free_check_null(phases);
+	shared_definitions = NULL;
 
 /* inverse */
 	for (j = 0; j < count_inverse; j++)
@@ -1391,11 +1395,14 @@ phase_free(struct phase *phase_ptr)
 		(struct elt_list *) free_check_null(phase_ptr->next_elt);
 	phase_ptr->next_sys_total =
 		(struct elt_list *) free_check_null(phase_ptr->next_sys_total);
-	rxn_free(phase_ptr->rxn);
-	rxn_free(phase_ptr->rxn_s);
+	if (shared_definitions == NULL)
+	{
+		rxn_free(phase_ptr->rxn);
+		rxn_free(phase_ptr->rxn_s);
+		phase_ptr->add_logk =
+			(struct name_coef *) free_check_null(phase_ptr->add_logk);
+	}
 	rxn_free(phase_ptr->rxn_x);
-	phase_ptr->add_logk =
-		(struct name_coef *) free_check_null(phase_ptr->add_logk);
 	return (OK);
 }
 
@@ -1843,6 +1850,10 @@ rxn_dup(struct reaction *rxn_ptr_old)
  */
 	memcpy(rxn_ptr_new->token, rxn_ptr_old->token,
 		   (size_t) (i + 1) * sizeof(struct rxn_token));
+	for (i = 0; rxn_ptr_new->token[i].s != NULL; i++)
+	{
+		rxn_ptr_new->token[i].s = s_local(rxn_ptr_new->token[i].s);
+	}
 
 	return (rxn_ptr_new);
 }
@@ -2063,9 +2074,12 @@ s_free(struct species *s_ptr)
 		(struct elt_list *) free_check_null(s_ptr->next_secondary);
 	s_ptr->next_sys_total =
 		(struct elt_list *) free_check_null(s_ptr->next_sys_total);
-	s_ptr->add_logk = (struct name_coef *) free_check_null(s_ptr->add_logk);
-	rxn_free(s_ptr->rxn);
-	rxn_free(s_ptr->rxn_s);
+	if (shared_definitions == NULL)
+	{
+		s_ptr->add_logk = (struct name_coef *) free_check_null(s_ptr->add_logk);
+		rxn_free(s_ptr->rxn);
+		rxn_free(s_ptr->rxn_s);
+	}
 	rxn_free(s_ptr->rxn_x);
 	return (OK);
 }
@@ -2171,10 +2185,8 @@ s_search(const char *name)
  */
 	struct species *s_ptr;
 	ENTRY item, *found_item;
-	char safe_name[MAX_LENGTH];
 
-	strcpy(safe_name, name);
-	item.key = safe_name;
+	item.key = name;
 	item.data = NULL;
 	found_item = hsearch_multi(species_hash_table, item, FIND);
 	if (found_item != NULL)
@@ -2185,6 +2197,126 @@ s_search(const char *name)
 	return (NULL);
 }
 
+/* ---------------------------------------------------------------------- */
+struct species * Phreeqc::
+s_local(struct species *s_ptr)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Reactions shared with another instance (see InternalCopy) point to the
+ *   species of shared_definitions; this instance has its species in the
+ *   same order.
+ *
+ *   The owner's basic_bind_generation changes when its species may have
+ *   been redefined, like the names bound in BASIC programs (see
+ *   PBasic::boundfactor); the tokens are then no longer valid.
+ *
+ *   Returns:
+ *      this instance's species for a species of shared_definitions,
+ *      else s_ptr.
+ */
+	if (shared_definitions != NULL &&
+		shared_definitions->basic_bind_generation != shared_bind_generation)
+	{
+		error_msg("Shared species definitions changed after they were attached.", STOP);
+	}
+	if (shared_definitions != NULL && s_ptr != NULL &&
+		s_ptr->number >= 0 && s_ptr->number < shared_definitions->count_s &&
+		shared_definitions->s[s_ptr->number] == s_ptr)
+	{
+		return (s[s_ptr->number]);
+	}
+	return (s_ptr);
+}
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+shared_reaction_count(void)const
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Returns the number of species and phase reactions that are shared
+ *   with another instance rather than owned
+ */
+	int i, n;
+
+	if (shared_definitions == NULL)
+		return (0);
+	n = 0;
+	for (i = 0; i < count_s && i < shared_definitions->count_s; i++)
+	{
+		if (s[i]->rxn != NULL && s[i]->rxn == shared_definitions->s[i]->rxn)
+			n++;
+		if (s[i]->rxn_s != NULL && s[i]->rxn_s == shared_definitions->s[i]->rxn_s)
+			n++;
+	}
+	for (i = 0; i < count_phases && i < shared_definitions->count_phases; i++)
+	{
+		if (phases[i]->rxn != NULL && phases[i]->rxn == shared_definitions->phases[i]->rxn)
+			n++;
+		if (phases[i]->rxn_s != NULL && phases[i]->rxn_s == shared_definitions->phases[i]->rxn_s)
+			n++;
+	}
+	return (n);
+}
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+unshare_definitions(void)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Copies the reactions and log K lists shared with another instance,
+ *   as InternalCopy does, before species, phases, or master species are
+ *   read or tidied
+ */
+	int i;
+	struct name_coef *add_logk;
+
+	if (shared_definitions == NULL)
+		return;
+	for (i = 0; i < count_s; i++)
+	{
+		if (s[i]->rxn != NULL)
+		{
+			cxxChemRxn rxn(s[i]->rxn);
+			s[i]->rxn = cxxChemRxn2rxn(rxn);
+		}
+		if (s[i]->rxn_s != NULL)
+		{
+			cxxChemRxn rxn_s(s[i]->rxn_s);
+			s[i]->rxn_s = cxxChemRxn2rxn(rxn_s);
+		}
+		add_logk = s[i]->add_logk;
+		s[i]->add_logk = NULL;
+		if (s[i]->count_add_logk > 0)
+		{
+			s[i]->add_logk = (struct name_coef *) PHRQ_malloc((size_t) s[i]->count_add_logk * sizeof(struct name_coef));
+			if (s[i]->add_logk == NULL) malloc_error();
+			memcpy(s[i]->add_logk, add_logk, (size_t) s[i]->count_add_logk * sizeof(struct name_coef));
+		}
+	}
+	for (i = 0; i < count_phases; i++)
+	{
+		if (phases[i]->rxn != NULL)
+		{
+			cxxChemRxn rxn(phases[i]->rxn);
+			phases[i]->rxn = cxxChemRxn2rxn(rxn);
+		}
+		if (phases[i]->rxn_s != NULL)
+		{
+			cxxChemRxn rxn_s(phases[i]->rxn_s);
+			phases[i]->rxn_s = cxxChemRxn2rxn(rxn_s);
+		}
+		add_logk = phases[i]->add_logk;
+		phases[i]->add_logk = NULL;
+		if (phases[i]->count_add_logk > 0)
+		{
+			phases[i]->add_logk = (struct name_coef *) PHRQ_malloc((size_t) phases[i]->count_add_logk * sizeof(struct name_coef));
+			if (phases[i]->add_logk == NULL) malloc_error();
+			memcpy(phases[i]->add_logk, add_logk, (size_t) phases[i]->count_add_logk * sizeof(struct name_coef));
+		}
+	}
+	shared_definitions = NULL;
+}
 /* ---------------------------------------------------------------------- */
 struct species * Phreeqc::
 s_store(const char *name, LDBLE l_z, int replace_if_found)
@@ -2727,7 +2859,7 @@ trxn_add(cxxChemRxn &r_ptr, LDBLE coef, int combine)
 				  &max_trxn, sizeof(struct rxn_token_temp));
 		}
 		trxn.token[count_trxn].name = r_ptr.Get_tokens()[j].name;
-		trxn.token[count_trxn].s = r_ptr.Get_tokens()[j].s;
+		trxn.token[count_trxn].s = s_local(r_ptr.Get_tokens()[j].s);
 		trxn.token[count_trxn].coef = coef * r_ptr.Get_tokens()[j].coef;
 		count_trxn++;
 	}
@@ -2792,7 +2924,7 @@ trxn_add(struct reaction *r_ptr, LDBLE coef, int combine)
 				  &max_trxn, sizeof(struct rxn_token_temp));
 		}
 		trxn.token[count_trxn].name = next_token->s->name;
-		trxn.token[count_trxn].s = next_token->s;
+		trxn.token[count_trxn].s = s_local(next_token->s);
 		trxn.token[count_trxn].coef = coef * next_token->coef;
 		count_trxn++;
 		next_token++;
@@ -2852,7 +2984,7 @@ trxn_add_phase(struct reaction *r_ptr, LDBLE coef, int combine)
 		if (next_token->s != NULL)
 		{
 			trxn.token[count_trxn].name = next_token->s->name;
-			trxn.token[count_trxn].s = next_token->s;
+			trxn.token[count_trxn].s = s_local(next_token->s);
 		}
 		else
 		{
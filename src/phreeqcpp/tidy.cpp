@@ -15,6 +15,7 @@ int Phreeqc::
 tidy_model(void)
 /* ---------------------------------------------------------------------- */
 {
+	ProfilerScope profiler_scope(profiler, "tidy_model");
 	int n_user, last;
 	int new_named_logk;
 	/*
@@ -59,6 +60,8 @@ tidy_model(void)
 		)
 	{							
 		new_model = TRUE;
+		/* names bound in BASIC programs may be redefined or deleted */
+		basic_bind_generation++;
 	}
 	if (keycount[Keywords::KEY_EQUILIBRIUM_PHASES] > 0		|| 
 		keycount[Keywords::KEY_EQUILIBRIUM_PHASES_RAW] > 0	||
@@ -173,6 +176,8 @@ tidy_model(void)
 	if (new_model)
 	{
 		sum_species_map.clear();
+		/* warm-start guesses refer to master species by number */
+		cell_guess_map.clear();
 
 		tidy_species();
 
@@ -436,7 +441,7 @@ check_species_input(void)
 					s[i]->name);
 			error_msg(error_string, CONTINUE);
 		}
-		else
+		else if (shared_definitions == NULL)
 		{
 			select_log_k_expression(s[i]->logk, s[i]->rxn->logk);
 			add_other_logk(s[i]->rxn->logk, s[i]->count_add_logk,
@@ -1603,6 +1608,11 @@ tidy_phases(void)
 {
 	int i;
 	int replaced;
+	/*
+	 *  Reactions shared with another instance were rewritten there
+	 */
+	if (shared_definitions != NULL)
+		return (OK);
 	/*
 	 *  Fix log Ks first, so they can possibly be added to other phase equations
 	 */
@@ -2819,9 +2829,10 @@ tidy_species(void)
 		master[i]->coef = coef_in_master(master[i]);
 	}
 /*
- *   Rewrite all species to secondary species
+ *   Rewrite all species to secondary species, unless the reactions are
+ *   shared with another instance that did so
  */
-	for (i = 0; i < count_s; i++)
+	for (i = 0; i < count_s && shared_definitions == NULL; i++)
 	{
 		count_trxn = 0;
 		if (s[i]->primary != NULL || s[i]->secondary != NULL)
@@ -2978,7 +2989,7 @@ tidy_species(void)
 			LDBLE exchange_coef = 0.0;
 			for (j = 1; s[i]->rxn_s->token[j].s != NULL; j++)
 			{
-				if (s[i]->rxn_s->token[j].s->type == EX)
+				if (s_local(s[i]->rxn_s->token[j].s)->type == EX)
 				{
 					exchange_coef = s[i]->rxn_s->token[j].coef;
 					break;
@@ -3002,7 +3013,7 @@ tidy_species(void)
 			 */
 			for (j = 1; s[i]->rxn_s->token[j].s != NULL; j++)
 			{
-				if (s[i]->rxn_s->token[j].s->type == SURF)
+				if (s_local(s[i]->rxn_s->token[j].s)->type == SURF)
 				{
 					surface_coef = s[i]->rxn_s->token[j].coef;
 					break;
@@ -3310,7 +3321,7 @@ species_rxn_to_trxn(struct species *s_ptr)
 	{
 		trxn.token[i].name = s_ptr->rxn->token[i].s->name;
 		trxn.token[i].z = s_ptr->rxn->token[i].s->z;
-		trxn.token[i].s = s_ptr->rxn->token[i].s;
+		trxn.token[i].s = s_local(s_ptr->rxn->token[i].s);
 		trxn.token[i].unknown = NULL;
 		trxn.token[i].coef = s_ptr->rxn->token[i].coef;
 		count_trxn = i + 1;
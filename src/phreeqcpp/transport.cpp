@@ -9,38 +9,13 @@
 #include "Solution.h"
 #include <limits.h>
 
-LDBLE F_Re3 = F_C_MOL / (R_KJ_DEG_MOL * 1e3);
-LDBLE tk_x2; // average tx_x of icell and jcell
-LDBLE dV_dcell; // difference in Volt among icell and jcell
-int find_current;
-struct CURRENT_CELLS
-{
-	LDBLE dif, ele, R; // diffusive and electric components, relative cell resistance
-} *current_cells;
-LDBLE sum_R, sum_Rd; // sum of R, sum of (current_cells[0].dif - current_cells[i].dif) * R
-struct V_M   // For calculating Vinograd and McBain's zero-charge, diffusive tranfer of individual solutes
-{
-	LDBLE grad, D, z, c, zc, Dz, Dzc;
-	LDBLE b_ij; // harmonic mean of cell properties, with EDL enrichment
-};
-struct CT /* summed parts of V_M and mcd transfer in a timestep for all cells, for free + DL water */
-{
-	LDBLE dl_s, Dz2c, Dz2c_dl, visc1, visc2, J_ij_sum;
-	LDBLE A_ij_il, Dz2c_il, mixf_il;
-	int J_ij_count_spec, J_ij_il_count_spec;
-	struct V_M *v_m, *v_m_il;
-	struct J_ij *J_ij, *J_ij_il;
-} *ct = NULL;
-struct MOLES_ADDED /* total moles added to balance negative conc's */
-{
-	char *name;
-	LDBLE moles;
-} *moles_added;
+static const LDBLE F_Re3 = F_C_MOL / (R_KJ_DEG_MOL * 1e3);
 /* ---------------------------------------------------------------------- */
 int Phreeqc::
 transport(void)
 /* ---------------------------------------------------------------------- */
 {
+	ProfilerScope profiler_scope(profiler, "transport");
 	int i, j, k, n;
 	int j_imm;
 	LDBLE b, f, mix_f_m, mix_f_imm;
@@ -436,6 +411,8 @@ transport(void)
 			count_cells, count_shifts - transport_start + 1, nmix);
 		screen_msg(token);
 		max_iter = 0;
+		/* cell workers are not used with multicomponent diffusion or potential gradients */
+		bool use_workers = (count_workers > 1 && !multi_Dflag && !dV_dcell);
 		for (transport_step = transport_start; transport_step <= count_shifts;
 			transport_step++)
 		{
@@ -511,56 +488,67 @@ transport(void)
 					if (multi_Dflag)
 						multi_D(stagkin_time, 1, FALSE);
 
-					for (i = 0; i <= count_cells + 1; i++)
+					if (use_workers && change_surf_count == 0)
 					{
-						if (!dV_dcell && (i == 0 || i == count_cells + 1))
-							continue;
+						mixrun = j;
+						transport_workers(WORKER_DISP, kin_time, step_fraction,
+							(ishift == 0 && j == nmix && stag_data->count_stag == 0));
 						if (overall_iterations > max_iter)
 							max_iter = overall_iterations;
-						cell_no = i;
-						mixrun = j;
-						if (multi_Dflag)
-							sprintf(token,
-							"Transport step %3d. MCDrun %3d. Cell %3d. (Max. iter %3d)",
-							transport_step, j, i, max_iter);
-						else
-							sprintf(token,
-							"Transport step %3d. Mixrun %3d. Cell %3d. (Max. iter %3d)",
-							transport_step, j, i, max_iter);
-						status(0, token);
+					}
+					else
+					{
+						for (i = 0; i <= count_cells + 1; i++)
+						{
+							if (!dV_dcell && (i == 0 || i == count_cells + 1))
+								continue;
+							if (overall_iterations > max_iter)
+								max_iter = overall_iterations;
+							cell_no = i;
+							mixrun = j;
+							if (multi_Dflag)
+								sprintf(token,
+								"Transport step %3d. MCDrun %3d. Cell %3d. (Max. iter %3d)",
+								transport_step, j, i, max_iter);
+							else
+								sprintf(token,
+								"Transport step %3d. Mixrun %3d. Cell %3d. (Max. iter %3d)",
+								transport_step, j, i, max_iter);
+							status(0, token);
 
-						if (i == 0 || i == count_cells + 1)
-							run_reactions(i, kin_time, NOMIX, step_fraction); // nsaver = i
-						else
-							run_reactions(i, kin_time, DISP, step_fraction);  // nsaver = -2
-						if (multi_Dflag)
-							fill_spec(i);
+							if (i == 0 || i == count_cells + 1)
+								run_reactions(i, kin_time, NOMIX, step_fraction); // nsaver = i
+							else
+								run_reactions(i, kin_time, DISP, step_fraction);  // nsaver = -2
+							if (multi_Dflag)
+								fill_spec(i);
 
-						/* punch and output file */
-						if (ishift == 0 && j == nmix && stag_data->count_stag == 0)
-							print_punch(i, true);
-						if (i > 1)
-							Utilities::Rxn_copy(Rxn_solution_map, -2, i - 1);
-						saver();
+							/* punch and output file */
+							if (ishift == 0 && j == nmix && stag_data->count_stag == 0)
+								print_punch(i, true);
+							if (i > 1)
+								Utilities::Rxn_copy(Rxn_solution_map, -2, i - 1);
+							saver();
 
-						/* maybe sorb a surface component... */
-						if (ishift == 0 && j == nmix && (stag_data->count_stag == 0
-							|| Utilities::Rxn_find(Rxn_solution_map, i + 1 + count_cells) == 0))
-						{
-							if (change_surf_count > 0)
+							/* maybe sorb a surface component... */
+							if (ishift == 0 && j == nmix && (stag_data->count_stag == 0
+								|| Utilities::Rxn_find(Rxn_solution_map, i + 1 + count_cells) == 0))
 							{
-								for (k = 0; k < change_surf_count; k++)
+								if (change_surf_count > 0)
 								{
-									if (change_surf[k].cell_no != i)
-										break;
-									reformat_surf(change_surf[k].comp_name,
-										change_surf[k].fraction,
-										change_surf[k].new_comp_name,
-										change_surf[k].new_Dw,
-										change_surf[k].cell_no);
-									change_surf[k].cell_no = -99;
+									for (k = 0; k < change_surf_count; k++)
+									{
+										if (change_surf[k].cell_no != i)
+											break;
+										reformat_surf(change_surf[k].comp_name,
+											change_surf[k].fraction,
+											change_surf[k].new_comp_name,
+											change_surf[k].new_Dw,
+											change_surf[k].cell_no);
+										change_surf[k].cell_no = -99;
+									}
+									change_surf_count = 0;
 								}
-								change_surf_count = 0;
 							}
 						}
 					}
@@ -691,58 +679,70 @@ transport(void)
 					}
 				}
 
-				for (i = 1; i <= count_cells; i++)
+				if (use_workers && change_surf_count == 0 &&
+					(nmix != 0 || stag_data->count_stag == 0))
 				{
-					if (i == first_c && count_cells > 1)
-						kin_time /= 2;
-					cell_no = i;
 					mixrun = 0;
-					if (multi_Dflag)
-						sprintf(token,
-						"Transport step %3d. MCDrun %3d. Cell %3d. (Max. iter %3d)",
-						transport_step, 0, i, max_iter);
-					else
-						sprintf(token,
-						"Transport step %3d. Mixrun %3d. Cell %3d. (Max. iter %3d)",
-						transport_step, 0, i, max_iter);
-					status(0, token);
-					run_reactions(i, kin_time, NOMIX, step_fraction);
-					if (multi_Dflag == TRUE)
-						fill_spec(i);
+					transport_workers(WORKER_NOMIX, kin_time, step_fraction,
+						(nmix == 0 && stag_data->count_stag == 0));
 					if (overall_iterations > max_iter)
 						max_iter = overall_iterations;
-					if (nmix == 0 && stag_data->count_stag == 0)
-						print_punch(i, true);
-					if (i == first_c && count_cells > 1)
-						kin_time = kin_time_save;
-					saver();
-
-					/* maybe sorb a surface component... */
-					if (nmix == 0 && (stag_data->count_stag == 0 ||
-						(Utilities::Rxn_find(Rxn_solution_map, i + 1 + count_cells) == 0)))
+				}
+				else
+				{
+					for (i = 1; i <= count_cells; i++)
 					{
-						if (change_surf_count > 0)
+						if (i == first_c && count_cells > 1)
+							kin_time /= 2;
+						cell_no = i;
+						mixrun = 0;
+						if (multi_Dflag)
+							sprintf(token,
+							"Transport step %3d. MCDrun %3d. Cell %3d. (Max. iter %3d)",
+							transport_step, 0, i, max_iter);
+						else
+							sprintf(token,
+							"Transport step %3d. Mixrun %3d. Cell %3d. (Max. iter %3d)",
+							transport_step, 0, i, max_iter);
+						status(0, token);
+						run_reactions(i, kin_time, NOMIX, step_fraction);
+						if (multi_Dflag == TRUE)
+							fill_spec(i);
+						if (overall_iterations > max_iter)
+							max_iter = overall_iterations;
+						if (nmix == 0 && stag_data->count_stag == 0)
+							print_punch(i, true);
+						if (i == first_c && count_cells > 1)
+							kin_time = kin_time_save;
+						saver();
+
+						/* maybe sorb a surface component... */
+						if (nmix == 0 && (stag_data->count_stag == 0 ||
+							(Utilities::Rxn_find(Rxn_solution_map, i + 1 + count_cells) == 0)))
 						{
-							for (k = 0; k < change_surf_count; k++)
+							if (change_surf_count > 0)
 							{
-								if (change_surf[k].cell_no != i)
-									break;
-								reformat_surf(change_surf[k].comp_name,
-									change_surf[k].fraction,
-									change_surf[k].new_comp_name,
-									change_surf[k].new_Dw,
-									change_surf[k].cell_no);
-								change_surf[k].cell_no = -99;
+								for (k = 0; k < change_surf_count; k++)
+								{
+									if (change_surf[k].cell_no != i)
+										break;
+									reformat_surf(change_surf[k].comp_name,
+										change_surf[k].fraction,
+										change_surf[k].new_comp_name,
+										change_surf[k].new_Dw,
+										change_surf[k].cell_no);
+									change_surf[k].cell_no = -99;
+								}
+								change_surf_count = 0;
 							}
-							change_surf_count = 0;
 						}
-					}
 
-					/* If nmix is zero, stagnant zone mixing after
-					advective step ... */
-					if ((nmix == 0) && (stag_data->count_stag > 0))
-					{
-						mix_stag(i, stagkin_time, TRUE, step_fraction);
+						/* If nmix is zero, stagnant zone mixing after
+						advective step ... */
+						if ((nmix == 0) && (stag_data->count_stag > 0))
+						{
+							mix_stag(i, stagkin_time, TRUE, step_fraction);
+						}
 					}
 				}
 				if (nmix == 0 && stag_data->count_stag > 0)
@@ -808,54 +808,65 @@ transport(void)
 					multi_D(stagkin_time, 1, FALSE);
 
 				/* for each cell in column */
-				for (i = 0; i <= count_cells + 1; i++)
+				if (use_workers && change_surf_count == 0)
 				{
-					if (!dV_dcell && (i == 0 || i == count_cells + 1))
-						continue;
+					mixrun = j;
+					transport_workers(WORKER_DISP, kin_time, step_fraction,
+						(j == nmix && stag_data->count_stag == 0));
 					if (overall_iterations > max_iter)
 						max_iter = overall_iterations;
-					cell_no = i;
-					mixrun = j;
-					if (multi_Dflag)
-						sprintf(token,
-						"Transport step %3d. MCDrun %3d. Cell %3d. (Max. iter %3d)",
-						transport_step, j, i, max_iter);
-					else
-						sprintf(token,
-						"Transport step %3d. Mixrun %3d. Cell %3d. (Max. iter %3d)",
-						transport_step, j, i, max_iter);
-					status(0, token);
+				}
+				else
+				{
+					for (i = 0; i <= count_cells + 1; i++)
+					{
+						if (!dV_dcell && (i == 0 || i == count_cells + 1))
+							continue;
+						if (overall_iterations > max_iter)
+							max_iter = overall_iterations;
+						cell_no = i;
+						mixrun = j;
+						if (multi_Dflag)
+							sprintf(token,
+							"Transport step %3d. MCDrun %3d. Cell %3d. (Max. iter %3d)",
+							transport_step, j, i, max_iter);
+						else
+							sprintf(token,
+							"Transport step %3d. Mixrun %3d. Cell %3d. (Max. iter %3d)",
+							transport_step, j, i, max_iter);
+						status(0, token);
 
-					if (i == 0 || i == count_cells + 1)
-						run_reactions(i, kin_time, NOMIX, step_fraction);
-					else
-						run_reactions(i, kin_time, DISP, step_fraction);
-					if (multi_Dflag == TRUE)
-						fill_spec(i);
-					if (j == nmix && stag_data->count_stag == 0)
-						print_punch(i, true);
-					if (i > 1)
-						Utilities::Rxn_copy(Rxn_solution_map, -2, i - 1);
-					saver();
+						if (i == 0 || i == count_cells + 1)
+							run_reactions(i, kin_time, NOMIX, step_fraction);
+						else
+							run_reactions(i, kin_time, DISP, step_fraction);
+						if (multi_Dflag == TRUE)
+							fill_spec(i);
+						if (j == nmix && stag_data->count_stag == 0)
+							print_punch(i, true);
+						if (i > 1)
+							Utilities::Rxn_copy(Rxn_solution_map, -2, i - 1);
+						saver();
 
-					/* maybe sorb a surface component... */
-					if ((j == nmix) && ((stag_data->count_stag == 0)
-						|| (Utilities::Rxn_find(Rxn_solution_map, i + 1 + count_cells) == 0)))
-					{
-						if (change_surf_count > 0)
+						/* maybe sorb a surface component... */
+						if ((j == nmix) && ((stag_data->count_stag == 0)
+							|| (Utilities::Rxn_find(Rxn_solution_map, i + 1 + count_cells) == 0)))
 						{
-							for (k = 0; k < change_surf_count; k++)
+							if (change_surf_count > 0)
 							{
-								if (change_surf[k].cell_no != i)
-									break;
-								reformat_surf(change_surf[k].comp_name,
-									change_surf[k].fraction,
-									change_surf[k].new_comp_name,
-									change_surf[k].new_Dw,
-									change_surf[k].cell_no);
-								change_surf[k].cell_no = -99;
+								for (k = 0; k < change_surf_count; k++)
+								{
+									if (change_surf[k].cell_no != i)
+										break;
+									reformat_surf(change_surf[k].comp_name,
+										change_surf[k].fraction,
+										change_surf[k].new_comp_name,
+										change_surf[k].new_Dw,
+										change_surf[k].cell_no);
+									change_surf[k].cell_no = -99;
+								}
+								change_surf_count = 0;
 							}
-							change_surf_count = 0;
 						}
 					}
 				}
@@ -926,6 +937,29 @@ transport(void)
 	return (OK);
 }
 /* ---------------------------------------------------------------------- */
+int Phreeqc::
+transport_workers(int task, LDBLE kin_time, LDBLE step_fraction, bool punch)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Runs the reactions of the mobile cells on the cell workers;
+ *   in an advective shift (WORKER_NOMIX), kinetics of the first cell
+ *   are calculated for half the time step
+ */
+	int first_c = (ishift >= 0) ? 1 : count_cells;
+	std::vector<int> cells;
+	std::vector<LDBLE> kin_times;
+	for (int i = 1; i <= count_cells; i++)
+	{
+		cells.push_back(i);
+		if (task == WORKER_NOMIX && i == first_c && count_cells > 1)
+			kin_times.push_back(kin_time / 2);
+		else
+			kin_times.push_back(kin_time);
+	}
+	return (run_cells_workers(task, cells, kin_times, step_fraction, punch));
+}
+/* ---------------------------------------------------------------------- */
 void Phreeqc::
 transport_cleanup(void)
 /* ---------------------------------------------------------------------- */
@@ -1839,7 +1873,7 @@ fill_spec(int l_cell_no)
 				/* find the aqueous species in the exchange reaction... */
 				for (i2 = 0; (s_ptr->rxn->token[i2].s != NULL); i2++)
 				{
-					if ((s_ptr2 = s_ptr->rxn->token[i2].s)->type == AQ)
+					if ((s_ptr2 = s_local(s_ptr->rxn->token[i2].s))->type == AQ)
 						break;
 				}
 				/* copy its name and Dw and charge... */
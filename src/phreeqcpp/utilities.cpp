@@ -1285,6 +1285,14 @@ string_hsave(const char *str)
  *         starting address of saved string (str)
  */
 	std::hash_map<std::string, std::string *>::const_iterator it;
+	if (database_snapshot != NULL)
+	{
+		it = database_snapshot->strings_hash.find(str);
+		if (it != database_snapshot->strings_hash.end())
+		{
+			return (it->second->c_str());
+		}
+	}
 	it = strings_hash.find(str);
 	if (it != strings_hash.end())
 	{
@@ -1332,6 +1340,14 @@ string_hsave(const char *str)
  *         starting address of saved string (str)
  */
 	std::map<std::string, std::string *>::const_iterator it;
+	if (database_snapshot != NULL)
+	{
+		it = database_snapshot->strings_map.find(str);
+		if (it != database_snapshot->strings_map.end())
+		{
+			return (it->second->c_str());
+		}
+	}
 	it = strings_map.find(str);
 	if (it != strings_map.end())
 	{
@@ -1537,130 +1553,57 @@ status(int count, const char *str, bool rk_string)
 }
 #endif /*PHREEQCI_GUI */
 /*
-** Dynamic hashing, after CACM April 1988 pp 446-457, by Per-Ake Larson.
-** Coded into C, with minor code improvements, and with hsearch(3) interface,
-** by ejp@ausmelb.oz, Jul 26, 1988: 13:16;
-** also, hcreate/hdestroy routines added to simulate hsearch(3).
-**
-** These routines simulate hsearch(3) and family, with the important
-** difference that the hash table is dynamic - can grow indefinitely
-** beyond its original size (as supplied to hcreate()).
+** hsearch(3)-style tables with open addressing and linear probing.
 **
-** Performance appears to be comparable to that of hsearch(3).
-** The 'source-code' options referred to in hsearch(3)'s 'man' page
-** are not implemented; otherwise functionality is identical.
+** Keys are strings saved with string_hsave and are never removed, so a
+** slot is either empty (key NULL) or holds a key for the lifetime of the
+** table. The full hash of each key is kept next to the slot; a probe
+** compares hashes, then the interned key pointers, and calls strcmp only
+** when a name was not passed as its saved string. The table doubles when
+** it is more than half full, so probe sequences stay short.
 **
-** Compilation controls:
-** DEBUG controls some informative traces, mainly for debugging.
-** HASH_STATISTICS causes HashAccesses and HashCollisions to be maintained;
-** when combined with DEBUG, these are displayed by hdestroy().
-**
-** Problems & fixes to ejp@ausmelb.oz. WARNING: relies on pre-processor
-** concatenation property, in probably unnecessary code 'optimisation'.
-** Esmond Pitt, Austec (Asia/Pacific) Ltd
-** ...!uunet.UU.NET!munnari!ausmelb!ejp,ejp@ausmelb.oz
+** Pointers returned by hsearch_multi are valid until the next ENTER.
 */
 
 # include	<assert.h>
 
-/*
-** Fast arithmetic, relying on powers of 2,
-** and on pre-processor concatenation property
-*/
-
-/* rewrote to remove MUL and DIV */
-# define MOD(x,y)		((x) & ((y)-1))
-
-/*
-** Local data
-*/
-
-#ifdef HASH_STATISTICS
- long HashAccesses, HashCollisions;
-#endif
-
-/*
-** Code
-*/
-
 int Phreeqc::
 hcreate_multi(unsigned Count, HashTable ** HashTable_ptr)
 {
-	int i;
+	Address n;
 	HashTable *Table;
 	/*
-	 ** Adjust Count to be nearest higher power of 2,
-	 ** minimum SegmentSize, then convert into segments.
+	 ** At least twice Count slots, a power of 2
 	 */
-	i = SegmentSize;
-	while (i < (int) Count)
-		i <<= 1;
-/*    Count = DIV(i,SegmentSize); */
-	Count = ((i) >> (SegmentSizeShift));
+	n = HashMinSlots;
+	while (n < 2 * (Address) Count)
+		n <<= 1;
 
 	Table = (HashTable *) PHRQ_calloc(sizeof(HashTable), 1);
 	*HashTable_ptr = Table;
-
 	if (Table == NULL)
 		return (0);
-	/*
-	 ** resets are redundant - done by calloc(3)
-	 **
-	 Table->SegmentCount = Table->p = Table->KeyCount = 0;
-	 */
-	/*
-	 ** Allocate initial 'i' segments of buckets
-	 */
-	for (i = 0; i < (int) Count; i++)
+	Table->Slots = (ENTRY *) PHRQ_calloc(sizeof(ENTRY), (size_t) n);
+	Table->Hashes = (Address *) PHRQ_calloc(sizeof(Address), (size_t) n);
+	if (Table->Slots == NULL || Table->Hashes == NULL)
 	{
-		Table->Directory[i] =
-			(Segment *) PHRQ_calloc(sizeof(Segment), SegmentSize);
-		if (Table->Directory[i] == NULL)
-		{
-			hdestroy_multi(Table);
-			return (0);
-		}
-		Table->SegmentCount++;
-	}
-/*    Table->maxp = MUL(Count,SegmentSize); */
-	Table->maxp = (short) ((Count) << (SegmentSizeShift));
-	Table->MinLoadFactor = 1;
-	Table->MaxLoadFactor = DefaultMaxLoadFactor;
-#ifdef HASH_STATISTICS
-	HashAccesses = HashCollisions = 0;
-#endif
+		hdestroy_multi(Table);
+		*HashTable_ptr = NULL;
+		return (0);
+	}
+	Table->Mask = n - 1;
+	Table->KeyCount = 0;
 	return (1);
 }
 
 void Phreeqc::
 hdestroy_multi(HashTable * Table)
 {
-	int i, j;
-	Segment *seg;
-	Element *p, *q;
-
 	if (Table != NULL)
 	{
-		for (i = 0; i < Table->SegmentCount; i++)
-		{
-			/* test probably unnecessary        */
-			if ((seg = Table->Directory[i]) != NULL)
-			{
-				for (j = 0; j < SegmentSize; j++)
-				{
-					p = seg[j];
-					while (p != NULL)
-					{
-						q = p->Next;
-						PHRQ_free((void *) p);
-						p = q;
-					}
-				}
-				PHRQ_free(Table->Directory[i]);
-			}
-		}
+		PHRQ_free(Table->Slots);
+		PHRQ_free(Table->Hashes);
 		PHRQ_free(Table);
-		/*      Table = NULL; */
 	}
 }
 
@@ -1668,197 +1611,103 @@ ENTRY * Phreeqc::
 hsearch_multi(HashTable * Table, ENTRY item, ACTION action)
 /* ACTION       FIND/ENTER	*/
 {
-	Address h;
-	Segment *CurrentSegment;
-	int SegmentIndex;
-	int SegmentDir;
-	Segment *p, q;
+	Address h, i;
+	ENTRY *slot;
 
 	assert(Table != NULL);		/* Kinder really than return(NULL);     */
-#ifdef HASH_STATISTICS
-	HashAccesses++;
-#endif
-	h = Hash_multi(Table, item.key);
-/*    SegmentDir = DIV(h,SegmentSize); */
-	SegmentDir = ((h) >> (SegmentSizeShift));
-	SegmentIndex = MOD(h, SegmentSize);
-	/*
-	 ** valid segment ensured by Hash()
-	 */
-	CurrentSegment = Table->Directory[SegmentDir];
-	assert(CurrentSegment != NULL);	/* bad failure if tripped       */
-	p = &CurrentSegment[SegmentIndex];
-	q = *p;
-	/*
-	 ** Follow collision chain
-	 */
-	while (q != NULL && strcmp(q->Key, item.key))
-	{
-		p = &q->Next;
-		q = *p;
-#ifdef HASH_STATISTICS
-		HashCollisions++;
-#endif
-	}
-	if (q != NULL				/* found        */
-		|| action == FIND		/* not found, search only       */
-		)
+	h = Hash_multi(item.key);
+	for (i = h & Table->Mask;; i = (i + 1) & Table->Mask)
 	{
-		return ((ENTRY *) q);
-	}
-	else if ((q = (Element *) PHRQ_calloc(sizeof(Element), 1)) == NULL)
-	{
-		malloc_error();
+		slot = &Table->Slots[i];
+		if (slot->key == NULL)
+			break;
+		if (Table->Hashes[i] == h &&
+			(slot->key == item.key || strcmp(slot->key, item.key) == 0))
+			return (slot);
 	}
-	*p = q;						/* link into chain      */
-	/*
-	 ** Initialize new element
-	 */
-	q->Key = item.key;
-	q->Data = (char *) item.data;
-	/*
-	 ** cleared by calloc(3)
-	 q->Next = NULL;
-	 */
+	if (action == FIND)
+		return (NULL);
 	/*
-	 ** Table over-full?
+	 ** Enter in the empty slot, expand when over half full
 	 */
-/*    if (++Table->KeyCount / MUL(Table->SegmentCount,SegmentSize) > Table->MaxLoadFactor) */
-	if (++Table->KeyCount / ((Table->SegmentCount) << (SegmentSizeShift)) >
-		Table->MaxLoadFactor)
-		ExpandTable_multi(Table);	/* doesn`t affect q     */
-	return ((ENTRY *) q);
+	slot->key = item.key;
+	slot->data = item.data;
+	Table->Hashes[i] = h;
+	if (2 * (Address) ++Table->KeyCount > Table->Mask + 1)
+	{
+		ExpandTable_multi(Table);
+		return (hsearch_multi(Table, item, FIND));
+	}
+	return (slot);
 }
 
 /*
 ** Internal routines
 */
 
- Address Phreeqc::
-Hash_multi(HashTable * Table, const char *Key)
+Address Phreeqc::
+Hash_multi(const char *Key)
 {
-	Address h, address;
-	unsigned char *k = (unsigned char *) Key;
-
-	h = 0;
 	/*
-	 ** Convert string to integer
+	 ** FNV-1a
 	 */
+	unsigned int h = 2166136261u;
+	const unsigned char *k = (const unsigned char *) Key;
 	while (*k)
-		h = h * Prime1 ^ (*k++ - ' ');
-	h %= Prime2;
-	address = MOD(h, Table->maxp);
-	if (address < (unsigned long) Table->p)
-		address = MOD(h, (Table->maxp << 1));	/* h % (2*Table->maxp)  */
-	return (address);
+	{
+		h ^= *k++;
+		h *= 16777619u;
+	}
+	return ((Address) h);
 }
 
 void Phreeqc::
 ExpandTable_multi(HashTable * Table)
 {
-	Address NewAddress;
-	int OldSegmentIndex, NewSegmentIndex;
-	int OldSegmentDir, NewSegmentDir;
-	Segment *OldSegment, *NewSegment;
-	Element *Current, **Previous, **LastOfNew;
-
-/*    if (Table->maxp + Table->p < MUL(DirectorySize,SegmentSize)) */
-	if (Table->maxp + Table->p < ((DirectorySize) << (SegmentSizeShift)))
-	{
-		/*
-		 ** Locate the bucket to be split
-		 */
-/*	OldSegmentDir = DIV(Table->p,SegmentSize); */
-		OldSegmentDir = ((Table->p) >> (SegmentSizeShift));
-		OldSegment = Table->Directory[OldSegmentDir];
-		OldSegmentIndex = MOD(Table->p, SegmentSize);
-		/*
-		 ** Expand address space; if necessary create a new segment
-		 */
-		NewAddress = Table->maxp + Table->p;
-/*	NewSegmentDir = DIV(NewAddress,SegmentSize); */
-		NewSegmentDir = ((NewAddress) >> (SegmentSizeShift));
-		NewSegmentIndex = MOD(NewAddress, SegmentSize);
-		if (NewSegmentIndex == 0)
-		{
-			Table->Directory[NewSegmentDir] =
-				(Segment *) PHRQ_calloc(sizeof(Segment), SegmentSize);
-			if (Table->Directory[NewSegmentDir] == NULL)
-			{
-				malloc_error();
-			}
-		}
-		NewSegment = Table->Directory[NewSegmentDir];
-		/*
-		 ** Adjust state variables
-		 */
-		Table->p++;
-		if (Table->p == Table->maxp)
-		{
-			Table->maxp <<= 1;	/* Table->maxp *= 2     */
-			Table->p = 0;
-		}
-		Table->SegmentCount++;
-		/*
-		 ** Relocate records to the new bucket
-		 */
-		Previous = &OldSegment[OldSegmentIndex];
-		Current = *Previous;
-		LastOfNew = &NewSegment[NewSegmentIndex];
-		*LastOfNew = NULL;
-		while (Current != NULL)
-		{
-			if (Hash_multi(Table, Current->Key) == NewAddress)
-			{
-				/*
-				 ** Attach it to the end of the new chain
-				 */
-				*LastOfNew = Current;
-				/*
-				 ** Remove it from old chain
-				 */
-				*Previous = Current->Next;
-				LastOfNew = &Current->Next;
-				Current = Current->Next;
-				*LastOfNew = NULL;
-			}
-			else
-			{
-				/*
-				 ** leave it on the old chain
-				 */
-				Previous = &Current->Next;
-				Current = Current->Next;
-			}
-		}
+	Address n, i, j, mask;
+	ENTRY *slots;
+	Address *hashes;
+
+	n = 2 * (Table->Mask + 1);
+	mask = n - 1;
+	slots = (ENTRY *) PHRQ_calloc(sizeof(ENTRY), (size_t) n);
+	hashes = (Address *) PHRQ_calloc(sizeof(Address), (size_t) n);
+	if (slots == NULL || hashes == NULL)
+	{
+		malloc_error();
+		return;
 	}
+	/*
+	 ** Reinsert the keys, no comparisons needed
+	 */
+	for (i = 0; i <= Table->Mask; i++)
+	{
+		if (Table->Slots[i].key == NULL)
+			continue;
+		for (j = Table->Hashes[i] & mask; slots[j].key != NULL; j = (j + 1) & mask);
+		slots[j] = Table->Slots[i];
+		hashes[j] = Table->Hashes[i];
+	}
+	PHRQ_free(Table->Slots);
+	PHRQ_free(Table->Hashes);
+	Table->Slots = slots;
+	Table->Hashes = hashes;
+	Table->Mask = mask;
 }
 
 
 void Phreeqc::
 free_hash_strings(HashTable * Table)
 {
-	int i, j;
-	Segment *seg;
-	Element *p, *q;
+	Address i;
 
 	if (Table != NULL)
 	{
-		for (i = 0; i < Table->SegmentCount; i++)
+		for (i = 0; i <= Table->Mask; i++)
 		{
-			/* test probably unnecessary        */
-			if ((seg = Table->Directory[i]) != NULL)
+			if (Table->Slots[i].key != NULL)
 			{
-				for (j = 0; j < SegmentSize; j++)
-				{
-					p = seg[j];
-					while (p != NULL)
-					{
-						q = p->Next;
-						p->Data = (char *) free_check_null((void *) p->Data);
-						p = q;
-					}
-				}
+				Table->Slots[i].data = free_check_null(Table->Slots[i].data);
 			}
 		}
 	}
@@ -0,0 +1,926 @@
+#include "Utils.h"
+#include "Phreeqc.h"
+#include "phqalloc.h"
+#include "Solution.h"
+#include "Exchange.h"
+#include "GasPhase.h"
+#include "cxxKinetics.h"
+#include "PPassemblage.h"
+#include "SSassemblage.h"
+#include "Surface.h"
+#include "Temperature.h"
+#include "Reaction.h"
+#include "cxxMix.h"
+#include "StorageBin.h"
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+/* ----------------------------------------------------------------------
+ *   WorkerIO
+ *
+ *   Output of a worker clone is recorded cell by cell and replayed by
+ *   the master in cell order, so that output, log, error and selected
+ *   output are the same as for a serial run.
+ * ---------------------------------------------------------------------- */
+class WorkerIO: public PHRQ_io
+{
+public:
+	enum EVENT_TYPE
+	{
+		EV_OUTPUT,
+		EV_LOG,
+		EV_WARNING,
+		EV_ERROR,
+		EV_PUNCH_MSG,
+		EV_PUNCH_DOUBLE,
+		EV_PUNCH_STRING,
+		EV_PUNCH_INT,
+		EV_PUNCH_END_ROW
+	};
+	struct event
+	{
+		EVENT_TYPE type;
+		int n_user;				/* selected output number */
+		int punch_index;		/* n_user_punch_index at end of row */
+		std::string name;
+		std::string format;
+		std::string str;
+		double d;
+		int i;
+		bool stop;
+	};
+
+	WorkerIO(void)
+	{
+		this->phreeqc_ptr = NULL;
+		this->events = NULL;
+	}
+	void Set_phreeqc_ptr(Phreeqc *p)				{this->phreeqc_ptr = p;}
+	void Set_events(std::vector<event> *ev)			{this->events = ev;}
+
+	void output_msg(const char *str)				{this->record(EV_OUTPUT, NULL, NULL, str);}
+	void log_msg(const char *str)					{this->record(EV_LOG, NULL, NULL, str);}
+	void warning_msg(const char *str)				{this->record(EV_WARNING, NULL, NULL, str);}
+	void error_msg(const char *str, bool stop = false)
+	{
+		event *e = this->record(EV_ERROR, NULL, NULL, str);
+		if (e) e->stop = stop;
+	}
+	void punch_msg(const char *str)					{this->record(EV_PUNCH_MSG, NULL, NULL, str);}
+	void fpunchf(const char *name, const char *format, double d)
+	{
+		event *e = this->record(EV_PUNCH_DOUBLE, name, format, NULL);
+		if (e) e->d = d;
+	}
+	void fpunchf(const char *name, const char *format, char * s)
+	{
+		this->record(EV_PUNCH_STRING, name, format, s);
+	}
+	void fpunchf(const char *name, const char *format, int i)
+	{
+		event *e = this->record(EV_PUNCH_INT, name, format, NULL);
+		if (e) e->i = i;
+	}
+	void fpunchf_end_row(const char *format)
+	{
+		event *e = this->record(EV_PUNCH_END_ROW, NULL, format, NULL);
+		if (e) e->punch_index = this->phreeqc_ptr->n_user_punch_index;
+	}
+	void screen_msg(const char *str)				{}
+	void echo_msg(const char *str)					{}
+	void dump_msg(const char *str)					{}
+
+	static void replay(Phreeqc *p, std::vector<event> &events)
+	{
+	/*
+	 *   Sends the recorded output of a worker cell to p->phrq_io
+	 */
+		if (p->phrq_io == NULL)
+			return;
+		for (size_t k = 0; k < events.size(); k++)
+		{
+			event &e = events[k];
+			if (e.type >= EV_PUNCH_MSG &&
+				(p->current_selected_output == NULL || p->current_selected_output->Get_n_user() != e.n_user))
+			{
+				std::map < int, SelectedOutput >::iterator so_it = p->SelectedOutput_map.find(e.n_user);
+				if (so_it == p->SelectedOutput_map.end())
+					continue;
+				p->current_selected_output = &(so_it->second);
+				p->phrq_io->Set_punch_ostream(p->current_selected_output->Get_punch_ostream());
+				std::map < int, UserPunch >::iterator up_it = p->UserPunch_map.find(e.n_user);
+				p->current_user_punch = up_it == p->UserPunch_map.end() ? NULL : &(up_it->second);
+			}
+			switch (e.type)
+			{
+			case EV_OUTPUT:
+				p->phrq_io->output_msg(e.str.c_str());
+				break;
+			case EV_LOG:
+				p->phrq_io->log_msg(e.str.c_str());
+				break;
+			case EV_WARNING:
+				p->phrq_io->warning_msg(e.str.c_str());
+				break;
+			case EV_ERROR:
+				if (p->get_input_errors() <= 0)
+					p->input_error = 1;
+				p->phrq_io->error_msg(e.str.c_str(), e.stop);
+				break;
+			case EV_PUNCH_MSG:
+				p->phrq_io->punch_msg(e.str.c_str());
+				break;
+			case EV_PUNCH_DOUBLE:
+				p->phrq_io->fpunchf(e.name.c_str(), e.format.c_str(), e.d);
+				break;
+			case EV_PUNCH_STRING:
+				p->phrq_io->fpunchf(e.name.c_str(), e.format.c_str(), (char *) e.str.c_str());
+				break;
+			case EV_PUNCH_INT:
+				p->phrq_io->fpunchf(e.name.c_str(), e.format.c_str(), e.i);
+				break;
+			case EV_PUNCH_END_ROW:
+				p->n_user_punch_index = e.punch_index;
+				p->phrq_io->fpunchf_end_row(e.format.c_str());
+				p->punch_flush();
+				break;
+			}
+		}
+		if (p->current_selected_output != NULL)
+		{
+			p->current_selected_output = NULL;
+			p->current_user_punch = NULL;
+			p->phrq_io->Set_punch_ostream(NULL);
+		}
+	}
+
+protected:
+	event *record(EVENT_TYPE type, const char *name, const char *format, const char *str)
+	{
+		if (this->events == NULL) return NULL;
+		event e;
+		e.type = type;
+		e.n_user = 1;
+		if (this->phreeqc_ptr->current_selected_output != NULL)
+		{
+			e.n_user = this->phreeqc_ptr->current_selected_output->Get_n_user();
+		}
+		e.punch_index = 0;
+		if (name) e.name = name;
+		if (format) e.format = format;
+		if (str) e.str = str;
+		e.d = 0.0;
+		e.i = 0;
+		e.stop = false;
+		this->events->push_back(e);
+		return &(this->events->back());
+	}
+
+protected:
+	Phreeqc *phreeqc_ptr;
+	std::vector<event> *events;
+};
+
+/*
+ *   results of one cell, or one column of a CVODE jacobian, computed by a worker
+ */
+struct worker_cell
+{
+	std::vector<WorkerIO::event> events;
+	cxxStorageBin sb;
+	std::map<int, struct cell_guess> guess;
+	std::vector<struct solver_stats> stats;
+	int iterations;
+	int calculations, warm_starts, cell_iterations;
+	int warnings;
+	LDBLE rate_sim_time;
+	bool stop;
+};
+
+template < typename T >
+static void
+worker_copy_entity(std::map < int, T > &source, std::map < int, T > &target, int n)
+{
+	typename std::map < int, T >::iterator it = source.find(n);
+	if (it != source.end())
+	{
+		target[n] = it->second;
+	}
+	else
+	{
+		target.erase(n);
+	}
+}
+
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+workers_create(int n)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Makes n clones of this instance; clones are kept until the next
+ *   input is read.
+ */
+	while ((int) workers.size() < n)
+	{
+		workers.push_back(worker_clone());
+	}
+}
+/* ---------------------------------------------------------------------- */
+Phreeqc * Phreeqc::
+worker_clone(void)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Returns a clone of this instance with a WorkerIO; the clone runs
+ *   cells and jacobian columns serially
+ */
+	WorkerIO *io = new WorkerIO;
+	Phreeqc *worker_ptr = new Phreeqc(io);
+	io->Set_phreeqc_ptr(worker_ptr);
+	// share strings with this instance (or its snapshot); set before any string_hsave
+	worker_ptr->database_snapshot = (database_snapshot != NULL) ? database_snapshot : this;
+	worker_ptr->initialize();
+	worker_ptr->InternalCopy(this);
+	worker_ptr->count_workers = 1;
+	worker_ptr->count_jacobian_workers = 1;
+	worker_ptr->rates_map.clear();
+	worker_ptr->basic_callback_ptr = basic_callback_ptr;
+	worker_ptr->basic_callback_cookie = basic_callback_cookie;
+	worker_ptr->basic_fortran_callback_ptr = basic_fortran_callback_ptr;
+	return worker_ptr;
+}
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+workers_free(void)
+/* ---------------------------------------------------------------------- */
+{
+	for (size_t n = 0; n < workers.size(); n++)
+	{
+		PHRQ_io *io = workers[n]->Get_phrq_io();
+		delete workers[n];
+		delete io;
+	}
+	workers.clear();
+	for (size_t n = 0; n < jacobian_workers.size(); n++)
+	{
+		PHRQ_io *io = jacobian_workers[n]->Get_phrq_io();
+		delete jacobian_workers[n];
+		delete io;
+	}
+	jacobian_workers.clear();
+}
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+worker_copy_cell(Phreeqc *worker_ptr, int i, int task)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Copies the reactants of cell i, and the solutions it mixes with,
+ *   from this instance to worker_ptr
+ */
+	worker_copy_entity(Rxn_solution_map, worker_ptr->Rxn_solution_map, i);
+	worker_copy_entity(Rxn_exchange_map, worker_ptr->Rxn_exchange_map, i);
+	worker_copy_entity(Rxn_gas_phase_map, worker_ptr->Rxn_gas_phase_map, i);
+	worker_copy_entity(Rxn_kinetics_map, worker_ptr->Rxn_kinetics_map, i);
+	worker_copy_entity(Rxn_pp_assemblage_map, worker_ptr->Rxn_pp_assemblage_map, i);
+	worker_copy_entity(Rxn_ss_assemblage_map, worker_ptr->Rxn_ss_assemblage_map, i);
+	worker_copy_entity(Rxn_surface_map, worker_ptr->Rxn_surface_map, i);
+	worker_copy_entity(Rxn_reaction_map, worker_ptr->Rxn_reaction_map, i);
+	worker_copy_entity(Rxn_temperature_map, worker_ptr->Rxn_temperature_map, i);
+	worker_copy_entity(Rxn_pressure_map, worker_ptr->Rxn_pressure_map, i);
+	worker_copy_entity(cell_guess_map, worker_ptr->cell_guess_map, i);
+	if (task == WORKER_DISP)
+	{
+		worker_copy_entity(Dispersion_mix_map, worker_ptr->Dispersion_mix_map, i);
+		cxxMix *mix_ptr = Utilities::Rxn_find(Dispersion_mix_map, i);
+		if (mix_ptr != NULL)
+		{
+			std::map < int, LDBLE >::const_iterator it = mix_ptr->Get_mixComps().begin();
+			for (; it != mix_ptr->Get_mixComps().end(); it++)
+			{
+				worker_copy_entity(Rxn_solution_map, worker_ptr->Rxn_solution_map, it->first);
+			}
+		}
+	}
+}
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+worker_sync(Phreeqc *worker_ptr)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Copies the run state of this instance to worker_ptr
+ */
+	worker_ptr->state = state;
+	worker_ptr->pr = pr;
+	worker_ptr->status_on = false;
+	worker_ptr->run_info = run_info;
+	worker_ptr->run_info.Set_io(worker_ptr->phrq_io);
+	worker_ptr->run_cells_one_step = run_cells_one_step;
+	worker_ptr->incremental_reactions = incremental_reactions;
+	worker_ptr->initial_total_time = initial_total_time;
+	worker_ptr->rate_sim_time_start = rate_sim_time_start;
+	worker_ptr->rate_sim_time = rate_sim_time;
+	worker_ptr->transport_step = transport_step;
+	worker_ptr->mixrun = mixrun;
+	worker_ptr->simulation = simulation;
+	worker_ptr->count_warnings = count_warnings;
+	worker_ptr->profiler.Set_on(profiler.Get_on());
+	worker_ptr->profiler.Clear();
+	worker_ptr->cvode_integrations = 0;
+	worker_ptr->cvode_steps_taken = 0;
+	worker_ptr->cvode_rhs_evaluations = 0;
+	worker_ptr->cvode_jacobian_evaluations = 0;
+}
+/* ---------------------------------------------------------------------- */
+int Phreeqc::
+run_cells_workers(int task, const std::vector<int> &cells, const std::vector<LDBLE> &kin_times,
+				  LDBLE step_fraction, bool punch)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Calculates cells on count_workers clones of this instance and
+ *   merges the reactants and output back in cell order.
+ *
+ *   task       --WORKER_RUN_CELLS, reaction steps of RUN_CELLS
+ *                WORKER_NOMIX, transport reaction without mixing
+ *                WORKER_DISP, transport reaction with dispersive mixing,
+ *                             solutions are mixed from the values before
+ *                             this call
+ *   cells      --user numbers of the cells
+ *   kin_times  --kinetic time step of each cell (transport tasks)
+ *   punch      --print and punch each cell (transport tasks)
+ */
+	int count_cells_w = (int) cells.size();
+	if (count_cells_w == 0)
+		return (OK);
+	ProfilerScope profiler_scope(profiler, "cell_workers");
+	int n_workers = count_workers;
+	if (n_workers > count_cells_w)
+		n_workers = count_cells_w;
+	if (n_workers < 1)
+		n_workers = 1;
+	workers_create(n_workers);
+	for (int n = 0; n < n_workers; n++)
+	{
+		worker_sync(workers[n]);
+	}
+
+	std::vector<worker_cell> results(count_cells_w);
+#ifdef USE_OPENMP
+	#pragma omp parallel for num_threads(n_workers) schedule(dynamic)
+#endif
+	for (int j = 0; j < count_cells_w; j++)
+	{
+		int n = 0;
+#ifdef USE_OPENMP
+		n = omp_get_thread_num();
+#endif
+		Phreeqc *worker_ptr = workers[n];
+		WorkerIO *io = (WorkerIO *) worker_ptr->phrq_io;
+		worker_cell &r = results[j];
+		int i = cells[j];
+		int warnings_start = worker_ptr->count_warnings;
+		int calculations_start = worker_ptr->cell_calculations;
+		int warm_starts_start = worker_ptr->cell_warm_starts;
+		int iterations_start = worker_ptr->cell_iterations;
+
+		r.stop = false;
+		worker_ptr->solver_stats_clear();
+		io->Set_events(&r.events);
+		try
+		{
+			worker_copy_cell(worker_ptr, i, task);
+			worker_ptr->cell_no = i;
+			switch (task)
+			{
+			case WORKER_RUN_CELLS:
+				{
+					LDBLE initial_total_time_save = worker_ptr->initial_total_time;
+					if (worker_ptr->run_info.Get_start_time() != NA)
+					{
+						initial_total_time_save = worker_ptr->run_info.Get_start_time();
+					}
+					worker_ptr->run_as_cell(i, initial_total_time_save);
+					worker_ptr->initial_total_time = initial_total_time;
+				}
+				break;
+			case WORKER_NOMIX:
+			case WORKER_DISP:
+				worker_ptr->run_reactions(i, kin_times[j], (task == WORKER_DISP) ? DISP : NOMIX, step_fraction);
+				if (punch)
+					worker_ptr->print_punch(i, true);
+				worker_ptr->saver();
+				break;
+			}
+			worker_ptr->phreeqc2cxxStorageBin(r.sb, i);
+			if (task == WORKER_DISP)
+			{
+				cxxSolution *soln_ptr = Utilities::Rxn_find(worker_ptr->Rxn_solution_map, -2);
+				if (soln_ptr != NULL)
+				{
+					r.sb.Set_Solution(i, soln_ptr);
+					r.sb.Get_Solution(i)->Set_n_user_both(i);
+				}
+			}
+		}
+		catch (const PhreeqcStop&)
+		{
+			r.stop = true;
+		}
+		catch (...)
+		{
+			worker_ptr->input_error++;
+			io->error_msg("ERROR: Unexpected exception in cell worker.\n", true);
+			r.stop = true;
+		}
+		io->Set_events(NULL);
+		r.iterations = worker_ptr->overall_iterations;
+		r.warnings = worker_ptr->count_warnings - warnings_start;
+		r.calculations = worker_ptr->cell_calculations - calculations_start;
+		r.warm_starts = worker_ptr->cell_warm_starts - warm_starts_start;
+		r.cell_iterations = worker_ptr->cell_iterations - iterations_start;
+		worker_copy_entity(worker_ptr->cell_guess_map, r.guess, i);
+		r.stats.swap(worker_ptr->solver_stats_list);
+		r.rate_sim_time = worker_ptr->rate_sim_time;
+	}
+
+	/*
+	 *   merge in cell order; phase times of the workers are summed
+	 */
+	for (int n = 0; n < n_workers; n++)
+	{
+		profiler.Merge(workers[n]->profiler);
+		cvode_integrations += workers[n]->cvode_integrations;
+		cvode_steps_taken += workers[n]->cvode_steps_taken;
+		cvode_rhs_evaluations += workers[n]->cvode_rhs_evaluations;
+		cvode_jacobian_evaluations += workers[n]->cvode_jacobian_evaluations;
+	}
+	int max_iterations = 0;
+	for (int j = 0; j < count_cells_w; j++)
+	{
+		worker_cell &r = results[j];
+		count_warnings += r.warnings;
+		WorkerIO::replay(this, r.events);
+		for (size_t s = 0; s < r.stats.size(); s++)
+			solver_stats_add(r.stats[s]);
+		if (r.stop)
+		{
+			if (get_input_errors() <= 0)
+				input_error = 1;
+			throw PhreeqcStop();
+		}
+		cxxStorageBin2phreeqc(r.sb, cells[j]);
+		worker_copy_entity(r.guess, cell_guess_map, cells[j]);
+		cell_calculations += r.calculations;
+		cell_warm_starts += r.warm_starts;
+		cell_iterations += r.cell_iterations;
+		if (r.iterations > max_iterations)
+			max_iterations = r.iterations;
+		rate_sim_time = r.rate_sim_time;
+	}
+	overall_iterations = max_iterations;
+	cell_no = cells.back();
+	if (task == WORKER_DISP)
+	{
+		Utilities::Rxn_copy(Rxn_solution_map, cells.back(), -2);
+	}
+	return (OK);
+}
+/* ---------------------------------------------------------------------- */
+bool Phreeqc::
+numerical_jacobian_workers(const LDBLE *base)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Calculates the columns of numerical_jacobian on count_jacobian_workers
+ *   clones of this instance. Each column starts from a copy of the state
+ *   of this instance, which is not changed until all columns are done.
+ *   Columns of PP and SS_MOLES go through reset and are calculated by
+ *   this instance afterwards.
+ *
+ *   Returns false if the columns are to be calculated serially: initial
+ *   calculations, surfaces and solid solutions, calls from a parallel
+ *   region, and models that the clones can not reproduce.
+ */
+	int i, j;
+	if (count_jacobian_workers < 2 || state < REACTION ||
+		use.Get_surface_ptr() != NULL || use.Get_ss_assemblage_ptr() != NULL)
+		return false;
+#ifdef USE_OPENMP
+	if (omp_in_parallel())
+		return false;
+#endif
+	std::vector<int> columns;
+	for (i = 0; i < count_unknowns; i++)
+	{
+		if (x[i]->type != PP && x[i]->type != SS_MOLES)
+			columns.push_back(i);
+	}
+	int count_columns = (int) columns.size();
+	int n_workers = count_jacobian_workers;
+	if (n_workers > count_columns)
+		n_workers = count_columns;
+	if (n_workers < 2)
+		return false;
+	/*
+	 *   phases of unknowns and gas components, copied for each column
+	 */
+	std::vector<int> phase_list;
+	for (i = 0; i < count_unknowns; i++)
+	{
+		if (x[i]->phase != NULL && phase_bsearch(x[i]->phase->name, &j, FALSE) != NULL)
+			phase_list.push_back(j);
+	}
+	cxxGasPhase *gas_phase_ptr = use.Get_gas_phase_ptr();
+	if (gas_phase_ptr != NULL)
+	{
+		for (size_t k = 0; k < gas_phase_ptr->Get_gas_comps().size(); k++)
+		{
+			if (phase_bsearch(gas_phase_ptr->Get_gas_comps()[k].Get_phase_name().c_str(), &j, FALSE) != NULL)
+				phase_list.push_back(j);
+		}
+	}
+	while ((int) jacobian_workers.size() < n_workers)
+	{
+		jacobian_workers.push_back(worker_clone());
+	}
+	for (int n = 0; n < n_workers; n++)
+	{
+		if (!jacobian_worker_sync(jacobian_workers[n]))
+			return false;
+	}
+
+	std::vector<int> failed(count_columns, 0);
+#ifdef USE_OPENMP
+	#pragma omp parallel for num_threads(n_workers) schedule(static)
+#endif
+	for (int k = 0; k < count_columns; k++)
+	{
+		int n = k % n_workers;
+#ifdef USE_OPENMP
+		n = omp_get_thread_num();
+#endif
+		Phreeqc *worker_ptr = jacobian_workers[n];
+		try
+		{
+			jacobian_worker_load(worker_ptr, phase_list);
+			worker_ptr->numerical_jacobian_column(columns[k], base, my_array);
+		}
+		catch (...)
+		{
+			worker_ptr->jacobian_prep = -1;
+			failed[k] = 1;
+		}
+	}
+	for (int k = 0; k < count_columns; k++)
+	{
+		if (failed[k])
+			return false;
+	}
+	for (i = 0; i < count_unknowns; i++)
+	{
+		if (x[i]->type == PP || x[i]->type == SS_MOLES)
+			numerical_jacobian_column(i, base, my_array);
+	}
+	return true;
+}
+/* ---------------------------------------------------------------------- */
+bool Phreeqc::
+jacobian_worker_sync(Phreeqc *worker_ptr)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Gives worker_ptr the model of this instance. The reactants are copied
+ *   and prepped if this instance has called prep since the last sync;
+ *   basis switches are repeated with reprep. Returns false if the
+ *   unknowns or species of the two models differ.
+ */
+	int i, j;
+	if (worker_ptr->jacobian_prep != count_prep)
+	{
+		worker_ptr->jacobian_prep = -1;
+		worker_ptr->use.init();
+		if (use.Get_solution_ptr() != NULL)
+		{
+			int n = use.Get_solution_ptr()->Get_n_user();
+			worker_ptr->Rxn_solution_map[n] = *use.Get_solution_ptr();
+			worker_ptr->use.Set_solution_ptr(&(worker_ptr->Rxn_solution_map[n]));
+			worker_ptr->use.Set_solution_in(true);
+		}
+		if (use.Get_exchange_ptr() != NULL)
+		{
+			int n = use.Get_exchange_ptr()->Get_n_user();
+			worker_ptr->Rxn_exchange_map[n] = *use.Get_exchange_ptr();
+			worker_ptr->use.Set_exchange_ptr(&(worker_ptr->Rxn_exchange_map[n]));
+			worker_ptr->use.Set_exchange_in(true);
+		}
+		if (use.Get_pp_assemblage_ptr() != NULL)
+		{
+			int n = use.Get_pp_assemblage_ptr()->Get_n_user();
+			worker_ptr->Rxn_pp_assemblage_map[n] = *use.Get_pp_assemblage_ptr();
+			worker_ptr->use.Set_pp_assemblage_ptr(&(worker_ptr->Rxn_pp_assemblage_map[n]));
+			worker_ptr->use.Set_pp_assemblage_in(true);
+		}
+		if (use.Get_gas_phase_ptr() != NULL)
+		{
+			int n = use.Get_gas_phase_ptr()->Get_n_user();
+			worker_ptr->Rxn_gas_phase_map[n] = *use.Get_gas_phase_ptr();
+			worker_ptr->use.Set_gas_phase_ptr(&(worker_ptr->Rxn_gas_phase_map[n]));
+			worker_ptr->use.Set_gas_phase_in(true);
+		}
+		worker_ptr->state = state;
+		worker_ptr->tc_x = tc_x;
+		worker_ptr->tk_x = tk_x;
+		worker_ptr->patm_x = patm_x;
+		worker_ptr->numerical_fixed_volume = numerical_fixed_volume;
+		worker_ptr->mass_water_switch = mass_water_switch;
+		worker_ptr->input_error = 0;
+		try
+		{
+			worker_ptr->prep();
+		}
+		catch (const PhreeqcStop&)
+		{
+			return false;
+		}
+		worker_ptr->jacobian_prep = count_prep;
+	}
+	if (worker_ptr->count_unknowns != count_unknowns)
+		return false;
+	bool switched = false;
+	for (i = 0; i < count_unknowns; i++)
+	{
+		if (worker_ptr->x[i]->type != x[i]->type)
+			return false;
+		if (x[i]->type != MB)
+			continue;
+		for (j = 0; x[i]->master[j] != NULL; j++)
+		{
+			if (worker_ptr->x[i]->master[j] == NULL)
+				return false;
+			struct master *master_ptr = worker_ptr->master[x[i]->master[j]->number];
+			if (worker_ptr->x[i]->master[j] != master_ptr)
+			{
+				worker_ptr->x[i]->master[j] = master_ptr;
+				switched = true;
+			}
+		}
+	}
+	if (switched)
+	{
+		for (i = 0; i < count_master; i++)
+		{
+			worker_ptr->master[i]->in = master[i]->in;
+		}
+		try
+		{
+			worker_ptr->reprep();
+		}
+		catch (const PhreeqcStop&)
+		{
+			worker_ptr->jacobian_prep = -1;
+			return false;
+		}
+	}
+	if (worker_ptr->count_s_x != count_s_x)
+		return false;
+	for (i = 0; i < count_s_x; i++)
+	{
+		if (worker_ptr->s_x[i]->number != s_x[i]->number)
+			return false;
+	}
+	return true;
+}
+/* ---------------------------------------------------------------------- */
+void Phreeqc::
+jacobian_worker_load(Phreeqc *worker_ptr, const std::vector<int> &phase_list)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Copies the values of species, unknowns, phases and the gas phase of
+ *   this instance to worker_ptr, which has the same model
+ */
+	int i;
+	for (i = 0; i < count_s_x; i++)
+	{
+		const struct species *s_ptr = s_x[i];
+		struct species *w_ptr = worker_ptr->s_x[i];
+		w_ptr->lk = s_ptr->lk;
+		w_ptr->lg = s_ptr->lg;
+		w_ptr->lm = s_ptr->lm;
+		w_ptr->la = s_ptr->la;
+		w_ptr->dg = s_ptr->dg;
+		w_ptr->dg_total_g = s_ptr->dg_total_g;
+		w_ptr->moles = s_ptr->moles;
+		w_ptr->tot_g_moles = s_ptr->tot_g_moles;
+		w_ptr->tot_dh2o_moles = s_ptr->tot_dh2o_moles;
+	}
+	worker_ptr->s_eminus->la = s_eminus->la;
+	for (i = 0; i < count_unknowns; i++)
+	{
+		const struct unknown *x_ptr = x[i];
+		struct unknown *w_ptr = worker_ptr->x[i];
+		w_ptr->moles = x_ptr->moles;
+		w_ptr->ln_moles = x_ptr->ln_moles;
+		w_ptr->f = x_ptr->f;
+		w_ptr->sum = x_ptr->sum;
+		w_ptr->delta = x_ptr->delta;
+		w_ptr->la = x_ptr->la;
+		w_ptr->si = x_ptr->si;
+		w_ptr->related_moles = x_ptr->related_moles;
+		w_ptr->mass_water = x_ptr->mass_water;
+		w_ptr->inert_moles = x_ptr->inert_moles;
+		w_ptr->V_m = x_ptr->V_m;
+		w_ptr->pressure = x_ptr->pressure;
+		w_ptr->ss_in = x_ptr->ss_in;
+		w_ptr->dissolve_only = x_ptr->dissolve_only;
+	}
+	for (size_t k = 0; k < phase_list.size(); k++)
+	{
+		const struct phase *p_ptr = phases[phase_list[k]];
+		struct phase *w_ptr = worker_ptr->phases[phase_list[k]];
+		w_ptr->in = p_ptr->in;
+		w_ptr->lk = p_ptr->lk;
+		w_ptr->moles_x = p_ptr->moles_x;
+		w_ptr->delta_max = p_ptr->delta_max;
+		w_ptr->p_soln_x = p_ptr->p_soln_x;
+		w_ptr->fraction_x = p_ptr->fraction_x;
+		w_ptr->log10_lambda = p_ptr->log10_lambda;
+		w_ptr->log10_fraction_x = p_ptr->log10_fraction_x;
+		w_ptr->pr_a = p_ptr->pr_a;
+		w_ptr->pr_b = p_ptr->pr_b;
+		w_ptr->pr_alpha = p_ptr->pr_alpha;
+		w_ptr->pr_tk = p_ptr->pr_tk;
+		w_ptr->pr_p = p_ptr->pr_p;
+		w_ptr->pr_phi = p_ptr->pr_phi;
+		w_ptr->pr_aa_sum2 = p_ptr->pr_aa_sum2;
+		w_ptr->pr_si_f = p_ptr->pr_si_f;
+		w_ptr->pr_in = p_ptr->pr_in;
+	}
+	cxxGasPhase *gas_phase_ptr = use.Get_gas_phase_ptr();
+	cxxGasPhase *w_gas_phase_ptr = worker_ptr->use.Get_gas_phase_ptr();
+	if (gas_phase_ptr != NULL && w_gas_phase_ptr != NULL)
+	{
+		w_gas_phase_ptr->Set_total_p(gas_phase_ptr->Get_total_p());
+		w_gas_phase_ptr->Set_volume(gas_phase_ptr->Get_volume());
+		w_gas_phase_ptr->Set_total_moles(gas_phase_ptr->Get_total_moles());
+		w_gas_phase_ptr->Set_v_m(gas_phase_ptr->Get_v_m());
+		w_gas_phase_ptr->Set_pr_in(gas_phase_ptr->Get_pr_in());
+	}
+	/* k_temp, called by gammas, recalculates log k's when these change */
+	worker_ptr->current_tc = current_tc;
+	worker_ptr->current_pa = current_pa;
+	worker_ptr->current_mu = current_mu;
+	worker_ptr->mu_terms_in_logk = mu_terms_in_logk;
+	worker_ptr->rho_0 = rho_0;
+	worker_ptr->eps_r = eps_r;
+	worker_ptr->DH_A = DH_A;
+	worker_ptr->DH_B = DH_B;
+	worker_ptr->DH_Av = DH_Av;
+	worker_ptr->mu_x = mu_x;
+	worker_ptr->ah2o_x = ah2o_x;
+	worker_ptr->AW = AW;
+	worker_ptr->mass_water_aq_x = mass_water_aq_x;
+	worker_ptr->mass_water_bulk_x = mass_water_bulk_x;
+	worker_ptr->mass_water_surfaces_x = mass_water_surfaces_x;
+	worker_ptr->tc_x = tc_x;
+	worker_ptr->tk_x = tk_x;
+	worker_ptr->patm_x = patm_x;
+	worker_ptr->last_patm_x = last_patm_x;
+	worker_ptr->iterations = iterations;
+	worker_ptr->gas_in = gas_in;
+	worker_ptr->numerical_fixed_volume = numerical_fixed_volume;
+	worker_ptr->mass_water_switch = mass_water_switch;
+	worker_ptr->calculating_deriv = calculating_deriv;
+}
+/* ---------------------------------------------------------------------- */
+bool Phreeqc::
+cvode_jacobian_workers(N_Vector y, const LDBLE *initial_rates, DenseMat J)
+/* ---------------------------------------------------------------------- */
+{
+/*
+ *   Calculates the columns of the CVODE jacobian of the kinetic rates on
+ *   count_jacobian_workers clones of this instance. Each column starts
+ *   from a copy of the reactants of cell cvode_n_user, which are not
+ *   changed in this instance; output is replayed in column order.
+ *
+ *   Returns false if the columns are to be calculated serially: a single
+ *   kinetic reaction, calls from a parallel region, and columns that
+ *   failed on a clone.
+ */
+	int n_reactions = cvode_n_reactions;
+	if (count_jacobian_workers < 2 || n_reactions < 2)
+		return false;
+#ifdef USE_OPENMP
+	if (omp_in_parallel())
+		return false;
+#endif
+	ProfilerScope profiler_scope(profiler, "cvode_jacobian_workers");
+	int n_workers = count_jacobian_workers;
+	if (n_workers > n_reactions)
+		n_workers = n_reactions;
+	while ((int) jacobian_workers.size() < n_workers)
+	{
+		jacobian_workers.push_back(worker_clone());
+	}
+	for (int n = 0; n < n_workers; n++)
+	{
+		Phreeqc *worker_ptr = jacobian_workers[n];
+		worker_sync(worker_ptr);
+		/* the columns change the model of the clone */
+		worker_ptr->jacobian_prep = -1;
+		worker_ptr->use = use;
+		worker_ptr->cell_no = cell_no;
+		worker_ptr->cell_guess_n = cell_guess_n;
+		worker_ptr->reaction_step = reaction_step;
+		worker_ptr->count_total_steps = count_total_steps;
+		worker_ptr->rate_kin_time = rate_kin_time;
+		worker_ptr->solver_stats_on = solver_stats_on;
+		worker_ptr->cvode_n_user = cvode_n_user;
+		worker_ptr->cvode_n_reactions = n_reactions;
+		worker_ptr->cvode_step_fraction = cvode_step_fraction;
+		worker_ptr->cvode_rate_sim_time = cvode_rate_sim_time;
+		/* read only, shared with this instance */
+		worker_ptr->m_original = m_original;
+		worker_ptr->m_temp = m_temp;
+		worker_ptr->cvode_pp_assemblage_save = cvode_pp_assemblage_save;
+		worker_ptr->cvode_ss_assemblage_save = cvode_ss_assemblage_save;
+	}
+
+	std::vector<worker_cell> results(n_reactions);
+	std::vector<int> failed(n_reactions, 0);
+#ifdef USE_OPENMP
+	#pragma omp parallel for num_threads(n_workers) schedule(static)
+#endif
+	for (int k = 0; k < n_reactions; k++)
+	{
+		int n = k % n_workers;
+#ifdef USE_OPENMP
+		n = omp_get_thread_num();
+#endif
+		Phreeqc *worker_ptr = jacobian_workers[n];
+		WorkerIO *io = (WorkerIO *) worker_ptr->phrq_io;
+		worker_cell &r = results[k];
+		int warnings_start = worker_ptr->count_warnings;
+		int calculations_start = worker_ptr->cell_calculations;
+		int iterations_start = worker_ptr->cell_iterations;
+		int reactions_iterations_start = worker_ptr->run_reactions_iterations;
+
+		worker_ptr->solver_stats_clear();
+		io->Set_events(&r.events);
+		try
+		{
+			worker_copy_cell(worker_ptr, cvode_n_user, WORKER_NOMIX);
+			worker_ptr->cvode_kinetics_ptr = (void *) Utilities::Rxn_find(worker_ptr->Rxn_kinetics_map, cvode_n_user);
+			if (worker_ptr->cvode_kinetics_ptr == NULL ||
+				!worker_ptr->cvode_jacobian_column(k, y, initial_rates, J))
+			{
+				failed[k] = 1;
+			}
+		}
+		catch (...)
+		{
+			failed[k] = 1;
+		}
+		io->Set_events(NULL);
+		r.iterations = worker_ptr->run_reactions_iterations - reactions_iterations_start;
+		r.warnings = worker_ptr->count_warnings - warnings_start;
+		r.calculations = worker_ptr->cell_calculations - calculations_start;
+		r.cell_iterations = worker_ptr->cell_iterations - iterations_start;
+		r.stats.swap(worker_ptr->solver_stats_list);
+	}
+	for (int n = 0; n < n_workers; n++)
+	{
+		Phreeqc *worker_ptr = jacobian_workers[n];
+		worker_ptr->m_original = NULL;
+		worker_ptr->m_temp = NULL;
+		worker_ptr->cvode_pp_assemblage_save = NULL;
+		worker_ptr->cvode_ss_assemblage_save = NULL;
+		worker_ptr->cvode_kinetics_ptr = NULL;
+		profiler.Merge(worker_ptr->profiler);
+	}
+	for (int k = 0; k < n_reactions; k++)
+	{
+		if (failed[k])
+			return false;
+	}
+
+	/*
+	 *   merge in column order
+	 */
+	for (int k = 0; k < n_reactions; k++)
+	{
+		worker_cell &r = results[k];
+		count_warnings += r.warnings;
+		WorkerIO::replay(this, r.events);
+		for (size_t s = 0; s < r.stats.size(); s++)
+			solver_stats_add(r.stats[s]);
+		run_reactions_iterations += r.iterations;
+		cell_calculations += r.calculations;
+		cell_iterations += r.cell_iterations;
+	}
+	return true;
+}
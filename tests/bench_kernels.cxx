@@ -0,0 +1,689 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <IPhreeqc.hpp>
+
+// Times representative workloads against the bundled databases and
+// writes the results in the JSON layout of Google Benchmark, so that
+// runs can be compared with its compare.py.
+//
+//   bench_kernels [--database_dir=DIR] [--benchmark_filter=TEXT]
+//                 [--benchmark_min_time=SECONDS] [--benchmark_out=FILE]
+//                 [--benchmark_format=console|json]
+//
+// Each workload is run once untimed after the database is loaded and
+// then repeated until --benchmark_min_time seconds have elapsed.
+
+static const char SEAWATER[] =
+  "SOLUTION 1 Seawater\n"
+  " units ppm\n"
+  " pH 8.22\n"
+  " temp 25\n"
+  " density 1.023\n"
+  " Ca 412.3\n"
+  " Mg 1291.8\n"
+  " Na 10768.0\n"
+  " K 399.1\n"
+  " Cl 19353.0\n"
+  " Alkalinity 141.682 as HCO3\n"
+  " S(6) 2712.0\n"
+  " Si 4.28\n"
+  "SELECTED_OUTPUT\n"
+  " -reset false\n"
+  " -pH\n"
+  " -ionic_strength\n"
+  " -activities H2O Ca+2\n"
+  " -si Calcite Gypsum\n"
+  "END\n";
+
+// reaction steps of one model, timed per Newton iteration
+static const char SEAWATER_STEPS[] =
+  "SOLUTION 1 Seawater\n"
+  " units ppm\n"
+  " pH 8.22\n"
+  " pe 8.451\n"
+  " temp 25\n"
+  " density 1.023\n"
+  " Ca 412.3\n"
+  " Mg 1291.8\n"
+  " Na 10768.0\n"
+  " K 399.1\n"
+  " Fe 0.002\n"
+  " Mn 0.0002\n"
+  " Cl 19353.0\n"
+  " Alkalinity 141.682 as HCO3\n"
+  " S(6) 2712.0\n"
+  " N(5) 0.29 as NO3\n"
+  " Si 4.28\n"
+  "REACTION 1\n"
+  " CaCl2 1\n"
+  " 0.5 1 1.5 2 2.5 3 3.5 4 4.5 5 5.5 6 6.5 7 7.5 8 8.5 9 9.5 10 mmol\n"
+  "END\n";
+
+static const char EQUILIBRIUM_PHASES_SS[] =
+  "SOLUTION 1\n"
+  " pH 7 charge\n"
+  " Ca 2\n"
+  " Mg 1\n"
+  " Sr 0.05\n"
+  " C 4\n"
+  " S(6) 1\n"
+  " Cl 1\n"
+  "EQUILIBRIUM_PHASES 1\n"
+  " Dolomite 0 0\n"
+  " Gypsum 0 0\n"
+  " CO2(g) -2.0 10\n"
+  "SOLID_SOLUTIONS 1\n"
+  " Ca(x)Sr(1-x)CO3\n"
+  " -comp Calcite 0.1\n"
+  " -comp Strontianite 0.001\n"
+  "REACTION 1\n"
+  " CaCl2 1\n"
+  " 1 2 3 4 5 mmol\n"
+  "SELECTED_OUTPUT\n"
+  " -reset false\n"
+  " -pH\n"
+  " -equilibrium_phases Dolomite Gypsum\n"
+  " -solid_solutions Calcite Strontianite\n"
+  "END\n";
+
+static const char CD_MUSIC[] =
+  "SURFACE_MASTER_SPECIES\n"
+  " Goe_uni Goe_uniOH-0.5\n"
+  " Goe_tri Goe_triO-0.5\n"
+  "SURFACE_SPECIES\n"
+  " Goe_uniOH-0.5 = Goe_uniOH-0.5\n"
+  "  log_k 0\n"
+  " Goe_uniOH-0.5 + H+ = Goe_uniOH2+0.5\n"
+  "  log_k 9.20\n"
+  "  -cd_music 1 0 0 0 0\n"
+  " Goe_triO-0.5 = Goe_triO-0.5\n"
+  "  log_k 0\n"
+  " Goe_triO-0.5 + H+ = Goe_triOH+0.5\n"
+  "  log_k 9.20\n"
+  "  -cd_music 1 0 0 0 0\n"
+  " Goe_uniOH-0.5 + Na+ = Goe_uniOHNa+0.5\n"
+  "  log_k -0.6\n"
+  "  -cd_music 0 1 0 0 0\n"
+  " Goe_triO-0.5 + Na+ = Goe_triONa+0.5\n"
+  "  log_k -0.6\n"
+  "  -cd_music 0 1 0 0 0\n"
+  " Goe_uniOH-0.5 + H+ + NO3- = Goe_uniOH2NO3-0.5\n"
+  "  log_k 8.52\n"
+  "  -cd_music 1 -1 0 0 0\n"
+  " Goe_triO-0.5 + H+ + NO3- = Goe_triOHNO3-0.5\n"
+  "  log_k 8.52\n"
+  "  -cd_music 1 -1 0 0 0\n"
+  " 2Goe_uniOH-0.5 + 2H+ + PO4-3 = Goe_uni2O2PO2-2 + 2H2O\n"
+  "  log_k 29.77\n"
+  "  -cd_music 0.46 -1.46 0 0 0\n"
+  "SOLUTION 1\n"
+  " pH 4\n"
+  " Na 100\n"
+  " N(5) 100 charge\n"
+  " P 0.5\n"
+  "SURFACE 1\n"
+  " -cd_music\n"
+  " Goe_uniOH-0.5 3.45e-3 98 3.0\n"
+  " Goe_triO-0.5 2.7e-3\n"
+  " -capacitances 0.85 0.75\n"
+  " -equilibrate 1\n"
+  "REACTION 1\n"
+  " NaOH 1\n"
+  " 0.5 1 1.5 2 2.5 3 3.5 4 mmol\n"
+  "SELECTED_OUTPUT\n"
+  " -reset false\n"
+  " -pH\n"
+  " -molalities Goe_uni2O2PO2-2 H2PO4-\n"
+  "END\n";
+
+static const char TRANSPORT_MULTI_D[] =
+  "SOLUTION 0\n"
+  " Na 1\n"
+  " Cl 1\n"
+  "SOLUTION 1-20\n"
+  " K 1\n"
+  " N(5) 1\n"
+  "EXCHANGE 1-20\n"
+  " X 0.001\n"
+  " -equilibrate 1\n"
+  "TRANSPORT\n"
+  " -cells 20\n"
+  " -shifts 10\n"
+  " -flow_direction diffusion_only\n"
+  " -time_step 3600\n"
+  " -boundary_conditions constant closed\n"
+  " -lengths 0.01\n"
+  " -multi_d true 1e-9 0.3 0.05 1.0\n"
+  " -punch_cells 20\n"
+  " -punch_frequency 10\n"
+  "SELECTED_OUTPUT\n"
+  " -reset false\n"
+  " -totals Na Cl K\n"
+  "END\n";
+
+// the same transport run serially and on 4 cell workers (KNOBS -workers,
+// parallel only when built with IPHREEQC_ENABLE_OPENMP)
+#define TRANSPORT_CELLS_INPUT \
+  "SOLUTION 0\n" \
+  " Ca 0.6\n" \
+  " Cl 1.2\n" \
+  " C 0.1\n" \
+  "SOLUTION 1-40\n" \
+  " Na 1.0\n" \
+  " K 0.2\n" \
+  " N(5) 1.2 charge\n" \
+  " C 0.1\n" \
+  "EXCHANGE 1-40\n" \
+  " -equilibrate 1\n" \
+  " X 0.0011\n" \
+  "KINETICS 1-40\n" \
+  "Calcite\n" \
+  " -m0 1e-4\n" \
+  " -parms 1 0.6\n" \
+  "TRANSPORT\n" \
+  " -cells 40\n" \
+  " -shifts 20\n" \
+  " -time_step 720\n" \
+  " -lengths 0.002\n" \
+  " -dispersivities 0.002\n" \
+  " -punch_cells 40\n" \
+  " -punch_frequency 20\n" \
+  "SELECTED_OUTPUT\n" \
+  " -reset false\n" \
+  " -totals Na Cl K Ca\n" \
+  "END\n"
+
+static const char TRANSPORT_CELLS[] = TRANSPORT_CELLS_INPUT;
+
+static const char TRANSPORT_CELLS_WORKERS[] = "KNOBS\n -workers 4\n" TRANSPORT_CELLS_INPUT;
+
+// numerical jacobian of a fixed-volume gas phase, serially and with its
+// columns on 4 jacobian workers (KNOBS -jacobian_workers)
+#define JACOBIAN_GAS_INPUT \
+  "KNOBS\n" \
+  " -numerical_fixed_volume true\n" \
+  " -force_numerical_fixed_volume true\n" \
+  "SOLUTION 1\n" \
+  " temp 60\n" \
+  " pressure 150\n" \
+  " pH 7 charge\n" \
+  " Na 1000\n" \
+  " Cl 1000\n" \
+  " Ca 20\n" \
+  " Mg 10\n" \
+  " S(6) 20\n" \
+  " C(4) 10\n" \
+  "EQUILIBRIUM_PHASES 1\n" \
+  " Calcite 0 1\n" \
+  " Dolomite 0 1\n" \
+  " Anhydrite 0 1\n" \
+  "GAS_PHASE 1\n" \
+  " -fixed_volume\n" \
+  " -volume 1\n" \
+  " -temperature 60\n" \
+  " CO2(g) 0\n" \
+  " H2O(g) 0\n" \
+  " CH4(g) 0\n" \
+  " H2S(g) 0\n" \
+  " N2(g) 0\n" \
+  "REACTION 1\n" \
+  " CO2 1\n" \
+  " 8 mol in 20 steps\n" \
+  "SELECTED_OUTPUT\n" \
+  " -reset false\n" \
+  " -pH\n" \
+  " -gases CO2(g) H2O(g)\n" \
+  "END\n"
+
+static const char JACOBIAN_GAS[] = JACOBIAN_GAS_INPUT;
+
+static const char JACOBIAN_GAS_WORKERS[] = "KNOBS\n -jacobian_workers 4\n" JACOBIAN_GAS_INPUT;
+
+static const char KINETICS_CVODE[] =
+  "SOLUTION 1\n"
+  " pH 7 charge\n"
+  " Ca 1\n"
+  " C 1 CO2(g) -2\n"
+  "KINETICS 1\n"
+  "Calcite\n"
+  " -tol 1e-8\n"
+  " -m0 3.e-3\n"
+  " -m 3.e-3\n"
+  " -parms 5 0.6\n"
+  "-steps 100 400 3100 10800 21600 5.04e4 8.64e4 1.728e5 1.728e5 1.728e5 1.728e5\n"
+  "-cvode true\n"
+  "INCREMENTAL_REACTIONS true\n"
+  "SELECTED_OUTPUT\n"
+  " -reset false\n"
+  " -time\n"
+  " -pH\n"
+  " -kinetic_reactants Calcite\n"
+  "END\n";
+
+static const char INVERSE[] =
+  "SOLUTION 1  SPRING WATER\n"
+  " temp 8.0\n"
+  " pH 6.2\n"
+  " units mmol/kgw\n"
+  " Ca .078\n"
+  " Mg .029\n"
+  " Na .134\n"
+  " K .028\n"
+  " Cl .014\n"
+  " S(6) .010\n"
+  " Alkalinity .328\n"
+  " Si .273\n"
+  "SOLUTION 2  ADDITIONAL WATER\n"
+  " temp 8.0\n"
+  " pH 6.8\n"
+  " units mmol/kgw\n"
+  " Ca .546\n"
+  " Mg .086\n"
+  " Na .357\n"
+  " K .047\n"
+  " Cl .058\n"
+  " S(6) .098\n"
+  " Alkalinity 1.414\n"
+  " Si .410\n"
+  "INVERSE_MODELING 1\n"
+  " -solutions 1 2\n"
+  " -uncertainty 0.05\n"
+  " -phases\n"
+  "  Halite\n"
+  "  Gypsum\n"
+  "  Kaolinite precip\n"
+  "  Ca-montmorillonite precip\n"
+  "  CO2(g)\n"
+  "  Calcite\n"
+  "  Chalcedony precip\n"
+  "  Biotite dissolve\n"
+  "  Plagioclase dissolve\n"
+  "PHASES\n"
+  "Biotite\n"
+  " KMg3AlSi3O10(OH)2 + 6H+ + 4H2O = K+ + 3Mg+2 + Al(OH)4- + 3H4SiO4\n"
+  " log_k 0.0\n"
+  "Plagioclase\n"
+  " Na0.62Ca0.38Al1.38Si2.62O8 + 5.52 H+ + 2.48H2O = 0.62Na+ + 0.38Ca+2 + 1.38Al+3 + 2.62H4SiO4\n"
+  " log_k 0.0\n"
+  "END\n";
+
+// 23 phases that are the only source of an element and 7 alternatives
+// for them, solution 2 is solution 1 after reaction with the 23 phases
+static const char INVERSE_30[] =
+  "PHASES\n"
+  "MgCO3\n"
+  " MgCO3 = Mg+2 + CO3-2\n"
+  " log_k 0.0\n"
+  "Na2CO3\n"
+  " Na2CO3 = 2Na+ + CO3-2\n"
+  " log_k 0.0\n"
+  "K2CO3\n"
+  " K2CO3 = 2K+ + CO3-2\n"
+  " log_k 0.0\n"
+  "Li2CO3\n"
+  " Li2CO3 = 2Li+ + CO3-2\n"
+  " log_k 0.0\n"
+  "CuCO3\n"
+  " CuCO3 = Cu+2 + CO3-2\n"
+  " log_k 0.0\n"
+  "PbCO3\n"
+  " PbCO3 = Pb+2 + CO3-2\n"
+  " log_k 0.0\n"
+  "HCl(g)\n"
+  " HCl = H+ + Cl-\n"
+  " log_k 0.0\n"
+  "HBr(g)\n"
+  " HBr = H+ + Br-\n"
+  " log_k 0.0\n"
+  "HF(g)\n"
+  " HF = H+ + F-\n"
+  " log_k 0.0\n"
+  "HNO3(l)\n"
+  " HNO3 = H+ + NO3-\n"
+  " log_k 0.0\n"
+  "H2SO4(l)\n"
+  " H2SO4 = 2H+ + SO4-2\n"
+  " log_k 0.0\n"
+  "H3PO4(s)\n"
+  " H3PO4 = 3H+ + PO4-3\n"
+  " log_k 0.0\n"
+  "H3BO3(s)\n"
+  " H3BO3 = H3BO3\n"
+  " log_k 0.0\n"
+  "SOLUTION 1\n"
+  " units mmol/kgw\n"
+  " pH 7.0\n"
+  " Ca 0.5\n"
+  " Na 0.5\n"
+  " Cl 0.5\n"
+  " Alkalinity 1.0\n"
+  "END\n"
+  "USE solution 1\n"
+  "REACTION 1\n"
+  " Calcite 1.0; MgCO3 0.4; Na2CO3 0.2; K2CO3 0.1; Li2CO3 0.05\n"
+  " Siderite 0.02; Rhodochrosite 0.01; Witherite 0.03; Strontianite 0.04\n"
+  " Smithsonite 0.01; Otavite 0.005; PbCO3 0.005; CuCO3 0.01\n"
+  " Gibbsite 0.01; Chalcedony 0.3; CO2(g) 0.5\n"
+  " HCl(g) 0.6; HBr(g) 0.02; HF(g) 0.03; HNO3(l) 0.1; H2SO4(l) 0.2\n"
+  " H3PO4(s) 0.01; H3BO3(s) 0.02\n"
+  " 0.001 mol\n"
+  "SAVE solution 2\n"
+  "END\n"
+  "INVERSE_MODELING 1\n"
+  " -solutions 1 2\n"
+  " -uncertainty 0.05\n"
+  " -minimal\n"
+  " -phases\n"
+  "  Calcite\n"
+  "  MgCO3\n"
+  "  Na2CO3\n"
+  "  K2CO3\n"
+  "  Li2CO3\n"
+  "  Siderite\n"
+  "  Rhodochrosite\n"
+  "  Witherite\n"
+  "  Strontianite\n"
+  "  Smithsonite\n"
+  "  Otavite\n"
+  "  PbCO3\n"
+  "  CuCO3\n"
+  "  Gibbsite\n"
+  "  Chalcedony\n"
+  "  CO2(g)\n"
+  "  HCl(g)\n"
+  "  HBr(g)\n"
+  "  HF(g)\n"
+  "  HNO3(l)\n"
+  "  H2SO4(l)\n"
+  "  H3PO4(s)\n"
+  "  H3BO3(s)\n"
+  "  Aragonite\n"
+  "  Quartz\n"
+  "  SiO2(a)\n"
+  "  Al(OH)3(a)\n"
+  "  Barite\n"
+  "  Celestite\n"
+  "  Anglesite\n"
+  "END\n";
+
+struct Workload
+{
+  const char* name;
+  const char* database;
+  const char* input;             // NULL times LoadDatabase itself
+};
+
+static const Workload WORKLOADS[] =
+{
+  { "LoadDatabase/phreeqc.dat",         "phreeqc.dat", NULL },
+  { "LoadDatabase/llnl.dat",            "llnl.dat",    NULL },
+  { "Speciation/seawater/phreeqc.dat",  "phreeqc.dat", SEAWATER },
+  { "Speciation/seawater/llnl.dat",     "llnl.dat",    SEAWATER },
+  { "Speciation/seawater/pitzer.dat",   "pitzer.dat",  SEAWATER },
+  { "Speciation/seawater/sit.dat",      "sit.dat",     SEAWATER },
+  { "Newton/seawater_steps/phreeqc.dat", "phreeqc.dat", SEAWATER_STEPS },
+  { "Newton/seawater_steps/llnl.dat",   "llnl.dat",    SEAWATER_STEPS },
+  { "EquilibriumPhases/solid_solution", "phreeqc.dat", EQUILIBRIUM_PHASES_SS },
+  { "Surface/cd_music",                 "phreeqc.dat", CD_MUSIC },
+  { "Transport/multi_d",                "phreeqc.dat", TRANSPORT_MULTI_D },
+  { "Workers/transport/serial",         "phreeqc.dat", TRANSPORT_CELLS },
+  { "Workers/transport/4",              "phreeqc.dat", TRANSPORT_CELLS_WORKERS },
+  { "Workers/jacobian/serial",          "phreeqc.dat", JACOBIAN_GAS },
+  { "Workers/jacobian/4",               "phreeqc.dat", JACOBIAN_GAS_WORKERS },
+  { "Kinetics/cvode",                   "phreeqc.dat", KINETICS_CVODE },
+  { "Inverse/spring_water",             "phreeqc.dat", INVERSE },
+  { "Inverse/30_phases",                "phreeqc.dat", INVERSE_30 },
+};
+
+struct Result
+{
+  std::string name;
+  long iterations;
+  double real_time;              // milliseconds per iteration
+  double cpu_time;               // milliseconds per iteration
+  int newton_iterations;         // Newton iterations of one run
+};
+
+static double
+wall_seconds(void)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double
+cpu_seconds(void)
+{
+  return (double)std::clock() / CLOCKS_PER_SEC;
+}
+
+static bool
+run_once(IPhreeqc& iphreeqc, const std::string& database, const Workload& w)
+{
+  if (w.input == NULL)
+  {
+    return iphreeqc.LoadDatabase(database.c_str()) == 0;
+  }
+  return iphreeqc.RunString(w.input) == 0;
+}
+
+static bool
+run_workload(const Workload& w, const std::string& database_dir, double min_time, Result* result)
+{
+  std::string database = database_dir + "/" + w.database;
+
+  IPhreeqc iphreeqc;
+  if (iphreeqc.LoadDatabase(database.c_str()) != 0 || !run_once(iphreeqc, database, w))
+  {
+    std::cerr << w.name << ":\n" << iphreeqc.GetErrorString();
+    return false;
+  }
+
+  long iterations = 0;
+  double wall0 = wall_seconds();
+  double cpu0 = cpu_seconds();
+  double wall = 0.0;
+  do
+  {
+    if (!run_once(iphreeqc, database, w))
+    {
+      std::cerr << w.name << ":\n" << iphreeqc.GetErrorString();
+      return false;
+    }
+    ++iterations;
+    wall = wall_seconds() - wall0;
+  } while (wall < min_time);
+  double cpu = cpu_seconds() - cpu0;
+
+  result->name = w.name;
+  result->iterations = iterations;
+  result->real_time = 1e3 * wall / iterations;
+  result->cpu_time = 1e3 * cpu / iterations;
+  result->newton_iterations = 0;
+  if (w.input != NULL)
+  {
+    iphreeqc.GetWarmStartStatistics(NULL, NULL, &result->newton_iterations);
+  }
+  return true;
+}
+
+// s as the contents of a JSON string
+static std::string
+json_escape(const std::string& s)
+{
+  std::string escaped;
+  for (size_t i = 0; i < s.size(); ++i)
+  {
+    unsigned char c = (unsigned char) s[i];
+    if (c == '"' || c == '\\')
+    {
+      escaped += '\\';
+      escaped += (char) c;
+    }
+    else if (c < 0x20)
+    {
+      char code[8];
+      std::snprintf(code, sizeof(code), "\\u%04x", (unsigned int) c);
+      escaped += code;
+    }
+    else
+    {
+      escaped += (char) c;
+    }
+  }
+  return escaped;
+}
+
+static void
+write_json(std::ostream& os, const std::vector<Result>& results, const char* executable)
+{
+  char date[64];
+  std::time_t now = std::time(NULL);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+  os << std::setprecision(9);
+  os << "{\n";
+  os << "  \"context\": {\n";
+  os << "    \"date\": \"" << date << "\",\n";
+  os << "    \"executable\": \"" << json_escape(executable) << "\",\n";
+  os << "    \"library_version\": \"" << json_escape(IPhreeqc::GetVersionString()) << "\"\n";
+  os << "  },\n";
+  os << "  \"benchmarks\": [\n";
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    const Result& r = results[i];
+    os << "    {\n";
+    os << "      \"name\": \"" << json_escape(r.name) << "\",\n";
+    os << "      \"run_name\": \"" << json_escape(r.name) << "\",\n";
+    os << "      \"run_type\": \"iteration\",\n";
+    os << "      \"iterations\": " << r.iterations << ",\n";
+    os << "      \"real_time\": " << r.real_time << ",\n";
+    os << "      \"cpu_time\": " << r.cpu_time << ",\n";
+    os << "      \"time_unit\": \"ms\"";
+    if (r.newton_iterations > 0)
+    {
+      // user counters
+      os << ",\n      \"newton_iterations\": " << r.newton_iterations;
+      os << ",\n      \"us_per_newton_iteration\": " << 1e3 * r.real_time / r.newton_iterations;
+    }
+    os << "\n";
+    os << "    }" << (i + 1 < results.size() ? ",\n" : "\n");
+  }
+  os << "  ]\n";
+  os << "}\n";
+}
+
+static void
+write_console(std::ostream& os, const std::vector<Result>& results)
+{
+  os << std::left << std::setw(36) << "Benchmark" << std::right
+    << std::setw(14) << "Time(ms)" << std::setw(14) << "CPU(ms)" << std::setw(12) << "Iterations"
+    << std::setw(14) << "us/Newton" << "\n";
+  os << std::string(90, '-') << "\n";
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    const Result& r = results[i];
+    os << std::left << std::setw(36) << r.name << std::right << std::fixed << std::setprecision(3)
+      << std::setw(14) << r.real_time << std::setw(14) << r.cpu_time << std::setw(12) << r.iterations;
+    if (r.newton_iterations > 0)
+    {
+      os << std::setw(14) << 1e3 * r.real_time / r.newton_iterations;
+    }
+    os << "\n";
+  }
+}
+
+static bool
+get_option(const char* arg, const char* option, std::string* value)
+{
+  size_t n = std::strlen(option);
+  if (std::strncmp(arg, option, n) != 0 || arg[n] != '=')
+  {
+    return false;
+  }
+  *value = arg + n + 1;
+  return true;
+}
+
+int
+main(int argc, char* argv[])
+{
+  std::string database_dir = ".";
+  std::string filter;
+  std::string out;
+  std::string format = "console";
+  double min_time = 0.5;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string value;
+    if (get_option(argv[i], "--database_dir", &value))
+    {
+      database_dir = value;
+    }
+    else if (get_option(argv[i], "--benchmark_filter", &value))
+    {
+      filter = value;
+    }
+    else if (get_option(argv[i], "--benchmark_min_time", &value))
+    {
+      min_time = std::atof(value.c_str());
+    }
+    else if (get_option(argv[i], "--benchmark_out", &value))
+    {
+      out = value;
+    }
+    else if (get_option(argv[i], "--benchmark_format", &value) && (value == "console" || value == "json"))
+    {
+      format = value;
+    }
+    else
+    {
+      std::cerr << "Unknown option: " << argv[i] << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::vector<Result> results;
+  for (size_t i = 0; i < sizeof(WORKLOADS) / sizeof(WORKLOADS[0]); ++i)
+  {
+    if (!filter.empty() && std::string(WORKLOADS[i].name).find(filter) == std::string::npos)
+    {
+      continue;
+    }
+    Result r;
+    if (!run_workload(WORKLOADS[i], database_dir, min_time, &r))
+    {
+      return EXIT_FAILURE;
+    }
+    results.push_back(r);
+  }
+
+  if (format == "json")
+  {
+    write_json(std::cout, results, argv[0]);
+  }
+  else
+  {
+    write_console(std::cout, results);
+  }
+  if (!out.empty())
+  {
+    std::ofstream ofs(out.c_str());
+    if (!ofs)
+    {
+      std::cerr << "Unable to open " << out << "\n";
+      return EXIT_FAILURE;
+    }
+    write_json(ofs, results, argv[0]);
+  }
+  return EXIT_SUCCESS;
+}
@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <string.h>
 #include <IPhreeqc.h>
 
 typedef int (*getFunc)(int);
@@ -10,7 +11,10 @@ main(int argc, const char* argv[])
 {
   int id;
   int r, c;
+  int ncomps, ca;
+  int rows, cols;
   VAR v;
+  double *c_in, *c_out, *values;
 
   id = CreateIPhreeqc();
   if (id < 0)
@@ -78,7 +82,57 @@ main(int argc, const char* argv[])
       VarClear(&v);
     }
   }
-  
+
+  /* GetSelectedOutputDoubles checks the dimensions of the array */
+  rows = GetSelectedOutputRowCount(id) - 1;
+  cols = GetSelectedOutputColumnCount(id);
+  values = (double *) malloc(rows * cols * sizeof(double));
+  if (values == NULL)
+  {
+    return EXIT_FAILURE;
+  }
+  if (GetSelectedOutputDoubles(id, values, rows, cols - 1, 1) != IPQ_INVALIDARG ||
+    GetSelectedOutputDoubles(id, values, rows - 1, cols, 0) != IPQ_INVALIDARG ||
+    GetSelectedOutputDoubles(id, values, rows, cols, 0) != IPQ_OK ||
+    values[rows - 1] != GetSelectedOutputColumnDoubles(id, 0)[rows - 1])
+  {
+    return EXIT_FAILURE;
+  }
+  free(values);
+
+  /* RunCells with totals; twice the water dissolves about twice the gypsum */
+  ncomps = GetComponentCount(id) + 3;
+  for (ca = 3; ca < ncomps; ++ca)
+  {
+    if (strcmp(GetComponent(id, ca - 3), "Ca") == 0)
+    {
+      break;
+    }
+  }
+  c_in = (double *) malloc(2 * ncomps * sizeof(double));
+  if (ca >= ncomps || c_in == NULL)
+  {
+    return EXIT_FAILURE;
+  }
+  c_out = c_in + ncomps;
+  if (RunCells(id, 1, 1, NULL, NULL, NULL, c_in, NULL) != 0)
+  {
+    OutputErrorString(id);
+    return EXIT_FAILURE;
+  }
+  c_in[0] *= 2.0;
+  c_in[1] *= 2.0;
+  if (RunCells(id, 1, 1, c_in, NULL, NULL, c_out, NULL) != 0)
+  {
+    OutputErrorString(id);
+    return EXIT_FAILURE;
+  }
+  if (c_out[ca] < 1.8 * c_in[ca] || c_out[ca] > 2.2 * c_in[ca])
+  {
+    return EXIT_FAILURE;
+  }
+  free(c_in);
+
   if (DestroyIPhreeqc(id) != IPQ_OK)
   {
     OutputErrorString(id);
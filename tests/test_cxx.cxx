@@ -1,5 +1,16 @@
+#include <cmath>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <string>
+#include <vector>
+#if defined(_WIN32)
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
 #include <IPhreeqc.hpp>
 
 template <class TClass> class TTestGetSet
@@ -40,6 +51,109 @@ public:
     }
 };
 
+// Runs input with the numerical and with the analytic jacobian; debug_model
+// prints the difference of the two jacobians in each iteration
+int
+TestAnalyticJacobian(const char *db, const char *input)
+{
+  VAR v, b;
+  VarInit(&v);
+  VarInit(&b);
+  std::string analytic_input = std::string("KNOBS\n -analytic_jacobian true\n -debug_model true\n") + input;
+  IPhreeqc numeric, analytic;
+  analytic.SetOutputStringOn(true);
+  if (numeric.LoadDatabaseString(db) != 0 || numeric.RunString(input) != 0 ||
+    analytic.LoadDatabaseString(db) != 0 || analytic.RunString(analytic_input.c_str()) != 0)
+  {
+    std::cout << numeric.GetErrorString() << analytic.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  int jacobians = 0;
+  const std::string jacobian_line("Analytic jacobian: largest difference from numerical ");
+  for (int i = 0; i < analytic.GetOutputStringLineCount(); ++i)
+  {
+    std::string line(analytic.GetOutputStringLine(i));
+    if (line.compare(0, jacobian_line.size(), jacobian_line) != 0)
+    {
+      continue;
+    }
+    if (atof(line.c_str() + jacobian_line.size()) > 1e-4)
+    {
+      std::cout << line << std::endl;
+      return EXIT_FAILURE;
+    }
+    ++jacobians;
+  }
+  if (jacobians == 0)
+  {
+    return EXIT_FAILURE;
+  }
+  for (int r = 1; r < numeric.GetSelectedOutputRowCount(); ++r)
+  {
+    for (int c = 0; c < numeric.GetSelectedOutputColumnCount(); ++c)
+    {
+      numeric.GetSelectedOutputValue(r, c, &v);
+      analytic.GetSelectedOutputValue(r, c, &b);
+      if (b.type != TT_DOUBLE || fabs(v.dVal - b.dVal) > 1e-6 * fabs(v.dVal))
+      {
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+// Runs input serially and on cell workers; the selected output must be
+// the same to the last bit, and no phase may report negative self time
+int
+TestCellWorkers(const char *input)
+{
+  VAR v, b;
+  VarInit(&v);
+  VarInit(&b);
+  std::string workers_input = std::string("KNOBS\n -workers 4\n") + input;
+  IPhreeqc serial, workers;
+  workers.SetProfilingOn(true);
+  if (serial.LoadDatabase("phreeqc.dat") != 0 || serial.RunString(input) != 0 ||
+    workers.LoadDatabase("phreeqc.dat") != 0 || workers.RunString(workers_input.c_str()) != 0)
+  {
+    std::cout << serial.GetErrorString() << workers.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  int serial_calculations, workers_calculations;
+  serial.GetWarmStartStatistics(&serial_calculations, NULL, NULL);
+  workers.GetWarmStartStatistics(&workers_calculations, NULL, NULL);
+  if (serial.GetSelectedOutputRowCount() < 2 || workers_calculations != serial_calculations ||
+    workers.GetSelectedOutputRowCount() != serial.GetSelectedOutputRowCount() ||
+    workers.GetSelectedOutputColumnCount() != serial.GetSelectedOutputColumnCount())
+  {
+    return EXIT_FAILURE;
+  }
+  for (int r = 0; r < serial.GetSelectedOutputRowCount(); ++r)
+  {
+    for (int c = 0; c < serial.GetSelectedOutputColumnCount(); ++c)
+    {
+      serial.GetSelectedOutputValue(r, c, &v);
+      workers.GetSelectedOutputValue(r, c, &b);
+      if (v.type != b.type || (v.type == TT_DOUBLE && v.dVal != b.dVal) ||
+        (v.type == TT_STRING && strcmp(v.sVal, b.sVal) != 0))
+      {
+        return EXIT_FAILURE;
+      }
+      VarClear(&v);
+      VarClear(&b);
+    }
+  }
+  std::string profile = workers.GetProfilingString();
+  if (profile.find("\"cell_workers\"") == std::string::npos || profile.find("\"self\": -") != std::string::npos)
+  {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
 int
 main(int argc, const char* argv[])
 {
@@ -116,5 +230,708 @@ main(int argc, const char* argv[])
     }
   }
 
+  // A heading punched twice in a row keeps the last string, in place when it fits
+  IPhreeqc punched;
+  if (punched.LoadDatabase("phreeqc.dat") != 0 || punched.RunString(
+    "SOLUTION 1\nREACTION 1\n NaCl 1\n 1 2 3 4 mmol\nSELECTED_OUTPUT\n -reset false\n"
+    "USER_PUNCH\n -headings name name name\n"
+    " 10 PUNCH \"a longer name\", \"x\", \"the longest name of all\"\nEND\n") != 0)
+  {
+    std::cout << punched.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  if (punched.GetSelectedOutputRowCount() != 6 || punched.GetSelectedOutputColumnCount() != 1)
+  {
+    return EXIT_FAILURE;
+  }
+  for (int r = 1; r < punched.GetSelectedOutputRowCount(); ++r)
+  {
+    if (punched.GetSelectedOutputValue(r, 0, &v) != VR_OK || v.type != TT_STRING ||
+      strcmp(v.sVal, "the longest name of all") != 0)
+    {
+      return EXIT_FAILURE;
+    }
+    ::VarClear(&v);
+  }
+
+  // RunCells
+  std::vector<double> tc(1, 50.0);
+  std::vector<double> c_out(iphreeqc.GetComponentCount() + 3);
+  std::vector<double> so_out(iphreeqc.GetSelectedOutputColumnCount());
+  if (iphreeqc.RunCells(1, 1, NULL, &tc[0], NULL, &c_out[0], &so_out[0]) != 0)
+  {
+    std::cout << iphreeqc.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  if (iphreeqc.GetSelectedOutputRowCount() != 2 || c_out[0] <= 0.0)
+  {
+    return EXIT_FAILURE;
+  }
+
+  // RunCells with totals; twice the water dissolves about twice the gypsum
+  size_t ca = 3;
+  while (ca < c_out.size() && iphreeqc.GetComponent((int) ca - 3) != std::string("Ca"))
+  {
+    ++ca;
+  }
+  std::vector<double> c_in(c_out);
+  c_in[0] *= 2.0;
+  c_in[1] *= 2.0;
+  std::vector<double> c_out2(c_out.size());
+  if (ca >= c_out.size() || iphreeqc.RunCells(1, 1, &c_in[0], &tc[0], NULL, &c_out2[0], &so_out[0]) != 0)
+  {
+    std::cout << iphreeqc.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  if (c_out2[ca] < 1.8 * c_out[ca] || c_out2[ca] > 2.2 * c_out[ca])
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Binary database image
+  IPhreeqc reference;
+  if (reference.LoadDatabase("phreeqc.dat") != 0 || reference.WriteDatabaseBinary("phreeqc.dat.bin") != 0)
+  {
+    std::cout << reference.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  if (reference.RunFile("ex2") != 0)
+  {
+    std::cout << reference.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  IPhreeqc binary;
+  if (binary.LoadDatabaseBinary("phreeqc.dat.bin", "phreeqc.dat") != 0 || binary.RunFile("ex2") != 0)
+  {
+    std::cout << binary.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  if (binary.GetSelectedOutputRowCount() != reference.GetSelectedOutputRowCount() ||
+    binary.GetSelectedOutputColumnCount() != reference.GetSelectedOutputColumnCount())
+  {
+    return EXIT_FAILURE;
+  }
+  VAR b;
+  ::VarInit(&b);
+  for (int r = 0; r < reference.GetSelectedOutputRowCount(); ++r)
+  {
+    for (int c = 0; c < reference.GetSelectedOutputColumnCount(); ++c)
+    {
+      reference.GetSelectedOutputValue(r, c, &v);
+      binary.GetSelectedOutputValue(r, c, &b);
+      if (v.type != b.type || (v.type == TT_DOUBLE && v.dVal != b.dVal))
+      {
+        return EXIT_FAILURE;
+      }
+      ::VarClear(&v);
+      ::VarClear(&b);
+    }
+  }
+  if (reference.GetDatabaseBinaryUsed() || !binary.GetDatabaseBinaryUsed())
+  {
+    return EXIT_FAILURE;
+  }
+
+  // A stale image is replaced from the database text
+  {
+    std::fstream image("phreeqc.dat.bin", std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+    unsigned int version = 0xffffffff;
+    image.seekp(sizeof("PHRQDBI"));
+    image.write((const char *) &version, sizeof(version));
+  }
+  if (binary.LoadDatabaseBinary("phreeqc.dat.bin", "phreeqc.dat") != 0 || binary.GetDatabaseBinaryUsed() ||
+    binary.LoadDatabaseBinary("phreeqc.dat.bin", "phreeqc.dat") != 0 || !binary.GetDatabaseBinaryUsed())
+  {
+    std::cout << binary.GetErrorString();
+    return EXIT_FAILURE;
+  }
+
+  // So is the image of a database that has changed
+  const char *changed_input = "SOLUTION 1\nEQUILIBRIUM_PHASES 1\n Changed_halite 0 0\nEND\n";
+  {
+    std::ifstream original("phreeqc.dat", std::ios_base::in | std::ios_base::binary);
+    std::ofstream changed("changed.dat", std::ios_base::out | std::ios_base::binary);
+    changed << original.rdbuf();
+  }
+  std::remove("changed.dat.bin");
+  if (binary.LoadDatabaseBinary("changed.dat.bin", "changed.dat") != 0 || binary.GetDatabaseBinaryUsed() ||
+    binary.LoadDatabaseBinary("changed.dat.bin", "changed.dat") != 0 || !binary.GetDatabaseBinaryUsed() ||
+    binary.RunString(changed_input) == 0)
+  {
+    return EXIT_FAILURE;
+  }
+  {
+    std::ifstream original("phreeqc.dat", std::ios_base::in | std::ios_base::binary);
+    std::ofstream changed("changed.dat", std::ios_base::out | std::ios_base::binary);
+    changed << "PHASES\nChanged_halite\n NaCl = Cl- + Na+\n log_k 1.570\n" << original.rdbuf();
+  }
+  if (binary.LoadDatabaseBinary("changed.dat.bin", "changed.dat") != 0 || binary.GetDatabaseBinaryUsed() ||
+    binary.RunString(changed_input) != 0 ||
+    binary.LoadDatabaseBinary("changed.dat.bin", "changed.dat") != 0 || !binary.GetDatabaseBinaryUsed() ||
+    binary.RunString(changed_input) != 0)
+  {
+    std::cout << binary.GetErrorString();
+    return EXIT_FAILURE;
+  }
+
+  // but not the image of a database that was only touched
+  for (int i = 1; i <= 2; ++i)
+  {
+    struct utimbuf times;
+    times.actime = times.modtime = 1000000000 + 100 * i;
+    if (::utime("changed.dat", &times) != 0 ||
+      binary.LoadDatabaseBinary("changed.dat.bin", "changed.dat") != 0 || !binary.GetDatabaseBinaryUsed() ||
+      binary.RunString(changed_input) != 0)
+    {
+      std::cout << binary.GetErrorString();
+      return EXIT_FAILURE;
+    }
+  }
+  std::remove("changed.dat");
+  std::remove("changed.dat.bin");
+
+  // Sparse LU solver
+  const char *sparse_input =
+    "SOLUTION 1\n pH 8.2\n Na 10\n Cl 10\n Ca 2\n Mg 1\n S(6) 1\n C(4) 2\n"
+    "REACTION 1\n NaCl 1\n 0.05 in 5 steps\n"
+    "SELECTED_OUTPUT\n -reset false\n -pH\n -ionic_strength\nEND\n";
+  IPhreeqc dense, sparse;
+  if (dense.LoadDatabase("phreeqc.dat") != 0 || dense.RunString(sparse_input) != 0)
+  {
+    std::cout << dense.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  std::string knobs = std::string("KNOBS\n -sparse_solver true\n -solver_stats true\n") + sparse_input;
+  if (sparse.LoadDatabase("phreeqc.dat") != 0 || sparse.RunString(knobs.c_str()) != 0)
+  {
+    std::cout << sparse.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  if (sparse.GetSelectedOutputRowCount() != dense.GetSelectedOutputRowCount())
+  {
+    return EXIT_FAILURE;
+  }
+  for (int r = 1; r < dense.GetSelectedOutputRowCount(); ++r)
+  {
+    for (int c = 0; c < dense.GetSelectedOutputColumnCount(); ++c)
+    {
+      dense.GetSelectedOutputValue(r, c, &v);
+      sparse.GetSelectedOutputValue(r, c, &b);
+      if (v.type != TT_DOUBLE || b.type != TT_DOUBLE ||
+        fabs(v.dVal - b.dVal) > 1e-8 * fabs(v.dVal))
+      {
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  int sparse_solves = 0;
+  for (int n = 0; n < sparse.GetSolverStatsCount(); ++n)
+  {
+    SolverStats s;
+    sparse.GetSolverStats(n, &s);
+    sparse_solves += s.sparse_solves;
+  }
+  if (sparse_solves == 0)
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Warm start
+  std::string warm_input = std::string("KNOBS\n -warm_start true\n") + sparse_input;
+  IPhreeqc warm;
+  if (warm.LoadDatabase("phreeqc.dat") != 0 || warm.RunString(warm_input.c_str()) != 0)
+  {
+    std::cout << warm.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  int calculations, warm_starts, iterations;
+  warm.GetWarmStartStatistics(&calculations, &warm_starts, &iterations);
+  if (calculations < 5 || warm_starts < 4 || iterations <= 0)
+  {
+    return EXIT_FAILURE;
+  }
+  for (int r = 1; r < dense.GetSelectedOutputRowCount(); ++r)
+  {
+    for (int c = 0; c < dense.GetSelectedOutputColumnCount(); ++c)
+    {
+      dense.GetSelectedOutputValue(r, c, &v);
+      warm.GetSelectedOutputValue(r, c, &b);
+      if (b.type != TT_DOUBLE || fabs(v.dVal - b.dVal) > 1e-8 * fabs(v.dVal))
+      {
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  // guesses are kept from one run to the next, the first calculation starts warm too
+  if (warm.RunString(sparse_input) != 0)
+  {
+    std::cout << warm.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  int warm_calculations;
+  warm.GetWarmStartStatistics(&warm_calculations, &warm_starts, NULL);
+  if (warm_calculations != calculations || warm_starts != calculations)
+  {
+    return EXIT_FAILURE;
+  }
+  // and dropped when the species may have changed
+  std::string phases_input = std::string("PHASES\nFix_H+\n H+ = H+\n log_k 0\n") + sparse_input;
+  if (warm.RunString(phases_input.c_str()) != 0)
+  {
+    std::cout << warm.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  warm.GetWarmStartStatistics(&warm_calculations, &warm_starts, NULL);
+  if (warm_calculations != calculations || warm_starts != calculations - 1)
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Interpolated log K
+  std::string grid_input = std::string("KNOBS\n -logk_grid 5 1e-6\n") + sparse_input;
+  grid_input.insert(grid_input.find(" Na 10\n"), " temp 57.3\n");
+  std::string exact_input = grid_input.substr(grid_input.find("SOLUTION"));
+  IPhreeqc exact, grid;
+  if (exact.LoadDatabase("phreeqc.dat") != 0 || exact.RunString(exact_input.c_str()) != 0 ||
+    grid.LoadDatabase("phreeqc.dat") != 0 || grid.RunString(grid_input.c_str()) != 0)
+  {
+    std::cout << exact.GetErrorString() << grid.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  for (int r = 1; r < exact.GetSelectedOutputRowCount(); ++r)
+  {
+    for (int c = 0; c < exact.GetSelectedOutputColumnCount(); ++c)
+    {
+      exact.GetSelectedOutputValue(r, c, &v);
+      grid.GetSelectedOutputValue(r, c, &b);
+      if (b.type != TT_DOUBLE || fabs(v.dVal - b.dVal) > 1e-5 * fabs(v.dVal))
+      {
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // Analytic Pitzer jacobian
+  const char *pitzer_db =
+    "SOLUTION_MASTER_SPECIES\n H H+ -1 H 1.008\n H(1) H+ -1 0\n E e- 0 0 0\n O H2O 0 O 16.0\n"
+    " O(-2) H2O 0 0\n Na Na+ 0 Na 22.99\n Ca Ca+2 0 Ca 40.08\n Cl Cl- 0 Cl 35.453\n"
+    " S SO4-2 0 SO4 96.06\n S(6) SO4-2 0 SO4\n"
+    "SOLUTION_SPECIES\n H+ = H+\n e- = e-\n H2O = H2O\n Na+ = Na+\n Ca+2 = Ca+2\n Cl- = Cl-\n"
+    " SO4-2 = SO4-2\n H2O = OH- + H+\n log_k -13.998\n Ca+2 + SO4-2 = CaSO4\n log_k 2.3\n"
+    "PHASES\n Halite\n NaCl = Cl- + Na+\n log_k 1.57\n"
+    " Gypsum\n CaSO4:2H2O = Ca+2 + SO4-2 + 2 H2O\n log_k -4.58\n"
+    "PITZER\n -B0\n Na+ Cl- 0.0765\n Ca+2 Cl- 0.3159\n Na+ SO4-2 0.01958\n Ca+2 SO4-2 0.2\n"
+    " -B1\n Na+ Cl- 0.2664\n Ca+2 Cl- 1.614\n Na+ SO4-2 1.113\n Ca+2 SO4-2 3.1973\n"
+    " -B2\n Ca+2 SO4-2 -54.24\n -C0\n Na+ Cl- 0.00127\n Ca+2 Cl- -0.00034\n Na+ SO4-2 0.00497\n"
+    " -THETA\n Na+ Ca+2 0.07\n Cl- SO4-2 0.02\n -LAMDA\n CaSO4 Na+ 0.1\n"
+    " -PSI\n Na+ Ca+2 Cl- -0.007\n Na+ Cl- SO4-2 0.0014\nEND\n";
+  const char *brine_input =
+    "SOLUTION 1\n units mol/kgw\n Na 4\n Ca 0.3\n Cl 4.5 charge\n S(6) 0.15\n"
+    "EQUILIBRIUM_PHASES\n Gypsum 0 0\n Halite 0 0\n"
+    "SELECTED_OUTPUT\n -reset false\n -ionic_strength\n -activities H2O Na+ Ca+2 Cl- SO4-2\nEND\n";
+  if (TestAnalyticJacobian(pitzer_db, brine_input) != EXIT_SUCCESS)
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Analytic SIT jacobian
+  const char *sit_db =
+    "SOLUTION_MASTER_SPECIES\n H H+ -1 H 1.008\n H(1) H+ -1 0\n E e- 0 0 0\n O H2O 0 O 16.0\n"
+    " O(-2) H2O 0 0\n Na Na+ 0 Na 22.99\n Ca Ca+2 0 Ca 40.08\n Cl Cl- 0 Cl 35.453\n"
+    " S SO4-2 0 SO4 96.06\n S(6) SO4-2 0 SO4\n"
+    "SOLUTION_SPECIES\n H+ = H+\n e- = e-\n H2O = H2O\n Na+ = Na+\n Ca+2 = Ca+2\n Cl- = Cl-\n"
+    " SO4-2 = SO4-2\n H2O = OH- + H+\n log_k -13.998\n Ca+2 + SO4-2 = CaSO4\n log_k 2.3\n"
+    " Na+ + SO4-2 = NaSO4-\n log_k 0.7\n 2 H+ + 2 e- = H2\n log_k -3.15\n"
+    " 2 H2O = O2 + 4 H+ + 4 e-\n log_k -86.08\n"
+    "PHASES\n Halite\n NaCl = Cl- + Na+\n log_k 1.57\n"
+    " Gypsum\n CaSO4:2H2O = Ca+2 + SO4-2 + 2 H2O\n log_k -4.58\n"
+    "SIT\n -epsilon\n Na+ Cl- 0.03\n Ca+2 Cl- 0.14\n Na+ SO4-2 -0.12\n Na+ NaSO4- -0.05\n"
+    " -epsilon1\n Na+ Cl- 0.01\n Ca+2 Cl- -0.02\nEND\n";
+  if (TestAnalyticJacobian(sit_db, brine_input) != EXIT_SUCCESS)
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Transport and RUN_CELLS on cell workers
+  const char *transport_input =
+    "SOLUTION 0\n Ca 0.6\n Cl 1.2\n C 0.1\n"
+    "SOLUTION 1-20\n Na 1.0\n K 0.2\n N(5) 1.2 charge\n C 0.1\n"
+    "EXCHANGE 1-20\n -equilibrate 1\n X 0.0011\n"
+    "KINETICS 1-20\n Calcite\n -m0 1e-4\n -parms 1 0.6\n"
+    "TRANSPORT\n -cells 20\n -shifts 10\n -time_step 720\n -lengths 0.004\n -dispersivities 0.002\n"
+    " -punch_cells 1-20\n -punch_frequency 5\n"
+    "SELECTED_OUTPUT\n -reset false\n -step\n -totals Na Cl K Ca\n -kinetic_reactants Calcite\nEND\n";
+  const char *run_cells_input =
+    "SOLUTION 1-8\n pH 7 charge\n Ca 1\n C 2\n"
+    "EQUILIBRIUM_PHASES 1-8\n Calcite 0 0\n"
+    "REACTION 1-8\n CO2 1\n 1 mmol\n"
+    "RUN_CELLS\n -cells 1-8\n"
+    "SELECTED_OUTPUT\n -reset false\n -solution\n -pH\n -equilibrium_phases Calcite\nEND\n";
+  if (TestCellWorkers(transport_input) != EXIT_SUCCESS || TestCellWorkers(run_cells_input) != EXIT_SUCCESS)
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Numerical jacobian columns on cloned workers, bit-for-bit: each column
+  // starts from the same state, serially or on a worker
+  const char *gas_input =
+    "KNOBS\n -numerical_fixed_volume true\n -force_numerical_fixed_volume true\n"
+    "SOLUTION 1\n temp 60\n pressure 150\n pH 7 charge\n Na 1000\n Cl 1000\n Ca 20\n C(4) 10\n"
+    "EQUILIBRIUM_PHASES 1\n Calcite 0 1\n"
+    "GAS_PHASE 1\n -fixed_volume\n -volume 1\n -temperature 60\n CO2(g) 0\n H2O(g) 0\n CH4(g) 0\n"
+    "REACTION 1\n CO2 1\n 0.5 1 2 4 8 mol\n"
+    "SELECTED_OUTPUT\n -reset false\n -pH\n -ionic_strength\n -gases CO2(g) H2O(g)\n"
+    " -equilibrium_phases Calcite\nEND\n";
+  std::string workers_input = std::string("KNOBS\n -jacobian_workers 3\n") + gas_input;
+  IPhreeqc serial, workers;
+  if (serial.LoadDatabase("phreeqc.dat") != 0 || serial.RunString(gas_input) != 0 ||
+    workers.LoadDatabase("phreeqc.dat") != 0 || workers.RunString(workers_input.c_str()) != 0)
+  {
+    std::cout << serial.GetErrorString() << workers.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  if (serial.GetSelectedOutputRowCount() != 7 || workers.GetSelectedOutputRowCount() != 7)
+  {
+    return EXIT_FAILURE;
+  }
+  for (int r = 1; r < serial.GetSelectedOutputRowCount(); ++r)
+  {
+    for (int c = 0; c < serial.GetSelectedOutputColumnCount(); ++c)
+    {
+      serial.GetSelectedOutputValue(r, c, &v);
+      workers.GetSelectedOutputValue(r, c, &b);
+      if (b.type != TT_DOUBLE || v.dVal != b.dVal)
+      {
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // Solver statistics of each calculation
+  std::string stats_input = std::string("KNOBS\n -solver_stats each\n") + sparse_input;
+  IPhreeqc stats;
+  if (stats.LoadDatabase("phreeqc.dat") != 0 || stats.RunString(stats_input.c_str()) != 0)
+  {
+    std::cout << stats.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  stats.GetWarmStartStatistics(&calculations, &warm_starts, &iterations);
+  if (calculations < 5 || stats.GetSolverStatsCount() != calculations || stats.GetSolverStats(calculations, NULL) != VR_INVALIDARG)
+  {
+    return EXIT_FAILURE;
+  }
+  int stats_iterations = 0;
+  for (int n = 0; n < stats.GetSolverStatsCount(); ++n)
+  {
+    SolverStats s;
+    if (stats.GetSolverStats(n, &s) != VR_OK || s.cell != 1 || s.calculations != 1 || !s.converged || s.tries != 1 ||
+      s.path != 1 || s.sparse_solves != 0 || s.time < s.time_ineq + s.time_gammas + s.time_jacobian)
+    {
+      return EXIT_FAILURE;
+    }
+    stats_iterations += s.iterations;
+  }
+  if (stats_iterations != iterations || dense.GetSolverStatsCount() != 0)
+  {
+    return EXIT_FAILURE;
+  }
+  // and summed by cell
+  stats_input = std::string("KNOBS\n -solver_stats true\n") + sparse_input;
+  IPhreeqc cell_stats;
+  SolverStats cs;
+  if (cell_stats.LoadDatabase("phreeqc.dat") != 0 || cell_stats.RunString(stats_input.c_str()) != 0)
+  {
+    std::cout << cell_stats.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  if (cell_stats.GetSolverStatsCount() != 1 || cell_stats.GetSolverStats(0, &cs) != VR_OK ||
+    cs.cell != 1 || cs.calculations != calculations || cs.tries != calculations || !cs.converged ||
+    cs.path != 1 || cs.iterations != iterations)
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Timers of the calculation phases
+  IPhreeqc timed;
+  timed.SetProfilingOn(true);
+  if (!timed.GetProfilingOn() || timed.LoadDatabase("phreeqc.dat") != 0 || timed.RunString(sparse_input) != 0)
+  {
+    std::cout << timed.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  std::string profile = timed.GetProfilingString();
+  if (profile.find("\"RunString\"") == std::string::npos || profile.find("\"read_input\"") == std::string::npos ||
+    profile.find("\"model\"") == std::string::npos || profile.find("\"punch_all\"") == std::string::npos)
+  {
+    return EXIT_FAILURE;
+  }
+  if (std::string(stats.GetProfilingString()).find("\"RunString\"") != std::string::npos)
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Constant names in BASIC are bound once and rebound when species change
+  const char bound_input[] =
+    "SOLUTION 1\n"
+    " Na 10\n"
+    " Br 10\n"
+    " Ca 1\n"
+    " Cl 2\n"
+    " C 1 Calcite\n"
+    "USER_PUNCH\n"
+    " -headings bound unbound\n"
+    "10 n$ = \"NaBr\"\n"
+    "20 PUNCH MOL(\"NaBr\") + TOT(\"Ca\") + SI(\"Calcite\"), MOL(n$) + TOT(\"C\" + \"a\") + SI(\"Calc\" + \"ite\")\n"
+    "SELECTED_OUTPUT\n"
+    " -reset false\n"
+    "END\n"
+    "SOLUTION_SPECIES\n"
+    "Na+ + Br- = NaBr\n"
+    " log_k 1\n"
+    "SOLUTION 1\n"
+    " Na 10\n"
+    " Br 10\n"
+    " Ca 1\n"
+    " Cl 2\n"
+    " C 1 Calcite\n"
+    "END\n";
+  IPhreeqc bound;
+  if (bound.LoadDatabase("phreeqc.dat") != 0 || bound.RunString(bound_input) != 0)
+  {
+    std::cout << bound.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  if (bound.GetSelectedOutputRowCount() != 3)
+  {
+    return EXIT_FAILURE;
+  }
+  for (int r = 1; r < 3; ++r)
+  {
+    VAR b, u;
+    ::VarInit(&b);
+    ::VarInit(&u);
+    if (bound.GetSelectedOutputValue(r, 0, &b) != VR_OK || bound.GetSelectedOutputValue(r, 1, &u) != VR_OK ||
+      b.type != TT_DOUBLE || u.type != TT_DOUBLE || b.dVal != u.dVal)
+    {
+      return EXIT_FAILURE;
+    }
+  }
+  VAR first, second;
+  ::VarInit(&first);
+  ::VarInit(&second);
+  bound.GetSelectedOutputValue(1, 0, &first);
+  bound.GetSelectedOutputValue(2, 0, &second);
+  if (second.dVal - first.dVal < 1e-6)
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Bulk double export of the selected-output columns
+  IPhreeqc bulk;
+  if (bulk.LoadDatabase("phreeqc.dat") != 0 || bulk.RunString(sparse_input) != 0)
+  {
+    std::cout << bulk.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  int rows = bulk.GetSelectedOutputRowCount() - 1;
+  int cols = bulk.GetSelectedOutputColumnCount();
+  if (rows < 1 || cols < 1 || bulk.GetSelectedOutputColumnDoubles(cols) != NULL)
+  {
+    return EXIT_FAILURE;
+  }
+  std::vector<double> by_row(rows * cols), by_col(rows * cols);
+  if (bulk.GetSelectedOutputDoubles(&by_row[0], rows, cols, true) != VR_OK ||
+    bulk.GetSelectedOutputDoubles(&by_col[0], rows, cols, false) != VR_OK)
+  {
+    return EXIT_FAILURE;
+  }
+  if (bulk.GetSelectedOutputDoubles(&by_row[0], rows - 1, cols, true) != VR_INVALIDARG ||
+    bulk.GetSelectedOutputDoubles(&by_col[0], rows, cols - 1, false) != VR_INVALIDARG)
+  {
+    return EXIT_FAILURE;
+  }
+  for (int c = 0; c < cols; ++c)
+  {
+    const double *column = bulk.GetSelectedOutputColumnDoubles(c);
+    for (int r = 0; r < rows; ++r)
+    {
+      VAR v;
+      ::VarInit(&v);
+      bulk.GetSelectedOutputValue(r + 1, c, &v);
+      double expected = (v.type == TT_DOUBLE) ? v.dVal : (v.type == TT_LONG) ? (double)v.lVal : 1e30;
+      ::VarClear(&v);
+      if (column == NULL || column[r] != expected || by_row[r * cols + c] != expected || by_col[c * rows + r] != expected)
+      {
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // Binary-only selected output skips the file and string but fills the buffer
+  IPhreeqc in_memory;
+  in_memory.SetSelectedOutputFileName("binary_only.sel");
+  in_memory.SetSelectedOutputFileOn(true);
+  in_memory.SetSelectedOutputStringOn(true);
+  in_memory.SetSelectedOutputBinaryOnly(true);
+  if (!in_memory.GetSelectedOutputBinaryOnly() || !in_memory.GetSelectedOutputFileOn() || !in_memory.GetSelectedOutputStringOn())
+  {
+    return EXIT_FAILURE;
+  }
+  std::remove("binary_only.sel");
+  if (in_memory.LoadDatabase("phreeqc.dat") != 0 || in_memory.RunString(sparse_input) != 0)
+  {
+    std::cout << in_memory.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  if (std::FILE *f = std::fopen("binary_only.sel", "r"))
+  {
+    std::fclose(f);
+    return EXIT_FAILURE;
+  }
+  if (in_memory.GetSelectedOutputStringLineCount() != 0 ||
+    in_memory.GetSelectedOutputRowCount() != rows + 1 || in_memory.GetSelectedOutputColumnCount() != cols)
+  {
+    return EXIT_FAILURE;
+  }
+  std::vector<double> in_memory_values(rows * cols);
+  in_memory.GetSelectedOutputDoubles(&in_memory_values[0], rows, cols, true);
+  if (in_memory_values != by_row)
+  {
+    return EXIT_FAILURE;
+  }
+
+
+  // CVODE jacobian columns on cloned workers and jacobian reuse
+  const char *cvode_input =
+    "SOLUTION 1\n pH 5 charge\n Na 0.1\n K 0.01\n Ca 0.1\n Cl 0.1\n C(4) 1\n Al 1e-6\n Si 0.01\n"
+    "KINETICS 1\nK-feldspar\n -m0 2.16\n -parms 6.41 0.1\n -tol 1e-9\nAlbite\n -m0 0.43\n -parms 43.1 0.1\n -tol 1e-9\n"
+    "Calcite\n -m0 3e-3\n -parms 50 0.6\n -tol 1e-9\n -steps 1e4 1e6 1e8 1e10\n -cvode true\n -cvode_steps 1000\n";
+  const char *cvode_punch = "SELECTED_OUTPUT\n -reset false\n -pH\n -kinetic_reactants K-feldspar Albite Calcite\nEND\n";
+  std::string cvode_serial_input = std::string(cvode_input) + cvode_punch;
+  std::string cvode_workers_input = std::string("KNOBS\n -jacobian_workers 3\n") + cvode_input + cvode_punch;
+  std::string cvode_reuse_input = std::string(cvode_input) + " -cvode_jacobian_steps 1000\n" + cvode_punch;
+  IPhreeqc cvode_serial, cvode_workers, cvode_reuse;
+  if (cvode_serial.LoadDatabase("phreeqc.dat") != 0 || cvode_serial.RunString(cvode_serial_input.c_str()) != 0 ||
+    cvode_workers.LoadDatabase("phreeqc.dat") != 0 || cvode_workers.RunString(cvode_workers_input.c_str()) != 0 ||
+    cvode_reuse.LoadDatabase("phreeqc.dat") != 0 || cvode_reuse.RunString(cvode_reuse_input.c_str()) != 0)
+  {
+    std::cout << cvode_serial.GetErrorString() << cvode_workers.GetErrorString() << cvode_reuse.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  if (cvode_serial.GetSelectedOutputRowCount() != 6 || cvode_workers.GetSelectedOutputRowCount() != 6 ||
+    cvode_reuse.GetSelectedOutputRowCount() != 6)
+  {
+    return EXIT_FAILURE;
+  }
+  for (int r = 1; r < cvode_serial.GetSelectedOutputRowCount(); ++r)
+  {
+    for (int c = 0; c < cvode_serial.GetSelectedOutputColumnCount(); ++c)
+    {
+      cvode_serial.GetSelectedOutputValue(r, c, &v);
+      cvode_workers.GetSelectedOutputValue(r, c, &b);
+      if (b.type != TT_DOUBLE || v.dVal != b.dVal)
+      {
+        return EXIT_FAILURE;
+      }
+      cvode_reuse.GetSelectedOutputValue(r, c, &b);
+      if (b.type != TT_DOUBLE || fabs(v.dVal - b.dVal) > 1e-2 * fabs(v.dVal) + 1e-9)
+      {
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  int integrations, steps, rhs_evaluations, jacobian_evaluations, reused_jacobian_evaluations;
+  cvode_serial.GetCvodeStatistics(&integrations, &steps, &rhs_evaluations, &jacobian_evaluations);
+  if (integrations < 4 || steps < integrations || rhs_evaluations < steps || jacobian_evaluations < integrations)
+  {
+    return EXIT_FAILURE;
+  }
+  cvode_reuse.GetCvodeStatistics(NULL, NULL, NULL, &reused_jacobian_evaluations);
+  if (reused_jacobian_evaluations <= 0 || reused_jacobian_evaluations >= jacobian_evaluations)
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Runge-Kutta stages that reuse the last equilibrium calculation
+  const char *rk_input =
+    "SOLUTION 1\n pH 5 charge\n Na 0.1\n K 0.01\n Ca 0.1\n Cl 0.1\n C(4) 1\n Al 1e-6\n Si 0.01\n"
+    "KINETICS 1\nK-feldspar\n -m0 2.16\n -parms 6.41 0.1\n -tol 1e-9\nAlbite\n -m0 0.43\n -parms 43.1 0.1\n -tol 1e-9\n"
+    "Calcite\n -m0 3e-3\n -parms 50 0.6\n -tol 1e-9\n -steps 1e7 in 5\n";
+  std::string rk_full_input = std::string(rk_input) + cvode_punch;
+  std::string rk_reuse_input = std::string(rk_input) + " -rk_reuse_tol 1e-6\n" + cvode_punch;
+  IPhreeqc rk_full, rk_reuse;
+  if (rk_full.LoadDatabase("phreeqc.dat") != 0 || rk_full.RunString(rk_full_input.c_str()) != 0 ||
+    rk_reuse.LoadDatabase("phreeqc.dat") != 0 || rk_reuse.RunString(rk_reuse_input.c_str()) != 0)
+  {
+    std::cout << rk_full.GetErrorString() << rk_reuse.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  if (rk_full.GetSelectedOutputRowCount() != 7 || rk_reuse.GetSelectedOutputRowCount() != 7)
+  {
+    return EXIT_FAILURE;
+  }
+  for (int r = 1; r < rk_full.GetSelectedOutputRowCount(); ++r)
+  {
+    for (int c = 0; c < rk_full.GetSelectedOutputColumnCount(); ++c)
+    {
+      rk_full.GetSelectedOutputValue(r, c, &v);
+      rk_reuse.GetSelectedOutputValue(r, c, &b);
+      if (b.type != TT_DOUBLE || fabs(v.dVal - b.dVal) > 1e-4 * fabs(v.dVal) + 1e-8)
+      {
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  int full_calculations, reuse_calculations;
+  rk_full.GetWarmStartStatistics(&full_calculations, NULL, NULL);
+  rk_reuse.GetWarmStartStatistics(&reuse_calculations, NULL, NULL);
+  if (reuse_calculations <= 0 || 2 * reuse_calculations > full_calculations)
+  {
+    return EXIT_FAILURE;
+  }
+
+  // Inverse modeling with more than 32 phases and solutions, each of 33
+  // elements comes from one phase and two of the phases have a duplicate
+  std::string inverse_master("SOLUTION_MASTER_SPECIES\n"), inverse_species("SOLUTION_SPECIES\n");
+  std::string inverse_phases("PHASES\n"), inverse_reaction("REACTION\n"), inverse_list;
+  for (int i = 0; i < 33; ++i)
+  {
+    std::string e = std::string(1, "QR"[i / 26]) + (char) ('a' + i % 26);
+    inverse_master += " " + e + " " + e + "+ 0 1 1\n";
+    inverse_species += e + "+ = " + e + "+\n log_k 0\n";
+    inverse_phases += e + "Cl\n " + e + "Cl = " + e + "+ + Cl-\n log_k 0\n";
+    inverse_reaction += " " + e + "Cl 1\n";
+    inverse_list += "  " + e + "Cl\n";
+    if (i < 2)
+    {
+      inverse_phases += e + "Cl(b)\n " + e + "Cl = " + e + "+ + Cl-\n log_k 0\n";
+      inverse_list += "  " + e + "Cl(b)\n";
+    }
+  }
+  std::string inverse_input = inverse_master + inverse_species + inverse_phases +
+    "SOLUTION 1\n Qa 1\n Cl 1\nEND\nUSE solution 1\n" + inverse_reaction + " 0.001 mol\nSAVE solution 2\nEND\n"
+    "INVERSE_MODELING\n -solutions 1 2\n -minimal\n -phases\n" + inverse_list;
+  IPhreeqc inverse;
+  inverse.SetOutputStringOn(true);
+  if (inverse.LoadDatabase("phreeqc.dat") != 0 || inverse.RunString(inverse_input.c_str()) != 0)
+  {
+    std::cout << inverse.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  int minimal_models = -1;
+  const std::string minimal_line("\tNumber of minimal models found: ");
+  for (int i = 0; i < inverse.GetOutputStringLineCount(); ++i)
+  {
+    std::string line(inverse.GetOutputStringLine(i));
+    if (line.compare(0, minimal_line.size(), minimal_line) == 0)
+    {
+      minimal_models = atoi(line.c_str() + minimal_line.size());
+    }
+  }
+  if (minimal_models != 4)
+  {
+    return EXIT_FAILURE;
+  }
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,227 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <IPhreeqc.hpp>
+
+// Runs ex2 on many IPhreeqc instances concurrently and checks that every
+// selected-output value is bit-for-bit identical to a serial run, first
+// with each instance loading phreeqc.dat and then with all instances
+// sharing one database snapshot.  Also checks that attached instances
+// share the species and phase reactions of the snapshot, and that a BASIC
+// program run again after SOLUTION_SPECIES and PHASES are redefined gives
+// the same values on an attached instance as on one that loaded the
+// database.
+
+const int NTHREADS = 64;
+
+struct Result
+{
+  bool ok;
+  IPhreeqcDatabase* snapshot;
+  std::vector<int> types;
+  std::vector<double> doubles;
+  std::vector<long> longs;
+  std::vector<std::string> strings;
+};
+
+static void
+run_ex2(Result* result)
+{
+  result->ok = false;
+
+  IPhreeqc iphreeqc;
+  int n = result->snapshot ? iphreeqc.LoadDatabaseSnapshot(result->snapshot) : iphreeqc.LoadDatabase("phreeqc.dat");
+  if (n != 0)
+  {
+    std::cerr << iphreeqc.GetErrorString();
+    return;
+  }
+  if (iphreeqc.RunFile("ex2") != 0)
+  {
+    std::cerr << iphreeqc.GetErrorString();
+    return;
+  }
+
+  VAR v;
+  ::VarInit(&v);
+  for (int r = 0; r < iphreeqc.GetSelectedOutputRowCount(); ++r)
+  {
+    for (int c = 0; c < iphreeqc.GetSelectedOutputColumnCount(); ++c)
+    {
+      if (iphreeqc.GetSelectedOutputValue(r, c, &v) != VR_OK)
+      {
+        return;
+      }
+      result->types.push_back(v.type);
+      switch (v.type)
+      {
+      case TT_DOUBLE:
+        result->doubles.push_back(v.dVal);
+        break;
+      case TT_LONG:
+        result->longs.push_back(v.lVal);
+        break;
+      case TT_STRING:
+        result->strings.push_back(v.sVal);
+        break;
+      default:
+        break;
+      }
+      ::VarClear(&v);
+    }
+  }
+  result->ok = true;
+}
+
+static bool
+same(const Result& a, const Result& b)
+{
+  return a.ok && b.ok
+    && a.types == b.types
+    && a.longs == b.longs
+    && a.strings == b.strings
+    && a.doubles.size() == b.doubles.size()
+    && (a.doubles.empty() ||
+        std::memcmp(&a.doubles[0], &b.doubles[0], a.doubles.size() * sizeof(double)) == 0);
+}
+
+static bool
+run_threads(const Result& serial, IPhreeqcDatabase* snapshot)
+{
+  std::vector<Result> results(NTHREADS);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < NTHREADS; ++i)
+  {
+    results[i].snapshot = snapshot;
+    threads.push_back(std::thread(run_ex2, &results[i]));
+  }
+  for (int i = 0; i < NTHREADS; ++i)
+  {
+    threads[i].join();
+  }
+
+  for (int i = 0; i < NTHREADS; ++i)
+  {
+    if (!same(serial, results[i]))
+    {
+      std::cerr << "thread " << i << " differs from the serial run" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+int
+main(int argc, const char* argv[])
+{
+  Result serial;
+  serial.snapshot = NULL;
+  run_ex2(&serial);
+  if (!serial.ok || serial.doubles.empty())
+  {
+    return EXIT_FAILURE;
+  }
+
+  if (!run_threads(serial, NULL))
+  {
+    return EXIT_FAILURE;
+  }
+
+  IPhreeqc iphreeqc;
+  if (iphreeqc.LoadDatabase("phreeqc.dat") != 0)
+  {
+    std::cerr << iphreeqc.GetErrorString();
+    return EXIT_FAILURE;
+  }
+  IPhreeqcDatabase* snapshot = iphreeqc.CreateDatabaseSnapshot();
+  if (snapshot == NULL)
+  {
+    return EXIT_FAILURE;
+  }
+  bool ok = run_threads(serial, snapshot);
+
+  // attached instances share the reactions of the snapshot until they
+  // define their own phases
+  IPhreeqc a, b;
+  if (a.LoadDatabaseSnapshot(snapshot) != 0 || b.LoadDatabaseSnapshot(snapshot) != 0)
+  {
+    ok = false;
+  }
+  int shared = a.GetSharedReactionCount();
+  if (shared <= 0 || b.GetSharedReactionCount() != shared)
+  {
+    std::cerr << "reactions are not shared with the snapshot" << std::endl;
+    ok = false;
+  }
+  if (b.RunString("PHASES\nFix_H+\n  H+ = H+\n  log_k 0\nSOLUTION 1\nEND\n") != 0)
+  {
+    std::cerr << b.GetErrorString();
+    ok = false;
+  }
+  if (b.GetSharedReactionCount() != 0 || a.GetSharedReactionCount() != shared)
+  {
+    std::cerr << "reactions are still shared after PHASES" << std::endl;
+    ok = false;
+  }
+
+  // the same BASIC program before and after species and phases change
+  const char redefine_input[] =
+    "SOLUTION 1\n Na 10\n Br 10\n Ca 1\n Cl 2\n C 1\n"
+    "SURFACE 1\n Hfo_wOH 1e-3 600 1\n -equilibrate 1\n"
+    "USER_PUNCH\n"
+    " -headings mol si surf\n"
+    "10 PUNCH MOL(\"NaBr\"), SI(\"Calcite\"), SURF(\"Ca\", \"Hfo\")\n"
+    "SELECTED_OUTPUT\n -reset false\n"
+    "END\n"
+    "SOLUTION_SPECIES\nNa+ + Br- = NaBr\n log_k 1\n"
+    "PHASES\nCalcite\n CaCO3 = CO3-2 + Ca+2\n log_k -8.0\n"
+    "SOLUTION 1\n Na 10\n Br 10\n Ca 1\n Cl 2\n C 1\n"
+    "SURFACE 1\n Hfo_wOH 1e-3 600 1\n -equilibrate 1\n"
+    "END\n";
+  IPhreeqc attached, loaded;
+  if (attached.LoadDatabaseSnapshot(snapshot) != 0 || attached.RunString(redefine_input) != 0 ||
+    loaded.LoadDatabase("phreeqc.dat") != 0 || loaded.RunString(redefine_input) != 0)
+  {
+    std::cerr << attached.GetErrorString() << loaded.GetErrorString();
+    ok = false;
+  }
+  else
+  {
+    // rows of the first simulation, then of the second
+    int rows = loaded.GetSelectedOutputRowCount();
+    int half = (rows - 1) / 2;
+    if (rows < 3 || attached.GetSelectedOutputRowCount() != rows)
+    {
+      ok = false;
+    }
+    for (int r = 1; r < rows && ok; ++r)
+    {
+      for (int c = 0; c < 3; ++c)
+      {
+        VAR va, vl, vr;
+        ::VarInit(&va);
+        ::VarInit(&vl);
+        ::VarInit(&vr);
+        attached.GetSelectedOutputValue(r, c, &va);
+        loaded.GetSelectedOutputValue(r, c, &vl);
+        if (va.type != TT_DOUBLE || vl.type != TT_DOUBLE || va.dVal != vl.dVal)
+        {
+          std::cerr << "attached and loaded instances differ after redefinition" << std::endl;
+          ok = false;
+        }
+        if (r <= half && c < 2 &&
+          (loaded.GetSelectedOutputValue(r + half, c, &vr) != VR_OK || vr.dVal == vl.dVal))
+        {
+          std::cerr << "redefinition did not change the BASIC values" << std::endl;
+          ok = false;
+        }
+      }
+    }
+  }
+  IPhreeqc::ReleaseDatabaseSnapshot(snapshot);
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}